@@ -1,12 +1,14 @@
 #pragma once
 
 #include "cascade/config.h"
+#include "cascade/detail/blob_segment_store.hpp"
 
 #include <derecho/core/derecho.hpp>
 #include <derecho/mutils-serialization/SerializationSupport.hpp>
 #include <derecho/persistent/Persistent.hpp>
 
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -97,6 +99,46 @@ public:
      * @param value
      */
     virtual void put_and_forget(const VT& value) const = 0;
+    /**
+     * put_and_forget_batch(const std::vector<VT>&)
+     *
+     * Put the values of a client-side batch, each of them as put_and_forget() does. The batch only saves the p2p
+     * messages: every value is still an ordered put of its own.
+     *
+     * @param values
+     */
+    virtual void put_and_forget_batch(const std::vector<VT>& values) const = 0;
+    /**
+     * put_batch(const std::vector<VT>&)
+     *
+     * Put a batch of values in one ordered message, which is logged as a single delta. All values in the batch get the
+     * version and the timestamp of the message. A value may be rejected, for example by the previous version check,
+     * without failing the rest of the batch.
+     *
+     * @param values
+     *
+     * @return a tuple of version number (version_t) and timestamp in microseconds for each value, in order. The version
+     *         of a rejected value is INVALID_VERSION.
+     */
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> put_batch(const std::vector<VT>& values) const = 0;
+    /**
+     * transact(const std::vector<std::tuple<KT, persistent::version_t>>&, const std::vector<VT>&)
+     *
+     * Put a set of values atomically and conditionally, in one ordered message. The transaction commits only if the
+     * current version of every key in the read set is the expected one, and every value in the write set passes its
+     * own checks (e.g. IVerifyPreviousVersion); otherwise nothing is written. The version of a key is the version of
+     * its current object, as returned by get(): for a removed key, it is the version of the remove, and for a key that
+     * never existed, it is INVALID_VERSION. The keys in the write set must be distinct.
+     *
+     * @param read_set      the keys and their expected versions
+     * @param write_set     the values to put
+     *
+     * @return a tuple including version number (version_t) and a timestamp in microseconds of the committed
+     *         transaction, or INVALID_VERSION if it is rejected. A read-only transaction writes no new version: it
+     *         returns the latest version of the shard, against which the read set is checked, and a zero timestamp.
+     */
+    virtual std::tuple<persistent::version_t, uint64_t> transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                 const std::vector<VT>& write_set) const = 0;
 #ifdef ENABLE_EVALUATION
     /**
      * perf_put is used to evaluate the performance of an internal shard
@@ -176,6 +218,34 @@ public:
      */
     virtual const VT get_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const = 0;
 
+    /**
+     * get_many(const std::vector<KT>&, const persistent::version_t&, const bool)
+     *
+     * Get the values of a set of keys, as get() does with exact == false, but all from the same state: at the
+     * current version, the values are read from one consistent snapshot of the store without taking a lock; at an
+     * earlier version, they are read from the state at that version.
+     *
+     * @param keys
+     * @param ver   Version. CURRENT_VERSION for the latest value.
+     * @param stable
+     *
+     * @return the values, in the order of the keys. The value of a key that is not found is invalid.
+     */
+    virtual std::vector<VT> get_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const = 0;
+
+    /**
+     * get_many_by_time(const std::vector<KT>&, const uint64_t&, const bool)
+     *
+     * Get the values of a set of keys at a timestamp, as get_by_time() does, from the same state.
+     *
+     * @param keys
+     * @param ts_us - timestamp in microsecond
+     * @param stable
+     *
+     * @return the values, in the order of the keys. The value of a key that is not found is invalid.
+     */
+    virtual std::vector<VT> get_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const = 0;
+
     /**
      * multi_list_keys(const std::string& prefix)
      *
@@ -279,6 +349,32 @@ public:
      */
     virtual uint64_t get_size_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const = 0;
 
+    /**
+     * get_size_many(const std::vector<KT>&, const persistent::version_t&, const bool)
+     *
+     * Get the sizes of the values of a set of keys from the same state, see get_many().
+     *
+     * @param keys
+     * @param ver   Version. CURRENT_VERSION for the latest value.
+     * @param stable
+     *
+     * @return the size of each serialized value, in the order of the keys. The size of a key that is not found is 0.
+     */
+    virtual std::vector<uint64_t> get_size_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const = 0;
+
+    /**
+     * get_size_many_by_time(const std::vector<KT>&, const uint64_t&, const bool)
+     *
+     * Get the sizes of the values of a set of keys at a timestamp from the same state, see get_many_by_time().
+     *
+     * @param keys
+     * @param ts_us - timestamp in microsecond
+     * @param stable
+     *
+     * @return the size of each serialized value, in the order of the keys. The size of a key that is not found is 0.
+     */
+    virtual std::vector<uint64_t> get_size_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const = 0;
+
     /**
      * trigger_put(const VT& value)
      *
@@ -289,6 +385,15 @@ public:
      */
     virtual void trigger_put(const VT& value) const = 0;
 
+    /**
+     * trigger_put_batch(const std::vector<VT>& values)
+     *
+     * Put the objects of a client-side batch, each of them as trigger_put() does.
+     *
+     * @param values - the objects to trig
+     */
+    virtual void trigger_put_batch(const std::vector<VT>& values) const = 0;
+
 #ifdef ENABLE_EVALUATION
     /**
      * dump_timestamp_log(const std::string& filename)
@@ -323,6 +428,20 @@ protected:
      * @param value
      */
     virtual void ordered_put_and_forget(const VT& value) = 0;
+    /**
+     * ordered_put_batch
+     * @param values
+     * @return a tuple including version number (version_t) and a timestamp in microseconds for each value.
+     */
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> ordered_put_batch(const std::vector<VT>& values) = 0;
+    /**
+     * ordered_transact
+     * @param read_set
+     * @param write_set
+     * @return a tuple including version number (version_t) and a timestamp in microseconds.
+     */
+    virtual std::tuple<persistent::version_t, uint64_t> ordered_transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                         const std::vector<VT>& write_set) = 0;
     /**
      * ordered_remove
      * @param key
@@ -506,6 +625,62 @@ public:
     virtual bool validate(const std::map<KT, VT>& kv_map) const = 0;
 };
 
+/**
+ * If the VT type of PersistentCascadeStore implements IOffloadableBlob interface, and the store has blob segments
+ * configured, the blobs larger than the threshold are stored out of line in the blob segments: 'ordered_put' calls
+ * 'copy_with_blob_segment' to create the object kept in memory, whose blob refers to the mapped copy of the data, and
+ * only the reference goes into the delta.
+ *
+ * If the store has a memory budget, it calls 'copy_with_blob_generator' to evict a cold blob from memory: the object
+ * kept in memory loads the blob from the log when it is copied or serialized.
+ */
+template <typename VT>
+class IOffloadableBlob {
+public:
+    /**
+     * get_blob_bytes()
+     *
+     * @return the blob data, or nullptr if the data is not in memory, e.g. it is generated on serialization, or it is
+     *         in a blob segment already.
+     */
+    virtual const uint8_t* get_blob_bytes() const = 0;
+    /**
+     * get_blob_size()
+     *
+     * @return the blob size
+     */
+    virtual std::size_t get_blob_size() const = 0;
+    /**
+     * has_blob_segment_ref()
+     *
+     * @return true if the blob refers to a blob segment. The objects received from the clients never do: the
+     *         references they carry are not resolved, and the stores reject them.
+     */
+    virtual bool has_blob_segment_ref() const = 0;
+    /**
+     * copy_with_blob_segment()
+     *
+     * Create a copy of this object whose blob refers to a copy of the data in a blob segment. The data is not copied.
+     *
+     * @param ref           - the reference to the blob segment
+     * @param mapped_bytes  - the address of the data in the mapped segment
+     *
+     * @return the new object
+     */
+    virtual VT copy_with_blob_segment(const BlobSegmentRef& ref, const uint8_t* mapped_bytes) const = 0;
+    /**
+     * copy_with_blob_generator()
+     *
+     * Create a copy of this object whose blob data is generated on demand, with the same size.
+     *
+     * @param generator     - the generator, which writes the data to a buffer of the blob size, and returns the number
+     *                        of bytes written.
+     *
+     * @return the new object
+     */
+    virtual VT copy_with_blob_generator(const std::function<std::size_t(uint8_t*, const std::size_t)>& generator) const = 0;
+};
+
 #ifdef ENABLE_EVALUATION
 /**
  * TODO:
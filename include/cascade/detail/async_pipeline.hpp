@@ -0,0 +1,226 @@
+#pragma once
+
+#include <derecho/core/derecho.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <typeindex>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * AsyncPipeline implements the asynchronous operations of the ServiceClient. An asynchronous operation is sent at once,
+ * and its completion callback is called by a completion thread when all of its replies have come.
+ *
+ * Each shard has a window of in-flight operations. An operation to a shard whose window is full waits until an
+ * operation to that shard completes, which is the backpressure on the caller. An operation is in flight until its
+ * completion callback returns. An operation submitted by a completion callback does not wait for the window, so that
+ * the completion threads never wait for themselves.
+ *
+ * The completion threads complete the operations in the order their replies come, not in the order of submission,
+ * so that an operation to a slow shard does not hold back the operations to the other shards. A QueryResults has no
+ * completion callback, so the completion threads poll the in-flight operations, backing off from
+ * ASYNC_PIPELINE_MIN_POLL_US to ASYNC_PIPELINE_MAX_POLL_US while none of them is ready. They are started by the first
+ * operation. With more than one completion thread, the callbacks may also run concurrently.
+ */
+class AsyncPipeline {
+public:
+#define ASYNC_PIPELINE_DEFAULT_WINDOW_SIZE (64)
+#define ASYNC_PIPELINE_DEFAULT_COMPLETION_THREADS (1)
+#define ASYNC_PIPELINE_MIN_POLL_US (10)
+#define ASYNC_PIPELINE_MAX_POLL_US (1000)
+    /* a shard is identified by the subgroup type, the subgroup index, and the shard index. */
+    using shard_key_t = std::tuple<std::type_index, uint32_t, uint32_t>;
+
+private:
+    struct Window {
+        std::size_t in_flight = 0;
+        std::condition_variable cv;
+    };
+
+    /**
+     * An in-flight operation, whatever the reply type is.
+     */
+    class Operation {
+    public:
+        Window* window;
+        explicit Operation(Window* _window) : window(_window) {}
+        virtual ~Operation() = default;
+        /**
+         * @return true if all of the replies have come, without waiting for them.
+         */
+        virtual bool is_ready() = 0;
+        /**
+         * Wait for the replies, and call the completion callback.
+         */
+        virtual void complete() = 0;
+    };
+
+    template <typename ResultsType>
+    class TypedOperation;
+
+    /* the windows and the configuration, protected by windows_mutex. */
+    std::size_t window_size;
+    uint32_t num_completion_threads;
+    std::map<shard_key_t, std::unique_ptr<Window>> windows;
+    std::size_t total_in_flight;
+    std::condition_variable drained_cv;
+    mutable std::mutex windows_mutex;
+
+    /* the operations to complete, oldest first, and the completion threads. */
+    std::deque<std::unique_ptr<Operation>> pending;
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    bool completion_threads_running;
+    std::vector<std::thread> completion_threads;
+
+    /* true in the completion threads. */
+    static thread_local bool in_completion_thread;
+
+    /**
+     * Take a slot in the window of a shard, waiting until there is one.
+     *
+     * @return the window.
+     */
+    Window* acquire(const shard_key_t& shard);
+
+    /**
+     * Give a slot back to its window.
+     */
+    void release(Window* window);
+
+    /**
+     * Hand an in-flight operation over to the completion threads, starting them if needed.
+     */
+    void enqueue(std::unique_ptr<Operation>&& operation);
+
+    /**
+     * Take an operation whose replies have come out of pending. The caller must hold pending_mutex.
+     *
+     * @return the operation, or nullptr if none is ready.
+     */
+    std::unique_ptr<Operation> take_ready();
+
+    void run_completions();
+
+public:
+    AsyncPipeline();
+    AsyncPipeline(const AsyncPipeline&) = delete;
+    AsyncPipeline& operator=(const AsyncPipeline&) = delete;
+    /**
+     * The destructor waits for the in-flight operations.
+     */
+    virtual ~AsyncPipeline();
+
+    /**
+     * Configure the pipeline.
+     *
+     * @param window_size               - the maximal number of in-flight operations per shard, which must be
+     *                                    positive. It applies to the waiting operations at once.
+     * @param completion_threads        - the number of completion threads, which must be positive. It cannot change
+     *                                    once the completion threads are started.
+     */
+    void set_config(std::size_t window_size, uint32_t completion_threads);
+
+    /**
+     * @return the maximal number of in-flight operations per shard.
+     */
+    std::size_t get_window_size() const;
+
+    /**
+     * @return the number of in-flight operations.
+     */
+    std::size_t get_in_flight() const;
+
+    /**
+     * Wait until there is no in-flight operation. It must not be called by a completion callback.
+     */
+    void wait_all();
+
+    /**
+     * Send an operation when the window of its shard has a slot.
+     *
+     * @tparam ResultsType      - the QueryResults type of the operation
+     * @param shard             - the shard of the operation
+     * @param send              - sends the operation. If it throws, the slot is released and the exception is
+     *                            rethrown to the caller.
+     * @param on_complete       - called with the results once all of the replies have come. It may be empty.
+     */
+    template <typename ResultsType>
+    void submit(const shard_key_t& shard,
+                const std::function<ResultsType()>& send,
+                const std::function<void(ResultsType&)>& on_complete);
+};
+
+template <typename ResultsType>
+class AsyncPipeline::TypedOperation : public AsyncPipeline::Operation {
+private:
+    ResultsType results;
+    std::function<void(ResultsType&)> on_complete;
+
+public:
+    TypedOperation(Window* _window, ResultsType&& _results, const std::function<void(ResultsType&)>& _on_complete)
+            : Operation(_window),
+              results(std::move(_results)),
+              on_complete(_on_complete) {}
+
+    virtual bool is_ready() override {
+        try {
+            auto* replies = results.wait(std::chrono::nanoseconds(0));
+            if(replies == nullptr) {
+                return false;
+            }
+            for(auto& reply : *replies) {
+                if(reply.second.wait_for(std::chrono::nanoseconds(0)) != std::future_status::ready) {
+                    return false;
+                }
+            }
+        } catch(...) {
+            // complete() reports the error.
+        }
+        return true;
+    }
+
+    virtual void complete() override {
+        try {
+            for(auto& reply : results.get()) {
+                reply.second.wait();
+            }
+            if(on_complete) {
+                on_complete(results);
+            }
+        } catch(const std::exception& ex) {
+            dbg_default_warn("{}: asynchronous operation failed with exception: {}", __PRETTY_FUNCTION__, ex.what());
+        } catch(...) {
+            dbg_default_warn("{}: asynchronous operation failed with unknown exception.", __PRETTY_FUNCTION__);
+        }
+    }
+};
+
+template <typename ResultsType>
+void AsyncPipeline::submit(const shard_key_t& shard,
+                           const std::function<ResultsType()>& send,
+                           const std::function<void(ResultsType&)>& on_complete) {
+    Window* window = acquire(shard);
+    std::unique_ptr<Operation> operation;
+    try {
+        operation = std::make_unique<TypedOperation<ResultsType>>(window, send(), on_complete);
+    } catch(...) {
+        release(window);
+        throw;
+    }
+    enqueue(std::move(operation));
+}
+
+}  // namespace cascade
+}  // namespace derecho
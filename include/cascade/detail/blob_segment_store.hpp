@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * A reference to a blob stored out of line in a blob segment file.
+ */
+struct BlobSegmentRef {
+    uint64_t segment_id;
+    uint64_t offset;
+    uint64_t length;
+    uint64_t checksum;
+};
+
+/**
+ * The checksum of the blob data in a blob segment.
+ *
+ * @param data  - the data
+ * @param len   - the length of the data
+ *
+ * @return a 64-bit checksum
+ */
+uint64_t blob_checksum(const uint8_t* data, std::size_t len);
+
+/**
+ * BlobSegmentRegistry maps the ids of the blob segments opened in this process to their memory-mapped regions, so
+ * that a blob reference found in a delta can be resolved when the delta is deserialized.
+ *
+ * It also holds per-thread switches telling how Blobs in blob segments serialize: as references when a store writes
+ * its deltas (see RefScope), or as the data itself otherwise, e.g. in the replies to the clients, the state transfers
+ * and the checkpoints; and whether the references are resolved when they are deserialized: only when a store reads
+ * its deltas (see ResolveScope). A reference anywhere else, e.g. in a request of a client, is not resolved, and the
+ * stores reject the objects carrying it.
+ */
+class BlobSegmentRegistry {
+private:
+    struct Region {
+        const uint8_t* base;
+        std::size_t size;
+        /* the end of the data referenced by the resolved references. */
+        mutable std::atomic<std::size_t> referenced_end;
+
+        Region(const uint8_t* _base, std::size_t _size) : base(_base), size(_size), referenced_end(0) {}
+    };
+    std::unordered_map<uint64_t, Region> regions;
+    mutable std::shared_mutex regions_mutex;
+
+    BlobSegmentRegistry();
+
+public:
+    /**
+     * RAII scope in which the Blobs in blob segments serialize as references in the calling thread.
+     */
+    class RefScope {
+    private:
+        bool previous;
+
+    public:
+        RefScope();
+        RefScope(const RefScope&) = delete;
+        RefScope& operator=(const RefScope&) = delete;
+        ~RefScope();
+    };
+
+    /**
+     * RAII scope in which the serialized references to blob segments are resolved in the calling thread.
+     */
+    class ResolveScope {
+    private:
+        bool previous;
+
+    public:
+        ResolveScope();
+        ResolveScope(const ResolveScope&) = delete;
+        ResolveScope& operator=(const ResolveScope&) = delete;
+        ~ResolveScope();
+    };
+
+    /**
+     * @return true if the Blobs in blob segments serialize as references in the calling thread.
+     */
+    static bool serialize_refs();
+    /**
+     * @return true if the serialized references to blob segments are resolved in the calling thread.
+     */
+    static bool resolve_refs();
+
+    /**
+     * Register the mapped region of a segment.
+     */
+    void register_segment(uint64_t segment_id, const uint8_t* base, std::size_t size);
+    /**
+     * Unregister a segment.
+     */
+    void unregister_segment(uint64_t segment_id);
+    /**
+     * Resolve a blob reference and verify the checksum of the data.
+     *
+     * @param ref   - the reference
+     *
+     * @return the address of the data in the mapped segment, or nullptr if the segment is not open, the reference is
+     *         out of range, or the checksum does not match.
+     */
+    const uint8_t* resolve(const BlobSegmentRef& ref) const;
+    /**
+     * @return the end of the data referenced by the references to a segment resolved so far, or 0 if there is none.
+     */
+    std::size_t get_referenced_end(uint64_t segment_id) const;
+
+    /**
+     * Get the process-wide BlobSegmentRegistry.
+     */
+    static BlobSegmentRegistry& get();
+
+    BlobSegmentRegistry(const BlobSegmentRegistry&) = delete;
+    BlobSegmentRegistry& operator=(const BlobSegmentRegistry&) = delete;
+    virtual ~BlobSegmentRegistry();
+};
+
+/**
+ * BlobSegmentStore keeps the large blobs of a persistent store in append-only segment files, outside of the log and
+ * of the heap. Each segment is memory-mapped, so the objects in memory point to the mapped data without a copy, and
+ * only a BlobSegmentRef goes into the delta.
+ *
+ * A segment file is named "<name>-<segment number in hex>.blob". The id of a segment, which is what the references
+ * carry, is made of a hash of the store name and the segment number. On start, the existing segments are mapped for
+ * the log replay. After the replay, resume() removes the segments the log does not refer to, and appends the new blobs
+ * after the last blob the log refers to. Otherwise, the new blobs go to a new segment. The space of the overwritten
+ * blobs in the other segments is not reclaimed.
+ *
+ * The blobs are written without a sync, and sync() makes all the blobs appended so far durable at once, before the
+ * delta referring to them goes to the log.
+ *
+ * There is a single writer, the predicate thread.
+ */
+class BlobSegmentStore {
+private:
+    struct Segment {
+        uint64_t segment_id;
+        int fd;
+        uint8_t* base;
+        std::size_t capacity;
+    };
+    const std::string directory;
+    const std::string name;
+    const uint32_t store_hash;
+    const std::size_t threshold;
+    const std::size_t segment_capacity;
+    std::vector<Segment> segments;
+    /* the next segment number, and the append position in the last segment. */
+    uint32_t next_segment_number;
+    std::size_t write_offset;
+    /* the segments written since the last sync. */
+    std::vector<std::size_t> unsynced_segments;
+
+    /**
+     * Open and map a segment, and register it.
+     */
+    void map_segment(uint32_t segment_number, std::size_t capacity, bool create);
+    /**
+     * The segment file name of a segment number.
+     */
+    std::string segment_filename(uint32_t segment_number) const;
+
+public:
+    /**
+     * Open the blob segments of a store.
+     *
+     * @param directory         - the directory of the segment files. It is created if it does not exist.
+     * @param name              - the name of the store, unique in the directory.
+     * @param threshold         - the minimum size of a blob to store in a segment.
+     * @param segment_capacity  - the size of a segment file. A larger blob gets a segment of its own.
+     */
+    BlobSegmentStore(const std::string& directory, const std::string& name, std::size_t threshold, std::size_t segment_capacity);
+
+    /**
+     * @return the minimum size of a blob to store in a segment.
+     */
+    std::size_t get_threshold() const;
+
+    /**
+     * Keep the segments referred to by the replayed log, and continue appending to the last one after the data it
+     * refers to. The other segments are removed. It must be called once the whole log has been replayed.
+     */
+    void resume();
+
+    /**
+     * Append a blob to the segments. The data is not synced: see sync().
+     *
+     * @param data  - the blob data
+     * @param len   - the blob size
+     * @param ref   - the reference to the stored blob is returned here.
+     *
+     * @return the address of the stored blob in the mapped segment.
+     */
+    const uint8_t* append(const uint8_t* data, std::size_t len, BlobSegmentRef& ref);
+
+    /**
+     * Sync the blobs appended since the last sync to the device. The log only keeps the references, so it must be
+     * called before a delta referring to them is written to the log.
+     */
+    void sync();
+
+    BlobSegmentStore(const BlobSegmentStore&) = delete;
+    BlobSegmentStore& operator=(const BlobSegmentStore&) = delete;
+    virtual ~BlobSegmentStore();
+};
+
+}  // namespace cascade
+}  // namespace derecho
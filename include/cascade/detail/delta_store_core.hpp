@@ -1,19 +1,139 @@
 #pragma once
 
+#include "blob_segment_store.hpp"
 #include "cascade/cascade_interface.hpp"
+#include "key_path_trie.hpp"
+#include "key_version_index.hpp"
+#include "kv_hash_index.hpp"
+#include "residency_clock.hpp"
 
 #include <derecho/core/derecho.hpp>
 #include <derecho/mutils-serialization/SerializationSupport.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
 #include <vector>
 
 namespace derecho {
 namespace cascade {
 
+/**
+ * A delta of DeltaCascadeStoreCore is either a single serialized object, as the logs written before batches were
+ * introduced, or a batch of objects:
+ * - put/remove:            [object]
+ * - put_batch/transact:    [BATCH_DELTA_MARKER][number of objects][object]...[object]
+ * A remove is the put of a null object. The marker reads as the version -2, which a logged object never has: its
+ * version is assigned by the ordered delivery. An object whose first eight bytes are the marker anyway, e.g. because its
+ * first field is the message id under ENABLE_EVALUATION, is logged as a batch of one (see write_put_delta()).
+ */
+#define BATCH_DELTA_MARKER (0xfffffffffffffffeull)
+#define BATCH_DELTA_HEADER_SIZE (2 * sizeof(uint64_t))
+
+/**
+ * DeltaObjects reads the objects in a delta from the log, e.g. with Persistent<>::getDelta<DeltaObjects<VT>>().
+ */
+template <typename VT>
+class DeltaObjects : public mutils::ByteRepresentable {
+private:
+    const uint8_t* const delta_bytes;
+
+public:
+    /**
+     * @return true if a delta is a batch, false if it is a single object.
+     */
+    static bool is_batch(const uint8_t* delta) {
+        uint64_t marker;
+        memcpy(&marker, delta, sizeof(marker));
+        return marker == BATCH_DELTA_MARKER;
+    }
+
+    /**
+     * Call a function on each object in a delta, in order.
+     *
+     * @param delta - the delta
+     * @param func  - the function
+     */
+    static void for_each(const uint8_t* delta, const std::function<void(const VT&)>& func) {
+        // the references to blob segments in the log are resolved.
+        BlobSegmentRegistry::ResolveScope resolve_scope;
+        if(!is_batch(delta)) {
+            mutils::deserialize_and_run(nullptr, delta, [&func](const VT& value) {
+                func(value);
+            });
+            return;
+        }
+        uint64_t num_objects;
+        memcpy(&num_objects, delta + sizeof(uint64_t), sizeof(num_objects));
+        const uint8_t* pos = delta + BATCH_DELTA_HEADER_SIZE;
+        for(uint64_t i = 0; i < num_objects; i++) {
+            mutils::deserialize_and_run(nullptr, pos, [&func, &pos](const VT& value) {
+                func(value);
+                // the size as it is in the delta, where the blobs in blob segments are references.
+                BlobSegmentRegistry::RefScope ref_scope;
+                pos += mutils::bytes_size(value);
+            });
+        }
+    }
+
+    /**
+     * Call a function on each object in this delta, in order.
+     */
+    void for_each(const std::function<void(const VT&)>& func) const {
+        for_each(delta_bytes, func);
+    }
+
+    /**
+     * @return the size of a delta.
+     */
+    static std::size_t delta_size(const uint8_t* delta) {
+        std::size_t size = is_batch(delta) ? BATCH_DELTA_HEADER_SIZE : 0;
+        for_each(delta, [&size](const VT& value) {
+            BlobSegmentRegistry::RefScope ref_scope;
+            size += mutils::bytes_size(value);
+        });
+        return size;
+    }
+
+    // serialization supports: the bytes are the delta itself.
+    std::size_t to_bytes(uint8_t* v) const {
+        const std::size_t size = delta_size(delta_bytes);
+        memcpy(v, delta_bytes, size);
+        return size;
+    }
+    std::size_t bytes_size() const {
+        return delta_size(delta_bytes);
+    }
+    void post_object(const std::function<void(uint8_t const* const, std::size_t)>& f) const {
+        f(delta_bytes, delta_size(delta_bytes));
+    }
+    void ensure_registered(mutils::DeserializationManager&) {}
+    static std::unique_ptr<DeltaObjects> from_bytes(mutils::DeserializationManager*, const uint8_t* const v) {
+        return std::make_unique<DeltaObjects>(v);
+    }
+    static mutils::context_ptr<DeltaObjects> from_bytes_noalloc(mutils::DeserializationManager*, const uint8_t* const v) {
+        return mutils::context_ptr<DeltaObjects>{new DeltaObjects(v)};
+    }
+    static mutils::context_ptr<const DeltaObjects> from_bytes_noalloc_const(mutils::DeserializationManager*, const uint8_t* const v) {
+        return mutils::context_ptr<const DeltaObjects>{new DeltaObjects(v)};
+    }
+
+    /**
+     * The delta must stay valid while this object is in use.
+     */
+    explicit DeltaObjects(const uint8_t* const _delta_bytes) : delta_bytes(_delta_bytes) {}
+};
+
 /**
  * Persistent Cascade Store Delta Support
  */
@@ -34,6 +154,131 @@ private:
 #else
 #error The lockless reader/writer works only with TSO memory reordering. Please check https://en.wikipedia.org/wiki/Memory_ordering
 #endif
+    /**
+     * Hash index over kv_map for the point operations. kv_map is still the owner of the objects and serves the
+     * serialization and the ordered listings. The index is not serialized; it is rebuilt by the constructors.
+     */
+    KVHashIndex<KT, VT> kv_index;
+    /**
+     * Path trie over the keys in kv_map for list_keys. It is not serialized either.
+     */
+    KeyPathTrie<KT> key_trie;
+    /**
+     * Per-key version chains for the historical point reads. It is rebuilt by replaying the log, or seeded by the
+     * constructors from a kv_map snapshot.
+     */
+    KeyVersionIndex<KT> key_version_index;
+
+#define RECOVERY_BATCH_SIZE (65536)
+    /**
+     * Log replay state. num_recovery_threads is 0 when we are not recovering. With more than one recovery thread,
+     * applyDelta only collects the deltas, and finish_recovery() applies them in parallel.
+     */
+    uint32_t num_recovery_threads;
+    std::vector<uint8_t const*> recovery_deltas;
+    uint64_t num_recovered_deltas;
+    std::chrono::steady_clock::time_point recovery_start;
+
+    /**
+     * Apply the collected deltas with num_recovery_threads threads. The deltas are deserialized in parallel batches,
+     * and the objects are partitioned by key hash, so that each thread builds the latest state and the version chains
+     * of its own keys. The partitions are merged into kv_map at the end.
+     */
+    void parallel_replay();
+
+    /**
+     * The blob segments for the large blobs, owned by the store. It is nullptr if the blobs are kept in the log.
+     */
+    BlobSegmentStore* blob_segments;
+
+public:
+    /**
+     * Read the object in the delta of a version from the log.
+     */
+    using blob_loader_t = std::function<void(const persistent::version_t&, const std::function<void(const VT&)>&)>;
+
+private:
+    /**
+     * The values kept in memory under a memory budget, or nullptr if all values are kept in memory. An evicted value
+     * is replaced in kv_map by a copy whose blob is loaded from the log by blob_loader, at the version of the object.
+     */
+    std::unique_ptr<ResidencyClock<KT>> residency_clock;
+    blob_loader_t blob_loader;
+    /**
+     * With a memory budget, the promotion thread brings the evicted values that are read back into memory as soon as
+     * they are read. Both it and the predicate thread update kv_map, so they hold residency_mutex while they use it.
+     */
+    mutable std::mutex residency_mutex;
+    std::thread promotion_thread;
+
+    /**
+     * Lock out the promotion thread if there is a memory budget. The predicate thread holds the lock while it uses
+     * kv_map.
+     */
+    std::unique_lock<std::mutex> lock_residency() const;
+    /**
+     * The promotion thread.
+     */
+    void promotion_worker();
+
+    /**
+     * Replace the value of an entry in kv_map. The old entry is retired for the lockless readers.
+     */
+    void replace_value(typename std::map<KT, VT>::iterator it, VT&& value);
+    /**
+     * The memory held by a value in kv_map, which is what counts against the memory budget.
+     */
+    static uint64_t resident_bytes_of(const VT& value);
+    /**
+     * Load the blob of the object of a version from the log. It is the blob generator of the evicted values.
+     *
+     * @return the number of bytes loaded, which is 0 if the blob is not found.
+     */
+    std::size_t load_blob(const KT& key, const persistent::version_t& ver, uint8_t* buffer, const std::size_t size) const;
+    /**
+     * Bring back the evicted values that have been read, and evict values until the resident values fit in the
+     * memory budget.
+     */
+    void enforce_memory_budget();
+    /**
+     * Validate and verify a value to put against the current state, and set its previous versions.
+     *
+     * @return false if the value is rejected.
+     */
+    bool verify_put(const VT& value, persistent::version_t prev_ver);
+    /**
+     * Move the blob of a value to the blob segments if it is large enough. The object to keep is returned in
+     * offloaded_value; it stays empty if the blob is kept in the log.
+     */
+    void offload_blob(const VT& value, std::optional<VT>& offloaded_value);
+    /**
+     * Write the delta of the put of a single value.
+     */
+    void write_put_delta(const VT& value);
+    /**
+     * Append a value to the batch delta being built, whose length is delta_len.
+     */
+    void append_batch_delta(const VT& value, std::size_t& delta_len);
+    /**
+     * Write the header of the batch delta being built, and set its length.
+     */
+    void seal_batch_delta(uint64_t num_objects, std::size_t delta_len);
+    /**
+     * Mark the start and the end of an update for the lockless readers, which retry if an update overlaps with them.
+     * The objects of a batch or a transaction are applied in one update, so that they are seen all at once.
+     *
+     * @param ver   - the version of the update
+     */
+    void begin_lockless_update(const persistent::version_t& ver);
+    void end_lockless_update(const persistent::version_t& ver);
+    /**
+     * Find the objects of a set of keys in one consistent state of kv_map, retrying while an update overlaps with the
+     * lookups. The caller must hold an EpochManager::Guard while using the objects.
+     *
+     * @param keys      - the keys
+     * @param objects   - the object of each key is returned here, or nullptr if the key is not found.
+     */
+    void lockless_find_many(const std::vector<KT>& keys, std::vector<const VT*>& objects) const;
 
 public:
     // delta
@@ -59,26 +304,47 @@ public:
     std::map<KT, VT> kv_map;
 
     //////////////////////////////////////////////////////////////////////////
-    // Delta is represented by an operation id and a list of
-    // argument. The operation id (OPID) is a 4 bytes integer.
+    // Delta is represented by the serialized value, or by a batch of
+    // serialized values behind the batch marker, see DeltaObjects.
     // 1) put(const Object& object):
-    // [OPID:PUT]   [value]
+    // [value]
     // 2) remove(const KT& key)
-    // [OPID:REMOVE][key]
+    // [null value of the key]
     // 3) get(const KT& key)
     // no need to prepare a delta
+    // 4) put_batch(const std::vector<Object>& objects) and transact(...)
+    // [BATCH_DELTA_MARKER][number of objects][value]...[value]
     ///////////////////////////////////////////////////////////////////////////
     virtual void finalizeCurrentDelta(const persistent::DeltaFinalizer& df) override;
     virtual void applyDelta(uint8_t const* const delta) override;
     static std::unique_ptr<DeltaCascadeStoreCore<KT, VT, IK, IV>> create(mutils::DeserializationManager* dm);
     /**
-     * apply put to current state
+     * apply put to current state. The caller is responsible for begin_lockless_update()/end_lockless_update().
      */
     void apply_ordered_put(const VT& value);
     /**
      * Ordered put, and generate a delta.
      */
     virtual bool ordered_put(const VT& value, persistent::version_t prever);
+    /**
+     * Ordered put of a batch of values, and generate a single delta with the accepted values. Each value is verified
+     * against the state after the values before it in the batch.
+     *
+     * @return whether each value is accepted.
+     */
+    virtual std::vector<bool> ordered_put_batch(const std::vector<VT>& values, persistent::version_t prev_ver);
+    /**
+     * Ordered transaction: if the current version of every key in the read set is the expected one, put all values in
+     * the write set, and generate a single delta with them; otherwise put none of them. The version of a key is the
+     * version of its object, which is the version of the remove for a removed key, or INVALID_VERSION if the key does
+     * not exist. The values are verified against the state before the transaction, so the keys in the write set must
+     * be distinct.
+     *
+     * @return true if the transaction is committed. A transaction with an empty write set generates no delta.
+     */
+    virtual bool ordered_transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                  const std::vector<VT>& write_set,
+                                  persistent::version_t prev_ver);
     /**
      * Ordered remove, and generate a delta.
      */
@@ -94,7 +360,7 @@ public:
     /**
      * ordered list_keys, no need to generate a delta.
      */
-    virtual std::vector<KT> ordered_list_keys(const std::string& prefix);
+    virtual std::vector<KT> ordered_list_keys(const std::string& prefix) const;
     /**
      * locklessly list keys for the caller from a thread other than the predicate thread.
      */
@@ -107,9 +373,83 @@ public:
      * locklessly get size of an object
      */
     virtual uint64_t lockless_get_size(const KT& key) const;
+    /**
+     * locklessly get the values of a set of keys, all from the same state. The evicted values are loaded from the log
+     * after the lookups, out of the epoch guard.
+     */
+    virtual std::vector<VT> lockless_get_many(const std::vector<KT>& keys) const;
+    /**
+     * locklessly get the sizes of the objects of a set of keys, all from the same state.
+     */
+    virtual std::vector<uint64_t> lockless_get_size_many(const std::vector<KT>& keys) const;
+    /**
+     * Find the version of the latest update to a key no later than a given version, from the per-key version chains.
+     * It is safe to call from a thread other than the predicate thread.
+     *
+     * @param key           - the key
+     * @param ver           - the version
+     * @param key_version   - the version found, or INVALID_VERSION if the key did not exist at 'ver'.
+     *
+     * @return true if key_version is set, false if 'ver' is older than what the index covers.
+     */
+    virtual bool lockless_get_key_version(const KT& key, const persistent::version_t& ver, persistent::version_t& key_version) const;
+    /**
+     * Bound the per-key version chains. The versions superseded at the later of 'stable_version' and the version of
+     * the update 'max_updates' updates ago are dropped, and the historical reads before it are not answered by
+     * lockless_get_key_version() any more. It must be called by the predicate thread.
+     *
+     * @param stable_version    - the version up to which the state is available otherwise, e.g. from a checkpoint.
+     * @param max_updates       - the number of the latest updates to keep, or 0 for no limit.
+     */
+    virtual void trim_version_index(const persistent::version_t& stable_version, uint64_t max_updates);
+    /**
+     * Start recovering from the log. It must be called before Persistent<> replays the log through applyDelta.
+     * With more than one thread, the deltas passed to applyDelta must stay valid until finish_recovery() returns,
+     * which is the case for the memory-mapped file log.
+     *
+     * @param num_threads   - the number of replay threads.
+     */
+    void begin_recovery(uint32_t num_threads);
+    /**
+     * Finish recovering from the log, and report the recovery throughput.
+     */
+    void finish_recovery();
+    /**
+     * Store the blobs no smaller than the threshold of a BlobSegmentStore in its segments from now on.
+     *
+     * @param segments  - the blob segments, or nullptr to keep the blobs in the log. It must outlive this object.
+     */
+    void set_blob_segments(BlobSegmentStore* segments);
+    /**
+     * Keep the values in memory under a budget from now on. The cold values are evicted, and loaded from the log on
+     * demand. An evicted value that is read is brought back into memory by a background thread. It needs VT to
+     * implement IOffloadableBlob, and a blob loader. The budget can only be set once.
+     *
+     * @param budget_bytes  - the memory budget of the values.
+     */
+    void set_memory_budget(uint64_t budget_bytes);
+    /**
+     * Set the function to read the objects from the log, for the evicted values.
+     *
+     * @param loader    - the blob loader
+     */
+    void set_blob_loader(const blob_loader_t& loader);
+    /**
+     * Get the counters of the memory budget.
+     *
+     * @param stats     - the counters are returned here.
+     *
+     * @return false if there is no memory budget.
+     */
+    bool get_residency_stats(ResidencyStats& stats) const;
 
-    // serialization supports
-    DEFAULT_SERIALIZATION_SUPPORT(DeltaCascadeStoreCore, kv_map);
+    // serialization supports: kv_map is serialized with the promotion thread locked out.
+    std::size_t to_bytes(uint8_t* v) const;
+    std::size_t bytes_size() const;
+    void post_object(const std::function<void(uint8_t const* const, std::size_t)>& f) const;
+    void ensure_registered(mutils::DeserializationManager&) {}
+    static std::unique_ptr<DeltaCascadeStoreCore> from_bytes(mutils::DeserializationManager* dsm, const uint8_t* const v);
+    DEFAULT_DESERIALIZE_NOALLOC(DeltaCascadeStoreCore);
 
     // constructors
     DeltaCascadeStoreCore();
@@ -12,10 +12,15 @@
 #include <derecho/utils/time.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace derecho {
@@ -93,16 +98,25 @@ void DeltaCascadeStoreCore<KT, VT, IK, IV>::finalizeCurrentDelta(const persisten
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 void DeltaCascadeStoreCore<KT, VT, IK, IV>::applyDelta(uint8_t const* const delta) {
-    apply_ordered_put(*mutils::from_bytes<VT>(nullptr, delta));
-    mutils::deserialize_and_run(nullptr, delta, [this](const VT& value) {
+    if(num_recovery_threads > 1) {
+        recovery_deltas.push_back(delta);
+        return;
+    }
+    auto residency_lock = lock_residency();
+    DeltaObjects<VT>::for_each(delta, [this](const VT& value) {
+        this->begin_lockless_update(value.get_version());
         this->apply_ordered_put(value);
+        this->end_lockless_update(value.get_version());
     });
+    if(num_recovery_threads > 0) {
+        num_recovered_deltas++;
+    }
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
-void DeltaCascadeStoreCore<KT, VT, IK, IV>::apply_ordered_put(const VT& value) {
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::begin_lockless_update(const persistent::version_t& ver) {
     // for lockless check
-    this->lockless_v1.store(value.get_version(), std::memory_order_relaxed);
+    this->lockless_v1.store(ver, std::memory_order_relaxed);
     // compiler reordering barrier
 #ifdef __GNUC__
     asm volatile("" ::
@@ -110,10 +124,10 @@ void DeltaCascadeStoreCore<KT, VT, IK, IV>::apply_ordered_put(const VT& value) {
 #else
 #error Lockless support is currently for GCC only
 #endif
+}
 
-    this->kv_map.erase(value.get_key_ref());
-    this->kv_map.emplace(value.get_key_ref(), value);
-
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::end_lockless_update(const persistent::version_t& ver) {
     // compiler reordering barrier
 #ifdef __GNUC__
     asm volatile("" ::
@@ -121,9 +135,153 @@ void DeltaCascadeStoreCore<KT, VT, IK, IV>::apply_ordered_put(const VT& value) {
 #else
 #error Lockless support is currently for GCC only
 #endif
-
     // for lockless check
-    this->lockless_v2.store(value.get_version(), std::memory_order_relaxed);
+    this->lockless_v2.store(ver, std::memory_order_relaxed);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::apply_ordered_put(const VT& value) {
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(value.get_key_ref(), it)) {
+        // replace the existing entry in the tree: extracting by iterator and re-inserting with the successor as the
+        // hint are both amortized constant. The old node is retired instead of freed because lockless readers may
+        // still be reading it.
+        auto hint = std::next(it);
+        auto old_node = this->kv_map.extract(it);
+        it = this->kv_map.emplace_hint(hint, value.get_key_ref(), value);
+        this->kv_index.put(it);
+        const uint64_t old_bytes = resident_bytes_of(old_node.mapped());
+        EpochManager::get().retire(std::move(old_node), old_bytes);
+    } else {
+        it = this->kv_map.emplace(value.get_key_ref(), value).first;
+        this->kv_index.put(it);
+        this->key_trie.insert(value.get_key_ref());
+    }
+
+    this->key_version_index.append(value.get_key_ref(), value.get_version());
+
+    // evictions do not change the content: a lockless reader sees either the resident or the evicted object.
+    if(this->residency_clock) {
+        this->residency_clock->admit(value.get_key_ref(), resident_bytes_of(it->second));
+        enforce_memory_budget();
+    }
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::replace_value(typename std::map<KT, VT>::iterator it, VT&& value) {
+    auto hint = std::next(it);
+    auto old_node = this->kv_map.extract(it);
+    it = this->kv_map.emplace_hint(hint, old_node.key(), std::move(value));
+    this->kv_index.put(it);
+    const uint64_t old_bytes = resident_bytes_of(old_node.mapped());
+    EpochManager::get().retire(std::move(old_node), old_bytes);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+uint64_t DeltaCascadeStoreCore<KT, VT, IK, IV>::resident_bytes_of(const VT& value) {
+    if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+        // the blobs generated on demand, or in blob segments, are not in the heap.
+        return (value.get_blob_bytes() != nullptr) ? value.get_blob_size() : 0;
+    } else {
+        return 0;
+    }
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::size_t DeltaCascadeStoreCore<KT, VT, IK, IV>::load_blob(const KT& key, const persistent::version_t& ver, uint8_t* buffer, const std::size_t size) const {
+    std::size_t loaded = 0;
+    if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+        if(!this->blob_loader) {
+            return 0;
+        }
+        // a batch delta may have other keys, or earlier objects of the same key.
+        this->blob_loader(ver, [&loaded, &key, buffer, size](const VT& value) {
+            if(value.get_key_ref() == key && value.get_blob_bytes() != nullptr && value.get_blob_size() == size) {
+                memcpy(buffer, value.get_blob_bytes(), size);
+                loaded = size;
+            }
+        });
+    }
+    return loaded;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::unique_lock<std::mutex> DeltaCascadeStoreCore<KT, VT, IK, IV>::lock_residency() const {
+    if(!this->residency_clock) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(this->residency_mutex);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::promotion_worker() {
+    pthread_setname_np(pthread_self(), "cs_promote");
+    while(this->residency_clock->wait_for_promotions()) {
+        {
+            std::lock_guard<std::mutex> lck(this->residency_mutex);
+            enforce_memory_budget();
+        }
+        // the replaced values are freed once no reader uses them.
+        EpochManager::get().reclaim();
+    }
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::enforce_memory_budget() {
+    if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+        typename std::map<KT, VT>::iterator it;
+        // 1) bring back the evicted values that have been read.
+        for(const auto& key : this->residency_clock->take_promotions()) {
+            if(!this->kv_index.lookup(key, it) || this->residency_clock->is_resident(key)) {
+                continue;
+            }
+            try {
+                // the copy loads the blob from the log.
+                VT loaded_value(it->second);
+                const uint64_t bytes = resident_bytes_of(loaded_value);
+                replace_value(it, std::move(loaded_value));
+                this->residency_clock->admit(key, bytes);
+                this->residency_clock->count_promotion();
+            } catch(const std::exception& ex) {
+                dbg_default_warn("Failed to load the evicted value of a key from the log: {}", ex.what());
+            }
+        }
+        // 2) evict the cold values.
+        KT key;
+        while(this->residency_clock->over_budget() && this->residency_clock->next_victim(key)) {
+            if(!this->kv_index.lookup(key, it)) {
+                continue;
+            }
+            const persistent::version_t ver = it->second.get_version();
+            replace_value(it, it->second.copy_with_blob_generator([this, key, ver](uint8_t* buffer, const std::size_t size) {
+                return this->load_blob(key, ver, buffer, size);
+            }));
+        }
+    }
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::size_t DeltaCascadeStoreCore<KT, VT, IK, IV>::to_bytes(uint8_t* v) const {
+    auto residency_lock = lock_residency();
+    return mutils::to_bytes(this->kv_map, v);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::size_t DeltaCascadeStoreCore<KT, VT, IK, IV>::bytes_size() const {
+    auto residency_lock = lock_residency();
+    return mutils::bytes_size(this->kv_map);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::post_object(const std::function<void(uint8_t const* const, std::size_t)>& f) const {
+    auto residency_lock = lock_residency();
+    mutils::post_object(f, this->kv_map);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::unique_ptr<DeltaCascadeStoreCore<KT, VT, IK, IV>> DeltaCascadeStoreCore<KT, VT, IK, IV>::from_bytes(mutils::DeserializationManager* dsm, const uint8_t* const v) {
+    auto map_ptr = mutils::from_bytes<std::map<KT, VT>>(dsm, v);
+    return std::make_unique<DeltaCascadeStoreCore<KT, VT, IK, IV>>(std::move(*map_ptr));
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
@@ -138,7 +296,14 @@ std::unique_ptr<DeltaCascadeStoreCore<KT, VT, IK, IV>> DeltaCascadeStoreCore<KT,
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
-bool DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_put(const VT& value, persistent::version_t prev_ver) {
+bool DeltaCascadeStoreCore<KT, VT, IK, IV>::verify_put(const VT& value, persistent::version_t prev_ver) {
+    // only the deltas in the log refer to blob segments.
+    if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+        if(value.has_blob_segment_ref()) {
+            dbg_default_warn("{}: rejected an object of key:{} referring to a blob segment.", __PRETTY_FUNCTION__, value.get_key_ref());
+            return false;
+        }
+    }
     // call validator
     if constexpr(std::is_base_of<IValidator<KT, VT>, VT>::value) {
         if(!value.validate(this->kv_map)) {
@@ -147,10 +312,12 @@ bool DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_put(const VT& value, persist
     }
 
     // verify version MUST happen before updating it's previous versions (prev_ver,prev_ver_by_key).
+    typename std::map<KT, VT>::iterator it;
+    const bool found = this->kv_index.lookup(value.get_key_ref(), it);
     if constexpr(std::is_base_of<IVerifyPreviousVersion, VT>::value) {
         bool verify_result;
-        if(kv_map.find(value.get_key_ref()) != this->kv_map.end()) {
-            verify_result = value.verify_previous_version(prev_ver, this->kv_map.at(value.get_key_ref()).get_version());
+        if(found) {
+            verify_result = value.verify_previous_version(prev_ver, it->second.get_version());
         } else {
             verify_result = value.verify_previous_version(prev_ver, persistent::INVALID_VERSION);
         }
@@ -161,50 +328,210 @@ bool DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_put(const VT& value, persist
     }
     if constexpr(std::is_base_of<IKeepPreviousVersion, VT>::value) {
         persistent::version_t prev_ver_by_key = persistent::INVALID_VERSION;
-        if(kv_map.find(value.get_key_ref()) != kv_map.end()) {
-            prev_ver_by_key = kv_map.at(value.get_key_ref()).get_version();
+        if(found) {
+            prev_ver_by_key = it->second.get_version();
         }
         value.set_previous_version(prev_ver, prev_ver_by_key);
     }
-    // create delta.
-    assert(this->delta.is_empty());
-    this->delta.calibrate(mutils::bytes_size(value));
+    return true;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::offload_blob(const VT& value, std::optional<VT>& offloaded_value) {
+    // move a large blob out of line: the delta only carries the reference, and the object in kv_map points to the
+    // mapped segment.
+    if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+        if(this->blob_segments != nullptr && value.get_blob_bytes() != nullptr
+           && value.get_blob_size() >= this->blob_segments->get_threshold()) {
+            BlobSegmentRef ref;
+            const uint8_t* mapped_bytes = this->blob_segments->append(value.get_blob_bytes(), value.get_blob_size(), ref);
+            offloaded_value.emplace(value.copy_with_blob_segment(ref, mapped_bytes));
+        }
+    }
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::write_put_delta(const VT& value) {
+    const std::size_t object_size = mutils::bytes_size(value);
+    this->delta.calibrate(object_size);
     mutils::to_bytes(value, this->delta.data_ptr());
-    this->delta.set_data_len(mutils::bytes_size(value));
+    if(object_size < sizeof(uint64_t) || !DeltaObjects<VT>::is_batch(this->delta.data_ptr())) {
+        this->delta.set_data_len(object_size);
+        return;
+    }
+    // the object would read as a batch: log it as a batch of one.
+    std::size_t delta_len = BATCH_DELTA_HEADER_SIZE;
+    append_batch_delta(value, delta_len);
+    seal_batch_delta(1, delta_len);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::append_batch_delta(const VT& value, std::size_t& delta_len) {
+    BlobSegmentRegistry::RefScope ref_scope;
+    const std::size_t object_size = mutils::bytes_size(value);
+    this->delta.calibrate(delta_len + object_size);
+    mutils::to_bytes(value, this->delta.data_ptr() + delta_len);
+    delta_len += object_size;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::seal_batch_delta(uint64_t num_objects, std::size_t delta_len) {
+    const uint64_t marker = BATCH_DELTA_MARKER;
+    memcpy(this->delta.data_ptr(), &marker, sizeof(marker));
+    memcpy(this->delta.data_ptr() + sizeof(marker), &num_objects, sizeof(num_objects));
+    this->delta.set_data_len(delta_len);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+bool DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_put(const VT& value, persistent::version_t prev_ver) {
+    auto residency_lock = lock_residency();
+    if(!verify_put(value, prev_ver)) {
+        return false;
+    }
+    std::optional<VT> offloaded_value;
+    offload_blob(value, offloaded_value);
+    if(offloaded_value) {
+        this->blob_segments->sync();
+    }
+    const VT& stored_value = offloaded_value ? *offloaded_value : value;
+    // create delta.
+    {
+        BlobSegmentRegistry::RefScope ref_scope;
+        assert(this->delta.is_empty());
+        write_put_delta(stored_value);
+    }
     // apply_ordered_put
-    apply_ordered_put(value);
+    begin_lockless_update(stored_value.get_version());
+    apply_ordered_put(stored_value);
+    end_lockless_update(stored_value.get_version());
+    return true;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<bool> DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_put_batch(const std::vector<VT>& values, persistent::version_t prev_ver) {
+    auto residency_lock = lock_residency();
+    std::vector<bool> accepted(values.size(), false);
+    uint64_t num_accepted = 0;
+    // create delta: the header is written once we know the number of accepted values.
+    assert(this->delta.is_empty());
+    std::size_t delta_len = BATCH_DELTA_HEADER_SIZE;
+    this->delta.calibrate(delta_len);
+    if(values.empty()) {
+        return accepted;
+    }
+    // all values of the batch have the version of its ordered message.
+    begin_lockless_update(values.front().get_version());
+    for(std::size_t i = 0; i < values.size(); i++) {
+        if(!verify_put(values[i], prev_ver)) {
+            continue;
+        }
+        std::optional<VT> offloaded_value;
+        offload_blob(values[i], offloaded_value);
+        const VT& stored_value = offloaded_value ? *offloaded_value : values[i];
+        append_batch_delta(stored_value, delta_len);
+        // the next values are verified against this one.
+        apply_ordered_put(stored_value);
+        accepted[i] = true;
+        num_accepted++;
+    }
+    end_lockless_update(values.front().get_version());
+    // one sync for all the blobs of the batch.
+    if(this->blob_segments != nullptr) {
+        this->blob_segments->sync();
+    }
+    if(num_accepted > 0) {
+        seal_batch_delta(num_accepted, delta_len);
+    }
+    return accepted;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+bool DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                              const std::vector<VT>& write_set,
+                                                              persistent::version_t prev_ver) {
+    auto residency_lock = lock_residency();
+    typename std::map<KT, VT>::iterator it;
+    // 1) check the read set.
+    // the version of a key is that of its object, a removed key included, like in verify_put().
+    for(const auto& read : read_set) {
+        persistent::version_t current_version = persistent::INVALID_VERSION;
+        if(this->kv_index.lookup(std::get<0>(read), it)) {
+            current_version = it->second.get_version();
+        }
+        if(current_version != std::get<1>(read)) {
+            return false;
+        }
+    }
+    // 2) verify the write set. Nothing is applied until all values pass.
+    std::unordered_set<KT> write_keys;
+    for(const auto& value : write_set) {
+        if(!write_keys.insert(value.get_key_ref()).second) {
+            dbg_default_warn("{}: rejected a transaction writing key:{} more than once.", __PRETTY_FUNCTION__, value.get_key_ref());
+            return false;
+        }
+        if(!verify_put(value, prev_ver)) {
+            return false;
+        }
+    }
+    if(write_set.empty()) {
+        return true;
+    }
+    // 3) create a single delta, and apply.
+    assert(this->delta.is_empty());
+    std::size_t delta_len = BATCH_DELTA_HEADER_SIZE;
+    this->delta.calibrate(delta_len);
+    begin_lockless_update(write_set.front().get_version());
+    for(const auto& value : write_set) {
+        std::optional<VT> offloaded_value;
+        offload_blob(value, offloaded_value);
+        const VT& stored_value = offloaded_value ? *offloaded_value : value;
+        append_batch_delta(stored_value, delta_len);
+        apply_ordered_put(stored_value);
+    }
+    end_lockless_update(write_set.front().get_version());
+    if(this->blob_segments != nullptr) {
+        this->blob_segments->sync();
+    }
+    seal_batch_delta(write_set.size(), delta_len);
     return true;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 bool DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_remove(const VT& value, persistent::version_t prev_ver) {
+    auto residency_lock = lock_residency();
     auto& key = value.get_key_ref();
+    typename std::map<KT, VT>::iterator it;
     // test if key exists
-    if(kv_map.find(key) == kv_map.end()) {
+    if(!this->kv_index.lookup(key, it)) {
         // skip it when no such key.
         return false;
-    } else if(kv_map.at(key).is_null()) {
+    } else if(it->second.is_null()) {
         // and skip the keys has been deleted already.
         return false;
     }
 
     if constexpr(std::is_base_of<IKeepPreviousVersion, VT>::value) {
-        value.set_previous_version(prev_ver, kv_map.at(key).get_version());
+        value.set_previous_version(prev_ver, it->second.get_version());
     }
     // create delta.
     assert(this->delta.is_empty());
-    this->delta.calibrate(mutils::bytes_size(value));
-    mutils::to_bytes(value, this->delta.data_ptr());
-    this->delta.set_data_len(mutils::bytes_size(value));
+    write_put_delta(value);
     // apply_ordered_put
+    begin_lockless_update(value.get_version());
     apply_ordered_put(value);
+    end_lockless_update(value.get_version());
     return true;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 const VT DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_get(const KT& key) const {
-    if(kv_map.find(key) != kv_map.end()) {
-        return kv_map.at(key);
+    auto residency_lock = lock_residency();
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        if(this->residency_clock) {
+            this->residency_clock->touch(key);
+        }
+        return it->second;
     } else {
         return *IV;
     }
@@ -212,35 +539,19 @@ const VT DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_get(const KT& key) const
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 const VT DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_get(const KT& key) const {
-    persistent::version_t v1, v2;
-    static thread_local VT copied_out;
-    do {
-        // This only for TSO memory reordering.
-        v2 = this->lockless_v2.load(std::memory_order_relaxed);
-        // compiler reordering barrier
-#ifdef __GNUC__
-        asm volatile("" ::
-                             : "memory");
-#else
-#error Lockless support is currently for GCC only
-#endif
-        if(this->kv_map.find(key) != this->kv_map.end()) {
-            copied_out.copy_from(this->kv_map.at(key));
-        } else {
-            copied_out.copy_from(*IV);
+    // The epoch guard keeps the object alive while we copy it into the return value, so there is no need to
+    // validate against lockless_v1/lockless_v2 and retry. The copy shares the blob of the stored object, which is
+    // immutable and reference-counted, so the data is not copied.
+    EpochManager::Guard epoch_guard;
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        if(this->residency_clock) {
+            this->residency_clock->touch(key);
         }
-        // compiler reordering barrier
-#ifdef __GNUC__
-        asm volatile("" ::
-                             : "memory");
-#else
-#error Lockless support is currently for GCC only
-#endif
-        v1 = this->lockless_v1.load(std::memory_order_relaxed);
-        // busy sleep
-        std::this_thread::yield();
-    } while(v1 != v2);
-    return copied_out;
+        // an evicted value is loaded from the log by the copy.
+        return it->second;
+    }
+    return *IV;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
@@ -257,11 +568,8 @@ std::vector<KT> DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_list_keys(const
 #else
 #error Lockless support is currently for GCC only
 #endif
-        for(const auto& kv : kv_map) {
-            if(get_pathname<KT>(kv.first).find(prefix) == 0) {
-                key_list.push_back(kv.first);
-            }
-        }
+        key_list.clear();
+        this->key_trie.list_keys(prefix, key_list);
         // compiler reordering barrier
 #ifdef __GNUC__
         asm volatile("" ::
@@ -270,27 +578,27 @@ std::vector<KT> DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_list_keys(const
 #error Lockless support is currently for GCC only
 #endif
         v1 = this->lockless_v1.load(std::memory_order_relaxed);
-        // busy sleep
-        std::this_thread::yield();
+        if(v1 != v2) {
+            // busy sleep only when we have to retry
+            std::this_thread::yield();
+        }
     } while(v1 != v2);
     return key_list;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
-std::vector<KT> DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_list_keys(const std::string& prefix) {
+std::vector<KT> DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_list_keys(const std::string& prefix) const {
     std::vector<KT> key_list;
-    for(const auto& kv : kv_map) {
-        if(get_pathname<KT>(kv.first).find(prefix) == 0) {
-            key_list.push_back(kv.first);
-        }
-    }
+    this->key_trie.list_keys(prefix, key_list);
     return key_list;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 uint64_t DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_get_size(const KT& key) {
-    if(kv_map.find(key) != kv_map.end()) {
-        return mutils::bytes_size(kv_map.at(key));
+    auto residency_lock = lock_residency();
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        return mutils::bytes_size(it->second);
     } else {
         return 0;
     }
@@ -298,9 +606,17 @@ uint64_t DeltaCascadeStoreCore<KT, VT, IK, IV>::ordered_get_size(const KT& key)
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 uint64_t DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_get_size(const KT& key) const {
-    persistent::version_t v1, v2;
-    uint64_t size = 0ull;
+    EpochManager::Guard epoch_guard;
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        return mutils::bytes_size(it->second);
+    }
+    return 0;
+}
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_find_many(const std::vector<KT>& keys, std::vector<const VT*>& objects) const {
+    persistent::version_t v1, v2;
     do {
         // This only for TSO memory reordering.
         v2 = this->lockless_v2.load(std::memory_order_relaxed);
@@ -311,8 +627,11 @@ uint64_t DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_get_size(const KT& key)
 #else
 #error Lockless support is currently for GCC only
 #endif
-        if(this->kv_map.find(key) != this->kv_map.end()) {
-            size = mutils::bytes_size(this->kv_map.at(key));
+        // only the map nodes are collected here; the objects are copied once the state is known to be consistent.
+        objects.clear();
+        typename std::map<KT, VT>::iterator it;
+        for(const auto& key : keys) {
+            objects.emplace_back(this->kv_index.lookup(key, it) ? &it->second : nullptr);
         }
         // compiler reordering barrier
 #ifdef __GNUC__
@@ -322,34 +641,303 @@ uint64_t DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_get_size(const KT& key)
 #error Lockless support is currently for GCC only
 #endif
         v1 = this->lockless_v1.load(std::memory_order_relaxed);
-        // busy sleep
-        std::this_thread::yield();
+        if(v1 != v2) {
+            // busy sleep only when we have to retry
+            std::this_thread::yield();
+        }
     } while(v1 != v2);
-    return size;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<VT> DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_get_many(const std::vector<KT>& keys) const {
+    std::vector<VT> found;
+    // the positions of the evicted values in found, which hold their blob generators until they are loaded.
+    std::vector<std::size_t> evicted;
+    found.reserve(keys.size());
+    {
+        // The epoch guard keeps the found objects alive, even if they are replaced after the lookups.
+        EpochManager::Guard epoch_guard;
+        std::vector<const VT*> objects;
+        lockless_find_many(keys, objects);
+        for(std::size_t i = 0; i < keys.size(); i++) {
+            if(objects[i] == nullptr) {
+                found.emplace_back(*IV);
+                continue;
+            }
+            if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+                if(this->residency_clock) {
+                    this->residency_clock->touch(keys[i]);
+                    if(objects[i]->get_blob_bytes() == nullptr && !objects[i]->has_blob_segment_ref()
+                       && objects[i]->get_blob_size() > 0) {
+                        // an evicted value is not loaded here, so that the log reads do not hold the epoch back.
+                        const persistent::version_t ver = objects[i]->get_version();
+                        const KT key = keys[i];
+                        found.emplace_back(objects[i]->copy_with_blob_generator([this, key, ver](uint8_t* buffer, const std::size_t size) {
+                            return this->load_blob(key, ver, buffer, size);
+                        }));
+                        evicted.emplace_back(i);
+                        continue;
+                    }
+                }
+            }
+            found.emplace_back(*objects[i]);
+        }
+    }
+    if(evicted.empty()) {
+        return found;
+    }
+    // the copy of an evicted value loads its blob from the log.
+    std::vector<VT> values;
+    values.reserve(found.size());
+    auto next_evicted = evicted.cbegin();
+    for(std::size_t i = 0; i < found.size(); i++) {
+        if(next_evicted != evicted.cend() && *next_evicted == i) {
+            values.emplace_back(static_cast<const VT&>(found[i]));
+            next_evicted++;
+        } else {
+            values.emplace_back(std::move(found[i]));
+        }
+    }
+    return values;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<uint64_t> DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_get_size_many(const std::vector<KT>& keys) const {
+    EpochManager::Guard epoch_guard;
+    std::vector<const VT*> objects;
+    lockless_find_many(keys, objects);
+    std::vector<uint64_t> sizes;
+    sizes.reserve(keys.size());
+    for(const auto* object : objects) {
+        sizes.emplace_back(object ? mutils::bytes_size(*object) : 0);
+    }
+    return sizes;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+bool DeltaCascadeStoreCore<KT, VT, IK, IV>::lockless_get_key_version(const KT& key, const persistent::version_t& ver, persistent::version_t& key_version) const {
+    return this->key_version_index.lookup(key, ver, key_version);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::trim_version_index(const persistent::version_t& stable_version, uint64_t max_updates) {
+    persistent::version_t frontier = stable_version;
+    if(max_updates > 0) {
+        frontier = std::max(frontier, this->key_version_index.recent_update_version(max_updates));
+    }
+    if(frontier != persistent::INVALID_VERSION) {
+        this->key_version_index.trim(frontier);
+    }
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::begin_recovery(uint32_t num_threads) {
+    num_recovery_threads = std::max(num_threads, 1u);
+    num_recovered_deltas = 0;
+    recovery_start = std::chrono::steady_clock::now();
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::parallel_replay() {
+    const uint32_t num_threads = num_recovery_threads;
+    auto run_in_parallel = [num_threads](const std::function<void(uint32_t)>& func) {
+        std::vector<std::thread> threads;
+        for(uint32_t tid = 1; tid < num_threads; tid++) {
+            threads.emplace_back(func, tid);
+        }
+        func(0);
+        for(auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    std::vector<std::map<KT, VT>> partitions(num_threads);
+    std::vector<std::unordered_map<KT, std::vector<persistent::version_t>>> partition_chains(num_threads);
+    // the objects of each delta: a batch delta has several.
+    std::vector<std::vector<std::unique_ptr<VT>>> objects;
+    std::vector<std::vector<uint32_t>> owners;
+    persistent::version_t last_version = persistent::INVALID_VERSION;
+    // bound the memory to one batch of deserialized objects.
+    for(size_t batch_start = 0; batch_start < recovery_deltas.size(); batch_start += RECOVERY_BATCH_SIZE) {
+        const size_t batch_size = std::min(static_cast<size_t>(RECOVERY_BATCH_SIZE), recovery_deltas.size() - batch_start);
+        objects.resize(batch_size);
+        owners.resize(batch_size);
+        // 1) deserialize a contiguous range of the batch in each thread, and find the owner of each object.
+        run_in_parallel([&](uint32_t tid) {
+            const size_t begin = batch_size * tid / num_threads;
+            const size_t end = batch_size * (tid + 1) / num_threads;
+            for(size_t i = begin; i < end; i++) {
+                objects[i].clear();
+                owners[i].clear();
+                DeltaObjects<VT>::for_each(recovery_deltas[batch_start + i], [&](const VT& value) {
+                    objects[i].emplace_back(std::make_unique<VT>(value));
+                    owners[i].emplace_back(std::hash<KT>{}(value.get_key_ref()) % num_threads);
+                });
+            }
+        });
+        // 2) apply the objects in log order, each thread to its own partition.
+        run_in_parallel([&](uint32_t tid) {
+            auto& partition = partitions[tid];
+            auto& chains = partition_chains[tid];
+            for(size_t i = 0; i < batch_size; i++) {
+                for(size_t j = 0; j < objects[i].size(); j++) {
+                    if(owners[i][j] != tid) {
+                        continue;
+                    }
+                    const VT& value = *objects[i][j];
+                    auto it = partition.find(value.get_key_ref());
+                    if(it != partition.end()) {
+                        it = partition.erase(it);
+                    }
+                    partition.emplace_hint(it, value.get_key_ref(), value);
+                    auto& chain = chains[value.get_key_ref()];
+                    if(chain.empty() || chain.back() < value.get_version()) {
+                        chain.push_back(value.get_version());
+                    }
+                }
+            }
+        });
+        for(size_t i = batch_size; i > 0; i--) {
+            if(!objects[i - 1].empty()) {
+                last_version = std::max(last_version, objects[i - 1].back()->get_version());
+                break;
+            }
+        }
+        objects.clear();
+        owners.clear();
+    }
+
+    // 3) merge the partitions. The keys of the partitions are disjoint, and the replayed objects replace those in
+    // kv_map, if any.
+    for(uint32_t tid = 0; tid < num_threads; tid++) {
+        auto& partition = partitions[tid];
+        while(!partition.empty()) {
+            auto node = partition.extract(partition.begin());
+            this->kv_map.erase(node.key());
+            this->kv_map.insert(std::move(node));
+        }
+        this->key_version_index.append_chains(std::move(partition_chains[tid]));
+    }
+    this->kv_index.rebuild(this->kv_map);
+    for(const auto& kv : this->kv_map) {
+        this->key_trie.insert(kv.first);
+    }
+    // 4) the memory budget is set before the replay (see set_memory_budget()): admit the replayed values, and evict
+    // the cold ones as the sequential replay does.
+    if(this->residency_clock) {
+        for(const auto& kv : this->kv_map) {
+            this->residency_clock->admit(kv.first, resident_bytes_of(kv.second));
+        }
+        enforce_memory_budget();
+    }
+    this->lockless_v1.store(last_version, std::memory_order_relaxed);
+    this->lockless_v2.store(last_version, std::memory_order_relaxed);
+    num_recovered_deltas = recovery_deltas.size();
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::finish_recovery() {
+    if(num_recovery_threads == 0) {
+        return;
+    }
+    if(num_recovery_threads > 1 && !recovery_deltas.empty()) {
+        parallel_replay();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - recovery_start).count();
+    dbg_default_info("Recovered {} deltas of {} keys with {} thread(s) in {:.3f} seconds, {:.1f} deltas/s.",
+                     num_recovered_deltas, this->kv_map.size(), num_recovery_threads, seconds,
+                     (seconds > 0) ? (num_recovered_deltas / seconds) : 0.0);
+    recovery_deltas.clear();
+    recovery_deltas.shrink_to_fit();
+    num_recovery_threads = 0;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::set_blob_segments(BlobSegmentStore* segments) {
+    this->blob_segments = segments;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::set_memory_budget(uint64_t budget_bytes) {
+    if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+        if(this->residency_clock) {
+            dbg_default_warn("The memory budget of a store can only be set once.");
+            return;
+        }
+        this->residency_clock = std::make_unique<ResidencyClock<KT>>(budget_bytes);
+        for(const auto& kv : this->kv_map) {
+            this->residency_clock->admit(kv.first, resident_bytes_of(kv.second));
+        }
+        enforce_memory_budget();
+        this->promotion_thread = std::thread(&DeltaCascadeStoreCore::promotion_worker, this);
+    } else {
+        dbg_default_warn("The memory budget is ignored because the value type does not implement IOffloadableBlob.");
+    }
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void DeltaCascadeStoreCore<KT, VT, IK, IV>::set_blob_loader(const blob_loader_t& loader) {
+    this->blob_loader = loader;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+bool DeltaCascadeStoreCore<KT, VT, IK, IV>::get_residency_stats(ResidencyStats& stats) const {
+    if(!this->residency_clock) {
+        return false;
+    }
+    stats = this->residency_clock->get_stats();
+    return true;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 DeltaCascadeStoreCore<KT, VT, IK, IV>::DeltaCascadeStoreCore() : lockless_v1(persistent::INVALID_VERSION),
-                                                                 lockless_v2(persistent::INVALID_VERSION) {
+                                                                 lockless_v2(persistent::INVALID_VERSION),
+                                                                 num_recovery_threads(0),
+                                                                 num_recovered_deltas(0),
+                                                                 blob_segments(nullptr) {
     initialize_delta();
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 DeltaCascadeStoreCore<KT, VT, IK, IV>::DeltaCascadeStoreCore(const std::map<KT, VT>& _kv_map) : lockless_v1(persistent::INVALID_VERSION),
                                                                                                 lockless_v2(persistent::INVALID_VERSION),
+                                                                                                num_recovery_threads(0),
+                                                                                                num_recovered_deltas(0),
+                                                                                                blob_segments(nullptr),
                                                                                                 kv_map(_kv_map) {
     initialize_delta();
+    kv_index.rebuild(kv_map);
+    persistent::version_t snapshot_version = persistent::INVALID_VERSION;
+    for(const auto& kv : kv_map) {
+        key_trie.insert(kv.first);
+        snapshot_version = std::max(snapshot_version, kv.second.get_version());
+    }
+    key_version_index.seed(kv_map, snapshot_version);
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 DeltaCascadeStoreCore<KT, VT, IK, IV>::DeltaCascadeStoreCore(std::map<KT, VT>&& _kv_map) : lockless_v1(persistent::INVALID_VERSION),
                                                                                            lockless_v2(persistent::INVALID_VERSION),
+                                                                                           num_recovery_threads(0),
+                                                                                           num_recovered_deltas(0),
+                                                                                           blob_segments(nullptr),
                                                                                            kv_map(std::move(_kv_map)) {
     initialize_delta();
+    kv_index.rebuild(kv_map);
+    persistent::version_t snapshot_version = persistent::INVALID_VERSION;
+    for(const auto& kv : kv_map) {
+        key_trie.insert(kv.first);
+        snapshot_version = std::max(snapshot_version, kv.second.get_version());
+    }
+    key_version_index.seed(kv_map, snapshot_version);
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
 DeltaCascadeStoreCore<KT, VT, IK, IV>::~DeltaCascadeStoreCore() {
+    if(this->promotion_thread.joinable()) {
+        this->residency_clock->interrupt();
+        this->promotion_thread.join();
+    }
     if(this->delta.buffer != nullptr) {
         free(this->delta.buffer);
     }
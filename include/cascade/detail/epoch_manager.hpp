@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * EpochManager implements epoch-based reclamation for the lockless read paths of the stores.
+ *
+ * A reader pins the current epoch with an EpochManager::Guard for as long as it dereferences shared objects. A writer
+ * unlinks an object first and then retires it. A retired object is destroyed only when every reader that might still
+ * see it has unpinned its epoch, so readers never copy out under a retry loop.
+ *
+ * Typical usage:
+ *
+ *     // reader
+ *     {
+ *         EpochManager::Guard guard;
+ *         const VT* obj = lookup(key);
+ *         ... read *obj ...
+ *     }
+ *
+ *     // writer
+ *     unlink(old_obj);
+ *     EpochManager::get().retire(std::move(old_obj), bytes_of(old_obj));
+ *
+ * There is one EpochManager per process, shared by all stores. Pinning is reentrant.
+ *
+ * Each thread has its own record, holding the epoch it pins and the objects it retired. Retiring an object only appends
+ * it to the record of the calling thread. Every EPOCH_RETIRE_BATCH_SIZE retirements, or once the retired objects hold
+ * EPOCH_RETIRE_BATCH_BYTES, the thread advances the global epoch once and scans the pinned epochs once, destroying the
+ * objects of its batch that no reader can see any more.
+ *
+ * A thread which stops retiring, such as the writer of a quiet shard, would keep the rest of its batch alive, so a
+ * reclaimer thread, started by the first retirement, also reclaims the objects of all threads every
+ * EPOCH_RECLAIM_INTERVAL_MS. It skips the records in use by their thread at that moment.
+ */
+class EpochManager {
+public:
+#define EPOCH_RETIRE_BATCH_SIZE (64)
+#define EPOCH_RETIRE_BATCH_BYTES (1ul << 20)
+#define EPOCH_RECLAIM_INTERVAL_MS (100)
+
+private:
+    /**
+     * Type erasure for the retired objects.
+     */
+    struct RetiredObject {
+        /* the memory the object holds, as estimated by the caller. */
+        size_t bytes;
+        explicit RetiredObject(size_t _bytes) : bytes(_bytes) {}
+        virtual ~RetiredObject() = default;
+    };
+    template <typename T>
+    struct RetiredHolder : public RetiredObject {
+        T payload;
+        RetiredHolder(T&& obj, size_t bytes) : RetiredObject(bytes), payload(std::move(obj)) {}
+    };
+    /* a retired object and the epoch at which it was retired. */
+    using retired_list_t = std::vector<std::pair<uint64_t, std::unique_ptr<RetiredObject>>>;
+
+    /**
+     * Per-thread record. A record is claimed by one thread at a time, and given back when the thread exits.
+     */
+    struct alignas(64) ThreadRecord {
+        /* the pinned epoch, or 0 if the thread is not reading. */
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> in_use{false};
+        uint32_t pin_depth = 0;
+        /**
+         * the objects retired by the thread, and the bytes they hold, protected by retired_mutex. Only the thread
+         * waits for the lock; the reclaimer thread leaves the record alone if the lock is taken.
+         */
+        retired_list_t retired_objects;
+        size_t retired_bytes = 0;
+        std::mutex retired_mutex;
+        /* the next record in the list, which is immutable once the record is published. */
+        ThreadRecord* next = nullptr;
+    };
+
+    std::atomic<uint64_t> global_epoch;
+    /* the thread records are never freed, so the list is scanned without a lock. */
+    std::atomic<ThreadRecord*> thread_records;
+    /* the objects left behind by the exited threads, reclaimed by the next batch of any thread. */
+    retired_list_t orphaned_objects;
+    size_t orphaned_bytes;
+    std::mutex orphaned_objects_mutex;
+    /* the number of objects waiting for reclamation. */
+    std::atomic<size_t> num_retired;
+
+    /* the reclaimer thread, started by the first retirement. */
+    std::once_flag reclaimer_started;
+    std::thread reclaimer;
+    bool reclaimer_stopped;
+    std::mutex reclaimer_mutex;
+    std::condition_variable reclaimer_cv;
+
+    /**
+     * Get the record of the calling thread, claiming one on first use.
+     */
+    ThreadRecord* get_thread_record();
+    /**
+     * Give a record back when its thread exits. The objects it still holds are orphaned.
+     */
+    void release_thread_record(ThreadRecord* record);
+    /**
+     * Retire an object to the record of the calling thread, and reclaim its batch when it is full.
+     */
+    void retire_object(std::unique_ptr<RetiredObject>&& obj);
+    /**
+     * Advance the global epoch, then destroy the objects in the list that no reader can see any more.
+     *
+     * @param retired_objects   - the list
+     * @param retired_bytes     - the bytes held by the objects in the list, which is updated.
+     *
+     * @return the number of objects destroyed.
+     */
+    size_t reclaim_list(retired_list_t& retired_objects, size_t& retired_bytes);
+    /**
+     * The reclaimer thread.
+     */
+    void run_reclaimer();
+    /**
+     * @return the oldest epoch pinned by any reader, or UINT64_MAX if no reader is active.
+     */
+    uint64_t oldest_pinned_epoch() const;
+
+    friend struct ThreadRecordOwner;
+
+    EpochManager();
+
+public:
+    /**
+     * RAII guard pinning the current epoch in the calling thread.
+     */
+    class Guard {
+    private:
+        ThreadRecord* record;
+
+    public:
+        Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard();
+    };
+
+    /**
+     * Retire an unlinked object. It will be destroyed after all readers that might see it have left.
+     *
+     * @tparam T    - the object type, which must be movable. Typically a std::unique_ptr or a node handle.
+     * @param obj   - the object.
+     * @param bytes - the memory held by the object, if it is worth reclaiming sooner.
+     */
+    template <typename T>
+    void retire(T&& obj, size_t bytes = 0) {
+        retire_object(std::make_unique<RetiredHolder<std::decay_t<T>>>(std::move(obj), bytes));
+    }
+
+    /**
+     * Destroy the objects retired by the calling thread, and by the exited threads, that no reader can see any more.
+     *
+     * @return the number of objects destroyed.
+     */
+    size_t reclaim();
+
+    /**
+     * Destroy the objects retired by any thread, and by the exited threads, that no reader can see any more. The
+     * objects of a thread which is retiring an object at the same time are left to it. It is called periodically by
+     * the reclaimer thread.
+     *
+     * @return the number of objects destroyed.
+     */
+    size_t reclaim_all();
+
+    /**
+     * @return the number of retired objects waiting for reclamation.
+     */
+    size_t num_retired_objects() const;
+
+    /**
+     * Get the process-wide EpochManager.
+     */
+    static EpochManager& get();
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+    virtual ~EpochManager();
+};
+
+}  // namespace cascade
+}  // namespace derecho
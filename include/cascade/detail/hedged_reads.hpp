@@ -0,0 +1,372 @@
+#pragma once
+
+#include <derecho/core/derecho.hpp>
+
+#include "reply_watcher.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * HedgedReads implements the hedged reads of the ServiceClient. A hedged read is sent to one shard member as usual;
+ * if that member has not replied after a delay, a duplicate read is sent to another member of the shard. The first
+ * reply wins, and the other one is dropped.
+ *
+ * The delay is a percentile of the recent read latencies, so only the slowest reads are duplicated, but not less than
+ * a minimal delay. Until there are HEDGED_READ_MIN_SAMPLES samples, the delay is HEDGED_READ_INITIAL_DELAY_US. The
+ * duplicates are limited to HEDGED_READ_MAX_HEDGE_PERCENT percent of the reads, so that hedging does not double the
+ * load of an overloaded shard.
+ *
+ * A hedged read returns a QueryResults as a normal read does. Its ReplyMap has a single entry, keyed by the member
+ * whose reply won, or by the first member if the read fails. The replies are handed on by a ReplyWatcher as soon as
+ * they come, and each of them is reported to the completion given with its request, so that the caller can record the
+ * load of the members without watching the replies itself. The reads wait for their delay in a deadline queue, and a worker thread, started when hedging is enabled,
+ * sleeps until the earliest deadline to send the duplicate read.
+ */
+class HedgedReads {
+public:
+#define HEDGED_READ_DEFAULT_PERCENTILE (95.0)
+#define HEDGED_READ_DEFAULT_MIN_DELAY_US (200)
+#define HEDGED_READ_INITIAL_DELAY_US (10000)
+#define HEDGED_READ_LATENCY_WINDOW (1024)
+#define HEDGED_READ_MIN_SAMPLES (32)
+#define HEDGED_READ_MAX_HEDGE_PERCENT (10)
+    /**
+     * The counters of the hedged reads.
+     */
+    struct Stats {
+        /* the reads sent in hedging mode. */
+        uint64_t reads;
+        /* the duplicate reads sent. */
+        uint64_t hedges;
+        /* the reads answered by the duplicate first. */
+        uint64_t hedge_wins;
+    };
+    /**
+     * The completion of a request, called when its reply comes with true if the reply is a value, or with false if it
+     * is an error or if the reply watcher has stopped.
+     */
+    using completion_t = std::function<void(bool)>;
+
+private:
+    /**
+     * An in-flight read, whatever the reply type is.
+     */
+    class Read {
+    public:
+        virtual ~Read() = default;
+        /**
+         * Send the duplicate read, unless the read is complete or has been hedged already. It is called by the worker
+         * thread at the deadline of the read.
+         *
+         * @param hedged_reads  - the owner
+         */
+        virtual void hedge(HedgedReads& hedged_reads) = 0;
+        /**
+         * Fail the read if it waits for a duplicate read which will not be sent, when the worker thread stops.
+         */
+        virtual void abandon() = 0;
+    };
+
+    template <typename Ret>
+    class TypedRead;
+
+    /* a read and the time in microseconds at which it is hedged. */
+    using Deadline = std::pair<uint64_t, std::shared_ptr<Read>>;
+    struct LaterDeadline {
+        bool operator()(const Deadline& lhs, const Deadline& rhs) const {
+            return lhs.first > rhs.first;
+        }
+    };
+
+    std::atomic<bool> enabled;
+    /* the latency percentile and the minimal delay, protected by latency_mutex. */
+    double percentile;
+    uint64_t min_delay_us;
+    /* a ring of the recent read latencies in microseconds, and the delay computed from them. */
+    std::vector<uint64_t> latency_window;
+    std::size_t next_sample;
+    std::size_t samples_since_update;
+    uint64_t delay_us;
+    mutable std::mutex latency_mutex;
+
+    std::atomic<uint64_t> reads;
+    std::atomic<uint64_t> hedges;
+    std::atomic<uint64_t> hedge_wins;
+
+    /* the reads waiting for their deadline, earliest first, and the worker thread sending the duplicate reads. */
+    std::priority_queue<Deadline, std::vector<Deadline>, LaterDeadline> deadlines;
+    std::mutex deadlines_mutex;
+    std::condition_variable deadlines_cv;
+    bool worker_running;
+    bool worker_stopped;
+    std::thread worker;
+    /**
+     * 'reply_watcher' hands the replies on to the reads. It is declared last, so that it is destroyed first: it fails
+     * the reads whose replies have not come while the other members are alive.
+     */
+    ReplyWatcher reply_watcher;
+
+    static uint64_t now_us();
+
+    /**
+     * Add a latency sample, and update the delay every few samples.
+     */
+    void record_latency(uint64_t latency_us);
+
+    /**
+     * @return the current delay before a duplicate read.
+     */
+    uint64_t get_delay_us() const;
+
+    /**
+     * Check and consume the duplicate read budget.
+     *
+     * @return true if a duplicate read may be sent.
+     */
+    bool acquire_hedge();
+
+    /**
+     * Hand a read over to the worker thread, to be hedged at a deadline. The read is abandoned if the worker thread
+     * has stopped.
+     */
+    void schedule(uint64_t deadline_us, const std::shared_ptr<Read>& read);
+
+    void send_hedges();
+
+public:
+    HedgedReads();
+    HedgedReads(const HedgedReads&) = delete;
+    HedgedReads& operator=(const HedgedReads&) = delete;
+    virtual ~HedgedReads();
+
+    /**
+     * Enable or disable hedged reads.
+     *
+     * @param enable        - true to enable hedged reads.
+     * @param percentile    - the percentile of the recent latencies after which a duplicate read is sent, in (0,100].
+     * @param min_delay_us  - the minimal delay before a duplicate read, in microseconds.
+     */
+    void set_policy(bool enable, double percentile, uint64_t min_delay_us);
+
+    /**
+     * @return true if hedged reads are enabled.
+     */
+    bool is_enabled() const;
+
+    /**
+     * @return the counters of the hedged reads.
+     */
+    Stats get_stats() const;
+
+    /**
+     * Watch a read, and hedge it if it is slow.
+     *
+     * @tparam Ret              - the reply type
+     * @param primary_node_id   - the member the read was sent to
+     * @param primary           - the results of the read
+     * @param primary_completion - the completion of the read, which may be empty.
+     * @param send_hedge        - sends the duplicate read, and sets the member it was sent to and its completion. It
+     *                            returns nullptr if there is no other member. It is called by the worker thread.
+     *
+     * @return the results of the hedged read.
+     */
+    template <typename Ret>
+    derecho::rpc::QueryResults<Ret> read(
+            node_id_t primary_node_id,
+            derecho::rpc::QueryResults<Ret>&& primary,
+            completion_t&& primary_completion,
+            std::function<std::unique_ptr<derecho::rpc::QueryResults<Ret>>(node_id_t&, completion_t&)>&& send_hedge);
+};
+
+template <typename Ret>
+class HedgedReads::TypedRead : public HedgedReads::Read, public std::enable_shared_from_this<TypedRead<Ret>> {
+private:
+    node_id_t primary_node_id;
+    uint64_t start_us;
+    std::function<std::unique_ptr<derecho::rpc::QueryResults<Ret>>(node_id_t&, completion_t&)> send_hedge;
+    /* its ReplyMap is fulfilled with the member that replied first. */
+    std::shared_ptr<derecho::rpc::PendingResults<Ret>> pending_results;
+    /* the state of the read, protected by mutex. */
+    std::mutex mutex;
+    bool complete;
+    bool hedge_tried;
+    /* the number of requests whose reply has not come. */
+    uint32_t in_flight;
+    std::exception_ptr error;
+
+    /**
+     * Fail the read. The caller must have set complete.
+     */
+    void fail(const std::exception_ptr& read_error) {
+        pending_results->fulfill_map({primary_node_id});
+        pending_results->set_exception(primary_node_id, read_error);
+    }
+
+    /**
+     * Fail the read if no reply can come any more. The caller must hold mutex, which is released.
+     */
+    void fail_if_no_reply(std::unique_lock<std::mutex>& lck, const std::exception_ptr& read_error) {
+        if(complete || in_flight > 0) {
+            return;
+        }
+        complete = true;
+        lck.unlock();
+        fail(read_error);
+    }
+
+public:
+    TypedRead(node_id_t _primary_node_id,
+              uint64_t _start_us,
+              std::function<std::unique_ptr<derecho::rpc::QueryResults<Ret>>(node_id_t&, completion_t&)>&& _send_hedge,
+              const std::shared_ptr<derecho::rpc::PendingResults<Ret>>& _pending_results)
+            : primary_node_id(_primary_node_id),
+              start_us(_start_us),
+              send_hedge(std::move(_send_hedge)),
+              pending_results(_pending_results),
+              complete(false),
+              hedge_tried(false),
+              in_flight(1) {}
+
+    /**
+     * Take a reply, which completes the read if it is the first successful one. It is called by the reply watcher.
+     *
+     * @param hedged_reads  - the owner
+     * @param node_id       - the member that replied
+     * @param reply         - the reply, or nullptr if the reply watcher has stopped.
+     * @param is_hedge      - true if it is the reply of the duplicate read.
+     * @param completion    - the completion of the request, which is called before the read is completed.
+     */
+    void on_reply(HedgedReads& hedged_reads, node_id_t node_id, std::future<Ret>* reply, bool is_hedge,
+                  const completion_t& completion) {
+        std::exception_ptr reply_error;
+        if(reply == nullptr) {
+            reply_error = std::make_exception_ptr(derecho::derecho_exception("The hedged reads have stopped."));
+        } else {
+            try {
+                Ret value = reply->get();
+                if(completion) {
+                    completion(true);
+                }
+                std::unique_lock<std::mutex> lck(mutex);
+                in_flight--;
+                if(complete) {
+                    return;
+                }
+                complete = true;
+                lck.unlock();
+                hedged_reads.record_latency(now_us() - start_us);
+                if(is_hedge) {
+                    hedged_reads.hedge_wins++;
+                }
+                pending_results->fulfill_map({node_id});
+                pending_results->set_value(node_id, value);
+                return;
+            } catch(...) {
+                reply_error = std::current_exception();
+            }
+        }
+        if(completion) {
+            completion(false);
+        }
+        std::unique_lock<std::mutex> lck(mutex);
+        in_flight--;
+        if(complete) {
+            return;
+        }
+        if(!error) {
+            error = reply_error;
+        }
+        if(reply != nullptr && !hedge_tried) {
+            // a failed first read is hedged at once.
+            lck.unlock();
+            hedged_reads.schedule(now_us(), this->shared_from_this());
+            return;
+        }
+        if(reply == nullptr) {
+            // the other request, if any, is abandoned too.
+            complete = true;
+            lck.unlock();
+            fail(error);
+            return;
+        }
+        fail_if_no_reply(lck, error);
+    }
+
+    virtual void hedge(HedgedReads& hedged_reads) override {
+        std::unique_lock<std::mutex> lck(mutex);
+        if(complete || hedge_tried) {
+            return;
+        }
+        hedge_tried = true;
+        const bool primary_failed = (in_flight == 0);
+        if(!primary_failed && !hedged_reads.acquire_hedge()) {
+            return;
+        }
+        // count the duplicate read before sending it, so that a failing first read waits for it.
+        in_flight++;
+        lck.unlock();
+        std::exception_ptr hedge_error;
+        try {
+            node_id_t hedge_node_id = INVALID_NODE_ID;
+            completion_t hedge_completion;
+            auto hedge = send_hedge(hedge_node_id, hedge_completion);
+            if(hedge) {
+                hedged_reads.hedges++;
+                auto self = this->shared_from_this();
+                hedged_reads.reply_watcher.watch<Ret>(
+                        hedge_node_id, std::move(*hedge),
+                        [&hedged_reads, self, hedge_node_id, hedge_completion](std::future<Ret>* reply) {
+                            self->on_reply(hedged_reads, hedge_node_id, reply, true, hedge_completion);
+                        });
+                return;
+            }
+        } catch(...) {
+            hedge_error = std::current_exception();
+        }
+        lck.lock();
+        in_flight--;
+        fail_if_no_reply(lck, error ? error : hedge_error);
+    }
+
+    virtual void abandon() override {
+        std::unique_lock<std::mutex> lck(mutex);
+        fail_if_no_reply(lck, error ? error : std::make_exception_ptr(derecho::derecho_exception("The hedged reads have stopped.")));
+    }
+};
+
+template <typename Ret>
+derecho::rpc::QueryResults<Ret> HedgedReads::read(
+        node_id_t primary_node_id,
+        derecho::rpc::QueryResults<Ret>&& primary,
+        completion_t&& primary_completion,
+        std::function<std::unique_ptr<derecho::rpc::QueryResults<Ret>>(node_id_t&, completion_t&)>&& send_hedge) {
+    const uint64_t start_us = now_us();
+    reads++;
+    auto pending_results = std::make_shared<derecho::rpc::PendingResults<Ret>>();
+    auto query_results = pending_results->get_future();
+    auto read = std::make_shared<TypedRead<Ret>>(primary_node_id, start_us, std::move(send_hedge), pending_results);
+    reply_watcher.watch<Ret>(primary_node_id, std::move(primary),
+                             [this, read, primary_node_id, primary_completion = std::move(primary_completion)](
+                                     std::future<Ret>* reply) {
+                                 read->on_reply(*this, primary_node_id, reply, false, primary_completion);
+                             });
+    schedule(start_us + get_delay_us(), read);
+    return std::move(*query_results);
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * The key hash algorithms. The algorithm and the seed of an object pool are recorded in its metadata, so that every
+ * client, in any language, computes the same placement.
+ *
+ * - KEY_HASH_WYHASH: wyhash (final version 4), with its default secret. It consumes 48 bytes per round in three
+ *   independent lanes, and it is the default of the new object pools.
+ * - KEY_HASH_FNV1A: 64-bit FNV-1a, one byte at a time. It is slower, but trivial to reimplement in a client. The seed
+ *   is xor'ed into the offset basis. With seed 0, it is the hash of the VIRTUAL sharding policy before the algorithm
+ *   was recorded.
+ * - KEY_HASH_STD: std::hash<std::string>, the hash of the HASH sharding policy before the algorithm was recorded. It is
+ *   kept for the object pools created then. Its result depends on the standard library build, and it has no seed.
+ * - KEY_HASH_LEGACY: not an algorithm. It asks for the hash an object pool used before the algorithm was recorded,
+ *   which depends on its sharding policy, see ObjectPoolMetadata::legacy_key_hash_algorithm().
+ *
+ * KEY_HASH_WYHASH and KEY_HASH_FNV1A read the key bytes in little-endian order.
+ */
+using key_hash_algorithm_t = enum key_hash_algorithm_type {
+    KEY_HASH_WYHASH = 0,
+    KEY_HASH_FNV1A = 1,
+    KEY_HASH_STD = 2,
+    KEY_HASH_LEGACY = 0xff
+};
+
+/**
+ * The default seed of the key hash.
+ */
+#define KEY_HASH_DEFAULT_SEED (0ULL)
+
+namespace key_hash_detail {
+
+static constexpr uint64_t wyp[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+                                    0x4d5a2da51de1aa47ULL};
+
+static inline void wymum(uint64_t* a, uint64_t* b) {
+    __uint128_t r = *a;
+    r *= *b;
+    *a = static_cast<uint64_t>(r);
+    *b = static_cast<uint64_t>(r >> 64);
+}
+
+static inline uint64_t wymix(uint64_t a, uint64_t b) {
+    wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyr8(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t wyr4(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t wyr3(const uint8_t* p, std::size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+static inline uint64_t wyhash(const std::string_view& key, uint64_t seed) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(key.data());
+    const std::size_t len = key.size();
+    seed ^= wymix(seed ^ wyp[0], wyp[1]);
+    uint64_t a, b;
+    if(__builtin_expect(len <= 16, 1)) {
+        if(__builtin_expect(len >= 4, 1)) {
+            a = (wyr4(p) << 32) | wyr4(p + ((len >> 3) << 2));
+            b = (wyr4(p + len - 4) << 32) | wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if(__builtin_expect(len > 0, 1)) {
+            a = wyr3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        std::size_t i = len;
+        if(__builtin_expect(i >= 48, 0)) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ wyp[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ wyp[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while(__builtin_expect(i >= 48, 1));
+            seed ^= see1 ^ see2;
+        }
+        while(__builtin_expect(i > 16, 0)) {
+            seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+    a ^= wyp[1];
+    b ^= seed;
+    wymum(&a, &b);
+    return wymix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
+static inline uint64_t fnv1a(const std::string_view& key, uint64_t seed) {
+    uint64_t h = 14695981039346656037ULL ^ seed;
+    for(const char c : key) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+}  // namespace key_hash_detail
+
+/**
+ * Hash a key with the default algorithm. Unlike std::hash, the result is the same in all processes and builds, so it
+ * can be used for placement.
+ *
+ * @param key       - the key
+ * @param seed      - the seed
+ *
+ * @return the 64-bit hash of the key.
+ */
+inline uint64_t key_hash(const std::string_view& key, uint64_t seed = KEY_HASH_DEFAULT_SEED) {
+    return key_hash_detail::wyhash(key, seed);
+}
+
+/**
+ * Hash a key with a given algorithm.
+ *
+ * @param algorithm - the key hash algorithm
+ * @param seed      - the seed
+ * @param key       - the key
+ *
+ * @return the 64-bit hash of the key.
+ */
+inline uint64_t key_hash(key_hash_algorithm_t algorithm, uint64_t seed, const std::string_view& key) {
+    switch(algorithm) {
+        case KEY_HASH_FNV1A:
+            return key_hash_detail::fnv1a(key, seed);
+        case KEY_HASH_STD:
+            // the same as std::hash<std::string> of the key.
+            return std::hash<std::string_view>{}(key);
+        default:
+            return key_hash_detail::wyhash(key, seed);
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
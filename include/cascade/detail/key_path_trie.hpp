@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cascade/config.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * KeyPathTrie indexes the keys of a store by the components of their pathnames (see get_pathname()), so that listing
+ * the keys under a prefix only visits the matching part of the tree instead of every key in the store.
+ *
+ * The matching rule is the same as the one the stores used to apply key by key: a key matches a prefix if its
+ * pathname starts with the prefix. Therefore, the last component of the prefix is a partial match: "/a/b" matches keys
+ * in both "/a/b" and "/a/bc", while "/a/b/" only matches keys in the subfolders of "/a/b".
+ *
+ * KeyPathTrie is not thread-safe. The stores update it in the same critical section as their kv_map, and lockless
+ * readers use the same lockless_v1/lockless_v2 validation as they do for kv_map.
+ *
+ * @tparam KT           - the key type
+ * @tparam separator    - the path separator
+ */
+template <typename KT, char separator = PATH_SEPARATOR>
+class KeyPathTrie {
+private:
+    class TrieNode {
+    public:
+        // std::less<> allows looking up the children with a std::string_view.
+        std::map<std::string, std::unique_ptr<TrieNode>, std::less<>> children;
+        std::set<KT> keys;
+    };
+    TrieNode root;
+    size_t num_keys;
+
+    /**
+     * Append all keys in a subtree to key_list.
+     */
+    static void collect(const TrieNode* node, std::vector<KT>& key_list);
+    /**
+     * Split a path into components. An empty path has no component; a leading, trailing, or repeated separator
+     * yields an empty component.
+     */
+    static std::vector<std::string_view> split(const std::string_view& path);
+    /**
+     * Find the node of a pathname.
+     *
+     * @param pathname  - the pathname
+     * @param create    - create the absent nodes if true.
+     *
+     * @return the node, or nullptr if not found and create is false.
+     */
+    TrieNode* get_node(const std::string& pathname, bool create);
+
+public:
+    /**
+     * Add a key.
+     *
+     * @param key   - the key
+     *
+     * @return true if the key is new, false if it is indexed already.
+     */
+    bool insert(const KT& key);
+    /**
+     * Remove a key. The empty tree nodes are kept.
+     *
+     * @param key   - the key
+     *
+     * @return true if the key was removed, false if it was not found.
+     */
+    bool erase(const KT& key);
+    /**
+     * Append the keys whose pathname starts with prefix to key_list.
+     *
+     * @param prefix    - the prefix
+     * @param key_list  - the output
+     */
+    void list_keys(const std::string& prefix, std::vector<KT>& key_list) const;
+    /**
+     * Drop all keys.
+     */
+    void clear();
+    /**
+     * @return the number of keys.
+     */
+    size_t size() const;
+
+    KeyPathTrie();
+    KeyPathTrie(const KeyPathTrie&) = delete;
+    KeyPathTrie& operator=(const KeyPathTrie&) = delete;
+    virtual ~KeyPathTrie();
+};
+
+}  // namespace cascade
+}  // namespace derecho
+
+#include "key_path_trie_impl.hpp"
@@ -0,0 +1,116 @@
+#pragma once
+#include "key_path_trie.hpp"
+
+#include "debug_util.hpp"
+
+namespace derecho {
+namespace cascade {
+
+template <typename KT, char separator>
+void KeyPathTrie<KT, separator>::collect(const TrieNode* node, std::vector<KT>& key_list) {
+    key_list.insert(key_list.end(), node->keys.cbegin(), node->keys.cend());
+    for(const auto& child : node->children) {
+        collect(child.second.get(), key_list);
+    }
+}
+
+template <typename KT, char separator>
+std::vector<std::string_view> KeyPathTrie<KT, separator>::split(const std::string_view& path) {
+    std::vector<std::string_view> components;
+    if(path.empty()) {
+        return components;
+    }
+    size_t start = 0;
+    while(true) {
+        size_t pos = path.find(separator, start);
+        if(pos == std::string_view::npos) {
+            components.emplace_back(path.substr(start));
+            break;
+        }
+        components.emplace_back(path.substr(start, pos - start));
+        start = pos + 1;
+    }
+    return components;
+}
+
+template <typename KT, char separator>
+typename KeyPathTrie<KT, separator>::TrieNode* KeyPathTrie<KT, separator>::get_node(const std::string& pathname, bool create) {
+    TrieNode* node = &root;
+    for(const auto& comp : split(pathname)) {
+        auto child = node->children.find(comp);
+        if(child == node->children.end()) {
+            if(!create) {
+                return nullptr;
+            }
+            child = node->children.emplace(std::string(comp), std::make_unique<TrieNode>()).first;
+        }
+        node = child->second.get();
+    }
+    return node;
+}
+
+template <typename KT, char separator>
+bool KeyPathTrie<KT, separator>::insert(const KT& key) {
+    TrieNode* node = get_node(get_pathname<KT>(key), true);
+    if(node->keys.emplace(key).second) {
+        num_keys++;
+        return true;
+    }
+    return false;
+}
+
+template <typename KT, char separator>
+bool KeyPathTrie<KT, separator>::erase(const KT& key) {
+    TrieNode* node = get_node(get_pathname<KT>(key), false);
+    if(node != nullptr && node->keys.erase(key) > 0) {
+        num_keys--;
+        return true;
+    }
+    return false;
+}
+
+template <typename KT, char separator>
+void KeyPathTrie<KT, separator>::list_keys(const std::string& prefix, std::vector<KT>& key_list) const {
+    if(prefix.empty()) {
+        collect(&root, key_list);
+        return;
+    }
+    auto components = split(prefix);
+    const TrieNode* node = &root;
+    // all but the last components must match exactly.
+    for(size_t i = 0; i + 1 < components.size(); i++) {
+        auto child = node->children.find(components[i]);
+        if(child == node->children.cend()) {
+            return;
+        }
+        node = child->second.get();
+    }
+    // the last component matches the children starting with it.
+    const std::string_view& partial = components.back();
+    for(auto child = node->children.lower_bound(partial);
+        child != node->children.cend() && child->first.compare(0, partial.size(), partial) == 0;
+        child++) {
+        collect(child->second.get(), key_list);
+    }
+}
+
+template <typename KT, char separator>
+void KeyPathTrie<KT, separator>::clear() {
+    root.children.clear();
+    root.keys.clear();
+    num_keys = 0;
+}
+
+template <typename KT, char separator>
+size_t KeyPathTrie<KT, separator>::size() const {
+    return num_keys;
+}
+
+template <typename KT, char separator>
+KeyPathTrie<KT, separator>::KeyPathTrie() : num_keys(0) {}
+
+template <typename KT, char separator>
+KeyPathTrie<KT, separator>::~KeyPathTrie() {}
+
+}  // namespace cascade
+}  // namespace derecho
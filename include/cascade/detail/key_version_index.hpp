@@ -0,0 +1,219 @@
+#pragma once
+
+#include <derecho/persistent/PersistentInterface.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * KeyVersionIndex maps each key to the sorted list of log versions that updated it (its version chain). With it, a
+ * historical point read finds the version of the key at a given log version with a binary search, and then reads one
+ * delta, instead of reconstructing the whole state at that version.
+ *
+ * The index is built in memory by replaying updates, so it covers the versions since the state it was built from.
+ * When it is seeded from a snapshot (a deserialized kv_map), only the latest version of each key is known, and
+ * queries for versions before the snapshot are not covered.
+ *
+ * The chains are bounded by trim(): the versions of a key superseded at a frontier, e.g. the latest checkpoint, are
+ * dropped, and the queries for versions before the frontier are not covered any more. The updates since the last trim
+ * are queued in log order, so a trim only visits the keys updated since.
+ *
+ * The index has a single writer (the predicate thread, or the log replay) and concurrent readers. The writer takes the
+ * index lock exclusively only to add a key; an update of a known key only takes the lock of its chain.
+ *
+ * @tparam KT   - the key type
+ */
+template <typename KT>
+class KeyVersionIndex {
+private:
+    struct Chain {
+        mutable std::mutex mutex;
+        /* the versions of the updates to the key, in ascending order. */
+        std::vector<persistent::version_t> versions;
+    };
+
+    /* the chains are never erased, so the writer keeps pointers to them. */
+    std::unordered_map<KT, std::unique_ptr<Chain>> version_chains;
+    /* guards the structure of version_chains against the readers. */
+    mutable std::shared_mutex index_mutex;
+    /* queries for versions no earlier than this one are answered authoritatively. */
+    std::atomic<persistent::version_t> covered_since;
+    /* the updates since the last trim, in log order, which only the writer accesses. */
+    std::deque<std::pair<Chain*, persistent::version_t>> recent_updates;
+
+    /**
+     * Find the chain of a key, or add it. Only the writer calls it.
+     */
+    Chain* chain_of(const KT& key) {
+        // only the writer changes the structure, so it can look it up without the lock.
+        auto it = version_chains.find(key);
+        if(it != version_chains.end()) {
+            return it->second.get();
+        }
+        std::unique_lock<std::shared_mutex> wlck(index_mutex);
+        return version_chains.emplace(key, std::make_unique<Chain>()).first->second.get();
+    }
+
+public:
+    /**
+     * Append an update to a key's version chain. The versions of a key must be appended in ascending order.
+     *
+     * @param key   - the key
+     * @param ver   - the version of the update
+     */
+    void append(const KT& key, const persistent::version_t& ver) {
+        Chain* chain = chain_of(key);
+        {
+            std::lock_guard<std::mutex> lck(chain->mutex);
+            if(!chain->versions.empty() && chain->versions.back() >= ver) {
+                return;
+            }
+            chain->versions.push_back(ver);
+        }
+        recent_updates.emplace_back(chain, ver);
+    }
+
+    /**
+     * Append the version chains of a set of keys, built separately, for example by a partition of the log replay.
+     *
+     * @param chains    - the version chains, in ascending order. They are moved into the index.
+     */
+    void append_chains(std::unordered_map<KT, std::vector<persistent::version_t>>&& chains) {
+        std::vector<std::pair<Chain*, persistent::version_t>> trimmable;
+        for(auto& kv : chains) {
+            Chain* chain = chain_of(kv.first);
+            std::lock_guard<std::mutex> lck(chain->mutex);
+            if(chain->versions.empty()) {
+                chain->versions = std::move(kv.second);
+            } else {
+                for(const auto& ver : kv.second) {
+                    if(chain->versions.back() < ver) {
+                        chain->versions.push_back(ver);
+                    }
+                }
+            }
+            if(chain->versions.size() > 1) {
+                trimmable.emplace_back(chain, chain->versions.back());
+            }
+        }
+        // a chain is trimmed once the frontier passes its latest version.
+        std::sort(trimmable.begin(), trimmable.end(),
+                  [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+        recent_updates.insert(recent_updates.end(), trimmable.begin(), trimmable.end());
+    }
+
+    /**
+     * Seed the index from a snapshot: each key is seeded with the version of its object in the snapshot, and the
+     * index covers the versions since snapshot_version.
+     *
+     * @param kv_map            - the snapshot
+     * @param snapshot_version  - the version of the snapshot
+     */
+    template <typename VT>
+    void seed(const std::map<KT, VT>& kv_map, const persistent::version_t& snapshot_version) {
+        std::unique_lock<std::shared_mutex> wlck(index_mutex);
+        version_chains.clear();
+        recent_updates.clear();
+        for(const auto& kv : kv_map) {
+            auto chain = std::make_unique<Chain>();
+            chain->versions.push_back(kv.second.get_version());
+            version_chains.emplace(kv.first, std::move(chain));
+        }
+        covered_since.store(snapshot_version, std::memory_order_release);
+    }
+
+    /**
+     * Drop the versions superseded at a frontier: the chain of each key updated since the last trim keeps its latest
+     * version no later than the frontier, and the later ones. The queries for versions before the frontier are not
+     * covered any more. Only the writer calls it.
+     *
+     * @param frontier  - the frontier, which only moves forward.
+     */
+    void trim(const persistent::version_t& frontier) {
+        if(frontier <= covered_since.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // the readers check covered_since under the chain lock, so they never use a chain trimmed below their version.
+        covered_since.store(frontier, std::memory_order_release);
+        while(!recent_updates.empty() && recent_updates.front().second <= frontier) {
+            Chain* chain = recent_updates.front().first;
+            recent_updates.pop_front();
+            std::lock_guard<std::mutex> lck(chain->mutex);
+            auto it = std::upper_bound(chain->versions.begin(), chain->versions.end(), frontier);
+            if(it - chain->versions.begin() > 1) {
+                chain->versions.erase(chain->versions.begin(), std::prev(it));
+            }
+        }
+    }
+
+    /**
+     * @return the number of updates since the last trim.
+     */
+    std::size_t num_recent_updates() const {
+        return recent_updates.size();
+    }
+
+    /**
+     * @return the version of the update that is the given number of updates before the latest one, among the updates
+     *         since the last trim, or INVALID_VERSION if there are not so many.
+     */
+    persistent::version_t recent_update_version(std::size_t updates_before_latest) const {
+        if(updates_before_latest >= recent_updates.size()) {
+            return persistent::INVALID_VERSION;
+        }
+        return recent_updates[recent_updates.size() - 1 - updates_before_latest].second;
+    }
+
+    /**
+     * Find the version of the latest update to a key no later than a version.
+     *
+     * @param key           - the key
+     * @param ver           - the version
+     * @param key_version   - the version of the latest update to the key no later than 'ver', or INVALID_VERSION if
+     *                        the key did not exist at 'ver'.
+     *
+     * @return true if 'ver' is covered by the index and key_version is set, otherwise false.
+     */
+    bool lookup(const KT& key, const persistent::version_t& ver, persistent::version_t& key_version) const {
+        if(ver < covered_since.load(std::memory_order_acquire)) {
+            return false;
+        }
+        std::shared_lock<std::shared_mutex> rlck(index_mutex);
+        auto chain = version_chains.find(key);
+        if(chain == version_chains.cend()) {
+            key_version = persistent::INVALID_VERSION;
+            return true;
+        }
+        std::lock_guard<std::mutex> lck(chain->second->mutex);
+        if(ver < covered_since.load(std::memory_order_acquire)) {
+            return false;
+        }
+        const auto& versions = chain->second->versions;
+        auto it = std::upper_bound(versions.cbegin(), versions.cend(), ver);
+        if(it == versions.cbegin()) {
+            key_version = persistent::INVALID_VERSION;
+        } else {
+            key_version = *std::prev(it);
+        }
+        return true;
+    }
+
+    KeyVersionIndex() : covered_since(persistent::INVALID_VERSION) {}
+    KeyVersionIndex(const KeyVersionIndex&) = delete;
+    KeyVersionIndex& operator=(const KeyVersionIndex&) = delete;
+    virtual ~KeyVersionIndex() {}
+};
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "epoch_manager.hpp"
+#include "key_hash.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * KVHashIndex is an open-addressing hash index over the entries of an ordered std::map<KT,VT>.
+ *
+ * The std::map remains the owner of the key/value pairs: it is what we serialize, what the validators see, and what
+ * serves the ordered (prefix/range) listings. The hash index only stores the map iterators, which are stable across
+ * insertions and removals of other entries, so that point operations (get/get_size/put) skip the O(log n) tree walk.
+ *
+ * The slot table uses linear probing with backward-shift deletion (no tombstones) and its load factor is kept under
+ * 50%, so a probe sequence always terminates at an empty slot.
+ *
+ * Concurrency: there is a single writer (the predicate thread). Lockless readers must hold an EpochManager::Guard
+ * for as long as they use the table and the map entries it points to. The writer never frees a table or an entry
+ * that a reader might see: a replaced table is retired through the EpochManager, and the stores retire the replaced
+ * map nodes (std::map::extract) in the same way. Readers never observe a torn slot because the slot fields are
+ * atomic and the hash is published after the iterator. A lookup racing with erase() may miss the key being shifted;
+ * the stores never erase keys (a removed object is kept as a null object).
+ *
+ * @tparam KT   - key type
+ * @tparam VT   - value type
+ */
+template <typename KT, typename VT>
+class KVHashIndex {
+public:
+    using map_type = std::map<KT, VT>;
+    using iterator = typename map_type::iterator;
+
+private:
+#define KV_HASH_INDEX_INITIAL_CAPACITY (1024)
+    struct Slot {
+        // 0 is reserved for an empty slot.
+        std::atomic<uint64_t> hash;
+        std::atomic<iterator> it;
+    };
+    struct Table {
+        const size_t mask;
+        size_t count;
+        std::unique_ptr<Slot[]> slots;
+        explicit Table(size_t capacity);
+    };
+    std::atomic<Table*> table;
+
+    /**
+     * Publish a new table and retire the old one.
+     */
+    inline void replace_table(Table* new_table);
+
+    /**
+     * Hash a key. The result is never 0.
+     */
+    static inline uint64_t hash_of(const KT& key);
+    /**
+     * Insert an iterator into a table. The key must not exist in the table.
+     */
+    static inline void insert_into(Table* ptable, uint64_t hash, const iterator& it);
+    /**
+     * Double the table capacity.
+     */
+    inline void grow();
+
+public:
+    /**
+     * Look up a key. A caller other than the writer must hold an EpochManager::Guard while using the result.
+     *
+     * @param key   - the key
+     * @param it    - the map iterator of the key is returned here, if found.
+     *
+     * @return true if found, otherwise false.
+     */
+    bool lookup(const KT& key, iterator& it) const;
+    /**
+     * Insert or update the iterator for key it->first.
+     *
+     * @param it    - an iterator to a map entry.
+     */
+    void put(const iterator& it);
+    /**
+     * Remove a key from the index.
+     *
+     * @param key   - the key
+     *
+     * @return true if the key was found and removed, otherwise false.
+     */
+    bool erase(const KT& key);
+    /**
+     * Drop all entries and index every entry in the map.
+     *
+     * @param kv_map - the map to index.
+     */
+    void rebuild(map_type& kv_map);
+    /**
+     * Drop all entries.
+     */
+    void clear();
+    /**
+     * @return the number of indexed keys.
+     */
+    size_t size() const;
+
+    KVHashIndex();
+    KVHashIndex(const KVHashIndex&) = delete;
+    KVHashIndex& operator=(const KVHashIndex&) = delete;
+    virtual ~KVHashIndex();
+};
+
+}  // namespace cascade
+}  // namespace derecho
+
+#include "kv_hash_index_impl.hpp"
@@ -0,0 +1,188 @@
+#pragma once
+#include "kv_hash_index.hpp"
+
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+namespace derecho {
+namespace cascade {
+
+template <typename KT, typename VT>
+KVHashIndex<KT, VT>::Table::Table(size_t capacity) : mask(capacity - 1),
+                                                     count(0),
+                                                     slots(new Slot[capacity]) {
+    for(size_t i = 0; i < capacity; i++) {
+        slots[i].hash.store(0, std::memory_order_relaxed);
+        slots[i].it.store(iterator{}, std::memory_order_relaxed);
+    }
+}
+
+template <typename KT, typename VT>
+uint64_t KVHashIndex<KT, VT>::hash_of(const KT& key) {
+    uint64_t h;
+    if constexpr(std::is_convertible_v<const KT&, std::string_view>) {
+        h = key_hash(key);
+    } else {
+        h = static_cast<uint64_t>(std::hash<KT>{}(key));
+        // std::hash for integral types is the identity, so we finalize it (murmur3 fmix64) to spread the keys over the
+        // low bits used by the mask.
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+    }
+    return (h == 0) ? 1 : h;
+}
+
+template <typename KT, typename VT>
+void KVHashIndex<KT, VT>::insert_into(Table* ptable, uint64_t hash, const iterator& it) {
+    size_t pos = hash & ptable->mask;
+    while(ptable->slots[pos].hash.load(std::memory_order_relaxed) != 0) {
+        pos = (pos + 1) & ptable->mask;
+    }
+    ptable->slots[pos].it.store(it, std::memory_order_relaxed);
+    ptable->slots[pos].hash.store(hash, std::memory_order_release);
+    ptable->count++;
+}
+
+template <typename KT, typename VT>
+void KVHashIndex<KT, VT>::replace_table(Table* new_table) {
+    Table* old_table = table.exchange(new_table, std::memory_order_acq_rel);
+    if(old_table != nullptr) {
+        const size_t old_bytes = (old_table->mask + 1) * sizeof(Slot);
+        EpochManager::get().retire(std::unique_ptr<Table>(old_table), old_bytes);
+    }
+}
+
+template <typename KT, typename VT>
+void KVHashIndex<KT, VT>::grow() {
+    Table* old_table = table.load(std::memory_order_relaxed);
+    Table* new_table = new Table((old_table->mask + 1) << 1);
+    for(size_t i = 0; i <= old_table->mask; i++) {
+        uint64_t hash = old_table->slots[i].hash.load(std::memory_order_relaxed);
+        if(hash != 0) {
+            insert_into(new_table, hash, old_table->slots[i].it.load(std::memory_order_relaxed));
+        }
+    }
+    replace_table(new_table);
+}
+
+template <typename KT, typename VT>
+bool KVHashIndex<KT, VT>::lookup(const KT& key, iterator& it) const {
+    const Table* ptable = table.load(std::memory_order_acquire);
+    const uint64_t hash = hash_of(key);
+    size_t pos = hash & ptable->mask;
+    for(size_t probes = 0; probes <= ptable->mask; probes++) {
+        const Slot& slot = ptable->slots[pos];
+        uint64_t slot_hash = slot.hash.load(std::memory_order_acquire);
+        if(slot_hash == 0) {
+            return false;
+        }
+        if(slot_hash == hash) {
+            iterator slot_it = slot.it.load(std::memory_order_acquire);
+            if(slot_it->first == key) {
+                it = slot_it;
+                return true;
+            }
+        }
+        pos = (pos + 1) & ptable->mask;
+    }
+    return false;
+}
+
+template <typename KT, typename VT>
+void KVHashIndex<KT, VT>::put(const iterator& it) {
+    Table* ptable = table.load(std::memory_order_relaxed);
+    const uint64_t hash = hash_of(it->first);
+    size_t pos = hash & ptable->mask;
+    while(ptable->slots[pos].hash.load(std::memory_order_relaxed) != 0) {
+        if(ptable->slots[pos].hash.load(std::memory_order_relaxed) == hash
+           && ptable->slots[pos].it.load(std::memory_order_relaxed)->first == it->first) {
+            ptable->slots[pos].it.store(it, std::memory_order_release);
+            return;
+        }
+        pos = (pos + 1) & ptable->mask;
+    }
+    // a new key
+    if(((ptable->count + 1) << 1) > (ptable->mask + 1)) {
+        grow();
+        insert_into(table.load(std::memory_order_relaxed), hash, it);
+    } else {
+        insert_into(ptable, hash, it);
+    }
+}
+
+template <typename KT, typename VT>
+bool KVHashIndex<KT, VT>::erase(const KT& key) {
+    Table* ptable = table.load(std::memory_order_relaxed);
+    const uint64_t hash = hash_of(key);
+    size_t pos = hash & ptable->mask;
+    while(true) {
+        uint64_t slot_hash = ptable->slots[pos].hash.load(std::memory_order_relaxed);
+        if(slot_hash == 0) {
+            return false;
+        }
+        if(slot_hash == hash && ptable->slots[pos].it.load(std::memory_order_relaxed)->first == key) {
+            break;
+        }
+        pos = (pos + 1) & ptable->mask;
+    }
+    // backward-shift the following entries of the cluster into the hole.
+    size_t hole = pos;
+    size_t next = pos;
+    while(true) {
+        next = (next + 1) & ptable->mask;
+        uint64_t next_hash = ptable->slots[next].hash.load(std::memory_order_relaxed);
+        if(next_hash == 0) {
+            break;
+        }
+        size_t home = next_hash & ptable->mask;
+        // the entry at 'next' stays if its home slot is cyclically in (hole, next].
+        bool stays = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+        if(!stays) {
+            ptable->slots[hole].it.store(ptable->slots[next].it.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            ptable->slots[hole].hash.store(next_hash, std::memory_order_release);
+            hole = next;
+        }
+    }
+    ptable->slots[hole].hash.store(0, std::memory_order_release);
+    ptable->count--;
+    return true;
+}
+
+template <typename KT, typename VT>
+void KVHashIndex<KT, VT>::rebuild(map_type& kv_map) {
+    size_t capacity = KV_HASH_INDEX_INITIAL_CAPACITY;
+    while(capacity < (kv_map.size() << 1)) {
+        capacity <<= 1;
+    }
+    Table* new_table = new Table(capacity);
+    for(auto it = kv_map.begin(); it != kv_map.end(); it++) {
+        insert_into(new_table, hash_of(it->first), it);
+    }
+    replace_table(new_table);
+}
+
+template <typename KT, typename VT>
+void KVHashIndex<KT, VT>::clear() {
+    replace_table(new Table(KV_HASH_INDEX_INITIAL_CAPACITY));
+}
+
+template <typename KT, typename VT>
+size_t KVHashIndex<KT, VT>::size() const {
+    return table.load(std::memory_order_acquire)->count;
+}
+
+template <typename KT, typename VT>
+KVHashIndex<KT, VT>::KVHashIndex() : table(new Table(KV_HASH_INDEX_INITIAL_CAPACITY)) {}
+
+template <typename KT, typename VT>
+KVHashIndex<KT, VT>::~KVHashIndex() {
+    // the owner is being destroyed, so there is no reader left.
+    delete table.load();
+}
+
+}  // namespace cascade
+}  // namespace derecho
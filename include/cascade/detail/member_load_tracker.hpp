@@ -0,0 +1,143 @@
+#pragma once
+
+#include <derecho/core/derecho_type_definitions.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * MemberLoadTracker keeps the client-side view of the load of each server node, for the load-aware member selection
+ * policies (ShardMemberSelectionPolicy::LeastOutstanding and ShardMemberSelectionPolicy::LatencyEWMA).
+ *
+ * A request sent to a node is recorded by on_dispatch(), which returns its id, and it stays outstanding until its reply
+ * is recorded by on_reply() with that id. The time in between is a latency sample of the node. A node handles the
+ * requests of a client one by one, so its replies come in the order of the requests, and a reply completes the
+ * requests sent to the node before it too. Hence only one request per node needs to be tracked at a time: on_dispatch()
+ * tells whether a request is to be tracked, which is when no tracked request to the node is in flight, and the
+ * ServiceClient watches the replies of the tracked requests only. An untracked request is completed by the reply of a
+ * later tracked request, or expires after MEMBER_LOAD_UNTRACKED_EXPIRATION_FACTOR times the latency average of the
+ * node. The requests without a reply, like put_and_forget, are never recorded. A request whose reply is lost expires
+ * after MEMBER_LOAD_REQUEST_EXPIRATION_US, without a latency sample.
+ *
+ * The latency of a node is a peak-sensitive, exponentially weighted moving average: a sample above the average
+ * replaces it, and a sample below it is blended in with a weight that grows with the time since the previous sample,
+ * with a time constant of MEMBER_LOAD_LATENCY_DECAY_US. The average also decays towards zero while a node gets no
+ * reply, so that a node which was slow once is probed again.
+ *
+ * It is thread-safe.
+ */
+class MemberLoadTracker {
+private:
+#define MEMBER_LOAD_REQUEST_EXPIRATION_US (10000000)
+#define MEMBER_LOAD_LATENCY_DECAY_US (1000000)
+#define MEMBER_LOAD_UNTRACKED_EXPIRATION_FACTOR (4)
+    struct Request {
+        /* the dispatch time in microseconds. */
+        uint64_t dispatch_us;
+        /* true if its reply is recorded by on_reply(). */
+        bool tracked;
+    };
+    struct NodeLoad {
+        /* the outstanding requests by request id, oldest first. */
+        std::map<uint64_t, Request> outstanding_requests;
+        /* the number of outstanding tracked requests. */
+        std::size_t num_tracked = 0;
+        /* the average latency in microseconds, as of last_sample_us. */
+        double latency_ewma_us = 0.0;
+        /* the time of the last latency sample in microseconds, or zero if there is none. */
+        uint64_t last_sample_us = 0;
+    };
+    std::unordered_map<node_id_t, NodeLoad> node_loads;
+    mutable std::mutex node_loads_mutex;
+    /* the id of the next request, protected by node_loads_mutex. */
+    uint64_t next_request_id;
+    /* the first member to consider, which breaks the ties between the members. */
+    std::atomic<uint32_t> next_start;
+
+    static uint64_t now_us();
+
+    /**
+     * Drop the outstanding requests of a node up to a request, included. The caller must hold node_loads_mutex.
+     */
+    static void complete_until(NodeLoad& load, std::map<uint64_t, Request>::iterator last);
+
+    /**
+     * Drop the expired outstanding requests of a node. The caller must hold node_loads_mutex.
+     */
+    static void expire(NodeLoad& load, uint64_t now);
+
+    /**
+     * @return the decayed latency average of a node. The caller must hold node_loads_mutex.
+     */
+    static double latency_of(const NodeLoad& load, uint64_t now);
+
+    /**
+     * Pick the member with the lowest cost. The caller must hold node_loads_mutex.
+     */
+    template <typename CostFunc>
+    node_id_t pick(const std::vector<node_id_t>& members, const CostFunc& cost_of);
+
+public:
+    MemberLoadTracker();
+
+    /**
+     * Record a request sent to a node.
+     *
+     * @param node_id       - the node id
+     * @param tracked       - if it is nullptr, the request is tracked: the caller must record its reply. Otherwise,
+     *                        it is set to true if the request is tracked, which is when no tracked request to the node
+     *                        is in flight, and to false if the caller must not record its reply.
+     *
+     * @return the request id.
+     */
+    uint64_t on_dispatch(node_id_t node_id, bool* tracked = nullptr);
+
+    /**
+     * Record the reply of a tracked request, which completes it and the requests sent to the node before it.
+     *
+     * @param node_id       - the node id
+     * @param request_id    - the request id returned by on_dispatch()
+     * @param succeeded     - false if the request failed, which gives no latency sample.
+     */
+    void on_reply(node_id_t node_id, uint64_t request_id, bool succeeded = true);
+
+    /**
+     * @return the number of outstanding requests to a node.
+     */
+    std::size_t get_outstanding(node_id_t node_id) const;
+
+    /**
+     * @return the decayed latency average of a node in microseconds, or zero if there is no sample.
+     */
+    double get_latency_ewma_us(node_id_t node_id) const;
+
+    /**
+     * Pick the member with the fewest outstanding requests.
+     *
+     * @param members       - the candidates, which must not be empty.
+     *
+     * @return the node id.
+     */
+    node_id_t pick_least_outstanding(const std::vector<node_id_t>& members);
+
+    /**
+     * Pick the member with the lowest expected latency: the latency average, or the age of the oldest outstanding
+     * request if it is higher, multiplied by the number of outstanding requests plus one. An idle member without a
+     * latency sample is picked first.
+     *
+     * @param members       - the candidates, which must not be empty.
+     *
+     * @return the node id.
+     */
+    node_id_t pick_lowest_latency(const std::vector<node_id_t>& members);
+};
+
+}  // namespace cascade
+}  // namespace derecho
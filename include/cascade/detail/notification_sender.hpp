@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * NotificationSender sends the notifications of a critical data path observer from its own thread, so that the thread
+ * delivering the updates to the store does not wait for the subscribers. The notifications are sent one by one in the
+ * order they are posted, so the subscribers see them in the order of the updates. The thread is started by the first
+ * notification, and the destructor drops the notifications not sent yet.
+ */
+class NotificationSender {
+private:
+    std::deque<std::function<void()>> pending;
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    bool running;
+    bool stopped;
+    std::thread sender;
+
+    void send_notifications();
+
+public:
+    NotificationSender();
+    NotificationSender(const NotificationSender&) = delete;
+    NotificationSender& operator=(const NotificationSender&) = delete;
+    virtual ~NotificationSender();
+
+    /**
+     * Post a notification.
+     *
+     * @param send      - sends the notification, and handles its failure. It is called by the sender thread, and it
+     *                    must not throw.
+     */
+    void post(std::function<void()>&& send);
+};
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <derecho/mutils-serialization/SerializationSupport.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * ObjectLocations is the placement map of an object pool: the shards of the keys pinned to a specific shard. It is a
+ * compact, immutable table of the keys in ascending order, packed in one buffer, and their shard indexes. A lookup is
+ * a binary search, and the keys starting with a prefix are a contiguous range of the table.
+ *
+ * The table is shared by the copies of an ObjectLocations, so copying the object pool metadata, e.g. on every
+ * find_object_pool() or metadata cache hit, does not copy the placement map. An update builds a new table (see
+ * apply()).
+ *
+ * The placement map is still a field of the object pool metadata: it is not a separate store, and a client that
+ * fetches the metadata gets the whole map, not the changes since the version it has.
+ */
+class ObjectLocations : public mutils::ByteRepresentable {
+private:
+    struct Table {
+        /* the keys, concatenated in ascending order. */
+        std::string keys;
+        /* the end offset of each key in 'keys'. */
+        std::vector<uint64_t> key_ends;
+        /* the shard index of each key. */
+        std::vector<uint32_t> shards;
+    };
+    std::shared_ptr<const Table> table;
+
+    explicit ObjectLocations(std::shared_ptr<const Table>&& _table);
+
+    /**
+     * @return the position of the first key not less than 'key'.
+     */
+    std::size_t lower_bound(const std::string_view& key) const;
+
+    /**
+     * Deserialize a placement map, see to_bytes(). It throws derecho::derecho_exception if the key offsets are out of
+     * the key buffer, or the keys are not in ascending order.
+     */
+    static ObjectLocations* deserialize(const uint8_t* const v);
+
+public:
+    /**
+     * An empty placement map.
+     */
+    ObjectLocations();
+
+    /**
+     * Build a placement map.
+     *
+     * @param locations     - the shard index of each pinned key.
+     */
+    ObjectLocations(const std::unordered_map<std::string, uint32_t>& locations);
+
+    /**
+     * A copy shares the table. There is no move constructor, so a moved-from ObjectLocations keeps its table too.
+     */
+    ObjectLocations(const ObjectLocations&) = default;
+    ObjectLocations& operator=(const ObjectLocations&) = default;
+
+    /**
+     * @return the number of pinned keys.
+     */
+    std::size_t size() const;
+
+    /**
+     * @return true if no key is pinned.
+     */
+    bool empty() const;
+
+    /**
+     * @return the pinned key at a position, in ascending order.
+     */
+    std::string_view key_at(std::size_t pos) const;
+
+    /**
+     * @return the shard index of the pinned key at a position.
+     */
+    uint32_t shard_at(std::size_t pos) const;
+
+    /**
+     * Find the shard of a key.
+     *
+     * @param key           - the key
+     * @param shard_index   - the shard index is returned here if the key is pinned.
+     *
+     * @return true if the key is pinned.
+     */
+    bool find(const std::string_view& key, uint32_t& shard_index) const;
+
+    /**
+     * @return true if the key is pinned.
+     */
+    bool contains(const std::string_view& key) const;
+
+    /**
+     * Find the pinned keys starting with a prefix.
+     *
+     * @param prefix        - the key prefix
+     *
+     * @return the range [first,last) of their positions.
+     */
+    std::pair<std::size_t, std::size_t> prefix_range(const std::string_view& prefix) const;
+
+    /**
+     * Build the placement map updated by a change set. The change set is applied as a merge, so it costs a pass over
+     * the map, instead of rebuilding it from a hash map.
+     *
+     * @param updates       - the keys to pin, or to move, with their new shard indexes.
+     * @param removals      - the keys to unpin. A key in both 'updates' and 'removals' is unpinned.
+     *
+     * @return the updated placement map. This one is unchanged.
+     */
+    ObjectLocations apply(const std::unordered_map<std::string, uint32_t>& updates,
+                          const std::vector<std::string>& removals) const;
+
+    /**
+     * @return the placement map as a hash map.
+     */
+    std::unordered_map<std::string, uint32_t> to_map() const;
+
+    // serialization support
+    std::size_t to_bytes(uint8_t* v) const;
+    std::size_t bytes_size() const;
+    void post_object(const std::function<void(uint8_t const* const, std::size_t)>& f) const;
+    void ensure_registered(mutils::DeserializationManager&) {}
+    static std::unique_ptr<ObjectLocations> from_bytes(mutils::DeserializationManager*, const uint8_t* const v);
+    static mutils::context_ptr<ObjectLocations> from_bytes_noalloc(
+            mutils::DeserializationManager* ctx,
+            const uint8_t* const v);
+    static mutils::context_ptr<const ObjectLocations> from_bytes_noalloc_const(
+            mutils::DeserializationManager* ctx,
+            const uint8_t* const v);
+};
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cascade/config.h>
+#include <cascade/detail/epoch_manager.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * ObjectPoolResolver finds the object pool of a pathname: the object pool whose pathname is the longest prefix of it,
+ * made of whole path components. It is the client-side cache of the object pool metadata.
+ *
+ * The cache is an immutable snapshot, replaced as a whole on update and reclaimed through the EpochManager, so a
+ * lookup takes no lock. A lookup works on a std::string_view, without tokenizing or concatenating the pathname, and
+ * returns a handle to the shared, immutable metadata, without copying it.
+ *
+ * The pathnames that resolve to no object pool are cached too (negative entries), so that a lookup for an unknown
+ * pathname does not reload the whole metadata each time. A negative entry expires after
+ * OBJECT_POOL_RESOLVER_NEGATIVE_TTL_US, and all of them are dropped when the cache is updated.
+ *
+ * There may be concurrent writers; they are serialized by a mutex.
+ *
+ * @tparam MetadataType     - the object pool metadata type, with a 'pathname' member.
+ * @tparam separator        - the path separator
+ */
+template <typename MetadataType, char separator = PATH_SEPARATOR>
+class ObjectPoolResolver {
+public:
+    using handle_t = std::shared_ptr<const MetadataType>;
+
+private:
+#define OBJECT_POOL_RESOLVER_NEGATIVE_TTL_US (1000000)
+#define OBJECT_POOL_RESOLVER_MAX_NEGATIVE_ENTRIES (4096)
+    struct Snapshot {
+        /* the object pools, keyed by views of the pathnames in their metadata. */
+        std::unordered_map<std::string_view, handle_t> pools;
+        /* the pathnames in no object pool, and the expiration time of each entry in microseconds. */
+        std::map<std::string, uint64_t, std::less<>> negative_entries;
+    };
+    std::atomic<const Snapshot*> snapshot;
+    std::mutex writer_mutex;
+
+    static uint64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+    }
+
+    /**
+     * Publish a new snapshot, and retire the current one. The caller must hold writer_mutex.
+     */
+    void publish(std::unique_ptr<Snapshot>&& new_snapshot) {
+        const Snapshot* old_snapshot = snapshot.exchange(new_snapshot.release(), std::memory_order_acq_rel);
+        if(old_snapshot != nullptr) {
+            EpochManager::get().retire(std::unique_ptr<const Snapshot>(old_snapshot));
+        }
+    }
+
+    /**
+     * Look up the longest matching object pool in a snapshot.
+     */
+    static handle_t longest_prefix_match(const Snapshot* psnapshot, const std::string_view& pathname) {
+        // try the longest prefix first: the pathname itself, then up to each separator from the end.
+        std::string_view prefix = pathname;
+        while(!prefix.empty()) {
+            auto pool = psnapshot->pools.find(prefix);
+            if(pool != psnapshot->pools.cend()) {
+                return pool->second;
+            }
+            const auto pos = prefix.rfind(separator);
+            if(pos == std::string_view::npos || pos == 0) {
+                break;
+            }
+            prefix = prefix.substr(0, pos);
+        }
+        return nullptr;
+    }
+
+public:
+    /**
+     * Find the object pool of a pathname.
+     *
+     * @param pathname      - the pathname, in the canonical form: starting with a separator, with no empty component.
+     * @param known_absent  - set to true if the pathname is in an unexpired negative entry, otherwise false.
+     *
+     * @return the metadata of the object pool, or nullptr if it is not in the cache.
+     */
+    handle_t resolve(const std::string_view& pathname, bool& known_absent) const {
+        EpochManager::Guard epoch_guard;
+        const Snapshot* psnapshot = snapshot.load(std::memory_order_acquire);
+        known_absent = false;
+        handle_t handle = longest_prefix_match(psnapshot, pathname);
+        if(!handle && !psnapshot->negative_entries.empty()) {
+            auto entry = psnapshot->negative_entries.find(pathname);
+            known_absent = (entry != psnapshot->negative_entries.cend() && entry->second > now_us());
+        }
+        return handle;
+    }
+
+    /**
+     * Find the metadata of an object pool by its exact pathname.
+     *
+     * @param pathname      - the object pool pathname
+     *
+     * @return the metadata, or nullptr if it is not in the cache.
+     */
+    handle_t get(const std::string_view& pathname) const {
+        EpochManager::Guard epoch_guard;
+        const Snapshot* psnapshot = snapshot.load(std::memory_order_acquire);
+        auto pool = psnapshot->pools.find(pathname);
+        return (pool == psnapshot->pools.cend()) ? nullptr : pool->second;
+    }
+
+    /**
+     * @return the pathnames of the cached object pools.
+     */
+    std::vector<std::string> list_pathnames() const {
+        EpochManager::Guard epoch_guard;
+        const Snapshot* psnapshot = snapshot.load(std::memory_order_acquire);
+        std::vector<std::string> pathnames;
+        pathnames.reserve(psnapshot->pools.size());
+        for(const auto& pool : psnapshot->pools) {
+            pathnames.emplace_back(pool.first);
+        }
+        return pathnames;
+    }
+
+    /**
+     * Replace the whole cache, and drop the negative entries.
+     *
+     * @param pools         - the metadata of the object pools. They are moved into the cache.
+     */
+    void reset(std::vector<MetadataType>&& pools) {
+        auto new_snapshot = std::make_unique<Snapshot>();
+        for(auto& metadata : pools) {
+            handle_t handle = std::make_shared<const MetadataType>(std::move(metadata));
+            // the key is a view of the metadata it maps to, so a duplicate replaces the entry as a whole.
+            new_snapshot->pools.erase(std::string_view(handle->pathname));
+            new_snapshot->pools.emplace(std::string_view(handle->pathname), handle);
+        }
+        std::lock_guard<std::mutex> lck(writer_mutex);
+        publish(std::move(new_snapshot));
+    }
+
+    /**
+     * Add or replace the metadata of an object pool, and drop the negative entries.
+     *
+     * @param metadata      - the metadata. It is moved into the cache.
+     */
+    void update(MetadataType&& metadata) {
+        handle_t handle = std::make_shared<const MetadataType>(std::move(metadata));
+        std::lock_guard<std::mutex> lck(writer_mutex);
+        const Snapshot* psnapshot = snapshot.load(std::memory_order_relaxed);
+        auto new_snapshot = std::make_unique<Snapshot>();
+        new_snapshot->pools = psnapshot->pools;
+        new_snapshot->pools.erase(std::string_view(handle->pathname));
+        new_snapshot->pools.emplace(std::string_view(handle->pathname), handle);
+        publish(std::move(new_snapshot));
+    }
+
+    /**
+     * Remove an object pool from the cache, and drop the negative entries.
+     *
+     * @param pathname      - the object pool pathname
+     */
+    void erase(const std::string_view& pathname) {
+        std::lock_guard<std::mutex> lck(writer_mutex);
+        const Snapshot* psnapshot = snapshot.load(std::memory_order_relaxed);
+        if(psnapshot->pools.find(pathname) == psnapshot->pools.cend() && psnapshot->negative_entries.empty()) {
+            return;
+        }
+        auto new_snapshot = std::make_unique<Snapshot>();
+        new_snapshot->pools = psnapshot->pools;
+        new_snapshot->pools.erase(pathname);
+        publish(std::move(new_snapshot));
+    }
+
+    /**
+     * Record that a pathname resolves to no object pool.
+     *
+     * @param pathname      - the pathname
+     */
+    void add_negative_entry(const std::string_view& pathname) {
+        std::lock_guard<std::mutex> lck(writer_mutex);
+        const Snapshot* psnapshot = snapshot.load(std::memory_order_relaxed);
+        auto new_snapshot = std::make_unique<Snapshot>();
+        new_snapshot->pools = psnapshot->pools;
+        // when the negative cache is full, we start over instead of evicting entries one by one.
+        if(psnapshot->negative_entries.size() < OBJECT_POOL_RESOLVER_MAX_NEGATIVE_ENTRIES) {
+            new_snapshot->negative_entries = psnapshot->negative_entries;
+        }
+        new_snapshot->negative_entries[std::string(pathname)] = now_us() + OBJECT_POOL_RESOLVER_NEGATIVE_TTL_US;
+        publish(std::move(new_snapshot));
+    }
+
+    ObjectPoolResolver() : snapshot(new Snapshot()) {}
+    ObjectPoolResolver(const ObjectPoolResolver&) = delete;
+    ObjectPoolResolver& operator=(const ObjectPoolResolver&) = delete;
+    virtual ~ObjectPoolResolver() {
+        // the resolver is destroyed only when no reader can see it.
+        delete snapshot.load(std::memory_order_relaxed);
+    }
+};
+
+}  // namespace cascade
+}  // namespace derecho
@@ -9,9 +9,11 @@
 #include <derecho/conf/conf.hpp>
 #include <derecho/persistent/PersistentInterface.hpp>
 #include <derecho/persistent/detail/PersistLog.hpp>
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -52,6 +54,46 @@ void PersistentCascadeStore<KT, VT, IK, IV, ST>::put_and_forget(const VT& value)
     debug_leave_func();
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+void PersistentCascadeStore<KT, VT, IK, IV, ST>::put_and_forget_batch(const std::vector<VT>& values) const {
+    debug_enter_func_with_args("values.size()={}", values.size());
+    for(const auto& value : values) {
+        put_and_forget(value);
+    }
+    debug_leave_func();
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::vector<std::tuple<persistent::version_t, uint64_t>> PersistentCascadeStore<KT, VT, IK, IV, ST>::put_batch(const std::vector<VT>& values) const {
+    debug_enter_func_with_args("values.size()={}", values.size());
+    derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
+    auto results = subgroup_handle.template ordered_send<RPC_NAME(ordered_put_batch)>(values);
+    auto& replies = results.get();
+    std::vector<std::tuple<persistent::version_t, uint64_t>> ret;
+    // TODO: verfiy consistency ?
+    for(auto& reply_pair : replies) {
+        ret = reply_pair.second.get();
+    }
+    debug_leave_func();
+    return ret;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::tuple<persistent::version_t, uint64_t> PersistentCascadeStore<KT, VT, IK, IV, ST>::transact(
+        const std::vector<std::tuple<KT, persistent::version_t>>& read_set, const std::vector<VT>& write_set) const {
+    debug_enter_func_with_args("read_set.size()={},write_set.size()={}", read_set.size(), write_set.size());
+    derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
+    auto results = subgroup_handle.template ordered_send<RPC_NAME(ordered_transact)>(read_set, write_set);
+    auto& replies = results.get();
+    std::tuple<persistent::version_t, uint64_t> ret(CURRENT_VERSION, 0);
+    // TODO: verfiy consistency ?
+    for(auto& reply_pair : replies) {
+        ret = reply_pair.second.get();
+    }
+    debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(ret), std::get<1>(ret));
+    return ret;
+}
+
 #ifdef ENABLE_EVALUATION
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 double PersistentCascadeStore<KT, VT, IK, IV, ST>::perf_put(const uint32_t max_payload_size, const uint64_t duration_sec) const {
@@ -81,55 +123,64 @@ std::tuple<persistent::version_t, uint64_t> PersistentCascadeStore<KT, VT, IK, I
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 const VT PersistentCascadeStore<KT, VT, IK, IV, ST>::get(const KT& key, const persistent::version_t& ver, bool stable, bool exact) const {
     debug_enter_func_with_args("key={},ver=0x{:x},stable={},exact={}", key, ver, stable, exact);
-    persistent::version_t requested_version = ver;
-
-    // adjust version if stable is requested.
-    if(stable) {
-        derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
-        requested_version = ver;
-        if(requested_version == CURRENT_VERSION) {
-            requested_version = subgroup_handle.get_global_persistence_frontier();
-        } else {
-            // The first condition test if requested_version is beyond the active latest atomic broadcast version.
-            // However, that could be true for a valid requested version for a new started setup, where the active
-            // latest atomic broadcast version is INVALID_VERSION(-1) since there is no atomic broadcast yet. In such a
-            // case, we need also check if requested_version is beyond the local latest version. If both are true, we
-            // determine the requested_version is invalid: it asks a version in the future.
-            if(!subgroup_handle.wait_for_global_persistence_frontier(requested_version) && requested_version > persistent_core.getLatestVersion()) {
-                // INVALID version
-                dbg_default_debug("{}: requested version:{:x} is beyond the latest atomic broadcast version.", __PRETTY_FUNCTION__, requested_version);
-                return *IV;
-            }
-        }
+    persistent::version_t requested_version;
+    if(!resolve_read_version(ver, stable, requested_version)) {
+        return *IV;
     }
 
     if(requested_version == CURRENT_VERSION) {
         // return the unstable question
         debug_leave_func_with_value("lockless_get({})", key);
         return persistent_core->lockless_get(key);
-    } else {
-        return persistent_core.template getDelta<VT>(requested_version, exact, [this, key, requested_version, exact](const VT& v) {
-            if(key == v.get_key_ref()) {
-                debug_leave_func_with_value("key:{} is found at version:0x{:x}", key, requested_version);
-                return v;
+    }
+
+    if(!exact) {
+        // Find the version of the key at requested_version in the version chain, and read that delta only.
+        persistent::version_t key_version;
+        if(persistent_core->lockless_get_key_version(key, requested_version, key_version)) {
+            if(key_version == persistent::INVALID_VERSION) {
+                debug_leave_func_with_value("No data found for key:{} before version:0x{:x}", key, requested_version);
+                return *IV;
+            }
+            debug_leave_func_with_value("key:{} is found at version:0x{:x} by the version index", key, key_version);
+            return persistent_core.template getDelta<DeltaObjects<VT>>(key_version, true, [&key](const DeltaObjects<VT>& delta) {
+                std::optional<VT> found;
+                find_in_delta(delta, key, found);
+                return found ? *found : *IV;
+            });
+        }
+    }
+
+    // an exact search, or a version older than what the version index covers.
+    return persistent_core.template getDelta<DeltaObjects<VT>>(requested_version, exact, [this, key, requested_version, exact](const DeltaObjects<VT>& delta) {
+        std::optional<VT> v;
+        find_in_delta(delta, key, v);
+        if(v) {
+            debug_leave_func_with_value("key:{} is found at version:0x{:x}", key, requested_version);
+            return *v;
+        } else {
+            if(exact) {
+                // return invalid object for EXACT search.
+                debug_leave_func_with_value("No data found for key:{} at version:0x{:x}", key, requested_version);
+                return *IV;
             } else {
-                if(exact) {
-                    // return invalid object for EXACT search.
-                    debug_leave_func_with_value("No data found for key:{} at version:0x{:x}", key, requested_version);
-                    return *IV;
-                } else {
-                    // fall back to the slow path.
-                    auto versioned_state_ptr = persistent_core.get(requested_version);
-                    if(versioned_state_ptr->kv_map.find(key) != versioned_state_ptr->kv_map.end()) {
-                        debug_leave_func_with_value("Reconstructed version:0x{:x} for key:{}", requested_version, key);
-                        return versioned_state_ptr->kv_map.at(key);
+                // fall back to the slow path.
+                std::optional<VT> found;
+                with_state_at(requested_version, [&found, &key](const std::map<KT, VT>& kv_map) {
+                    auto it = kv_map.find(key);
+                    if(it != kv_map.end()) {
+                        found.emplace(it->second);
                     }
-                    debug_leave_func_with_value("No data found for key:{} before version:0x{:x}", key, requested_version);
-                    return *IV;
+                });
+                if(found) {
+                    debug_leave_func_with_value("Reconstructed version:0x{:x} for key:{}", requested_version, key);
+                    return *found;
                 }
+                debug_leave_func_with_value("No data found for key:{} before version:0x{:x}", key, requested_version);
+                return *IV;
             }
-        });
-    }
+        }
+    });
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
@@ -149,23 +200,49 @@ const VT PersistentCascadeStore<KT, VT, IK, IV, ST>::multi_get(const KT& key) co
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 const VT PersistentCascadeStore<KT, VT, IK, IV, ST>::get_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const {
     debug_enter_func_with_args("key={},ts_us={},stable={}", key, ts_us, stable);
-    const HLC hlc(ts_us, 0ull);
+    persistent::version_t ver;
+    if(!resolve_read_time(ts_us, ver)) {
+        return *IV;
+    }
 
-    derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
+    debug_leave_func();
+    return get(key, ver, stable, false);
+}
 
-    // get_global_stability_frontier return nano seconds.
-    if(ts_us > subgroup_handle.compute_global_stability_frontier() / 1000) {
-        dbg_default_warn("Cannot get data at a time in the future.");
-        return *IV;
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::vector<VT> PersistentCascadeStore<KT, VT, IK, IV, ST>::get_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const {
+    debug_enter_func_with_args("keys.size()={},ver=0x{:x},stable={}", keys.size(), ver, stable);
+    persistent::version_t requested_version;
+    if(!resolve_read_version(ver, stable, requested_version)) {
+        return std::vector<VT>(keys.size(), *IV);
     }
 
-    persistent::version_t ver = persistent_core.getVersionAtTime({ts_us, 0});
-    if(ver == persistent::INVALID_VERSION) {
-        return *IV;
+    if(requested_version == CURRENT_VERSION) {
+        // the latest unstable values, from one snapshot.
+        debug_leave_func_with_value("lockless_get_many({} keys)", keys.size());
+        return persistent_core->lockless_get_many(keys);
     }
 
+    // the state at a version does not change, so the keys are read one by one.
+    std::vector<VT> values;
+    values.reserve(keys.size());
+    for(const auto& key : keys) {
+        values.emplace_back(get(key, requested_version, false, false));
+    }
     debug_leave_func();
-    return get(key, ver, stable, false);
+    return values;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::vector<VT> PersistentCascadeStore<KT, VT, IK, IV, ST>::get_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const {
+    debug_enter_func_with_args("keys.size()={},ts_us={},stable={}", keys.size(), ts_us, stable);
+    persistent::version_t ver;
+    if(!resolve_read_time(ts_us, ver)) {
+        return std::vector<VT>(keys.size(), *IV);
+    }
+
+    debug_leave_func();
+    return get_many(keys, ver, stable);
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
@@ -185,78 +262,115 @@ uint64_t PersistentCascadeStore<KT, VT, IK, IV, ST>::multi_get_size(const KT& ke
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 uint64_t PersistentCascadeStore<KT, VT, IK, IV, ST>::get_size(const KT& key, const persistent::version_t& ver, const bool stable, const bool exact) const {
     debug_enter_func_with_args("key={},ver=0x{:x},stable={},exact={}", key, ver, stable, exact);
-    persistent::version_t requested_version = ver;
-
-    // adjust version if stable is requested.
-    if(stable) {
-        derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
-        requested_version = ver;
-        if(requested_version == CURRENT_VERSION) {
-            requested_version = subgroup_handle.get_global_persistence_frontier();
-        } else {
-            // The first condition test if requested_version is beyond the active latest atomic broadcast version.
-            // However, that could be true for a valid requested version for a new started setup, where the active
-            // latest atomic broadcast version is INVALID_VERSION(-1) since there is no atomic broadcast yet. In such a
-            // case, we need also check if requested_version is beyond the local latest version. If both are true, we
-            // determine the requested_version is invalid: it asks a version in the future.
-            if(!subgroup_handle.wait_for_global_persistence_frontier(requested_version) && requested_version > persistent_core.getLatestVersion()) {
-                // INVALID version
-                dbg_default_debug("{}: requested version:{:x} is beyond the latest atomic broadcast version.", __PRETTY_FUNCTION__, requested_version);
-                return 0ull;
-            }
-        }
+    persistent::version_t requested_version;
+    if(!resolve_read_version(ver, stable, requested_version)) {
+        return 0ull;
     }
 
     if(requested_version == CURRENT_VERSION) {
         // return the unstable question
         debug_leave_func_with_value("lockless_get_size({})", key);
         return persistent_core->lockless_get_size(key);
-    } else {
-        return persistent_core.template getDelta<VT>(requested_version, exact, [this, key, requested_version, exact](const VT& v) -> uint64_t {
-            if(key == v.get_key_ref()) {
-                debug_leave_func_with_value("key:{} is found at version:0x{:x}", key, requested_version);
-                return mutils::bytes_size(v);
+    }
+
+    if(!exact) {
+        // Find the version of the key at requested_version in the version chain, and read that delta only.
+        persistent::version_t key_version;
+        if(persistent_core->lockless_get_key_version(key, requested_version, key_version)) {
+            if(key_version == persistent::INVALID_VERSION) {
+                debug_leave_func_with_value("No data found for key:{} before version:0x{:x}", key, requested_version);
+                return 0ull;
+            }
+            debug_leave_func_with_value("key:{} is found at version:0x{:x} by the version index", key, key_version);
+            return persistent_core.template getDelta<DeltaObjects<VT>>(key_version, true, [&key](const DeltaObjects<VT>& delta) -> uint64_t {
+                std::optional<VT> found;
+                find_in_delta(delta, key, found);
+                return found ? mutils::bytes_size(*found) : 0ull;
+            });
+        }
+    }
+
+    // an exact search, or a version older than what the version index covers.
+    return persistent_core.template getDelta<DeltaObjects<VT>>(requested_version, exact, [this, key, requested_version, exact](const DeltaObjects<VT>& delta) -> uint64_t {
+        std::optional<VT> v;
+        find_in_delta(delta, key, v);
+        if(v) {
+            debug_leave_func_with_value("key:{} is found at version:0x{:x}", key, requested_version);
+            return mutils::bytes_size(*v);
+        } else {
+            if(exact) {
+                // return invalid object for EXACT search.
+                debug_leave_func_with_value("No data found for key:{} at version:0x{:x}", key, requested_version);
+                return 0ull;
             } else {
-                if(exact) {
-                    // return invalid object for EXACT search.
-                    debug_leave_func_with_value("No data found for key:{} at version:0x{:x}", key, requested_version);
-                    return 0ull;
-                } else {
-                    // fall back to the slow path.
-                    auto versioned_state_ptr = persistent_core.get(requested_version);
-                    if(versioned_state_ptr->kv_map.find(key) != versioned_state_ptr->kv_map.end()) {
-                        debug_leave_func_with_value("Reconstructed version:0x{:x} for key:{}", requested_version, key);
-                        return mutils::bytes_size(versioned_state_ptr->kv_map.at(key));
+                // fall back to the slow path.
+                uint64_t size = 0;
+                bool found = false;
+                with_state_at(requested_version, [&size, &found, &key](const std::map<KT, VT>& kv_map) {
+                    auto it = kv_map.find(key);
+                    if(it != kv_map.end()) {
+                        size = mutils::bytes_size(it->second);
+                        found = true;
                     }
-                    debug_leave_func_with_value("No data found for key:{} before version:0x{:x}", key, requested_version);
-                    return 0ull;
+                });
+                if(found) {
+                    debug_leave_func_with_value("Reconstructed version:0x{:x} for key:{}", requested_version, key);
+                    return size;
                 }
+                debug_leave_func_with_value("No data found for key:{} before version:0x{:x}", key, requested_version);
+                return 0ull;
             }
-        });
-    }
+        }
+    });
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 uint64_t PersistentCascadeStore<KT, VT, IK, IV, ST>::get_size_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const {
     debug_enter_func_with_args("key={},ts_us={},stable={}", key, ts_us, stable);
-    const HLC hlc(ts_us, 0ull);
+    persistent::version_t ver;
+    if(!resolve_read_time(ts_us, ver)) {
+        return 0;
+    }
 
-    derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
+    debug_leave_func();
 
-    // get_global_stability_frontier return nano seconds.
-    if(ts_us > subgroup_handle.compute_global_stability_frontier() / 1000) {
-        dbg_default_warn("Cannot get data at a time in the future.");
-        return 0;
+    return get_size(key, ver, stable);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::vector<uint64_t> PersistentCascadeStore<KT, VT, IK, IV, ST>::get_size_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const {
+    debug_enter_func_with_args("keys.size()={},ver=0x{:x},stable={}", keys.size(), ver, stable);
+    persistent::version_t requested_version;
+    if(!resolve_read_version(ver, stable, requested_version)) {
+        return std::vector<uint64_t>(keys.size(), 0);
     }
 
-    persistent::version_t ver = persistent_core.getVersionAtTime({ts_us, 0});
-    if(ver == persistent::INVALID_VERSION) {
-        return 0;
+    if(requested_version == CURRENT_VERSION) {
+        // the latest unstable values, from one snapshot.
+        debug_leave_func_with_value("lockless_get_size_many({} keys)", keys.size());
+        return persistent_core->lockless_get_size_many(keys);
     }
 
+    // the state at a version does not change, so the keys are read one by one.
+    std::vector<uint64_t> sizes;
+    sizes.reserve(keys.size());
+    for(const auto& key : keys) {
+        sizes.emplace_back(get_size(key, requested_version, false, false));
+    }
     debug_leave_func();
+    return sizes;
+}
 
-    return get_size(key, ver, stable);
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::vector<uint64_t> PersistentCascadeStore<KT, VT, IK, IV, ST>::get_size_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const {
+    debug_enter_func_with_args("keys.size()={},ts_us={},stable={}", keys.size(), ts_us, stable);
+    persistent::version_t ver;
+    if(!resolve_read_time(ts_us, ver)) {
+        return std::vector<uint64_t>(keys.size(), 0);
+    }
+
+    debug_leave_func();
+    return get_size_many(keys, ver, stable);
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
@@ -300,9 +414,26 @@ std::vector<KT> PersistentCascadeStore<KT, VT, IK, IV, ST>::list_keys(const std:
         debug_leave_func_with_value("lockless_list_prefix({})", prefix);
         return persistent_core->lockless_list_keys(prefix);
     } else {
-        std::vector<KT> keys;
-        persistent_core.get(requested_version, [&keys, &prefix](const DeltaCascadeStoreCore<KT, VT, IK, IV>& pers_core) {
-            for(const auto& kv : pers_core.kv_map) {
+        // the keys are never erased, so the keys at the requested version are among the current ones.
+        std::vector<KT> keys = persistent_core->lockless_list_keys(prefix);
+        std::vector<KT> keys_at_version;
+        bool covered = true;
+        for(const auto& key : keys) {
+            persistent::version_t key_version;
+            if(!persistent_core->lockless_get_key_version(key, requested_version, key_version)) {
+                covered = false;
+                break;
+            }
+            if(key_version != persistent::INVALID_VERSION) {
+                keys_at_version.push_back(key);
+            }
+        }
+        if(covered) {
+            return keys_at_version;
+        }
+        keys.clear();
+        with_state_at(requested_version, [&keys, &prefix](const std::map<KT, VT>& kv_map) {
+            for(const auto& kv : kv_map) {
                 if(get_pathname<KT>(kv.first).find(prefix) == 0) {
                     keys.push_back(kv.first);
                 }
@@ -315,18 +446,8 @@ std::vector<KT> PersistentCascadeStore<KT, VT, IK, IV, ST>::list_keys(const std:
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 std::vector<KT> PersistentCascadeStore<KT, VT, IK, IV, ST>::list_keys_by_time(const std::string& prefix, const uint64_t& ts_us, const bool stable) const {
     debug_enter_func_with_args("ts_us={}", ts_us);
-    const HLC hlc(ts_us, 0ull);
-
-    derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
-
-    // get_global_stability_frontier return nano seconds.
-    if(ts_us > subgroup_handle.compute_global_stability_frontier() / 1000) {
-        dbg_default_warn("Cannot get data at a time in the future.");
-        return {};
-    }
-
-    persistent::version_t ver = persistent_core.getVersionAtTime({ts_us, 0});
-    if(ver == persistent::INVALID_VERSION) {
+    persistent::version_t ver;
+    if(!resolve_read_time(ts_us, ver)) {
         return {};
     }
 
@@ -387,6 +508,90 @@ void PersistentCascadeStore<KT, VT, IK, IV, ST>::ordered_put_and_forget(const VT
     debug_leave_func();
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::vector<std::tuple<persistent::version_t, uint64_t>> PersistentCascadeStore<KT, VT, IK, IV, ST>::ordered_put_batch(const std::vector<VT>& values) {
+    debug_enter_func_with_args("values.size()={}", values.size());
+    // the batch is one ordered message, so all values share its version and timestamp.
+    const std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index).get_current_version();
+    for(const auto& value : values) {
+        if constexpr(std::is_base_of<IKeepVersion, VT>::value) {
+            value.set_version(std::get<0>(version_and_timestamp));
+        }
+        if constexpr(std::is_base_of<IKeepTimestamp, VT>::value) {
+            value.set_timestamp(std::get<1>(version_and_timestamp));
+        }
+    }
+    const std::vector<bool> accepted = this->persistent_core->ordered_put_batch(values, this->persistent_core.getLatestVersion());
+    std::vector<std::tuple<persistent::version_t, uint64_t>> ret;
+    ret.reserve(values.size());
+    uint64_t accepted_bytes = 0;
+    for(std::size_t i = 0; i < values.size(); i++) {
+        if(!accepted[i]) {
+            // verification failed. So we return invalid versions.
+            ret.emplace_back(persistent::INVALID_VERSION, 0);
+            continue;
+        }
+        ret.emplace_back(version_and_timestamp);
+        accepted_bytes += mutils::bytes_size(values[i]);
+        if(cascade_watcher_ptr) {
+            (*cascade_watcher_ptr)(
+                    this->subgroup_index,
+                    group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index).get_shard_num(),
+                    group->get_rpc_caller_id(),
+                    values[i].get_key_ref(), values[i], cascade_context_ptr);
+        }
+    }
+    if(checkpointer && accepted_bytes > 0) {
+        checkpointer->record(std::get<0>(version_and_timestamp), accepted_bytes);
+    }
+    trim_version_index(values.size());
+    debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(version_and_timestamp), std::get<1>(version_and_timestamp));
+    return ret;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::tuple<persistent::version_t, uint64_t> PersistentCascadeStore<KT, VT, IK, IV, ST>::ordered_transact(
+        const std::vector<std::tuple<KT, persistent::version_t>>& read_set, const std::vector<VT>& write_set) {
+    debug_enter_func_with_args("read_set.size()={},write_set.size()={}", read_set.size(), write_set.size());
+    const std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index).get_current_version();
+    for(const auto& value : write_set) {
+        if constexpr(std::is_base_of<IKeepVersion, VT>::value) {
+            value.set_version(std::get<0>(version_and_timestamp));
+        }
+        if constexpr(std::is_base_of<IKeepTimestamp, VT>::value) {
+            value.set_timestamp(std::get<1>(version_and_timestamp));
+        }
+    }
+    const persistent::version_t checked_version = this->persistent_core.getLatestVersion();
+    if(this->persistent_core->ordered_transact(read_set, write_set, checked_version) == false) {
+        // the read set is stale, or a value is rejected. So we return invalid versions.
+        debug_leave_func_with_value("transaction at version=0x{:x} is rejected", std::get<0>(version_and_timestamp));
+        return {persistent::INVALID_VERSION, 0};
+    }
+    // a read-only transaction creates no version: return the one whose state was checked.
+    if(write_set.empty()) {
+        debug_leave_func_with_value("read-only transaction checked at version=0x{:x}", checked_version);
+        return {checked_version, 0};
+    }
+    uint64_t write_bytes = 0;
+    for(const auto& value : write_set) {
+        write_bytes += mutils::bytes_size(value);
+        if(cascade_watcher_ptr) {
+            (*cascade_watcher_ptr)(
+                    this->subgroup_index,
+                    group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index).get_shard_num(),
+                    group->get_rpc_caller_id(),
+                    value.get_key_ref(), value, cascade_context_ptr);
+        }
+    }
+    if(checkpointer && write_bytes > 0) {
+        checkpointer->record(std::get<0>(version_and_timestamp), write_bytes);
+    }
+    trim_version_index(write_set.size());
+    debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(version_and_timestamp), std::get<1>(version_and_timestamp));
+    return version_and_timestamp;
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 bool PersistentCascadeStore<KT, VT, IK, IV, ST>::internal_ordered_put(const VT& value) {
     std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index).get_current_version();
@@ -401,6 +606,10 @@ bool PersistentCascadeStore<KT, VT, IK, IV, ST>::internal_ordered_put(const VT&
         debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(version_and_timestamp), std::get<1>(version_and_timestamp));
         return false;
     }
+    if(checkpointer) {
+        checkpointer->record(std::get<0>(version_and_timestamp), mutils::bytes_size(value));
+    }
+    trim_version_index(1);
     if(cascade_watcher_ptr) {
         (*cascade_watcher_ptr)(
                 // group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index).get_subgroup_id(), // this is subgroup id
@@ -424,6 +633,10 @@ std::tuple<persistent::version_t, uint64_t> PersistentCascadeStore<KT, VT, IK, I
         value.set_timestamp(std::get<1>(version_and_timestamp));
     }
     if(this->persistent_core->ordered_remove(value, this->persistent_core.getLatestVersion())) {
+        if(checkpointer) {
+            checkpointer->record(std::get<0>(version_and_timestamp), mutils::bytes_size(value));
+        }
+        trim_version_index(1);
         if(cascade_watcher_ptr) {
             (*cascade_watcher_ptr)(
                     // group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index).get_subgroup_id(), // this is subgroup id
@@ -472,6 +685,15 @@ void PersistentCascadeStore<KT, VT, IK, IV, ST>::trigger_put(const VT& value) co
     debug_leave_func();
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+void PersistentCascadeStore<KT, VT, IK, IV, ST>::trigger_put_batch(const std::vector<VT>& values) const {
+    debug_enter_func_with_args("values.size()={}", values.size());
+    for(const auto& value : values) {
+        trigger_put(value);
+    }
+    debug_leave_func();
+}
+
 #ifdef ENABLE_EVALUATION
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 void PersistentCascadeStore<KT, VT, IK, IV, ST>::dump_timestamp_log(const std::string& filename) const {
@@ -513,10 +735,190 @@ std::vector<KT> PersistentCascadeStore<KT, VT, IK, IV, ST>::ordered_list_keys(co
     return this->persistent_core->ordered_list_keys(prefix);
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+void PersistentCascadeStore<KT, VT, IK, IV, ST>::initialize_checkpointer() {
+    uint64_t interval_versions = 0;
+    uint64_t interval_bytes = 0;
+    if(derecho::hasCustomizedConfKey(CASCADE_CHECKPOINT_INTERVAL_VERSIONS)) {
+        interval_versions = derecho::getConfUInt64(CASCADE_CHECKPOINT_INTERVAL_VERSIONS);
+    }
+    if(derecho::hasCustomizedConfKey(CASCADE_CHECKPOINT_INTERVAL_BYTES)) {
+        interval_bytes = derecho::getConfUInt64(CASCADE_CHECKPOINT_INTERVAL_BYTES);
+    }
+    if(interval_versions == 0 && interval_bytes == 0) {
+        return;
+    }
+    std::string checkpoint_path = derecho::getConfString(CONF_PERS_FILE_PATH) + "/checkpoints";
+    if(derecho::hasCustomizedConfKey(CASCADE_CHECKPOINT_PATH)) {
+        checkpoint_path = derecho::getConfString(CASCADE_CHECKPOINT_PATH);
+    }
+    uint32_t retention = 2;
+    if(derecho::hasCustomizedConfKey(CASCADE_CHECKPOINT_RETENTION)) {
+        retention = derecho::getConfUInt32(CASCADE_CHECKPOINT_RETENTION);
+    }
+    // the state is at the latest version of the log.
+    checkpointer = std::make_unique<StoreCheckpointer<KT, VT>>(
+            checkpoint_path, persistent_core.getObjectName(), interval_versions, interval_bytes, retention,
+            [this](const persistent::version_t& ver, const std::function<void(const VT&)>& func) {
+                read_delta(ver, func);
+            },
+            [this](const persistent::version_t& ver, const std::function<void(const std::map<KT, VT>&)>& func) {
+                persistent_core.get(ver, [&func](const DeltaCascadeStoreCore<KT, VT, IK, IV>& pers_core) {
+                    func(pers_core.kv_map);
+                });
+            },
+            persistent_core.getLatestVersion());
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+void PersistentCascadeStore<KT, VT, IK, IV, ST>::read_delta(const persistent::version_t& ver,
+                                                            const std::function<void(const VT&)>& func) {
+    persistent_core.template getDelta<DeltaObjects<VT>>(ver, true, [&func](const DeltaObjects<VT>& delta) {
+        delta.for_each(func);
+        return true;
+    });
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+void PersistentCascadeStore<KT, VT, IK, IV, ST>::find_in_delta(const DeltaObjects<VT>& delta, const KT& key,
+                                                               std::optional<VT>& found) {
+    // a batch may update a key more than once; the last update wins.
+    delta.for_each([&key, &found](const VT& value) {
+        if(value.get_key_ref() == key) {
+            found.reset();
+            found.emplace(value);
+        }
+    });
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+uint64_t PersistentCascadeStore<KT, VT, IK, IV, ST>::get_memory_budget() {
+    if(derecho::hasCustomizedConfKey(CASCADE_MEMORY_BUDGET)) {
+        return derecho::getConfUInt64(CASCADE_MEMORY_BUDGET);
+    }
+    return 0;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+uint64_t PersistentCascadeStore<KT, VT, IK, IV, ST>::get_version_index_max_updates() {
+    if(derecho::hasCustomizedConfKey(CASCADE_VERSION_INDEX_MAX_UPDATES)) {
+        return derecho::getConfUInt64(CASCADE_VERSION_INDEX_MAX_UPDATES);
+    }
+    return VERSION_INDEX_DEFAULT_MAX_UPDATES;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+void PersistentCascadeStore<KT, VT, IK, IV, ST>::trim_version_index(uint64_t num_updates) {
+    updates_since_index_trim += num_updates;
+    if(updates_since_index_trim < VERSION_INDEX_TRIM_INTERVAL) {
+        return;
+    }
+    updates_since_index_trim = 0;
+    // the reads before the latest checkpoint are reconstructed from it.
+    persistent::version_t checkpoint_version = persistent::INVALID_VERSION;
+    if(checkpointer) {
+        checkpoint_version = checkpointer->get_latest_version();
+    }
+    persistent_core->trim_version_index(checkpoint_version, get_version_index_max_updates());
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+bool PersistentCascadeStore<KT, VT, IK, IV, ST>::get_residency_stats(ResidencyStats& stats) const {
+    return persistent_core->get_residency_stats(stats);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+uint32_t PersistentCascadeStore<KT, VT, IK, IV, ST>::get_num_recovery_threads() {
+    // The parallel replay keeps pointers to the deltas until the replay ends, which needs the log to be memory-mapped.
+    if constexpr(ST != persistent::ST_FILE) {
+        return 1;
+    }
+    // It also holds the whole state in memory until the replay ends, which a memory budget does not allow.
+    if(get_memory_budget() > 0) {
+        return 1;
+    }
+    if(derecho::hasCustomizedConfKey(CASCADE_NUM_RECOVERY_THREADS)) {
+        return std::max(derecho::getConfUInt32(CASCADE_NUM_RECOVERY_THREADS), 1u);
+    }
+    return 1;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+std::unique_ptr<BlobSegmentStore> PersistentCascadeStore<KT, VT, IK, IV, ST>::create_blob_segments(persistent::PersistentRegistry* pr) {
+    if(!derecho::hasCustomizedConfKey(CASCADE_BLOB_SEGMENT_THRESHOLD) || pr == nullptr) {
+        return nullptr;
+    }
+    const uint64_t threshold = derecho::getConfUInt64(CASCADE_BLOB_SEGMENT_THRESHOLD);
+    if(threshold == 0) {
+        return nullptr;
+    }
+    uint64_t segment_size = 1ull << 30;
+    if(derecho::hasCustomizedConfKey(CASCADE_BLOB_SEGMENT_SIZE)) {
+        segment_size = derecho::getConfUInt64(CASCADE_BLOB_SEGMENT_SIZE);
+    }
+    std::string blob_segment_path = derecho::getConfString(CONF_PERS_FILE_PATH) + "/blobs";
+    if(derecho::hasCustomizedConfKey(CASCADE_BLOB_SEGMENT_PATH)) {
+        blob_segment_path = derecho::getConfString(CASCADE_BLOB_SEGMENT_PATH);
+    }
+    return std::make_unique<BlobSegmentStore>(blob_segment_path, pr->get_subgroup_prefix(), threshold, segment_size);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+void PersistentCascadeStore<KT, VT, IK, IV, ST>::with_state_at(const persistent::version_t& ver,
+                                                               const std::function<void(const std::map<KT, VT>&)>& func) const {
+    if(checkpointer && checkpointer->reconstruct(ver, func)) {
+        return;
+    }
+    // replay the log from its origin.
+    persistent_core.get(ver, [&func](const DeltaCascadeStoreCore<KT, VT, IK, IV>& pers_core) {
+        func(pers_core.kv_map);
+    });
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+bool PersistentCascadeStore<KT, VT, IK, IV, ST>::resolve_read_version(const persistent::version_t& ver, const bool stable, persistent::version_t& requested_version) const {
+    requested_version = ver;
+
+    // adjust version if stable is requested.
+    if(stable) {
+        derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
+        if(requested_version == CURRENT_VERSION) {
+            requested_version = subgroup_handle.get_global_persistence_frontier();
+        } else {
+            // The first condition test if requested_version is beyond the active latest atomic broadcast version.
+            // However, that could be true for a valid requested version for a new started setup, where the active
+            // latest atomic broadcast version is INVALID_VERSION(-1) since there is no atomic broadcast yet. In such a
+            // case, we need also check if requested_version is beyond the local latest version. If both are true, we
+            // determine the requested_version is invalid: it asks a version in the future.
+            if(!subgroup_handle.wait_for_global_persistence_frontier(requested_version) && requested_version > persistent_core.getLatestVersion()) {
+                // INVALID version
+                dbg_default_debug("{}: requested version:{:x} is beyond the latest atomic broadcast version.", __PRETTY_FUNCTION__, requested_version);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
+bool PersistentCascadeStore<KT, VT, IK, IV, ST>::resolve_read_time(const uint64_t& ts_us, persistent::version_t& ver) const {
+    derecho::Replicated<PersistentCascadeStore>& subgroup_handle = group->template get_subgroup<PersistentCascadeStore>(this->subgroup_index);
+
+    // get_global_stability_frontier return nano seconds.
+    if(ts_us > subgroup_handle.compute_global_stability_frontier() / 1000) {
+        dbg_default_warn("Cannot get data at a time in the future.");
+        return false;
+    }
+
+    ver = persistent_core.getVersionAtTime({ts_us, 0});
+    return ver != persistent::INVALID_VERSION;
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 std::unique_ptr<PersistentCascadeStore<KT, VT, IK, IV, ST>> PersistentCascadeStore<KT, VT, IK, IV, ST>::from_bytes(mutils::DeserializationManager* dsm, uint8_t const* buf) {
     auto persistent_core_ptr = mutils::from_bytes<persistent::Persistent<DeltaCascadeStoreCore<KT, VT, IK, IV>, ST>>(dsm, buf);
     auto persistent_cascade_store_ptr = std::make_unique<PersistentCascadeStore>(std::move(*persistent_core_ptr),
+                                                                                 dsm->registered<persistent::PersistentRegistry>() ? &(dsm->mgr<persistent::PersistentRegistry>()) : nullptr,
                                                                                  dsm->registered<CriticalDataPathObserver<PersistentCascadeStore<KT, VT, IK, IV>>>() ? &(dsm->mgr<CriticalDataPathObserver<PersistentCascadeStore<KT, VT, IK, IV>>>()) : nullptr,
                                                                                  dsm->registered<ICascadeContext>() ? &(dsm->mgr<ICascadeContext>()) : nullptr);
     return persistent_cascade_store_ptr;
@@ -526,26 +928,59 @@ template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 PersistentCascadeStore<KT, VT, IK, IV, ST>::PersistentCascadeStore(
         persistent::PersistentRegistry* pr,
         CriticalDataPathObserver<PersistentCascadeStore<KT, VT, IK, IV>>* cw,
-        ICascadeContext* cc) : persistent_core([]() {
-                                   return std::make_unique<DeltaCascadeStoreCore<KT, VT, IK, IV>>();
+        ICascadeContext* cc) : log_replayed(false),
+                               blob_segments(create_blob_segments(pr)),
+                               persistent_core([this]() {
+                                   auto core = std::make_unique<DeltaCascadeStoreCore<KT, VT, IK, IV>>();
+                                   if(!log_replayed) {
+                                       core->begin_recovery(get_num_recovery_threads());
+                                       // the values are evicted during the replay, and loaded once it is done.
+                                       if(get_memory_budget() > 0) {
+                                           core->set_blob_loader([this](const persistent::version_t& ver, const std::function<void(const VT&)>& func) {
+                                               read_delta(ver, func);
+                                           });
+                                           core->set_memory_budget(get_memory_budget());
+                                       }
+                                   }
+                                   return core;
                                },
                                                nullptr, pr),
                                cascade_watcher_ptr(cw),
                                cascade_context_ptr(cc) {
+    // Persistent<> has replayed the log in its constructor.
+    persistent_core->finish_recovery();
+    log_replayed = true;
+    persistent_core->set_blob_segments(blob_segments.get());
+    if(blob_segments) {
+        blob_segments->resume();
+    }
+    initialize_checkpointer();
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
 PersistentCascadeStore<KT, VT, IK, IV, ST>::PersistentCascadeStore(
         persistent::Persistent<DeltaCascadeStoreCore<KT, VT, IK, IV>, ST>&&
                 _persistent_core,
+        persistent::PersistentRegistry* pr,
         CriticalDataPathObserver<PersistentCascadeStore<KT, VT, IK, IV>>* cw,
-        ICascadeContext* cc) : persistent_core(std::move(_persistent_core)),
+        ICascadeContext* cc) : log_replayed(true),
+                               blob_segments(create_blob_segments(pr)),
+                               persistent_core(std::move(_persistent_core)),
                                cascade_watcher_ptr(cw),
                                cascade_context_ptr(cc) {
+    if(get_memory_budget() > 0) {
+        persistent_core->set_blob_loader([this](const persistent::version_t& ver, const std::function<void(const VT&)>& func) {
+            read_delta(ver, func);
+        });
+        persistent_core->set_memory_budget(get_memory_budget());
+    }
+    persistent_core->set_blob_segments(blob_segments.get());
+    initialize_checkpointer();
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
-PersistentCascadeStore<KT, VT, IK, IV, ST>::PersistentCascadeStore() : persistent_core(
+PersistentCascadeStore<KT, VT, IK, IV, ST>::PersistentCascadeStore() : log_replayed(true),
+                                                                       persistent_core(
         []() {
             return std::make_unique<DeltaCascadeStoreCore<KT, VT, IK, IV>>();
         },
@@ -556,7 +991,10 @@ PersistentCascadeStore<KT, VT, IK, IV, ST>::PersistentCascadeStore() : persisten
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST>
-PersistentCascadeStore<KT, VT, IK, IV, ST>::~PersistentCascadeStore() {}
+PersistentCascadeStore<KT, VT, IK, IV, ST>::~PersistentCascadeStore() {
+    // stop the checkpoint thread before persistent_core goes away.
+    checkpointer.reset();
+}
 
 }  // namespace cascade
 }  // namespace derecho
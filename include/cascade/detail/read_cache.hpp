@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cascade/cascade_interface.hpp>
+#include <derecho/core/derecho.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * ReadCache implements the client-side object cache of the ServiceClient. It is enabled per object pool, and each
+ * object pool has its own bound in bytes, in which the least recently used objects are evicted.
+ *
+ * The objects read at a given version are immutable, so they are cached until they are evicted. The objects read at
+ * the current version are cached only if the client is told about the changes to the object pool, see invalidate():
+ * an entry is dropped when a newer version of its key is reported. The reported versions of the recently changed keys
+ * are kept as floors, so that a late read of an older version, from a member that has not applied the change yet, or
+ * of a version that is not stable yet, is not cached.
+ */
+class ReadCache {
+public:
+#define READ_CACHE_DEFAULT_MAX_BYTES (64ul << 20)
+#define READ_CACHE_MAX_FLOORS_PER_POOL (65536)
+
+    /**
+     * The counters of the read cache.
+     */
+    struct Stats {
+        /* the reads served by the cache. */
+        uint64_t hits;
+        /* the cacheable reads sent to the servers. */
+        uint64_t misses;
+        /* the entries dropped because their keys changed. */
+        uint64_t invalidations;
+        /* the entries evicted for space. */
+        uint64_t evictions;
+        /* the bytes of the cached objects. */
+        std::size_t bytes;
+    };
+
+private:
+    /* an entry is identified by the key, the version or CURRENT_VERSION, and whether the read is stable. */
+    using entry_key_t = std::tuple<std::string, persistent::version_t, bool>;
+
+    struct Entry {
+        /* the object, whose type is 'type'. */
+        std::shared_ptr<const void> object;
+        std::type_index type;
+        /* the version of the object. */
+        persistent::version_t version;
+        std::size_t bytes;
+        std::list<entry_key_t>::iterator lru_position;
+    };
+
+    struct Pool {
+        std::size_t max_bytes = 0;
+        /* true if the objects read at the current version are cached. */
+        bool cache_current = false;
+        std::size_t bytes = 0;
+        /* the entries, the most recently used first. */
+        std::list<entry_key_t> lru;
+        std::map<entry_key_t, Entry> entries;
+        /* the latest reported version of the recently changed keys, the oldest dropped first. */
+        std::unordered_map<std::string, persistent::version_t> floors;
+        std::deque<std::string> floor_order;
+    };
+
+    std::map<std::string, std::unique_ptr<Pool>> pools;
+    mutable std::mutex pools_mutex;
+    /* the number of pools, read without pools_mutex by is_active(), which every request to an object pool calls. */
+    std::atomic<std::size_t> num_pools;
+
+    Stats stats;
+
+    /**
+     * @return the entry key of a cacheable read, or false if the read is not cacheable in the pool.
+     */
+    static bool to_entry_key(const Pool& pool, const std::string& key, const persistent::version_t& version, bool stable,
+                             entry_key_t& entry_key);
+
+    /**
+     * Drop an entry. The caller must hold pools_mutex.
+     */
+    void erase_entry(Pool& pool, std::map<entry_key_t, Entry>::iterator it);
+
+    /**
+     * Drop the entries read at the current version. The caller must hold pools_mutex.
+     *
+     * @return the number of entries dropped.
+     */
+    std::size_t erase_current_entries(Pool& pool);
+
+    /**
+     * Cache an object, and evict the least recently used entries over the bound. The caller must hold pools_mutex.
+     *
+     * @return false if the object is older than a known version of its key.
+     */
+    bool insert_entry(Pool& pool, const entry_key_t& entry_key, std::shared_ptr<const void>&& object,
+                      const std::type_index& type, const persistent::version_t& version, std::size_t bytes);
+
+public:
+    ReadCache();
+    ReadCache(const ReadCache&) = delete;
+    ReadCache& operator=(const ReadCache&) = delete;
+
+    /**
+     * Enable the cache of an object pool, or change its bound. The cache of the pool is kept if it is enabled already.
+     *
+     * @param object_pool_pathname  - the object pool
+     * @param max_bytes             - the bound of the cached objects in bytes, which must be positive.
+     * @param cache_current         - true if the objects read at the current version are cached, which requires
+     *                                that the changes to the pool are reported with invalidate().
+     */
+    void enable(const std::string& object_pool_pathname, std::size_t max_bytes, bool cache_current);
+
+    /**
+     * Disable the cache of an object pool, and drop its objects.
+     */
+    void disable(const std::string& object_pool_pathname);
+
+    /**
+     * @return true if the cache of any object pool is enabled. It does not lock.
+     */
+    bool is_active() const;
+
+    /**
+     * @return true if the cache of an object pool is enabled.
+     */
+    bool is_enabled(const std::string& object_pool_pathname) const;
+
+    /**
+     * Report a change to a key: the entries of the key read at the current version, and older than the version, are
+     * dropped.
+     *
+     * @param object_pool_pathname  - the object pool
+     * @param key                   - the key
+     * @param version               - the version of the change, or CURRENT_VERSION if it is unknown, in which case
+     *                                all of the entries of the key read at the current version are dropped.
+     */
+    void invalidate(const std::string& object_pool_pathname, const std::string& key, const persistent::version_t& version);
+
+    /**
+     * Drop all of the entries of an object pool read at the current version, when its changes may have been missed.
+     *
+     * @param object_pool_pathname  - the object pool
+     */
+    void invalidate_all(const std::string& object_pool_pathname);
+
+    /**
+     * @return the counters of the read cache.
+     */
+    Stats get_stats() const;
+
+    /**
+     * Look an object up.
+     *
+     * @tparam ObjectType   - the object type
+     * @param object_pool_pathname  - the object pool
+     * @param key                   - the key
+     * @param version               - the version of the read
+     * @param stable                - the stable flag of the read
+     * @param cacheable             - set to true if the read is cacheable, so that its reply should be filled in.
+     *
+     * @return the object, or nullptr on a miss.
+     */
+    template <typename ObjectType>
+    std::shared_ptr<const ObjectType> lookup(const std::string& object_pool_pathname, const std::string& key,
+                                             const persistent::version_t& version, bool stable, bool& cacheable);
+
+    /**
+     * Cache the reply of a read that missed. A null or invalid object is not cached, neither is an object read at a
+     * version other than its own.
+     *
+     * @tparam ObjectType   - the object type
+     * @param object_pool_pathname  - the object pool
+     * @param key                   - the key
+     * @param version               - the version of the read
+     * @param stable                - the stable flag of the read
+     * @param object                - the object
+     * @param object_bytes          - the serialized size of the object
+     */
+    template <typename ObjectType>
+    void fill(const std::string& object_pool_pathname, const std::string& key, const persistent::version_t& version,
+              bool stable, const std::shared_ptr<const ObjectType>& object, std::size_t object_bytes);
+};
+
+template <typename ObjectType>
+std::shared_ptr<const ObjectType> ReadCache::lookup(const std::string& object_pool_pathname, const std::string& key,
+                                                    const persistent::version_t& version, bool stable, bool& cacheable) {
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    cacheable = false;
+    auto pool_it = pools.find(object_pool_pathname);
+    if(pool_it == pools.end()) {
+        return nullptr;
+    }
+    Pool& pool = *pool_it->second;
+    entry_key_t entry_key;
+    if(!to_entry_key(pool, key, version, stable, entry_key)) {
+        return nullptr;
+    }
+    cacheable = true;
+    auto it = pool.entries.find(entry_key);
+    if(it == pool.entries.end() || it->second.type != std::type_index(typeid(ObjectType))) {
+        stats.misses++;
+        return nullptr;
+    }
+    pool.lru.splice(pool.lru.begin(), pool.lru, it->second.lru_position);
+    stats.hits++;
+    return std::static_pointer_cast<const ObjectType>(it->second.object);
+}
+
+template <typename ObjectType>
+void ReadCache::fill(const std::string& object_pool_pathname, const std::string& key, const persistent::version_t& version,
+                     bool stable, const std::shared_ptr<const ObjectType>& object, std::size_t object_bytes) {
+    if(!object->is_valid() || object->is_null()) {
+        return;
+    }
+    const persistent::version_t object_version = object->get_version();
+    if(version != CURRENT_VERSION && object_version != version) {
+        // only the object of that exact version is immutable.
+        return;
+    }
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    auto pool_it = pools.find(object_pool_pathname);
+    if(pool_it == pools.end()) {
+        return;
+    }
+    entry_key_t entry_key;
+    if(!to_entry_key(*pool_it->second, key, version, stable, entry_key)) {
+        return;
+    }
+    insert_entry(*pool_it->second, entry_key, std::shared_ptr<const void>(object), std::type_index(typeid(ObjectType)),
+                 object_version, object_bytes + key.size());
+}
+
+}  // namespace cascade
+}  // namespace derecho
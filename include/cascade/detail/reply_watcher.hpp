@@ -0,0 +1,193 @@
+#pragma once
+
+#include <derecho/core/derecho.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * ReplyWatcher calls a completion hook when the reply of a p2p request comes, which a QueryResults cannot do: its
+ * future may be read by one thread only, so a watched QueryResults is owned by the watcher, and the caller gets a
+ * QueryResults forwarding its reply instead (see forward()).
+ *
+ * A server node handles the p2p requests of a client one by one, so its replies come in the order of the requests.
+ * Each node has a watcher thread, which waits for the replies from that node in that order: a reply is handed on as
+ * soon as it comes, without polling. The watcher threads are started on demand, and stopped by the destructor, which
+ * fails the replies not come yet.
+ */
+class ReplyWatcher {
+public:
+#define REPLY_WATCHER_STOP_CHECK_MS (100)
+    /**
+     * A watched reply, whatever its type is.
+     */
+    class Reply {
+    public:
+        virtual ~Reply() = default;
+        /**
+         * Wait for the reply until a deadline, and hand it on if it has come.
+         *
+         * @return true if the reply has been handed on.
+         */
+        virtual bool wait_until(const std::chrono::steady_clock::time_point& deadline) = 0;
+        /**
+         * Give the reply up, when the watcher stops.
+         */
+        virtual void abandon() = 0;
+    };
+
+private:
+    template <typename Ret>
+    class TypedReply;
+
+    struct NodeReplies {
+        /* the replies to watch, oldest first. */
+        std::deque<std::unique_ptr<Reply>> replies;
+        std::condition_variable replies_cv;
+        std::thread watcher;
+    };
+    std::unordered_map<node_id_t, std::unique_ptr<NodeReplies>> node_replies;
+    std::mutex node_replies_mutex;
+    bool stopped;
+
+    void watch_node_replies(node_id_t node_id, NodeReplies& replies);
+
+public:
+    ReplyWatcher();
+    ReplyWatcher(const ReplyWatcher&) = delete;
+    ReplyWatcher& operator=(const ReplyWatcher&) = delete;
+    virtual ~ReplyWatcher();
+
+    /**
+     * Watch a reply from a node.
+     *
+     * @param node_id       - the node the request was sent to
+     * @param reply         - the reply; it is abandoned at once if the watcher has stopped.
+     */
+    void watch(node_id_t node_id, std::unique_ptr<Reply>&& reply);
+
+    /**
+     * Watch the reply of a p2p request.
+     *
+     * @tparam Ret          - the reply type
+     * @param node_id       - the node the request was sent to
+     * @param results       - the results of the request
+     * @param on_reply      - called by the watcher thread with the future of the reply once it is ready, or with
+     *                        nullptr if the reply is abandoned.
+     */
+    template <typename Ret>
+    void watch(node_id_t node_id,
+               derecho::rpc::QueryResults<Ret>&& results,
+               std::function<void(std::future<Ret>*)>&& on_reply);
+
+    /**
+     * Watch the reply of a p2p request, and forward it to the returned QueryResults.
+     *
+     * @tparam Ret          - the reply type
+     * @param node_id       - the node the request was sent to
+     * @param results       - the results of the request
+     * @param on_complete   - called by the watcher thread after forwarding the reply, with true if the request
+     *                        succeeded.
+     *
+     * @return the QueryResults receiving the reply, keyed by node_id.
+     */
+    template <typename Ret>
+    derecho::rpc::QueryResults<Ret> forward(node_id_t node_id,
+                                            derecho::rpc::QueryResults<Ret>&& results,
+                                            std::function<void(bool)>&& on_complete);
+};
+
+template <typename Ret>
+class ReplyWatcher::TypedReply : public ReplyWatcher::Reply {
+private:
+    derecho::rpc::QueryResults<Ret> results;
+    std::future<Ret>* future;
+    /* holds the error if the ReplyMap cannot be read. */
+    std::future<Ret> failed_future;
+    std::function<void(std::future<Ret>*)> on_reply;
+
+public:
+    TypedReply(derecho::rpc::QueryResults<Ret>&& _results,
+               std::function<void(std::future<Ret>*)>&& _on_reply)
+            : results(std::move(_results)),
+              future(nullptr),
+              on_reply(std::move(_on_reply)) {}
+
+    virtual bool wait_until(const std::chrono::steady_clock::time_point& deadline) override {
+        if(future == nullptr) {
+            std::promise<Ret> failed_promise;
+            try {
+                // the ReplyMap of a p2p request is ready once it is sent.
+                for(auto& reply_future : results.get()) {
+                    future = &reply_future.second;
+                    break;
+                }
+                if(future == nullptr) {
+                    throw derecho::derecho_exception("The request has no reply.");
+                }
+            } catch(...) {
+                failed_promise.set_exception(std::current_exception());
+                failed_future = failed_promise.get_future();
+                future = &failed_future;
+            }
+        }
+        if(future->wait_until(deadline) != std::future_status::ready) {
+            return false;
+        }
+        on_reply(future);
+        return true;
+    }
+
+    virtual void abandon() override {
+        on_reply(nullptr);
+    }
+};
+
+template <typename Ret>
+void ReplyWatcher::watch(node_id_t node_id,
+                         derecho::rpc::QueryResults<Ret>&& results,
+                         std::function<void(std::future<Ret>*)>&& on_reply) {
+    watch(node_id, std::make_unique<TypedReply<Ret>>(std::move(results), std::move(on_reply)));
+}
+
+template <typename Ret>
+derecho::rpc::QueryResults<Ret> ReplyWatcher::forward(node_id_t node_id,
+                                                      derecho::rpc::QueryResults<Ret>&& results,
+                                                      std::function<void(bool)>&& on_complete) {
+    static_assert(!std::is_void_v<Ret>, "A request without a reply value cannot be forwarded.");
+    auto pending_results = std::make_shared<derecho::rpc::PendingResults<Ret>>();
+    pending_results->fulfill_map({node_id});
+    auto query_results = pending_results->get_future();
+    watch<Ret>(node_id, std::move(results),
+               [node_id, pending_results, on_complete = std::move(on_complete)](std::future<Ret>* reply) {
+                   bool succeeded = false;
+                   if(reply == nullptr) {
+                       pending_results->set_exception(node_id, std::make_exception_ptr(derecho::derecho_exception(
+                                                                       "The reply watcher has stopped.")));
+                   } else {
+                       try {
+                           Ret value = reply->get();
+                           pending_results->set_value(node_id, value);
+                           succeeded = true;
+                       } catch(...) {
+                           pending_results->set_exception(node_id, std::current_exception());
+                       }
+                   }
+                   on_complete(succeeded);
+               });
+    return std::move(*query_results);
+}
+
+}  // namespace cascade
+}  // namespace derecho
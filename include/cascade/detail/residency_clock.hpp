@@ -0,0 +1,272 @@
+#pragma once
+
+#include "epoch_manager.hpp"
+#include "kv_hash_index.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * Counters of a memory-bounded store, see ResidencyClock.
+ */
+struct ResidencyStats {
+    /* the memory budget and the bytes of the resident values. */
+    uint64_t budget_bytes;
+    uint64_t resident_bytes;
+    /* the number of keys, and of keys whose values are resident. */
+    uint64_t num_keys;
+    uint64_t num_resident_keys;
+    /* reads of resident values, and of evicted values, which are loaded from the log. */
+    uint64_t hits;
+    uint64_t misses;
+    /* values evicted from memory, and evicted values brought back into memory after a miss. */
+    uint64_t evictions;
+    uint64_t promotions;
+};
+
+/**
+ * ResidencyClock decides which values of a store stay in memory under a memory budget, with the CLOCK algorithm: a
+ * read sets the referenced bit of the key, and the clock hand evicts the first resident value whose bit is clear,
+ * clearing the bits it passes. The store keeps every key and its metadata, and replaces an evicted value with one that
+ * loads the data from the log on demand.
+ *
+ * A read of an evicted value is a miss. The key is queued for promotion, and the thread waiting in
+ * wait_for_promotions() is woken up to bring the value back into memory (see take_promotions()), since the readers
+ * must not modify the store.
+ *
+ * The clock has a single writer at a time (the predicate thread, the log replay, or the promotion thread, which the
+ * store serializes), and concurrent readers. A read only looks the key up in a lock-free index and sets its bits, so
+ * the readers never take a lock unless they miss.
+ *
+ * @tparam KT   - the key type
+ */
+template <typename KT>
+class ResidencyClock {
+private:
+#define RESIDENCY_CLOCK_MAX_PROMOTIONS (256)
+    struct Entry {
+        std::atomic<bool> referenced;
+        std::atomic<bool> resident;
+        uint64_t bytes;
+        explicit Entry(uint64_t _bytes) : referenced(true), resident(true), bytes(_bytes) {}
+    };
+    using entry_map_t = std::map<KT, Entry>;
+    /* the entries are never erased, so the readers use them through the index. */
+    entry_map_t entries;
+    KVHashIndex<KT, Entry> entry_index;
+    /* the order of the clock hand. */
+    std::vector<typename entry_map_t::iterator> ring;
+    size_t hand;
+    const uint64_t budget_bytes;
+    /* only the writer updates the counters; they are atomic for get_stats(). */
+    std::atomic<uint64_t> num_keys;
+    std::atomic<uint64_t> resident_bytes;
+    std::atomic<uint64_t> num_resident_keys;
+
+    std::vector<KT> promotions;
+    bool interrupted;
+    mutable std::mutex promotion_mutex;
+    std::condition_variable promotion_cv;
+
+    mutable std::atomic<uint64_t> hits;
+    mutable std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> num_promoted;
+
+    /**
+     * Find the entry of a key. A caller other than the writer must hold an EpochManager::Guard.
+     */
+    Entry* find(const KT& key) const {
+        typename entry_map_t::iterator it;
+        if(!entry_index.lookup(key, it)) {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+public:
+    /**
+     * Record a read of a key. It is safe to call from any thread.
+     *
+     * @param key   - the key
+     *
+     * @return true if the value of the key is resident, false if it has been evicted or the key is unknown.
+     */
+    bool touch(const KT& key) {
+        bool resident = false;
+        {
+            EpochManager::Guard epoch_guard;
+            Entry* entry = find(key);
+            if(entry == nullptr) {
+                return false;
+            }
+            if(!entry->referenced.load(std::memory_order_relaxed)) {
+                entry->referenced.store(true, std::memory_order_relaxed);
+            }
+            resident = entry->resident.load(std::memory_order_relaxed);
+        }
+        if(resident) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lck(promotion_mutex);
+            if(promotions.size() < RESIDENCY_CLOCK_MAX_PROMOTIONS) {
+                promotions.push_back(key);
+                promotion_cv.notify_one();
+            }
+        }
+        return resident;
+    }
+
+    /**
+     * Record that a key has a resident value, either new or brought back into memory.
+     *
+     * @param key   - the key
+     * @param bytes - the memory held by the value
+     */
+    void admit(const KT& key, uint64_t bytes) {
+        Entry* entry = find(key);
+        if(entry == nullptr) {
+            auto it = entries.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(bytes)).first;
+            entry_index.put(it);
+            ring.push_back(it);
+            num_keys.fetch_add(1, std::memory_order_relaxed);
+            num_resident_keys.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            if(entry->resident.load(std::memory_order_relaxed)) {
+                resident_bytes.fetch_sub(entry->bytes, std::memory_order_relaxed);
+            } else {
+                entry->resident.store(true, std::memory_order_relaxed);
+                num_resident_keys.fetch_add(1, std::memory_order_relaxed);
+            }
+            entry->bytes = bytes;
+            entry->referenced.store(true, std::memory_order_relaxed);
+        }
+        resident_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return true if the resident values take more memory than the budget.
+     */
+    bool over_budget() const {
+        return resident_bytes.load(std::memory_order_relaxed) > budget_bytes;
+    }
+
+    /**
+     * Advance the clock hand to the next value to evict, and mark it evicted. The caller must evict the value.
+     *
+     * @param key   - the key of the value to evict is returned here.
+     *
+     * @return false if there is no value to evict.
+     */
+    bool next_victim(KT& key) {
+        // two rounds at most: the first round may only clear the referenced bits.
+        for(size_t step = 0; step < 2 * ring.size(); step++) {
+            auto it = ring[hand];
+            hand = (hand + 1) % ring.size();
+            Entry& entry = it->second;
+            if(!entry.resident.load(std::memory_order_relaxed) || entry.bytes == 0) {
+                continue;
+            }
+            if(entry.referenced.exchange(false, std::memory_order_relaxed)) {
+                continue;
+            }
+            entry.resident.store(false, std::memory_order_relaxed);
+            resident_bytes.fetch_sub(entry.bytes, std::memory_order_relaxed);
+            num_resident_keys.fetch_sub(1, std::memory_order_relaxed);
+            evictions.fetch_add(1, std::memory_order_relaxed);
+            key = it->first;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Wait until a read misses, or interrupt() is called.
+     *
+     * @return false if interrupted.
+     */
+    bool wait_for_promotions() {
+        std::unique_lock<std::mutex> lck(promotion_mutex);
+        promotion_cv.wait(lck, [this]() { return interrupted || !promotions.empty(); });
+        return !interrupted;
+    }
+
+    /**
+     * Wake up and stop the thread waiting for promotions.
+     */
+    void interrupt() {
+        std::lock_guard<std::mutex> lck(promotion_mutex);
+        interrupted = true;
+        promotion_cv.notify_all();
+    }
+
+    /**
+     * Take the keys whose evicted values were read since the last call.
+     *
+     * @return the keys, which may contain duplicates and keys whose values are resident again.
+     */
+    std::vector<KT> take_promotions() {
+        std::vector<KT> keys;
+        std::lock_guard<std::mutex> lck(promotion_mutex);
+        keys.swap(promotions);
+        return keys;
+    }
+
+    /**
+     * Count a value brought back into memory. admit() is called for it too.
+     */
+    void count_promotion() {
+        num_promoted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return true if the value of a key is resident. Only the writer calls it.
+     */
+    bool is_resident(const KT& key) const {
+        Entry* entry = find(key);
+        return entry != nullptr && entry->resident.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return the counters.
+     */
+    ResidencyStats get_stats() const {
+        return ResidencyStats{budget_bytes,
+                              resident_bytes.load(std::memory_order_relaxed),
+                              num_keys.load(std::memory_order_relaxed),
+                              num_resident_keys.load(std::memory_order_relaxed),
+                              hits.load(std::memory_order_relaxed),
+                              misses.load(std::memory_order_relaxed),
+                              evictions.load(std::memory_order_relaxed),
+                              num_promoted.load(std::memory_order_relaxed)};
+    }
+
+    /**
+     * @param budget_bytes  - the memory budget of the values.
+     */
+    explicit ResidencyClock(uint64_t _budget_bytes) : hand(0),
+                                                      budget_bytes(_budget_bytes),
+                                                      num_keys(0),
+                                                      resident_bytes(0),
+                                                      num_resident_keys(0),
+                                                      interrupted(false),
+                                                      hits(0),
+                                                      misses(0),
+                                                      evictions(0),
+                                                      num_promoted(0) {}
+    ResidencyClock(const ResidencyClock&) = delete;
+    ResidencyClock& operator=(const ResidencyClock&) = delete;
+    virtual ~ResidencyClock() {}
+};
+
+}  // namespace cascade
+}  // namespace derecho
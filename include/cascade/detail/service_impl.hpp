@@ -1,6 +1,7 @@
 #include <derecho/core/derecho_exception.hpp>
 #include <derecho/core/detail/rpc_utils.hpp>
 #include <derecho/core/notification.hpp>
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <typeindex>
@@ -146,15 +147,31 @@ std::unique_ptr<CascadeType> client_stub_factory() {
 template <typename... CascadeTypes>
 ServiceClient<CascadeTypes...>::ServiceClient(derecho::Group<CascadeMetadataService<CascadeTypes...>,CascadeTypes...>* _group_ptr):
     external_group_ptr(nullptr),
-    group_ptr(_group_ptr) {
+    group_ptr(_group_ptr),
+    metadata_change_count(0),
+    metadata_cache_stale(false),
+    metadata_sync_stopped(false) {
     if (group_ptr == nullptr) {
         this->external_group_ptr = 
             std::make_unique<derecho::ExternalGroupClient<CascadeMetadataService<CascadeTypes...>,CascadeTypes...>>(
                     client_stub_factory<CascadeMetadataService<CascadeTypes...>>,
                     client_stub_factory<CascadeTypes>...);
+        subscribe_object_pool_metadata_changes();
     } 
 }
 
+template <typename... CascadeTypes>
+ServiceClient<CascadeTypes...>::~ServiceClient() {
+    {
+        std::lock_guard<std::mutex> lck(metadata_sync_mutex);
+        metadata_sync_stopped = true;
+    }
+    metadata_sync_cv.notify_all();
+    if (metadata_sync_thread.joinable()) {
+        metadata_sync_thread.join();
+    }
+}
+
 template <typename... CascadeTypes>
 bool ServiceClient<CascadeTypes...>::is_external_client() const {
     return (group_ptr == nullptr) && (external_group_ptr != nullptr);
@@ -237,9 +254,14 @@ void ServiceClient<CascadeTypes...>::set_member_selection_policy(uint32_t subgro
         ShardMemberSelectionPolicy policy, node_id_t user_specified_node_id) {
     // write lock policies
     std::unique_lock wlck(this->member_selection_policies_mutex);
+    auto key = std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index);
     // update map
-    this->member_selection_policies[std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index)] =
-            std::make_tuple(policy,user_specified_node_id);
+    this->member_selection_policies[key] = std::make_tuple(policy,user_specified_node_id);
+    if (policy == ShardMemberSelectionPolicy::RoundRobin) {
+        this->round_robin_counters[key] = std::make_unique<std::atomic<uint32_t>>(static_cast<uint32_t>(user_specified_node_id+1));
+    } else {
+        this->round_robin_counters.erase(key);
+    }
 }
 
 template <typename... CascadeTypes>
@@ -257,39 +279,284 @@ std::tuple<ShardMemberSelectionPolicy,node_id_t> ServiceClient<CascadeTypes...>:
     }
 }
 
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::set_hedged_read_policy(bool enable, double percentile, uint64_t min_delay_us) {
+    hedged_reads.set_policy(enable,percentile,min_delay_us);
+}
+
+template <typename... CascadeTypes>
+HedgedReads::Stats ServiceClient<CascadeTypes...>::get_hedged_read_stats() const {
+    return hedged_reads.get_stats();
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::set_async_pipeline(uint32_t window_size, uint32_t completion_threads) {
+    async_pipeline.set_config(window_size,completion_threads);
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::wait_for_async_operations() {
+    async_pipeline.wait_all();
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::set_write_coalescing_policy(bool enable, std::size_t max_batch_bytes, uint64_t max_delay_us) {
+    write_combiner.set_policy(enable,max_batch_bytes,max_delay_us);
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::flush_coalesced_writes() {
+    write_combiner.flush_all();
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::flush_shard_coalesced_writes(uint32_t subgroup_index, uint32_t shard_index) {
+    write_combiner.flush_shard(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index);
+}
+
+template <typename... CascadeTypes>
+WriteCombiner::Stats ServiceClient<CascadeTypes...>::get_write_coalescing_stats() const {
+    return write_combiner.get_stats();
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::put_async(
+        const typename SubgroupType::ObjectType& value,
+        uint32_t subgroup_index,
+        uint32_t shard_index,
+        const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete) {
+    using ResultsType = derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>;
+    async_pipeline.submit<ResultsType>(
+            std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index),
+            [this,&value,subgroup_index,shard_index]() {
+                return this->template put<SubgroupType>(value,subgroup_index,shard_index);
+            },
+            on_complete);
+}
+
+template <typename... CascadeTypes>
+template <typename ObjectType>
+void ServiceClient<CascadeTypes...>::put_async(
+        const ObjectType& value,
+        const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete) {
+    // STEP 1 - get key
+    if constexpr (!std::is_base_of_v<ICascadeObject<std::string,ObjectType>,ObjectType>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports object of type ICascadeObject<std::string,ObjectType>,but we get ") + typeid(ObjectType).name());
+    }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::string cached_object_pool;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(value.get_key_ref(),cached_object_pool);
+    invalidate_cached_key(cached_object_pool,value.get_key_ref());
+
+    // STEP 3 - submit recursive put
+    using ResultsType = derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>;
+    async_pipeline.submit<ResultsType>(
+            std::make_tuple(subgroup_type_order.at(subgroup_type_index),subgroup_index,shard_index),
+            [this,&value,subgroup_type_index,subgroup_index,shard_index]() {
+                return this->template type_recursive_put<ObjectType,CascadeTypes...>(subgroup_type_index,value,subgroup_index,shard_index);
+            },
+            on_complete);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::remove_async(
+        const typename SubgroupType::KeyType& key,
+        uint32_t subgroup_index,
+        uint32_t shard_index,
+        const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete) {
+    using ResultsType = derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>;
+    async_pipeline.submit<ResultsType>(
+            std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index),
+            [this,&key,subgroup_index,shard_index]() {
+                return this->template remove<SubgroupType>(key,subgroup_index,shard_index);
+            },
+            on_complete);
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType>
+void ServiceClient<CascadeTypes...>::remove_async(
+        const KeyType& key,
+        const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete) {
+    // STEP 1 - get key
+    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
+    }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::string cached_object_pool;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key,cached_object_pool);
+    invalidate_cached_key(cached_object_pool,key);
+
+    // STEP 3 - submit recursive remove
+    using ResultsType = derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>;
+    async_pipeline.submit<ResultsType>(
+            std::make_tuple(subgroup_type_order.at(subgroup_type_index),subgroup_index,shard_index),
+            [this,&key,subgroup_type_index,subgroup_index,shard_index]() {
+                return this->template type_recursive_remove<KeyType,CascadeTypes...>(subgroup_type_index,key,subgroup_index,shard_index);
+            },
+            on_complete);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::get_async(
+        const typename SubgroupType::KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index,
+        const std::function<void(derecho::rpc::QueryResults<const typename SubgroupType::ObjectType>&)>& on_complete) {
+    using ResultsType = derecho::rpc::QueryResults<const typename SubgroupType::ObjectType>;
+    async_pipeline.submit<ResultsType>(
+            std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index),
+            [this,&key,&version,stable,subgroup_index,shard_index]() {
+                return this->template get<SubgroupType>(key,version,stable,subgroup_index,shard_index);
+            },
+            on_complete);
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename CompletionCallback>
+void ServiceClient<CascadeTypes...>::get_async(
+        const KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        const CompletionCallback& on_complete) {
+    // STEP 1 - get key
+    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
+    }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
+
+    // STEP 3 - submit recursive get
+    using ResultsType = decltype(this->template type_recursive_get<KeyType,CascadeTypes...>(
+            subgroup_type_index,key,version,stable,subgroup_index,shard_index));
+    async_pipeline.submit<ResultsType>(
+            std::make_tuple(subgroup_type_order.at(subgroup_type_index),subgroup_index,shard_index),
+            [this,&key,&version,stable,subgroup_type_index,subgroup_index,shard_index]() {
+                return this->template type_recursive_get<KeyType,CascadeTypes...>(subgroup_type_index,key,version,stable,subgroup_index,shard_index);
+            },
+            std::function<void(ResultsType&)>(on_complete));
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+node_id_t ServiceClient<CascadeTypes...>::pick_hedge_member(uint32_t subgroup_index,
+                                                             uint32_t shard_index,
+                                                             node_id_t primary_node_id) {
+    auto key = std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index);
+    std::vector<node_id_t> members;
+    {
+        std::shared_lock rlck(member_cache_mutex);
+        if (member_cache.find(key) != member_cache.end()) {
+            members = member_cache.at(key);
+        }
+    }
+    if (members.empty()) {
+        members = get_shard_members<SubgroupType>(subgroup_index,shard_index);
+    }
+    members.erase(std::remove(members.begin(),members.end(),primary_node_id),members.end());
+    if (members.empty()) {
+        return INVALID_NODE_ID;
+    }
+    return member_load_tracker.pick_lowest_latency(members);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType, typename ReplyType>
+derecho::rpc::QueryResults<ReplyType> ServiceClient<CascadeTypes...>::track_reply(uint32_t subgroup_index,
+                                                                                  uint32_t shard_index,
+                                                                                  node_id_t node_id,
+                                                                                  derecho::rpc::QueryResults<ReplyType>&& results) {
+    if (node_id == get_my_id()) {
+        return std::move(results);
+    }
+    // the duplicates of the hedged reads go to the member with the lowest latency, whatever the policy is.
+    if (!hedged_reads.is_enabled()) {
+        auto policy = std::get<0>(get_member_selection_policy<SubgroupType>(subgroup_index,shard_index));
+        if (policy != ShardMemberSelectionPolicy::LeastOutstanding && policy != ShardMemberSelectionPolicy::LatencyEWMA) {
+            return std::move(results);
+        }
+    }
+    bool tracked = false;
+    const uint64_t request_id = member_load_tracker.on_dispatch(node_id,&tracked);
+    if (!tracked) {
+        return std::move(results);
+    }
+    return reply_watcher.forward<ReplyType>(node_id,std::move(results),
+        [this,node_id,request_id](bool succeeded) {
+            member_load_tracker.on_reply(node_id,request_id,succeeded);
+        });
+}
+
+template <typename... CascadeTypes>
+HedgedReads::completion_t ServiceClient<CascadeTypes...>::track_hedged_request(node_id_t node_id) {
+    const uint64_t request_id = member_load_tracker.on_dispatch(node_id);
+    return [this,node_id,request_id](bool succeeded) {
+        member_load_tracker.on_reply(node_id,request_id,succeeded);
+    };
+}
+
 template <typename... CascadeTypes>
 template <typename SubgroupType>
 void ServiceClient<CascadeTypes...>::refresh_member_cache_entry(uint32_t subgroup_index,
                                                           uint32_t shard_index) {
     auto key = std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index);
     auto members = get_shard_members<SubgroupType>(subgroup_index,shard_index);
-    std::shared_lock rlck(member_cache_mutex);
-    if (member_cache.find(key) == member_cache.end()) {
-        rlck.unlock();
-        std::unique_lock wlck(member_cache_mutex);
-        member_cache[key] = members;
-    } else {
-        member_cache[key].swap(members);
-    }
+    // the requests to other shards read the cache concurrently.
+    std::unique_lock wlck(member_cache_mutex);
+    member_cache[key].swap(members);
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType>
+std::tuple<uint32_t,uint32_t,uint32_t> ServiceClient<CascadeTypes...>::key_to_shard(
+	    const KeyType& key,
+	    bool check_object_location) {
+    std::string cached_object_pool;
+    return key_to_shard(key,cached_object_pool,check_object_location);
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType>
 std::tuple<uint32_t,uint32_t,uint32_t> ServiceClient<CascadeTypes...>::key_to_shard(
 	    const KeyType& key,
+	    std::string& cached_object_pool,
 	    bool check_object_location) {
-    std::string object_pool_pathname = get_pathname<KeyType>(key);
+    // the pathname is a view of the key, see get_pathname().
+    std::string_view object_pool_pathname;
+    if constexpr (std::is_convertible_v<const KeyType&,std::string_view>) {
+        const std::string_view key_view(key);
+        const auto pos = key_view.rfind(PATH_SEPARATOR);
+        if (pos != std::string_view::npos) {
+            object_pool_pathname = key_view.substr(0,pos);
+        }
+    }
     if (object_pool_pathname.empty()) {
-        std::string exp_msg("Key:");
         throw derecho::derecho_exception(std::string("Key:") + key + " does not belong to any object pool.");
     }
 
-    auto opm = find_object_pool(object_pool_pathname);
-    if (!opm.is_valid() || opm.is_null() || opm.deleted) {
-        throw derecho::derecho_exception("Failed to find object_pool:" + object_pool_pathname);
+    auto opm = resolve_object_pool(object_pool_pathname);
+    if (!opm || !opm->is_valid() || opm->is_null() || opm->deleted) {
+        throw derecho::derecho_exception("Failed to find object_pool:" + std::string(object_pool_pathname));
+    }
+    // the read cache is looked up with the metadata resolved here, and only if it is in use.
+    cached_object_pool.clear();
+    if (read_cache.is_active() && read_cache.is_enabled(opm->pathname)) {
+        cached_object_pool = opm->pathname;
     }
-    return std::tuple<uint32_t,uint32_t,uint32_t>{opm.subgroup_type_index,opm.subgroup_index,
-        opm.key_to_shard_index(key,get_number_of_shards(opm.subgroup_type_index,opm.subgroup_index),check_object_location)};
+    return std::tuple<uint32_t,uint32_t,uint32_t>{opm->subgroup_type_index,opm->subgroup_index,
+        opm->key_to_shard_index(key,get_number_of_shards(opm->subgroup_type_index,opm->subgroup_index),check_object_location)};
 }
 
 template <typename... CascadeTypes>
@@ -308,12 +575,13 @@ node_id_t ServiceClient<CascadeTypes...>::pick_member_by_policy(uint32_t subgrou
 
     auto key = std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index);
 
+    std::shared_lock rlck(member_cache_mutex);
     if (member_cache.find(key) == member_cache.end() || retry) {
+        rlck.unlock();
         refresh_member_cache_entry<SubgroupType>(subgroup_index,shard_index);
+        rlck.lock();
     }
 
-    std::shared_lock rlck(member_cache_mutex);
-
     node_id_t node_id = last_specified_node_id_or_index;
 
     switch(policy) {
@@ -331,12 +599,31 @@ node_id_t ServiceClient<CascadeTypes...>::pick_member_by_policy(uint32_t subgrou
             node_id = member_cache.at(key)[get_time()%member_cache.at(key).size()]; // use time as random source.
         }
         break;
+    case ShardMemberSelectionPolicy::LeastOutstanding:
+        node_id = member_load_tracker.pick_least_outstanding(member_cache.at(key));
+        break;
+    case ShardMemberSelectionPolicy::LatencyEWMA:
+        node_id = member_load_tracker.pick_lowest_latency(member_cache.at(key));
+        break;
     case ShardMemberSelectionPolicy::RoundRobin:
         {
-            std::shared_lock rlck(member_selection_policies_mutex);
-            node_id = static_cast<uint32_t>(node_id+1)%member_cache.at(key).size();
-            auto new_policy = std::make_tuple(ShardMemberSelectionPolicy::RoundRobin,node_id);
-            member_selection_policies[key].swap(new_policy);
+            // the concurrent requests to this shard advance the counter atomically under the read lock.
+            std::shared_lock policy_rlck(member_selection_policies_mutex);
+            auto counter = round_robin_counters.find(key);
+            if (counter == round_robin_counters.end()) {
+                // the default policy has no counter until the first pick.
+                policy_rlck.unlock();
+                {
+                    std::unique_lock policy_wlck(member_selection_policies_mutex);
+                    round_robin_counters.emplace(key,std::make_unique<std::atomic<uint32_t>>(static_cast<uint32_t>(node_id+1)));
+                }
+                policy_rlck.lock();
+                counter = round_robin_counters.find(key);
+            }
+            // the policy may be changed in between, which leaves no counter.
+            const uint32_t next_index = (counter == round_robin_counters.end()) ? 0 :
+                                        counter->second->fetch_add(1,std::memory_order_relaxed);
+            node_id = next_index%member_cache.at(key).size();
         }
         node_id = member_cache.at(key)[node_id];
         break;
@@ -355,31 +642,33 @@ derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceCl
         const typename SubgroupType::ObjectType& value,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
             // ordered put as a shard member
+            auto lck = submission_locks.lock(get_my_id());
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             return subgroup_handle.template ordered_send<RPC_NAME(ordered_put)>(value);
         } else {
             // p2p put
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
             try {
                 // as a subgroup member
                 auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
-                return subgroup_handle.template p2p_send<RPC_NAME(put)>(node_id,value);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(put)>(node_id,value));
             } catch (derecho::invalid_subgroup_exception& ex) {
                 // as an external caller
                 auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-                return subgroup_handle.template p2p_send<RPC_NAME(put)>(node_id,value);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(put)>(node_id,value));
             }
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(put)>(node_id,value);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(put)>(node_id,value));
     }
 }
 
@@ -422,7 +711,9 @@ derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceCl
 
     // STEP 2 - get shard
     uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(value.get_key_ref());
+    std::string cached_object_pool;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(value.get_key_ref(),cached_object_pool);
+    invalidate_cached_key(cached_object_pool,value.get_key_ref());
 
     // STEP 3 - call recursive put
     return this->template type_recursive_put<ObjectType,CascadeTypes...>(subgroup_type_index,value,subgroup_index,shard_index);
@@ -434,14 +725,24 @@ void ServiceClient<CascadeTypes...>::put_and_forget(
         const typename SubgroupType::ObjectType& value,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    if (write_combiner.is_enabled()) {
+        write_combiner.add(std::make_tuple(std::type_index(typeid(SubgroupType)),subgroup_index,shard_index),
+                           value,mutils::bytes_size(value),
+                           [this,subgroup_index,shard_index](const std::vector<typename SubgroupType::ObjectType>& values) {
+                               this->template put_and_forget_batch<SubgroupType>(values,subgroup_index,shard_index);
+                           });
+        return;
+    }
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
             // do ordered put as a shard member (Replicated).
+            auto lck = submission_locks.lock(get_my_id());
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             subgroup_handle.template ordered_send<RPC_NAME(ordered_put_and_forget)>(value);
         } else {
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
             // do p2p put
             try{
                 // as a subgroup member
@@ -454,14 +755,51 @@ void ServiceClient<CascadeTypes...>::put_and_forget(
             }
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
         caller.template p2p_send<RPC_NAME(put_and_forget)>(node_id,value);
     }
 }
 
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::put_and_forget_batch(
+        const std::vector<typename SubgroupType::ObjectType>& values,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (!is_external_client()) {
+        if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+            // do ordered puts as a shard member (Replicated).
+            auto lck = submission_locks.lock(get_my_id());
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            for (const auto& value : values) {
+                subgroup_handle.template ordered_send<RPC_NAME(ordered_put_and_forget)>(value);
+            }
+        } else {
+            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
+            // do p2p put
+            try{
+                // as a subgroup member
+                auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+                subgroup_handle.template p2p_send<RPC_NAME(put_and_forget_batch)>(node_id,values);
+            } catch (derecho::invalid_subgroup_exception& ex) {
+                // as an external caller
+                auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+                subgroup_handle.template p2p_send<RPC_NAME(put_and_forget_batch)>(node_id,values);
+            }
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        caller.template p2p_send<RPC_NAME(put_and_forget_batch)>(node_id,values);
+    }
+}
+
 template <typename... CascadeTypes>
 template <typename ObjectType, typename FirstType, typename SecondType, typename... RestTypes>
 void ServiceClient<CascadeTypes...>::type_recursive_put_and_forget(
@@ -500,7 +838,9 @@ void ServiceClient<CascadeTypes...>::put_and_forget(const ObjectType& value) {
 
     // STEP 2 - get shard
     uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(value.get_key_ref());
+    std::string cached_object_pool;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(value.get_key_ref(),cached_object_pool);
+    invalidate_cached_key(cached_object_pool,value.get_key_ref());
 
     // STEP 3 - call recursive put_and_forget
     this->template type_recursive_put_and_forget<ObjectType,CascadeTypes...>(subgroup_type_index,value,subgroup_index,shard_index);
@@ -508,56 +848,63 @@ void ServiceClient<CascadeTypes...>::put_and_forget(const ObjectType& value) {
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::trigger_put(
-        const typename SubgroupType::ObjectType& value,
+derecho::rpc::QueryResults<std::vector<std::tuple<persistent::version_t,uint64_t>>> ServiceClient<CascadeTypes...>::put_batch(
+        const std::vector<typename SubgroupType::ObjectType>& values,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
-        if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index){
+        if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+            // ordered put as a shard member
+            auto lck = submission_locks.lock(get_my_id());
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
-            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-            dbg_default_trace("trigger_put to node {}",node_id);
-            return subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(node_id,value);
+            return subgroup_handle.template ordered_send<RPC_NAME(ordered_put_batch)>(values);
         } else {
-            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            // p2p put
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-            dbg_default_trace("trigger_put to node {}",node_id);
-            return subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(node_id,value);
+            auto lck = submission_locks.lock(node_id);
+            try {
+                // as a subgroup member
+                auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(put_batch)>(node_id,values));
+            } catch (derecho::invalid_subgroup_exception& ex) {
+                // as an external caller
+                auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(put_batch)>(node_id,values));
+            }
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        dbg_default_trace("trigger_put to node {}",node_id);
-        return caller.template p2p_send<RPC_NAME(trigger_put)>(node_id,value);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(put_batch)>(node_id,values));
     }
 }
 
 template <typename... CascadeTypes>
 template <typename ObjectType, typename FirstType, typename SecondType, typename... RestTypes>
-derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::type_recursive_trigger_put(
+derecho::rpc::QueryResults<std::vector<std::tuple<persistent::version_t,uint64_t>>> ServiceClient<CascadeTypes...>::type_recursive_put_batch(
         uint32_t type_index,
-        const ObjectType& value,
+        const std::vector<ObjectType>& values,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return trigger_put<FirstType>(value,subgroup_index,shard_index);
+        return this->template put_batch<FirstType>(values,subgroup_index,shard_index);
     } else {
-        return type_recursive_trigger_put<ObjectType,SecondType,RestTypes...>(type_index-1,value,subgroup_index,shard_index);
+        return this->template type_recursive_put_batch<ObjectType, SecondType, RestTypes...>(type_index-1,values,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename ObjectType, typename LastType>
-derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::type_recursive_trigger_put(
+derecho::rpc::QueryResults<std::vector<std::tuple<persistent::version_t,uint64_t>>> ServiceClient<CascadeTypes...>::type_recursive_put_batch(
         uint32_t type_index,
-        const ObjectType& value,
+        const std::vector<ObjectType>& values,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return trigger_put<LastType>(value,subgroup_index,shard_index);
+        return this->template put_batch<LastType>(values,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
@@ -565,126 +912,372 @@ derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::type_recursive_
 
 template <typename... CascadeTypes>
 template <typename ObjectType>
-derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::trigger_put(
-        const ObjectType& value) {
+std::vector<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::put_batch(
+        const std::vector<ObjectType>& values) {
     // STEP 1 - get key
     if constexpr (!std::is_base_of_v<ICascadeObject<std::string,ObjectType>,ObjectType>) {
         throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports object of type ICascadeObject<std::string,ObjectType>,but we get ") + typeid(ObjectType).name());
     }
 
-    // STEP 2 - get shard
-    uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(value.get_key_ref());
-
-    // STEP 3 - call recursive trigger_put
-    return this->template type_recursive_trigger_put<ObjectType,CascadeTypes...>(subgroup_type_index,value,subgroup_index,shard_index);
-}
+    // STEP 2 - group the objects by shard, remembering their positions.
+    std::map<std::tuple<uint32_t,uint32_t,uint32_t>,std::pair<std::vector<ObjectType>,std::vector<std::size_t>>> batches;
+    for (std::size_t i = 0; i < values.size(); i++) {
+        std::string cached_object_pool;
+        auto& batch = batches[this->template key_to_shard(values[i].get_key_ref(),cached_object_pool)];
+        batch.first.emplace_back(values[i]);
+        batch.second.emplace_back(i);
+        invalidate_cached_key(cached_object_pool,values[i].get_key_ref());
+    }
 
-template <typename... CascadeTypes>
-template <typename SubgroupType>
-void ServiceClient<CascadeTypes...>::collective_trigger_put(
-        const typename SubgroupType::ObjectType& value,
-        uint32_t subgroup_index,
-        std::unordered_map<node_id_t,std::unique_ptr<derecho::rpc::QueryResults<void>>>& nodes_and_futures) {
-    if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
-        if (group_ptr->template get_my_shard<SubgroupType>(subgroup_index) != -1) {
-            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
-            for (auto& kv: nodes_and_futures) {
-                nodes_and_futures[kv.first] = std::make_unique<derecho::rpc::QueryResults<void>>(
-                        std::move(subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(kv.first,value)));
-            }
-        } else {
-            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            for (auto& kv: nodes_and_futures) {
-                nodes_and_futures[kv.first] = std::make_unique<derecho::rpc::QueryResults<void>>(
-                        std::move(subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(kv.first,value)));
-            }
+    // STEP 3 - send a batch to each shard, and then wait for all of them.
+    std::vector<std::pair<derecho::rpc::QueryResults<std::vector<std::tuple<persistent::version_t,uint64_t>>>,const std::vector<std::size_t>*>> results;
+    for (auto& kv : batches) {
+        results.emplace_back(
+                this->template type_recursive_put_batch<ObjectType,CascadeTypes...>(
+                        std::get<0>(kv.first),kv.second.first,std::get<1>(kv.first),std::get<2>(kv.first)),
+                &kv.second.second);
+    }
+    std::vector<std::tuple<persistent::version_t,uint64_t>> ret(values.size(),{persistent::INVALID_VERSION,0});
+    for (auto& result : results) {
+        std::vector<std::tuple<persistent::version_t,uint64_t>> replies;
+        for (auto& reply : result.first.get()) {
+            replies = reply.second.get();
         }
-    } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
-        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
-        for (auto& kv: nodes_and_futures) {
-            nodes_and_futures[kv.first] = std::make_unique<derecho::rpc::QueryResults<void>>(
-                    std::move(caller.template p2p_send<RPC_NAME(trigger_put)>(kv.first,value)));
+        const auto& positions = *result.second;
+        for (std::size_t i = 0; i < positions.size() && i < replies.size(); i++) {
+            ret[positions[i]] = replies[i];
         }
     }
+    return ret;
 }
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::remove(
-        const typename SubgroupType::KeyType& key,
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::transact(
+        const std::vector<std::tuple<typename SubgroupType::KeyType,persistent::version_t>>& read_set,
+        const std::vector<typename SubgroupType::ObjectType>& write_set,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
-            // do ordered remove as a member (Replicated).
+            // ordered transact as a shard member
+            auto lck = submission_locks.lock(get_my_id());
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template ordered_send<RPC_NAME(ordered_remove)>(key);
+            return subgroup_handle.template ordered_send<RPC_NAME(ordered_transact)>(read_set,write_set);
         } else {
-            // do p2p remove
+            // p2p transact
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
             try {
                 // as a subgroup member
                 auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
-                return subgroup_handle.template p2p_send<RPC_NAME(remove)>(node_id,key);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(transact)>(node_id,read_set,write_set));
             } catch (derecho::invalid_subgroup_exception& ex) {
                 // as an external caller
                 auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-                return subgroup_handle.template p2p_send<RPC_NAME(remove)>(node_id,key);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(transact)>(node_id,read_set,write_set));
             }
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(remove)>(node_id,key);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(transact)>(node_id,read_set,write_set));
     }
 }
 
 template <typename... CascadeTypes>
-template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::type_recursive_remove(
+template <typename ObjectType, typename FirstType, typename SecondType, typename... RestTypes>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::type_recursive_transact(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<std::tuple<std::string,persistent::version_t>>& read_set,
+        const std::vector<ObjectType>& write_set,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template remove<FirstType>(key,subgroup_index,shard_index);
+        return this->template transact<FirstType>(read_set,write_set,subgroup_index,shard_index);
     } else {
-        return this->template type_recursive_remove<KeyType,SecondType,RestTypes...>(type_index-1,key,subgroup_index,shard_index);
+        return this->template type_recursive_transact<ObjectType, SecondType, RestTypes...>(type_index-1,read_set,write_set,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
-template <typename KeyType, typename LastType>
-derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::type_recursive_remove(
+template <typename ObjectType, typename LastType>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::type_recursive_transact(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<std::tuple<std::string,persistent::version_t>>& read_set,
+        const std::vector<ObjectType>& write_set,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template remove<LastType>(key,subgroup_index,shard_index);
+        return this->template transact<LastType>(read_set,write_set,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
 }
 
 template <typename... CascadeTypes>
-template <typename KeyType>
-derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::remove(
-        const KeyType& key) {
+template <typename ObjectType>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::transact(
+        const std::vector<std::tuple<std::string,persistent::version_t>>& read_set,
+        const std::vector<ObjectType>& write_set) {
     // STEP 1 - get key
-    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
-        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
+    if constexpr (!std::is_base_of_v<ICascadeObject<std::string,ObjectType>,ObjectType>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports object of type ICascadeObject<std::string,ObjectType>,but we get ") + typeid(ObjectType).name());
     }
 
-    // STEP 2 - get shard
-    uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
+    // STEP 2 - get shard, which must be the same for all keys.
+    std::optional<std::tuple<uint32_t,uint32_t,uint32_t>> shard;
+    std::string cached_object_pool;
+    auto check_shard = [this,&shard,&cached_object_pool](const std::string& key) {
+        auto key_shard = this->template key_to_shard(key,cached_object_pool);
+        if (!shard) {
+            shard = key_shard;
+        } else if (*shard != key_shard) {
+            throw derecho::derecho_exception("transact() cannot span shards, but key:" + key + " is in another shard.");
+        }
+    };
+    for (const auto& read : read_set) {
+        check_shard(std::get<0>(read));
+    }
+    for (const auto& value : write_set) {
+        check_shard(value.get_key_ref());
+        invalidate_cached_key(cached_object_pool,value.get_key_ref());
+    }
+    if (!shard) {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": the transaction is empty.");
+    }
+
+    // STEP 3 - call recursive transact
+    return this->template type_recursive_transact<ObjectType,CascadeTypes...>(
+            std::get<0>(*shard),read_set,write_set,std::get<1>(*shard),std::get<2>(*shard));
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::trigger_put(
+        const typename SubgroupType::ObjectType& value,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    // a trigger_put is not coalesced, because its caller waits for its future.
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
+    return this->template send_trigger_put<SubgroupType>(value,subgroup_index,shard_index);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::send_trigger_put(
+        const typename SubgroupType::ObjectType& value,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (!is_external_client()) {
+        if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index){
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
+            dbg_default_trace("trigger_put to node {}",node_id);
+            return subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(node_id,value);
+        } else {
+            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
+            dbg_default_trace("trigger_put to node {}",node_id);
+            return subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(node_id,value);
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        dbg_default_trace("trigger_put to node {}",node_id);
+        return caller.template p2p_send<RPC_NAME(trigger_put)>(node_id,value);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::trigger_put_batch(
+        const std::vector<typename SubgroupType::ObjectType>& values,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (!is_external_client()) {
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        dbg_default_trace("trigger_put_batch of {} objects to node {}",values.size(),node_id);
+        if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index){
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            return subgroup_handle.template p2p_send<RPC_NAME(trigger_put_batch)>(node_id,values);
+        } else {
+            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            return subgroup_handle.template p2p_send<RPC_NAME(trigger_put_batch)>(node_id,values);
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        dbg_default_trace("trigger_put_batch of {} objects to node {}",values.size(),node_id);
+        return caller.template p2p_send<RPC_NAME(trigger_put_batch)>(node_id,values);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename ObjectType, typename FirstType, typename SecondType, typename... RestTypes>
+derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::type_recursive_trigger_put(
+        uint32_t type_index,
+        const ObjectType& value,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return trigger_put<FirstType>(value,subgroup_index,shard_index);
+    } else {
+        return type_recursive_trigger_put<ObjectType,SecondType,RestTypes...>(type_index-1,value,subgroup_index,shard_index);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename ObjectType, typename LastType>
+derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::type_recursive_trigger_put(
+        uint32_t type_index,
+        const ObjectType& value,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return trigger_put<LastType>(value,subgroup_index,shard_index);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename ObjectType>
+derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::trigger_put(
+        const ObjectType& value) {
+    // STEP 1 - get key
+    if constexpr (!std::is_base_of_v<ICascadeObject<std::string,ObjectType>,ObjectType>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports object of type ICascadeObject<std::string,ObjectType>,but we get ") + typeid(ObjectType).name());
+    }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(value.get_key_ref());
+
+    // STEP 3 - call recursive trigger_put
+    return this->template type_recursive_trigger_put<ObjectType,CascadeTypes...>(subgroup_type_index,value,subgroup_index,shard_index);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::collective_trigger_put(
+        const typename SubgroupType::ObjectType& value,
+        uint32_t subgroup_index,
+        std::unordered_map<node_id_t,std::unique_ptr<derecho::rpc::QueryResults<void>>>& nodes_and_futures) {
+    if (!is_external_client()) {
+        if (group_ptr->template get_my_shard<SubgroupType>(subgroup_index) != -1) {
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            for (auto& kv: nodes_and_futures) {
+                auto lck = submission_locks.lock(kv.first);
+                nodes_and_futures[kv.first] = std::make_unique<derecho::rpc::QueryResults<void>>(
+                        std::move(subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(kv.first,value)));
+            }
+        } else {
+            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            for (auto& kv: nodes_and_futures) {
+                auto lck = submission_locks.lock(kv.first);
+                nodes_and_futures[kv.first] = std::make_unique<derecho::rpc::QueryResults<void>>(
+                        std::move(subgroup_handle.template p2p_send<RPC_NAME(trigger_put)>(kv.first,value)));
+            }
+        }
+    } else {
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        for (auto& kv: nodes_and_futures) {
+            auto lck = submission_locks.lock(kv.first);
+            nodes_and_futures[kv.first] = std::make_unique<derecho::rpc::QueryResults<void>>(
+                    std::move(caller.template p2p_send<RPC_NAME(trigger_put)>(kv.first,value)));
+        }
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::remove(
+        const typename SubgroupType::KeyType& key,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
+    if (!is_external_client()) {
+        if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+            // do ordered remove as a member (Replicated).
+            auto lck = submission_locks.lock(get_my_id());
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            return subgroup_handle.template ordered_send<RPC_NAME(ordered_remove)>(key);
+        } else {
+            // do p2p remove
+            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
+            try {
+                // as a subgroup member
+                auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(remove)>(node_id,key));
+            } catch (derecho::invalid_subgroup_exception& ex) {
+                // as an external caller
+                auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+                return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(remove)>(node_id,key));
+            }
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(remove)>(node_id,key));
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::type_recursive_remove(
+        uint32_t type_index,
+        const KeyType& key,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template remove<FirstType>(key,subgroup_index,shard_index);
+    } else {
+        return this->template type_recursive_remove<KeyType,SecondType,RestTypes...>(type_index-1,key,subgroup_index,shard_index);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename LastType>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::type_recursive_remove(
+        uint32_t type_index,
+        const KeyType& key,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template remove<LastType>(key,subgroup_index,shard_index);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::remove(
+        const KeyType& key) {
+    // STEP 1 - get key
+    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
+    }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::string cached_object_pool;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key,cached_object_pool);
+    invalidate_cached_key(cached_object_pool,key);
 
     // STEP 3 - call recursive remove
     return this->template type_recursive_remove<KeyType,CascadeTypes...>(subgroup_type_index,key,subgroup_index,shard_index);
@@ -698,93 +1291,730 @@ derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClien
         bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    node_id_t node_id = INVALID_NODE_ID;
+    return this->template get_from_member<SubgroupType>(node_id,key,version,stable,subgroup_index,shard_index);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClient<CascadeTypes...>::get_from_member(
+        node_id_t& node_id,
+        const typename SubgroupType::KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
+    if (!is_external_client()) {
+        node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        try {
+            // do p2p get as a subgroup member
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                node_id = group_ptr->get_my_id();
+                // local get
+                auto obj = subgroup_handle.get_ref().get(key,version,stable);
+                auto pending_results = std::make_shared<PendingResults<const typename SubgroupType::ObjectType>>();
+                pending_results->fulfill_map({node_id});
+                pending_results->set_value(node_id,obj);                     
+                auto query_results = pending_results->get_future();
+                return std::move(*query_results);
+            }
+            auto lck = submission_locks.lock(node_id);
+            if (hedged_reads.is_enabled()) {
+                return hedged_get<SubgroupType>(node_id,subgroup_handle.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false),
+                                                key,version,stable,subgroup_index,shard_index);
+            }
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false));
+        } catch (derecho::invalid_subgroup_exception& ex) {
+            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            auto lck = submission_locks.lock(node_id);
+            if (hedged_reads.is_enabled()) {
+                return hedged_get<SubgroupType>(node_id,subgroup_handle.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false),
+                                                key,version,stable,subgroup_index,shard_index);
+            }
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false));
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        if (hedged_reads.is_enabled()) {
+            return hedged_get<SubgroupType>(node_id,caller.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false),
+                                            key,version,stable,subgroup_index,shard_index);
+        }
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false)); 
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClient<CascadeTypes...>::hedged_get(
+        node_id_t node_id,
+        derecho::rpc::QueryResults<const typename SubgroupType::ObjectType>&& primary,
+        const typename SubgroupType::KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    using ReplyType = const typename SubgroupType::ObjectType;
+    return hedged_reads.read<ReplyType>(node_id,std::move(primary),track_hedged_request(node_id),
+        [this,node_id,key,version,stable,subgroup_index,shard_index](node_id_t& hedge_node_id,
+                                                                     HedgedReads::completion_t& hedge_completion) {
+            std::unique_ptr<derecho::rpc::QueryResults<ReplyType>> hedge;
+            hedge_node_id = pick_hedge_member<SubgroupType>(subgroup_index,shard_index,node_id);
+            if (hedge_node_id == INVALID_NODE_ID) {
+                return hedge;
+            }
+            if (!is_external_client()) {
+                auto lck = submission_locks.lock(hedge_node_id);
+                try {
+                    auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+                    hedge = std::make_unique<derecho::rpc::QueryResults<ReplyType>>(
+                            subgroup_handle.template p2p_send<RPC_NAME(get)>(hedge_node_id,key,version,stable,false));
+                } catch (derecho::invalid_subgroup_exception& ex) {
+                    auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+                    hedge = std::make_unique<derecho::rpc::QueryResults<ReplyType>>(
+                            subgroup_handle.template p2p_send<RPC_NAME(get)>(hedge_node_id,key,version,stable,false));
+                }
+                hedge_completion = track_hedged_request(hedge_node_id);
+            } else {
+                auto lck = submission_locks.lock(hedge_node_id);
+                auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+                hedge = std::make_unique<derecho::rpc::QueryResults<ReplyType>>(
+                        caller.template p2p_send<RPC_NAME(get)>(hedge_node_id,key,version,stable,false));
+                hedge_completion = track_hedged_request(hedge_node_id);
+            }
+            return hedge;
+        });
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClient<CascadeTypes...>::cached_get(
+        const std::string& object_pool_pathname,
+        const typename SubgroupType::KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    using ObjectType = typename SubgroupType::ObjectType;
+    bool cacheable = false;
+    auto object = read_cache.template lookup<ObjectType>(object_pool_pathname,key,version,stable,cacheable);
+    if (!cacheable) {
+        return this->template get<SubgroupType>(key,version,stable,subgroup_index,shard_index);
+    }
+    node_id_t node_id = get_my_id();
+    auto pending_results = std::make_shared<PendingResults<const ObjectType>>();
+    auto query_results = pending_results->get_future();
+    if (object) {
+        pending_results->fulfill_map({node_id});
+        pending_results->set_value(node_id,*object);
+        return std::move(*query_results);
+    }
+    // the reply is cached by the hook, called when it comes.
+    auto fill_cache = [this,object_pool_pathname,key,version,stable,pending_results](
+            node_id_t reply_node_id, std::future<const ObjectType>* reply) {
+        pending_results->fulfill_map({reply_node_id});
+        if (reply == nullptr) {
+            pending_results->set_exception(reply_node_id,std::make_exception_ptr(
+                    derecho::derecho_exception("The reply watcher has stopped.")));
+            return;
+        }
+        try {
+            auto object = std::make_shared<const ObjectType>(reply->get());
+            read_cache.fill(object_pool_pathname,key,version,stable,object,mutils::bytes_size(*object));
+            pending_results->set_value(reply_node_id,*object);
+        } catch (...) {
+            pending_results->set_exception(reply_node_id,std::current_exception());
+        }
+    };
+    try {
+        auto results = this->template get_from_member<SubgroupType>(node_id,key,version,stable,subgroup_index,shard_index);
+        if (node_id == get_my_id()) {
+            // a local get has replied already.
+            auto& replies = results.get();
+            if (replies.empty()) {
+                throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": no reply for key:" + key);
+            }
+            fill_cache(node_id,&replies.begin()->second);
+            return std::move(*query_results);
+        }
+        reply_watcher.watch<const ObjectType>(node_id,std::move(results),
+            [node_id,fill_cache](std::future<const ObjectType>* reply) {
+                fill_cache(node_id,reply);
+            });
+    } catch (...) {
+        pending_results->fulfill_map({node_id});
+        pending_results->set_exception(node_id,std::current_exception());
+    }
+    return std::move(*query_results);
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+auto ServiceClient<CascadeTypes...>::type_recursive_cached_get(
+        uint32_t type_index,
+        const std::string& object_pool_pathname,
+        const KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template cached_get<FirstType>(object_pool_pathname,key,version,stable,subgroup_index,shard_index);
+    } else {
+        return this->template type_recursive_cached_get<KeyType,SecondType,RestTypes...>(type_index-1,object_pool_pathname,key,version,stable,subgroup_index,shard_index);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename LastType>
+auto ServiceClient<CascadeTypes...>::type_recursive_cached_get(
+        uint32_t type_index,
+        const std::string& object_pool_pathname,
+        const KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template cached_get<LastType>(object_pool_pathname,key,version,stable,subgroup_index,shard_index);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClient<CascadeTypes...>::multi_get(
+        const typename SubgroupType::KeyType& key,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
+    if (!is_external_client()) {
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        try {
+            // do p2p multi_get as a subgroup member.
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                node_id = group_ptr->get_my_id();
+            }
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_get)>(node_id,key));
+        } catch (derecho::invalid_subgroup_exception& ex) {
+            // do p2p multi_get as an external caller.
+            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_get)>(node_id,key));
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(multi_get)>(node_id,key)); 
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+auto ServiceClient<CascadeTypes...>::type_recursive_get(
+        uint32_t type_index,
+        const KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template get<FirstType>(key,version,stable,subgroup_index,shard_index);
+    } else {
+        return this->template type_recursive_get<KeyType,SecondType,RestTypes...>(type_index-1,key,version,stable,subgroup_index,shard_index);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename LastType>
+auto ServiceClient<CascadeTypes...>::type_recursive_get(
+        uint32_t type_index,
+        const KeyType& key,
+        const persistent::version_t& version,
+        bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template get<LastType>(key,version,stable,subgroup_index,shard_index);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType>
+auto ServiceClient<CascadeTypes...>::get(
+        // const std::decay_t<typename std::result_of_t<decltype(&ObjectType::get_key_ref())>>& key,
+        const KeyType& key,
+        const persistent::version_t& version,
+        bool stable) {
+    // STEP 1 - get key
+    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
+    }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::string cached_object_pool;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key,cached_object_pool);
+
+    // STEP 3 - call recursive get, through the read cache if the object pool is cached.
+    if (!cached_object_pool.empty()) {
+        return this->template type_recursive_cached_get<KeyType,CascadeTypes...>(subgroup_type_index,cached_object_pool,key,version,stable,subgroup_index,shard_index);
+    }
+    return this->template type_recursive_get<KeyType,CascadeTypes...>(subgroup_type_index,key,version,stable,subgroup_index,shard_index);
+}
+
+template <typename... CascadeTypes>
+template <typename ObjectType>
+std::tuple<persistent::version_t,uint64_t> ServiceClient<CascadeTypes...>::put_stream(
+        const std::string& key,
+        const stream_reader_t& reader,
+        std::size_t chunk_size) {
+    if (chunk_size == 0) {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": chunk size must be positive.");
+    }
+    using ResultsType = derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>;
+    auto wait_for_put = [](ResultsType& results, const std::string& put_key) {
+        std::tuple<persistent::version_t,uint64_t> ret{persistent::INVALID_VERSION,0};
+        for (auto& reply : results.get()) {
+            ret = reply.second.get();
+        }
+        if (std::get<0>(ret) == persistent::INVALID_VERSION) {
+            throw derecho::derecho_exception("Failed to put key:" + put_key);
+        }
+        return ret;
+    };
+
+    // STEP 1 - find the previous upload, whose chunks are kept until the next one is committed.
+    const std::string manifest_key = StreamManifest::manifest_key(key);
+    std::unique_ptr<StreamManifest> previous_manifest;
+    for (auto& reply : this->get(manifest_key,CURRENT_VERSION,false).get()) {
+        auto object = reply.second.get();
+        if (object.is_valid() && !object.is_null()) {
+            previous_manifest = StreamManifest::from_blob(object.blob.bytes,object.blob.size);
+            if (!previous_manifest) {
+                dbg_default_warn("The manifest of key:{} is invalid, its chunks are left behind.", key);
+            }
+        }
+    }
+
+    // STEP 2 - put the chunks, with a window of in-flight puts.
+    StreamManifest manifest(0,chunk_size,get_my_id(),get_walltime(),
+                            previous_manifest ? previous_manifest->uploader_id : 0,
+                            previous_manifest ? previous_manifest->upload_time : 0,
+                            previous_manifest ? previous_manifest->num_chunks() : 0);
+    std::vector<uint8_t> buffer(chunk_size);
+    std::deque<std::pair<std::string,ResultsType>> in_flight;
+    std::tuple<persistent::version_t,uint64_t> ret;
+    try {
+        bool end_of_stream = false;
+        while (!end_of_stream) {
+            std::size_t filled = 0;
+            while (filled < chunk_size) {
+                const std::size_t bytes_read = reader(buffer.data() + filled,chunk_size - filled);
+                if (bytes_read == 0) {
+                    end_of_stream = true;
+                    break;
+                }
+                filled += bytes_read;
+            }
+            if (filled == 0) {
+                break;
+            }
+            if (in_flight.size() >= STREAM_MAX_CHUNKS_IN_FLIGHT) {
+                wait_for_put(in_flight.front().second,in_flight.front().first);
+                in_flight.pop_front();
+            }
+            const std::string chunk_key = manifest.chunk_key(key,manifest.num_chunks());
+            in_flight.emplace_back(chunk_key,this->put(ObjectType(chunk_key,buffer.data(),filled)));
+            manifest.total_size += filled;
+        }
+        while (!in_flight.empty()) {
+            wait_for_put(in_flight.front().second,in_flight.front().first);
+            in_flight.pop_front();
+        }
+
+        // STEP 3 - commit the manifest after all of its chunks.
+        std::vector<uint8_t> manifest_bytes(mutils::bytes_size(manifest));
+        mutils::to_bytes(manifest,manifest_bytes.data());
+        auto results = this->put(ObjectType(manifest_key,manifest_bytes.data(),manifest_bytes.size()));
+        ret = wait_for_put(results,manifest_key);
+    } catch (...) {
+        // the chunk being put may have been written as well.
+        remove_stream_chunks(key,manifest.uploader_id,manifest.upload_time,manifest.num_chunks() + 1);
+        throw;
+    }
+
+    // STEP 4 - remove the chunks of the upload the previous one replaced. The chunks of the previous upload are left
+    // for its readers, and removed by the next upload.
+    if (previous_manifest) {
+        remove_stream_chunks(key,previous_manifest->previous_uploader_id,previous_manifest->previous_upload_time,
+                             previous_manifest->previous_num_chunks);
+    }
+    return ret;
+}
+
+template <typename... CascadeTypes>
+std::size_t ServiceClient<CascadeTypes...>::get_stream(
+        const std::string& key,
+        const stream_writer_t& writer,
+        const persistent::version_t& version,
+        bool stable,
+        std::size_t offset,
+        std::size_t length) {
+    // STEP 1 - get the manifest.
+    std::unique_ptr<StreamManifest> manifest;
+    bool streamed = false;
+    for (auto& reply : this->get(StreamManifest::manifest_key(key),version,stable).get()) {
+        auto object = reply.second.get();
+        if (!object.is_valid() || object.is_null()) {
+            continue;
+        }
+        manifest = StreamManifest::from_blob(object.blob.bytes,object.blob.size);
+        if (!manifest) {
+            throw derecho::derecho_exception("The manifest of key:" + key + " is invalid.");
+        }
+        streamed = true;
+    }
+    if (!streamed) {
+        // the object is not streamed: pass its range as it is.
+        for (auto& reply : this->get(key,version,stable).get()) {
+            auto object = reply.second.get();
+            if (!object.is_valid() || object.is_null()) {
+                throw derecho::derecho_exception("Failed to find key:" + key);
+            }
+            if (offset >= object.blob.size) {
+                return 0;
+            }
+            const std::size_t range_length = std::min(length,object.blob.size - offset);
+            writer(object.blob.bytes + offset,range_length);
+            return range_length;
+        }
+        return 0;
+    }
+    if (offset >= manifest->total_size) {
+        return 0;
+    }
+    const uint64_t end = offset + std::min<uint64_t>(length,manifest->total_size - offset);
+
+    // STEP 2 - read the chunks of the range in order, with a window of in-flight gets.
+    using ResultsType = decltype(this->get(key,version,stable));
+    std::deque<std::pair<uint64_t,ResultsType>> in_flight;
+    uint64_t next_chunk = offset / manifest->chunk_size;
+    const uint64_t last_chunk = (end - 1) / manifest->chunk_size;
+    std::size_t delivered = 0;
+    while (next_chunk <= last_chunk || !in_flight.empty()) {
+        while (next_chunk <= last_chunk && in_flight.size() < STREAM_MAX_CHUNKS_IN_FLIGHT) {
+            // a chunk has only one version, which is committed before the manifest, but maybe not stable yet in its
+            // own shard.
+            in_flight.emplace_back(next_chunk,this->get(manifest->chunk_key(key,next_chunk),CURRENT_VERSION,false));
+            next_chunk ++;
+        }
+        auto& chunk = in_flight.front();
+        const uint64_t chunk_offset = chunk.first * manifest->chunk_size;
+        const uint64_t chunk_length = std::min<uint64_t>(manifest->chunk_size,manifest->total_size - chunk_offset);
+        for (auto& reply : chunk.second.get()) {
+            auto object = reply.second.get();
+            if (!object.is_valid() || object.is_null() || object.blob.size != chunk_length) {
+                throw derecho::derecho_exception("Chunk:" + std::to_string(chunk.first) + " of key:" + key +
+                                                 " is missing, the object has been replaced twice since.");
+            }
+            const uint64_t range_begin = std::max<uint64_t>(offset,chunk_offset) - chunk_offset;
+            const uint64_t range_end = std::min<uint64_t>(end,chunk_offset + chunk_length) - chunk_offset;
+            writer(object.blob.bytes + range_begin,range_end - range_begin);
+            delivered += range_end - range_begin;
+        }
+        in_flight.pop_front();
+    }
+    return delivered;
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::remove_stream_chunks(
+        const std::string& key,
+        uint64_t uploader_id,
+        uint64_t upload_time,
+        uint64_t num_chunks) {
+    using ResultsType = derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>;
+    auto wait_for_remove = [&key](ResultsType& results) {
+        try {
+            for (auto& reply : results.get()) {
+                reply.second.get();
+            }
+        } catch (const std::exception& ex) {
+            dbg_default_warn("Failed to remove a chunk of key:{}: {}", key, ex.what());
+        }
+    };
+    std::deque<ResultsType> in_flight;
+    for (uint64_t index = 0; index < num_chunks; index ++) {
+        if (in_flight.size() >= STREAM_MAX_CHUNKS_IN_FLIGHT) {
+            wait_for_remove(in_flight.front());
+            in_flight.pop_front();
+        }
+        try {
+            in_flight.emplace_back(this->remove(StreamManifest::chunk_key(key,uploader_id,upload_time,index)));
+        } catch (const std::exception& ex) {
+            dbg_default_warn("Failed to remove chunk:{} of key:{}: {}", index, key, ex.what());
+        }
+    }
+    for (auto& results : in_flight) {
+        wait_for_remove(results);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+auto ServiceClient<CascadeTypes...>::type_recursive_multi_get(
+        uint32_t type_index,
+        const KeyType& key,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template multi_get<FirstType>(key,subgroup_index,shard_index);
+    } else {
+        return this->template type_recursive_multi_get<KeyType,SecondType,RestTypes...>(type_index-1,key,subgroup_index,shard_index);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename LastType>
+auto ServiceClient<CascadeTypes...>::type_recursive_multi_get(
+        uint32_t type_index,
+        const KeyType& key,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template multi_get<LastType>(key,subgroup_index,shard_index);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType>
+auto ServiceClient<CascadeTypes...>::multi_get(
+        const KeyType& key) {
+    // STEP 1 - get key
+    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
+    }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
+
+    // STEP 3 - call recursive get
+    return this->template type_recursive_multi_get<KeyType,CascadeTypes...>(subgroup_type_index,key,subgroup_index,shard_index);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClient<CascadeTypes...>::get_by_time(
+        const typename SubgroupType::KeyType& key,
+        const uint64_t& ts_us,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
         try {
-            // do p2p get as a subgroup member
+            // do p2p get_by_time
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                // as a shard member.
                 node_id = group_ptr->get_my_id();
-                // local get
-                auto obj = subgroup_handle.get_ref().get(key,version,stable);
-                auto pending_results = std::make_shared<PendingResults<const typename SubgroupType::ObjectType>>();
-                pending_results->fulfill_map({node_id});
-                pending_results->set_value(node_id,obj);                     
-                auto query_results = pending_results->get_future();
-                return std::move(*query_results);
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_by_time)>(node_id,key,ts_us,stable));
         } catch (derecho::invalid_subgroup_exception& ex) {
+            // do p2p get_by_time as an external caller
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_by_time)>(node_id,key,ts_us,stable));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
-        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>();
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(get)>(node_id,key,version,stable,false); 
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get_by_time)>(node_id,key,ts_us,stable));
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+auto ServiceClient<CascadeTypes...>::type_recursive_get_by_time(
+        uint32_t type_index,
+        const KeyType& key,
+        const uint64_t& ts_us,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template get_by_time<FirstType>(key,ts_us,stable,subgroup_index,shard_index);
+    } else {
+        return this->template type_recursive_get_by_time<KeyType,SecondType,RestTypes...>(type_index-1,key,ts_us,stable,subgroup_index,shard_index);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename LastType>
+auto ServiceClient<CascadeTypes...>::type_recursive_get_by_time(
+        uint32_t type_index,
+        const KeyType& key,
+        const uint64_t& ts_us,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template get_by_time<LastType>(key,ts_us,stable,subgroup_index,shard_index);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType>
+auto ServiceClient<CascadeTypes...>::get_by_time(
+        const KeyType& key,
+        const uint64_t& ts_us,
+        const bool stable) {
+    // STEP 1 - get key
+    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
     }
+
+    // STEP 2 - get shard
+    uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
+
+    // STEP 3 - call recursive get_by_time
+    return this->template type_recursive_get_by_time<KeyType,CascadeTypes...>(subgroup_type_index,key,ts_us,stable,subgroup_index,shard_index);
 }
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClient<CascadeTypes...>::multi_get(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size(
         const typename SubgroupType::KeyType& key,
+        const persistent::version_t& version,
+        const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
         try {
-            // do p2p multi_get as a subgroup member.
+            // do p2p get_size as a subgroup_member
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                // as a shard member.
                 node_id = group_ptr->get_my_id();
+            } else if (hedged_reads.is_enabled()) {
+                return hedged_get_size<SubgroupType>(node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false),
+                                                     key,version,stable,subgroup_index,shard_index);
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(multi_get)>(node_id,key);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false));
         } catch (derecho::invalid_subgroup_exception& ex) {
-            // do p2p multi_get as an external caller.
+            // do p2p get_size as an external caller
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(multi_get)>(node_id,key);
+            if (hedged_reads.is_enabled()) {
+                return hedged_get_size<SubgroupType>(node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false),
+                                                     key,version,stable,subgroup_index,shard_index);
+            }
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(multi_get)>(node_id,key); 
+        auto lck = submission_locks.lock(node_id);
+        if (hedged_reads.is_enabled()) {
+            return hedged_get_size<SubgroupType>(node_id,caller.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false),
+                                                 key,version,stable,subgroup_index,shard_index);
+        }
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false));
     }
 }
 
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::hedged_get_size(
+        node_id_t node_id,
+        derecho::rpc::QueryResults<uint64_t>&& primary,
+        const typename SubgroupType::KeyType& key,
+        const persistent::version_t& version,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    return hedged_reads.read<uint64_t>(node_id,std::move(primary),track_hedged_request(node_id),
+        [this,node_id,key,version,stable,subgroup_index,shard_index](node_id_t& hedge_node_id,
+                                                                     HedgedReads::completion_t& hedge_completion) {
+            std::unique_ptr<derecho::rpc::QueryResults<uint64_t>> hedge;
+            hedge_node_id = pick_hedge_member<SubgroupType>(subgroup_index,shard_index,node_id);
+            if (hedge_node_id == INVALID_NODE_ID) {
+                return hedge;
+            }
+            if (!is_external_client()) {
+                auto lck = submission_locks.lock(hedge_node_id);
+                try {
+                    auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+                    hedge = std::make_unique<derecho::rpc::QueryResults<uint64_t>>(
+                            subgroup_handle.template p2p_send<RPC_NAME(get_size)>(hedge_node_id,key,version,stable,false));
+                } catch (derecho::invalid_subgroup_exception& ex) {
+                    auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+                    hedge = std::make_unique<derecho::rpc::QueryResults<uint64_t>>(
+                            subgroup_handle.template p2p_send<RPC_NAME(get_size)>(hedge_node_id,key,version,stable,false));
+                }
+                hedge_completion = track_hedged_request(hedge_node_id);
+            } else {
+                auto lck = submission_locks.lock(hedge_node_id);
+                auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+                hedge = std::make_unique<derecho::rpc::QueryResults<uint64_t>>(
+                        caller.template p2p_send<RPC_NAME(get_size)>(hedge_node_id,key,version,stable,false));
+                hedge_completion = track_hedged_request(hedge_node_id);
+            }
+            return hedge;
+        });
+}
+
 template <typename... CascadeTypes>
 template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-auto ServiceClient<CascadeTypes...>::type_recursive_get(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size(
         uint32_t type_index,
         const KeyType& key,
         const persistent::version_t& version,
-        bool stable,
+        const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get<FirstType>(key,version,stable,subgroup_index,shard_index);
+        return this->template get_size<FirstType>(key,version,stable,subgroup_index,shard_index);
     } else {
-        return this->template type_recursive_get<KeyType,SecondType,RestTypes...>(type_index-1,key,version,stable,subgroup_index,shard_index);
+        return this->template type_recursive_get_size<KeyType,SecondType,RestTypes...>(type_index-1,key,version,stable,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename LastType>
-auto ServiceClient<CascadeTypes...>::type_recursive_get(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size(
         uint32_t type_index,
         const KeyType& key,
         const persistent::version_t& version,
-        bool stable,
+        const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get<LastType>(key,version,stable,subgroup_index,shard_index);
+        return this->template get_size<LastType>(key,version,stable,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
@@ -792,12 +2022,11 @@ auto ServiceClient<CascadeTypes...>::type_recursive_get(
 
 template <typename... CascadeTypes>
 template <typename KeyType>
-auto ServiceClient<CascadeTypes...>::get(
-        // const std::decay_t<typename std::result_of_t<decltype(&ObjectType::get_key_ref())>>& key,
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size(
         const KeyType& key,
         const persistent::version_t& version,
-        bool stable) {
-    // STEP 1 - get key
+        const bool stable) {
+    // STEP 1 - verify the keys
     if constexpr (!std::is_convertible_v<KeyType,std::string>) {
         throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
     }
@@ -807,32 +2036,63 @@ auto ServiceClient<CascadeTypes...>::get(
     std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
 
     // STEP 3 - call recursive get
-    return this->template type_recursive_get<KeyType,CascadeTypes...>(subgroup_type_index,key,version,stable,subgroup_index,shard_index);
+    return this->template type_recursive_get_size<KeyType,CascadeTypes...>(subgroup_type_index,key,version,stable,subgroup_index,shard_index);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::multi_get_size(
+        const typename SubgroupType::KeyType& key,
+        uint32_t subgroup_index, uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
+    if (!is_external_client()) {
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        try {
+            // do p2p multi_get_size as a subgroup member.
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                node_id = group_ptr->get_my_id();
+            }
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_get_size)>(node_id,key));
+        } catch (derecho::invalid_subgroup_exception& ex) {
+            // do p2p multi_get_size as an external caller. 
+            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_get_size)>(node_id,key));
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(multi_get_size)>(node_id,key));
+    }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-auto ServiceClient<CascadeTypes...>::type_recursive_multi_get(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_multi_get_size(
         uint32_t type_index,
         const KeyType& key,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template multi_get<FirstType>(key,subgroup_index,shard_index);
+        return this->template multi_get_size<FirstType>(key,subgroup_index,shard_index);
     } else {
-        return this->template type_recursive_multi_get<KeyType,SecondType,RestTypes...>(type_index-1,key,subgroup_index,shard_index);
+        return this->template type_recursive_multi_get_size<KeyType,SecondType,RestTypes...>(type_index-1,key,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename LastType>
-auto ServiceClient<CascadeTypes...>::type_recursive_multi_get(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_multi_get_size(
         uint32_t type_index,
         const KeyType& key,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template multi_get<LastType>(key,subgroup_index,shard_index);
+        return this->template multi_get_size<LastType>(key,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
@@ -840,9 +2100,8 @@ auto ServiceClient<CascadeTypes...>::type_recursive_multi_get(
 
 template <typename... CascadeTypes>
 template <typename KeyType>
-auto ServiceClient<CascadeTypes...>::multi_get(
-        const KeyType& key) {
-    // STEP 1 - get key
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::multi_get_size(const KeyType& key) {
+    // STEP 1 - verify the keys
     if constexpr (!std::is_convertible_v<KeyType,std::string>) {
         throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
     }
@@ -852,45 +2111,46 @@ auto ServiceClient<CascadeTypes...>::multi_get(
     std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
 
     // STEP 3 - call recursive get
-    return this->template type_recursive_multi_get<KeyType,CascadeTypes...>(subgroup_type_index,key,subgroup_index,shard_index);
+    return this->template type_recursive_multi_get_size<KeyType,CascadeTypes...>(subgroup_type_index,key,subgroup_index,shard_index);
 }
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> ServiceClient<CascadeTypes...>::get_by_time(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size_by_time(
         const typename SubgroupType::KeyType& key,
         const uint64_t& ts_us,
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
         try {
-            // do p2p get_by_time
+            // do p2p get_size_by_time as a subgroup member.
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
-                // as a shard member.
                 node_id = group_ptr->get_my_id();
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(get_by_time)>(node_id,key,ts_us,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size_by_time)>(node_id,key,ts_us,stable));
         } catch (derecho::invalid_subgroup_exception& ex) {
-            // do p2p get_by_time as an external caller
+            // do p2p get_size_by_time as an external caller.
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(get_by_time)>(node_id,key,ts_us,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size_by_time)>(node_id,key,ts_us,stable));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
-        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>();
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(get_by_time)>(node_id,key,ts_us,stable);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get_size_by_time)>(node_id,key,ts_us,stable));
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-auto ServiceClient<CascadeTypes...>::type_recursive_get_by_time(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size_by_time(
         uint32_t type_index,
         const KeyType& key,
         const uint64_t& ts_us,
@@ -898,15 +2158,15 @@ auto ServiceClient<CascadeTypes...>::type_recursive_get_by_time(
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get_by_time<FirstType>(key,ts_us,stable,subgroup_index,shard_index);
+        return this->template get_size_by_time<FirstType>(key,ts_us,stable,subgroup_index,shard_index);
     } else {
-        return this->template type_recursive_get_by_time<KeyType,SecondType,RestTypes...>(type_index-1,key,ts_us,stable,subgroup_index,shard_index);
+        return this->template type_recursive_get_size_by_time<KeyType,SecondType,RestTypes...>(type_index-1,key,ts_us,stable,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename LastType>
-auto ServiceClient<CascadeTypes...>::type_recursive_get_by_time(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size_by_time(
         uint32_t type_index,
         const KeyType& key,
         const uint64_t& ts_us,
@@ -914,7 +2174,7 @@ auto ServiceClient<CascadeTypes...>::type_recursive_get_by_time(
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get_by_time<LastType>(key,ts_us,stable,subgroup_index,shard_index);
+        return this->template get_size_by_time<LastType>(key,ts_us,stable,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
@@ -922,11 +2182,11 @@ auto ServiceClient<CascadeTypes...>::type_recursive_get_by_time(
 
 template <typename... CascadeTypes>
 template <typename KeyType>
-auto ServiceClient<CascadeTypes...>::get_by_time(
+derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size_by_time(
         const KeyType& key,
         const uint64_t& ts_us,
         const bool stable) {
-    // STEP 1 - get key
+    // STEP 1 - verify the keys
     if constexpr (!std::is_convertible_v<KeyType,std::string>) {
         throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
     }
@@ -935,70 +2195,177 @@ auto ServiceClient<CascadeTypes...>::get_by_time(
     uint32_t subgroup_type_index,subgroup_index,shard_index;
     std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
 
-    // STEP 3 - call recursive get_by_time
-    return this->template type_recursive_get_by_time<KeyType,CascadeTypes...>(subgroup_type_index,key,ts_us,stable,subgroup_index,shard_index);
+    // STEP 3 - call recursive get
+    return this->template type_recursive_get_size_by_time<KeyType,CascadeTypes...>(subgroup_type_index,key,ts_us,stable,subgroup_index,shard_index);
 }
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size(
-        const typename SubgroupType::KeyType& key,
+derecho::rpc::QueryResults<std::vector<typename SubgroupType::ObjectType>> ServiceClient<CascadeTypes...>::get_many(
+        const std::vector<typename SubgroupType::KeyType>& keys,
         const persistent::version_t& version,
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
         try {
-            // do p2p get_size as a subgroup_member
+            // do p2p get_many as a subgroup member
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
-                // as a shard member.
                 node_id = group_ptr->get_my_id();
+                // local get_many
+                auto replies = subgroup_handle.get_ref().get_many(keys,version,stable);
+                auto pending_results = std::make_shared<PendingResults<std::vector<typename SubgroupType::ObjectType>>>();
+                pending_results->fulfill_map({node_id});
+                pending_results->set_value(node_id,replies);
+                auto query_results = pending_results->get_future();
+                return std::move(*query_results);
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_many)>(node_id,keys,version,stable));
         } catch (derecho::invalid_subgroup_exception& ex) {
-            // do p2p get_size as an external caller
+            // do p2p get_many as an external caller
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_many)>(node_id,keys,version,stable));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(get_size)>(node_id,key,version,stable,false);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get_many)>(node_id,keys,version,stable));
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size(
+auto ServiceClient<CascadeTypes...>::type_recursive_get_many(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<KeyType>& keys,
         const persistent::version_t& version,
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get_size<FirstType>(key,version,stable,subgroup_index,shard_index);
+        return this->template get_many<FirstType>(keys,version,stable,subgroup_index,shard_index);
     } else {
-        return this->template type_recursive_get_size<KeyType,SecondType,RestTypes...>(type_index-1,key,version,stable,subgroup_index,shard_index);
+        return this->template type_recursive_get_many<KeyType,SecondType,RestTypes...>(type_index-1,keys,version,stable,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename LastType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size(
+auto ServiceClient<CascadeTypes...>::type_recursive_get_many(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<KeyType>& keys,
+        const persistent::version_t& version,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template get_many<LastType>(keys,version,stable,subgroup_index,shard_index);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType>
+auto ServiceClient<CascadeTypes...>::get_many(
+        const std::vector<KeyType>& keys,
         const persistent::version_t& version,
+        const bool stable) {
+    // STEP 1 - verify the keys
+    if constexpr (!std::is_convertible_v<KeyType,std::string>) {
+        throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
+    }
+
+    // STEP 2 - group the keys by shard, remembering their positions.
+    auto batches = this->template group_keys_by_shard<KeyType>(keys);
+
+    // STEP 3 - send the keys to each shard, and then wait for all of them.
+    using ResultsType = decltype(this->template type_recursive_get_many<KeyType,CascadeTypes...>(0,keys,version,stable,0,0));
+    std::vector<std::pair<ResultsType,const std::vector<std::size_t>*>> results;
+    for (auto& kv : batches) {
+        results.emplace_back(
+                this->template type_recursive_get_many<KeyType,CascadeTypes...>(
+                        std::get<0>(kv.first),kv.second.first,version,stable,std::get<1>(kv.first),std::get<2>(kv.first)),
+                &kv.second.second);
+    }
+    return scatter_replies(results,keys.size());
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+derecho::rpc::QueryResults<std::vector<typename SubgroupType::ObjectType>> ServiceClient<CascadeTypes...>::get_many_by_time(
+        const std::vector<typename SubgroupType::KeyType>& keys,
+        const uint64_t& ts_us,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
+    if (!is_external_client()) {
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        try {
+            // do p2p get_many_by_time as a subgroup member
+            auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+            if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                node_id = group_ptr->get_my_id();
+                // local get_many_by_time
+                auto replies = subgroup_handle.get_ref().get_many_by_time(keys,ts_us,stable);
+                auto pending_results = std::make_shared<PendingResults<std::vector<typename SubgroupType::ObjectType>>>();
+                pending_results->fulfill_map({node_id});
+                pending_results->set_value(node_id,replies);
+                auto query_results = pending_results->get_future();
+                return std::move(*query_results);
+            }
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_many_by_time)>(node_id,keys,ts_us,stable));
+        } catch (derecho::invalid_subgroup_exception& ex) {
+            // do p2p get_many_by_time as an external caller
+            auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_many_by_time)>(node_id,keys,ts_us,stable));
+        }
+    } else {
+        // call as an external client (ExternalClientCaller).
+        auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+        node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get_many_by_time)>(node_id,keys,ts_us,stable));
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+auto ServiceClient<CascadeTypes...>::type_recursive_get_many_by_time(
+        uint32_t type_index,
+        const std::vector<KeyType>& keys,
+        const uint64_t& ts_us,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    if (type_index == 0) {
+        return this->template get_many_by_time<FirstType>(keys,ts_us,stable,subgroup_index,shard_index);
+    } else {
+        return this->template type_recursive_get_many_by_time<KeyType,SecondType,RestTypes...>(type_index-1,keys,ts_us,stable,subgroup_index,shard_index);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename KeyType, typename LastType>
+auto ServiceClient<CascadeTypes...>::type_recursive_get_many_by_time(
+        uint32_t type_index,
+        const std::vector<KeyType>& keys,
+        const uint64_t& ts_us,
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get_size<LastType>(key,version,stable,subgroup_index,shard_index);
+        return this->template get_many_by_time<LastType>(keys,ts_us,stable,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
@@ -1006,75 +2373,98 @@ derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recurs
 
 template <typename... CascadeTypes>
 template <typename KeyType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size(
-        const KeyType& key,
-        const persistent::version_t& version,
+auto ServiceClient<CascadeTypes...>::get_many_by_time(
+        const std::vector<KeyType>& keys,
+        const uint64_t& ts_us,
         const bool stable) {
     // STEP 1 - verify the keys
     if constexpr (!std::is_convertible_v<KeyType,std::string>) {
         throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
     }
 
-    // STEP 2 - get shard
-    uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
-
-    // STEP 3 - call recursive get
-    return this->template type_recursive_get_size<KeyType,CascadeTypes...>(subgroup_type_index,key,version,stable,subgroup_index,shard_index);
+    // STEP 2 - group the keys by shard, remembering their positions.
+    auto batches = this->template group_keys_by_shard<KeyType>(keys);
+
+    // STEP 3 - send the keys to each shard, and then wait for all of them.
+    using ResultsType = decltype(this->template type_recursive_get_many_by_time<KeyType,CascadeTypes...>(0,keys,ts_us,stable,0,0));
+    std::vector<std::pair<ResultsType,const std::vector<std::size_t>*>> results;
+    for (auto& kv : batches) {
+        results.emplace_back(
+                this->template type_recursive_get_many_by_time<KeyType,CascadeTypes...>(
+                        std::get<0>(kv.first),kv.second.first,ts_us,stable,std::get<1>(kv.first),std::get<2>(kv.first)),
+                &kv.second.second);
+    }
+    return scatter_replies(results,keys.size());
 }
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::multi_get_size(
-        const typename SubgroupType::KeyType& key,
-        uint32_t subgroup_index, uint32_t shard_index) {
+derecho::rpc::QueryResults<std::vector<uint64_t>> ServiceClient<CascadeTypes...>::get_size_many(
+        const std::vector<typename SubgroupType::KeyType>& keys,
+        const persistent::version_t& version,
+        const bool stable,
+        uint32_t subgroup_index,
+        uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
         try {
-            // do p2p multi_get_size as a subgroup member.
+            // do p2p get_size_many as a subgroup member
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
                 node_id = group_ptr->get_my_id();
+                // local get_size_many
+                auto replies = subgroup_handle.get_ref().get_size_many(keys,version,stable);
+                auto pending_results = std::make_shared<PendingResults<std::vector<uint64_t>>>();
+                pending_results->fulfill_map({node_id});
+                pending_results->set_value(node_id,replies);
+                auto query_results = pending_results->get_future();
+                return std::move(*query_results);
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(multi_get_size)>(node_id,key);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size_many)>(node_id,keys,version,stable));
         } catch (derecho::invalid_subgroup_exception& ex) {
-            // do p2p multi_get_size as an external caller. 
+            // do p2p get_size_many as an external caller
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(multi_get_size)>(node_id,key);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size_many)>(node_id,keys,version,stable));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(multi_get_size)>(node_id,key);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get_size_many)>(node_id,keys,version,stable));
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_multi_get_size(
+auto ServiceClient<CascadeTypes...>::type_recursive_get_size_many(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<KeyType>& keys,
+        const persistent::version_t& version,
+        const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template multi_get_size<FirstType>(key,subgroup_index,shard_index);
+        return this->template get_size_many<FirstType>(keys,version,stable,subgroup_index,shard_index);
     } else {
-        return this->template type_recursive_multi_get_size<KeyType,SecondType,RestTypes...>(type_index-1,key,subgroup_index,shard_index);
+        return this->template type_recursive_get_size_many<KeyType,SecondType,RestTypes...>(type_index-1,keys,version,stable,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename LastType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_multi_get_size(
+auto ServiceClient<CascadeTypes...>::type_recursive_get_size_many(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<KeyType>& keys,
+        const persistent::version_t& version,
+        const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template multi_get_size<LastType>(key,subgroup_index,shard_index);
+        return this->template get_size_many<LastType>(keys,version,stable,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
@@ -1082,79 +2472,98 @@ derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recurs
 
 template <typename... CascadeTypes>
 template <typename KeyType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::multi_get_size(const KeyType& key) {
+std::vector<uint64_t> ServiceClient<CascadeTypes...>::get_size_many(
+        const std::vector<KeyType>& keys,
+        const persistent::version_t& version,
+        const bool stable) {
     // STEP 1 - verify the keys
     if constexpr (!std::is_convertible_v<KeyType,std::string>) {
         throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
     }
 
-    // STEP 2 - get shard
-    uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
-
-    // STEP 3 - call recursive get
-    return this->template type_recursive_multi_get_size<KeyType,CascadeTypes...>(subgroup_type_index,key,subgroup_index,shard_index);
+    // STEP 2 - group the keys by shard, remembering their positions.
+    auto batches = this->template group_keys_by_shard<KeyType>(keys);
+
+    // STEP 3 - send the keys to each shard, and then wait for all of them.
+    using ResultsType = decltype(this->template type_recursive_get_size_many<KeyType,CascadeTypes...>(0,keys,version,stable,0,0));
+    std::vector<std::pair<ResultsType,const std::vector<std::size_t>*>> results;
+    for (auto& kv : batches) {
+        results.emplace_back(
+                this->template type_recursive_get_size_many<KeyType,CascadeTypes...>(
+                        std::get<0>(kv.first),kv.second.first,version,stable,std::get<1>(kv.first),std::get<2>(kv.first)),
+                &kv.second.second);
+    }
+    return scatter_replies(results,keys.size());
 }
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size_by_time(
-        const typename SubgroupType::KeyType& key,
+derecho::rpc::QueryResults<std::vector<uint64_t>> ServiceClient<CascadeTypes...>::get_size_many_by_time(
+        const std::vector<typename SubgroupType::KeyType>& keys,
         const uint64_t& ts_us,
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
         try {
-            // do p2p get_size_by_time as a subgroup member.
+            // do p2p get_size_many_by_time as a subgroup member
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
                 node_id = group_ptr->get_my_id();
+                // local get_size_many_by_time
+                auto replies = subgroup_handle.get_ref().get_size_many_by_time(keys,ts_us,stable);
+                auto pending_results = std::make_shared<PendingResults<std::vector<uint64_t>>>();
+                pending_results->fulfill_map({node_id});
+                pending_results->set_value(node_id,replies);
+                auto query_results = pending_results->get_future();
+                return std::move(*query_results);
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(get_size_by_time)>(node_id,key,ts_us,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size_many_by_time)>(node_id,keys,ts_us,stable));
         } catch (derecho::invalid_subgroup_exception& ex) {
-            // do p2p get_size_by_time as an external caller.
+            // do p2p get_size_many_by_time as an external caller
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(get_size_by_time)>(node_id,key,ts_us,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(get_size_many_by_time)>(node_id,keys,ts_us,stable));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(get_size_by_time)>(node_id,key,ts_us,stable);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(get_size_many_by_time)>(node_id,keys,ts_us,stable));
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size_by_time(
+auto ServiceClient<CascadeTypes...>::type_recursive_get_size_many_by_time(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<KeyType>& keys,
         const uint64_t& ts_us,
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get_size_by_time<FirstType>(key,ts_us,stable,subgroup_index,shard_index);
+        return this->template get_size_many_by_time<FirstType>(keys,ts_us,stable,subgroup_index,shard_index);
     } else {
-        return this->template type_recursive_get_size_by_time<KeyType,SecondType,RestTypes...>(type_index-1,key,ts_us,stable,subgroup_index,shard_index);
+        return this->template type_recursive_get_size_many_by_time<KeyType,SecondType,RestTypes...>(type_index-1,keys,ts_us,stable,subgroup_index,shard_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename KeyType, typename LastType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recursive_get_size_by_time(
+auto ServiceClient<CascadeTypes...>::type_recursive_get_size_many_by_time(
         uint32_t type_index,
-        const KeyType& key,
+        const std::vector<KeyType>& keys,
         const uint64_t& ts_us,
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
     if (type_index == 0) {
-        return this->template get_size_by_time<LastType>(key,ts_us,stable,subgroup_index,shard_index);
+        return this->template get_size_many_by_time<LastType>(keys,ts_us,stable,subgroup_index,shard_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
@@ -1162,8 +2571,8 @@ derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::type_recurs
 
 template <typename... CascadeTypes>
 template <typename KeyType>
-derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size_by_time(
-        const KeyType& key,
+std::vector<uint64_t> ServiceClient<CascadeTypes...>::get_size_many_by_time(
+        const std::vector<KeyType>& keys,
         const uint64_t& ts_us,
         const bool stable) {
     // STEP 1 - verify the keys
@@ -1171,12 +2580,55 @@ derecho::rpc::QueryResults<uint64_t> ServiceClient<CascadeTypes...>::get_size_by
         throw derecho::derecho_exception(__PRETTY_FUNCTION__ + std::string(" only supports string key,but we get ") + typeid(KeyType).name());
     }
 
-    // STEP 2 - get shard
-    uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(key);
+    // STEP 2 - group the keys by shard, remembering their positions.
+    auto batches = this->template group_keys_by_shard<KeyType>(keys);
+
+    // STEP 3 - send the keys to each shard, and then wait for all of them.
+    using ResultsType = decltype(this->template type_recursive_get_size_many_by_time<KeyType,CascadeTypes...>(0,keys,ts_us,stable,0,0));
+    std::vector<std::pair<ResultsType,const std::vector<std::size_t>*>> results;
+    for (auto& kv : batches) {
+        results.emplace_back(
+                this->template type_recursive_get_size_many_by_time<KeyType,CascadeTypes...>(
+                        std::get<0>(kv.first),kv.second.first,ts_us,stable,std::get<1>(kv.first),std::get<2>(kv.first)),
+                &kv.second.second);
+    }
+    return scatter_replies(results,keys.size());
+}
 
-    // STEP 3 - call recursive get
-    return this->template type_recursive_get_size_by_time<KeyType,CascadeTypes...>(subgroup_type_index,key,ts_us,stable,subgroup_index,shard_index);
+template <typename... CascadeTypes>
+template <typename KeyType>
+std::map<std::tuple<uint32_t,uint32_t,uint32_t>,std::pair<std::vector<KeyType>,std::vector<std::size_t>>>
+ServiceClient<CascadeTypes...>::group_keys_by_shard(const std::vector<KeyType>& keys) {
+    std::map<std::tuple<uint32_t,uint32_t,uint32_t>,std::pair<std::vector<KeyType>,std::vector<std::size_t>>> batches;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        auto& batch = batches[this->template key_to_shard(keys[i])];
+        batch.first.emplace_back(keys[i]);
+        batch.second.emplace_back(i);
+    }
+    return batches;
+}
+
+template <typename... CascadeTypes>
+template <typename ReplyType>
+std::vector<ReplyType> ServiceClient<CascadeTypes...>::scatter_replies(
+        std::vector<std::pair<derecho::rpc::QueryResults<std::vector<ReplyType>>,const std::vector<std::size_t>*>>& results,
+        std::size_t num_keys) {
+    std::vector<ReplyType> ret(num_keys);
+    for (auto& result : results) {
+        std::vector<ReplyType> replies;
+        for (auto& reply : result.first.get()) {
+            replies = reply.second.get();
+        }
+        const auto& positions = *result.second;
+        if (replies.size() != positions.size()) {
+            throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": expecting " + std::to_string(positions.size())
+                                             + " replies, but got " + std::to_string(replies.size()) + ".");
+        }
+        for (std::size_t i = 0; i < positions.size(); i++) {
+            ret[positions[i]] = std::move(replies[i]);
+        }
+    }
+    return ret;
 }
 
 template <typename... CascadeTypes>
@@ -1186,8 +2638,8 @@ derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>> ServiceC
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
         try {
             // do p2p list_keys as a subgroup member.
@@ -1195,18 +2647,20 @@ derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>> ServiceC
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
                 node_id = group_ptr->get_my_id();
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,"",version,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,"",version,stable));
         } catch (derecho::invalid_subgroup_exception& ex) {
             // do p2p list_keys as an external client.
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,"",version,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,"",version,stable));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(list_keys)>(node_id,"",version,stable);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(list_keys)>(node_id,"",version,stable));
     }
 }
 
@@ -1244,14 +2698,16 @@ std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename Subg
         const persistent::version_t& version,
         const bool stable,
         const std::string& object_pool_pathname){
-    auto opm = find_object_pool(object_pool_pathname);
-    if (!opm.is_valid() || opm.is_null() || opm.deleted) {
+    auto opm = resolve_object_pool(object_pool_pathname);
+    if (!opm || !opm->is_valid() || opm->is_null() || opm->deleted) {
         throw derecho::derecho_exception("Failed to find object_pool:" + object_pool_pathname);
     }
-    uint32_t subgroup_index = opm.subgroup_index;
+    uint32_t subgroup_index = opm->subgroup_index;
     uint32_t shards = get_number_of_shards<SubgroupType>(subgroup_index);
     std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>> result;
-    for (uint32_t shard_index = 0; shard_index < shards; shard_index ++){
+    // with the RANGE sharding policy, only the shards overlapping the object pool are listed.
+    for (uint32_t shard_index : opm->prefix_to_shard_indexes(object_pool_pathname,shards)) {
+        flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
         if (!is_external_client()) {
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
             try {
@@ -1259,18 +2715,20 @@ std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename Subg
                 if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
                     node_id = group_ptr->get_my_id();
                 }
-                auto shard_keys = subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,object_pool_pathname,version,stable);
+                auto lck = submission_locks.lock(node_id);
+                auto shard_keys = track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,object_pool_pathname,version,stable));
                 result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
             } catch (derecho::invalid_subgroup_exception& ex) {
                 auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-                auto shard_keys= subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,object_pool_pathname,version,stable);
+                auto lck = submission_locks.lock(node_id);
+                auto shard_keys= track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys)>(node_id,object_pool_pathname,version,stable));
                 result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
             }
         } else {
-            std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
             auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-            auto shard_keys = caller.template p2p_send<RPC_NAME(list_keys)>(node_id,object_pool_pathname,version,stable);
+            auto lck = submission_locks.lock(node_id);
+            auto shard_keys = track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(list_keys)>(node_id,object_pool_pathname,version,stable));
             result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
         }
     }
@@ -1305,8 +2763,11 @@ std::vector<KeyType> ServiceClient<CascadeTypes...>::wait_list_keys(
     std::vector<KeyType> result;
     // iterate over each shard's Query result
     for(auto& query_result: future){
-        std::vector<KeyType> reply = wait_for_future<std::vector<KeyType>>(*(query_result.get()));
-        std::move(reply.begin(), reply.end(), std::back_inserter(result));
+        for (auto& reply_future: query_result->get()) {
+            std::vector<KeyType> reply = reply_future.second.get();
+            std::move(reply.begin(), reply.end(), std::back_inserter(result));
+            break;
+        }
     }
     return result;
 }
@@ -1316,8 +2777,8 @@ template <typename SubgroupType>
 derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>> ServiceClient<CascadeTypes...>::multi_list_keys(
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
         try {
             // do p2p multi_list_keys as a subgroup member.
@@ -1325,19 +2786,21 @@ derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>> ServiceC
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
                 node_id = group_ptr->get_my_id();
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,"");
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,""));
         } catch (derecho::invalid_subgroup_exception& ex) {
             // do p2p multi_list_keys as an external client.
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,"");
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,""));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,"");
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,""));
     }
 }
 
@@ -1368,14 +2831,16 @@ auto ServiceClient<CascadeTypes...>::type_recursive_multi_list_keys (
 template <typename... CascadeTypes>
 template <typename SubgroupType>
 std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>> ServiceClient<CascadeTypes...>::__multi_list_keys(const std::string& object_pool_pathname) {
-    auto opm = find_object_pool(object_pool_pathname);
-    if (!opm.is_valid() || opm.is_null() || opm.deleted) {
+    auto opm = resolve_object_pool(object_pool_pathname);
+    if (!opm || !opm->is_valid() || opm->is_null() || opm->deleted) {
         throw derecho::derecho_exception("Failed to find object_pool:" + object_pool_pathname);
     }
-    uint32_t subgroup_index = opm.subgroup_index;
+    uint32_t subgroup_index = opm->subgroup_index;
     uint32_t shards = get_number_of_shards<SubgroupType>(subgroup_index);
     std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>> result;
-    for (uint32_t shard_index = 0; shard_index < shards; shard_index ++){
+    // with the RANGE sharding policy, only the shards overlapping the object pool are listed.
+    for (uint32_t shard_index : opm->prefix_to_shard_indexes(object_pool_pathname,shards)) {
+        flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
         if (!is_external_client()) {
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
             try {
@@ -1383,18 +2848,20 @@ std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename Subg
                 if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
                     node_id = group_ptr->get_my_id();
                 }
-                auto shard_keys = subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,object_pool_pathname);
+                auto lck = submission_locks.lock(node_id);
+                auto shard_keys = track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,object_pool_pathname));
                 result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
             } catch (derecho::invalid_subgroup_exception& ex) {
                 auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-                auto shard_keys= subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,object_pool_pathname);
+                auto lck = submission_locks.lock(node_id);
+                auto shard_keys= track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,object_pool_pathname));
                 result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
             }
         } else {
-            std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
             auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-            auto shard_keys = caller.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,object_pool_pathname);
+            auto lck = submission_locks.lock(node_id);
+            auto shard_keys = track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(multi_list_keys)>(node_id,object_pool_pathname));
             result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
         }
     }
@@ -1415,8 +2882,8 @@ derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>> ServiceC
         const bool stable,
         uint32_t subgroup_index,
         uint32_t shard_index) {
+    flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
         try {
             // do p2p list_keys_by_time as a subgroup member
@@ -1424,144 +2891,547 @@ derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>> ServiceC
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
                 node_id = group_ptr->get_my_id();
             }
-            return subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,"",ts_us,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,"",ts_us,stable));
         } catch (derecho::invalid_subgroup_exception& ex) {
             // do p2p list_keys_by_time as an external client.
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-            return subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,"",ts_us,stable);
+            auto lck = submission_locks.lock(node_id);
+            return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,"",ts_us,stable));
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         // call as an external client (ExternalClientCaller).
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-        return caller.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,"",ts_us,stable);
+        auto lck = submission_locks.lock(node_id);
+        return track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,"",ts_us,stable));
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename FirstType, typename SecondType, typename... RestTypes>
+auto ServiceClient<CascadeTypes...>::type_recursive_list_keys_by_time(
+        uint32_t type_index,
+        const uint64_t& ts_us,
+        const bool stable,
+        const std::string& object_pool_pathname) {
+    if (type_index == 0) {
+        return this->template __list_keys_by_time<FirstType>(ts_us,stable,object_pool_pathname);
+    } else {
+        return this->template type_recursive_list_keys_by_time<SecondType, RestTypes...>(type_index-1,ts_us,stable,object_pool_pathname);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename LastType>
+auto ServiceClient<CascadeTypes...>::type_recursive_list_keys_by_time(
+        uint32_t type_index,
+        const uint64_t& ts_us,
+        const bool stable,
+        const std::string& object_pool_pathname) {
+    if (type_index == 0) {
+        return this->template __list_keys_by_time<LastType>(ts_us,stable,object_pool_pathname);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType> 
+std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>> ServiceClient<CascadeTypes...>::__list_keys_by_time(
+        const uint64_t& ts_us,
+        const bool stable,
+        const std::string& object_pool_pathname){
+    auto opm = resolve_object_pool(object_pool_pathname);
+    if (!opm || !opm->is_valid() || opm->is_null() || opm->deleted) {
+        throw derecho::derecho_exception("Failed to find object_pool:" + object_pool_pathname);
+    }
+    uint32_t subgroup_index = opm->subgroup_index;
+    uint32_t shards = get_number_of_shards<SubgroupType>(subgroup_index);
+    std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>> result;
+    // with the RANGE sharding policy, only the shards overlapping the object pool are listed.
+    for (uint32_t shard_index : opm->prefix_to_shard_indexes(object_pool_pathname,shards)) {
+        flush_shard_coalesced_writes<SubgroupType>(subgroup_index,shard_index);
+        if (!is_external_client()) {
+            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            try {
+                // do p2p list_keys_by_time as a subgroup member.
+                auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
+                if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                    node_id = group_ptr->get_my_id();
+                }
+                auto lck = submission_locks.lock(node_id);
+                auto shard_keys = track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,object_pool_pathname,ts_us,stable));
+                result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
+            } catch (derecho::invalid_subgroup_exception& ex) {
+                // do p2p list_keys_by_time as an external client.
+                auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
+                auto lck = submission_locks.lock(node_id);
+                auto shard_keys = track_reply<SubgroupType>(subgroup_index,shard_index,node_id,subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,object_pool_pathname,ts_us,stable));
+                result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
+            }
+        } else {
+            // call as an external client (ExternalClientCaller).
+            auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
+            auto shard_keys = track_reply<SubgroupType>(subgroup_index,shard_index,node_id,caller.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,object_pool_pathname,ts_us,stable));
+            result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
+        }
+    }
+    return result;
+}
+
+template <typename... CascadeTypes>
+auto ServiceClient<CascadeTypes...>::list_keys_by_time(const uint64_t& ts_us, const bool stable, const std::string& object_pool_pathname) {
+    volatile uint32_t subgroup_type_index,subgroup_index,shard_index;
+    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(object_pool_pathname+"/_");
+    return this->template type_recursive_list_keys_by_time<CascadeTypes...>(subgroup_type_index,ts_us,stable,object_pool_pathname);
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::refresh_object_pool_metadata_cache() {
+    std::vector<ObjectPoolMetadata<CascadeTypes...>> refreshed_metadata;
+    uint32_t num_shards = this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+    std::vector<persistent::version_t> shard_versions(num_shards,persistent::INVALID_VERSION);
+    uint64_t change_count;
+    {
+        std::lock_guard<std::mutex> lck(metadata_sync_mutex);
+        change_count = metadata_change_count;
+        metadata_cache_stale = false;
+    }
+    for(uint32_t shard=0;shard<num_shards;shard++) {
+        auto results = this->template list_keys<CascadeMetadataService<CascadeTypes...>>(CURRENT_VERSION,true,METADATA_SERVICE_SUBGROUP_INDEX,shard);
+        for (auto& reply : results.get()) { // only once
+            for(auto& key: reply.second.get()) { // iterate over keys
+                // we only read the stable version.
+                auto opm_result = this->template get<CascadeMetadataService<CascadeTypes...>>(key,CURRENT_VERSION,true,METADATA_SERVICE_SUBGROUP_INDEX,shard);
+                for (auto& opm_reply:opm_result.get()) { // only once
+                    refreshed_metadata.emplace_back(opm_reply.second.get());
+                    shard_versions[shard] = std::max(shard_versions[shard],refreshed_metadata.back().get_version());
+                    break;
+                }
+            }
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lck(metadata_sync_mutex);
+    object_pool_resolver.reset(std::move(refreshed_metadata));
+    if (metadata_change_count != change_count) {
+        // change events applied during the reload might be overwritten by older metadata: reload again on next lookup.
+        metadata_cache_stale = true;
+    }
+    metadata_shard_versions.resize(num_shards,persistent::INVALID_VERSION);
+    for (uint32_t shard = 0; shard < num_shards; shard ++) {
+        metadata_shard_versions[shard] = std::max(metadata_shard_versions[shard],shard_versions[shard]);
+    }
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::subscribe_object_pool_metadata_changes() {
+    {
+        std::lock_guard<std::mutex> lck(this->notification_handler_registry_mutex);
+        auto& subgroup_caller = external_group_ptr->template get_subgroup_caller<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+        metadata_notification_handler.object_pool_notification_handlers.emplace(
+                "",[this](const Blob& event){this->apply_object_pool_metadata_change(event);});
+        metadata_notification_handler.initialize(subgroup_caller);
+    }
+    // subscribe before loading the cache, so that no change is missed in between.
+    renew_object_pool_metadata_subscriptions();
+    refresh_object_pool_metadata_cache();
+    metadata_sync_thread = std::thread(&ServiceClient<CascadeTypes...>::metadata_sync_worker,this);
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::renew_object_pool_metadata_subscriptions() {
+    const uint32_t num_shards = this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+    for (uint32_t shard = 0; shard < num_shards; shard ++) {
+        node_id_t node_id;
+        bool lost;
+        {
+            std::lock_guard<std::mutex> lck(metadata_sync_mutex);
+            if (metadata_subscription_members.size() < num_shards) {
+                metadata_subscription_members.resize(num_shards,INVALID_NODE_ID);
+                metadata_missed_heartbeats.resize(num_shards,0);
+            }
+            node_id = metadata_subscription_members[shard];
+            lost = (metadata_missed_heartbeats[shard] >= METADATA_SYNC_MAX_MISSED_HEARTBEATS);
+            metadata_missed_heartbeats[shard] ++;
+        }
+        if (node_id != INVALID_NODE_ID && !lost) {
+            // the member has left the shard in a view change.
+            const auto members = this->template get_shard_members<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX,shard);
+            lost = (std::find(members.cbegin(),members.cend(),node_id) == members.cend());
+        }
+        const node_id_t failed_node_id = lost ? node_id : INVALID_NODE_ID;
+        const node_id_t new_node_id = send_object_pool_metadata_subscription(shard,lost ? INVALID_NODE_ID : node_id,failed_node_id);
+        if (new_node_id == node_id) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lck(metadata_sync_mutex);
+        metadata_subscription_members[shard] = new_node_id;
+        metadata_missed_heartbeats[shard] = 0;
+        if (node_id != INVALID_NODE_ID) {
+            // the changes pushed after the old member was lost are missing.
+            dbg_default_warn("The subscription to metadata service shard:{} moved from node:{} to node:{}.",
+                             shard, node_id, new_node_id);
+            metadata_cache_stale = true;
+        }
+    }
+}
+
+template <typename... CascadeTypes>
+node_id_t ServiceClient<CascadeTypes...>::send_object_pool_metadata_subscription(
+        const uint32_t shard_index,
+        const node_id_t node_id,
+        const node_id_t failed_node_id) {
+    std::vector<node_id_t> candidates;
+    if (node_id != INVALID_NODE_ID) {
+        candidates.emplace_back(node_id);
+    }
+    for (const auto& member : this->template get_shard_members<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX,shard_index)) {
+        if (member != node_id && member != failed_node_id) {
+            candidates.emplace_back(member);
+        }
+    }
+    // the subscription goes to the chosen member directly: it bypasses the member selection policy and the write
+    // combiner, because the client must know the member that has it.
+    auto& caller = external_group_ptr->template get_subgroup_caller<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+    for (const auto& candidate : candidates) {
+        try {
+            auto lck = submission_locks.lock(candidate);
+            caller.template p2p_send<RPC_NAME(trigger_put)>(candidate,ObjectPoolMetadata<CascadeTypes...>{});
+            return candidate;
+        } catch (derecho::derecho_exception& ex) {
+            dbg_default_warn("Failed to subscribe to metadata service shard:{} at node:{}: {}.", shard_index, candidate, ex.what());
+        }
+    }
+    return INVALID_NODE_ID;
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::metadata_sync_worker() {
+    pthread_setname_np(pthread_self(), "cs_mdsync");
+    std::unique_lock<std::mutex> lck(metadata_sync_mutex);
+    while (!metadata_sync_stopped) {
+        metadata_sync_cv.wait_for(lck,std::chrono::milliseconds(METADATA_SYNC_INTERVAL_MS),
+                                  [this]{return metadata_sync_stopped;});
+        if (metadata_sync_stopped) {
+            break;
+        }
+        lck.unlock();
+        try {
+            renew_object_pool_metadata_subscriptions();
+            if (metadata_cache_stale) {
+                refresh_object_pool_metadata_cache();
+            }
+        } catch (derecho::derecho_exception& ex) {
+            dbg_default_warn("Failed to sync the object pool metadata: {}.", ex.what());
+        }
+        renew_cache_invalidation_subscriptions();
+        lck.lock();
+    }
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::apply_object_pool_metadata_change(const Blob& event) {
+    auto pathname = mutils::from_bytes<std::string>(nullptr,event.bytes);
+    if (pathname->empty()) {
+        // a heartbeat.
+        std::size_t offset = mutils::bytes_size(*pathname);
+        auto shard = mutils::from_bytes<uint32_t>(nullptr,event.bytes + offset);
+        offset += mutils::bytes_size(*shard);
+        auto version = mutils::from_bytes<persistent::version_t>(nullptr,event.bytes + offset);
+        std::lock_guard<std::mutex> lck(metadata_sync_mutex);
+        if (*shard >= metadata_shard_versions.size() || *shard >= metadata_missed_heartbeats.size()) {
+            return;
+        }
+        metadata_missed_heartbeats[*shard] = 0;
+        if (*version != persistent::INVALID_VERSION &&
+            (metadata_shard_versions[*shard] == persistent::INVALID_VERSION || *version > metadata_shard_versions[*shard])) {
+            dbg_default_debug("Missed metadata changes of shard:{} up to version:{}.", *shard, *version);
+            metadata_cache_stale = true;
+        }
+        return;
+    }
+    auto opm = mutils::from_bytes<ObjectPoolMetadata<CascadeTypes...>>(nullptr,event.bytes + mutils::bytes_size(*pathname));
+
+    std::lock_guard<std::mutex> lck(metadata_sync_mutex);
+    // the number of metadata service shards is known from the last reload: we avoid RPC calls in the notification
+    // handler.
+    if (metadata_shard_versions.empty()) {
+        metadata_cache_stale = true;
+        return;
+    }
+    const uint32_t shard = key_hash(KEY_HASH_STD,KEY_HASH_DEFAULT_SEED,*pathname) % metadata_shard_versions.size();
+    persistent::version_t& last_version = metadata_shard_versions[shard];
+    if (last_version != persistent::INVALID_VERSION && opm->get_version() <= last_version) {
+        // the cache has it already.
+        return;
+    }
+    if (opm->previous_version != last_version) {
+        dbg_default_debug("Missed metadata changes of shard:{} between version:{} and version:{}.",
+                          shard, last_version, opm->previous_version);
+        metadata_cache_stale = true;
+    }
+    last_version = opm->get_version();
+    if (opm->is_valid() && !opm->is_null()) {
+        object_pool_resolver.update(std::move(*opm));
+    } else {
+        object_pool_resolver.erase(*pathname);
+    }
+    metadata_change_count ++;
+}
+
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::set_read_cache_policy(const std::string& object_pool_pathname,
+                                                           bool enable,
+                                                           std::size_t max_bytes) {
+    auto opm = find_object_pool(object_pool_pathname);
+    if (!opm.is_valid() || opm.is_null() || opm.deleted) {
+        throw derecho::derecho_exception("Failed to find object_pool:" + object_pool_pathname);
+    }
+    if (!enable) {
+        {
+            // the subscriptions are not renewed any more, and expire at the shard members.
+            std::lock_guard<std::mutex> lck(cache_subscriptions_mutex);
+            cache_subscriptions.erase(opm.pathname);
+        }
+        read_cache.disable(opm.pathname);
+        return;
+    }
+    // only an external client is notified of the changes, so a group member caches the versioned reads only.
+    const bool cache_current = is_external_client();
+    if (cache_current) {
+        {
+            std::lock_guard<std::mutex> lck(cache_subscriptions_mutex);
+            auto& subscription = cache_subscriptions[opm.pathname];
+            subscription.subgroup_type_index = opm.subgroup_type_index;
+            subscription.subgroup_index = opm.subgroup_index;
+        }
+        // subscribe before caching, so that no change is missed in between.
+        this->template type_recursive_subscribe_cache_invalidations<CascadeTypes...>(
+                opm.subgroup_type_index,opm.pathname,opm.subgroup_index);
+    }
+    read_cache.enable(opm.pathname,max_bytes,cache_current);
+}
+
+template <typename... CascadeTypes>
+ReadCache::Stats ServiceClient<CascadeTypes...>::get_read_cache_stats() const {
+    return read_cache.get_stats();
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::subscribe_cache_invalidations(const std::string& object_pool_pathname,
+                                                                   const uint32_t subgroup_index) {
+    if constexpr (std::is_convertible_v<std::string,typename SubgroupType::KeyType>) {
+        {
+            std::lock_guard<std::mutex> lck(this->notification_handler_registry_mutex);
+            auto& subgroup_handlers = this->template get_subgroup_notification_handler<SubgroupType>(subgroup_index);
+            std::lock_guard<std::mutex> subgroup_handlers_lock(*subgroup_handlers.object_pool_notification_handlers_mutex);
+            if (!subgroup_handlers.cache_invalidation_handler.has_value()) {
+                subgroup_handlers.cache_invalidation_handler = [this](const Blob& event){this->apply_cache_invalidation(event);};
+            }
+        }
+        using ObjectType = typename SubgroupType::ObjectType;
+        const auto subscription = create_null_object_cb<typename SubgroupType::KeyType,ObjectType,&ObjectType::IK,&ObjectType::IV>(
+                object_pool_pathname + PATH_SEPARATOR);
+        const uint32_t num_shards = this->template get_number_of_shards<SubgroupType>(subgroup_index);
+        for (uint32_t shard = 0; shard < num_shards; shard ++) {
+            node_id_t node_id;
+            bool lost;
+            {
+                std::lock_guard<std::mutex> lck(cache_subscriptions_mutex);
+                auto it = cache_subscriptions.find(object_pool_pathname);
+                if (it == cache_subscriptions.end()) {
+                    // the cache is disabled.
+                    return;
+                }
+                auto& subscription = it->second;
+                if (subscription.members.size() < num_shards) {
+                    subscription.members.resize(num_shards,INVALID_NODE_ID);
+                    subscription.missed_heartbeats.resize(num_shards,0);
+                    subscription.shard_versions.resize(num_shards,persistent::INVALID_VERSION);
+                }
+                node_id = subscription.members[shard];
+                lost = (subscription.missed_heartbeats[shard] >= METADATA_SYNC_MAX_MISSED_HEARTBEATS);
+                subscription.missed_heartbeats[shard] ++;
+            }
+            if (node_id != INVALID_NODE_ID && !lost) {
+                // the member has left the shard in a view change.
+                const auto members = this->template get_shard_members<SubgroupType>(subgroup_index,shard);
+                lost = (std::find(members.cbegin(),members.cend(),node_id) == members.cend());
+            }
+            const node_id_t failed_node_id = lost ? node_id : INVALID_NODE_ID;
+            const node_id_t new_node_id = this->template send_cache_invalidation_subscription<SubgroupType>(
+                    subscription,subgroup_index,shard,lost ? INVALID_NODE_ID : node_id,failed_node_id);
+            if (new_node_id == node_id) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lck(cache_subscriptions_mutex);
+            auto it = cache_subscriptions.find(object_pool_pathname);
+            if (it == cache_subscriptions.end()) {
+                return;
+            }
+            it->second.members[shard] = new_node_id;
+            it->second.missed_heartbeats[shard] = 0;
+            if (node_id != INVALID_NODE_ID) {
+                // the invalidations pushed after the old member was lost are missing.
+                dbg_default_warn("The cache subscription to {} in shard:{} moved from node:{} to node:{}.",
+                                 object_pool_pathname, shard, node_id, new_node_id);
+                it->second.shard_versions[shard] = persistent::INVALID_VERSION;
+                read_cache.invalidate_all(object_pool_pathname);
+            }
+        }
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + " only supports string key, but we get " + typeid(typename SubgroupType::KeyType).name());
     }
 }
 
 template <typename... CascadeTypes>
 template <typename FirstType, typename SecondType, typename... RestTypes>
-auto ServiceClient<CascadeTypes...>::type_recursive_list_keys_by_time(
+void ServiceClient<CascadeTypes...>::type_recursive_subscribe_cache_invalidations(
         uint32_t type_index,
-        const uint64_t& ts_us,
-        const bool stable,
-        const std::string& object_pool_pathname) {
+        const std::string& object_pool_pathname,
+        const uint32_t subgroup_index) {
     if (type_index == 0) {
-        return this->template __list_keys_by_time<FirstType>(ts_us,stable,object_pool_pathname);
+        this->template subscribe_cache_invalidations<FirstType>(object_pool_pathname,subgroup_index);
     } else {
-        return this->template type_recursive_list_keys_by_time<SecondType, RestTypes...>(type_index-1,ts_us,stable,object_pool_pathname);
+        this->template type_recursive_subscribe_cache_invalidations<SecondType,RestTypes...>(type_index-1,object_pool_pathname,subgroup_index);
     }
 }
 
 template <typename... CascadeTypes>
 template <typename LastType>
-auto ServiceClient<CascadeTypes...>::type_recursive_list_keys_by_time(
+void ServiceClient<CascadeTypes...>::type_recursive_subscribe_cache_invalidations(
         uint32_t type_index,
-        const uint64_t& ts_us,
-        const bool stable,
-        const std::string& object_pool_pathname) {
+        const std::string& object_pool_pathname,
+        const uint32_t subgroup_index) {
     if (type_index == 0) {
-        return this->template __list_keys_by_time<LastType>(ts_us,stable,object_pool_pathname);
+        this->template subscribe_cache_invalidations<LastType>(object_pool_pathname,subgroup_index);
     } else {
         throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
     }
 }
 
 template <typename... CascadeTypes>
-template <typename SubgroupType> 
-std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>> ServiceClient<CascadeTypes...>::__list_keys_by_time(
-        const uint64_t& ts_us,
-        const bool stable,
-        const std::string& object_pool_pathname){
-    auto opm = find_object_pool(object_pool_pathname);
-    if (!opm.is_valid() || opm.is_null() || opm.deleted) {
-        throw derecho::derecho_exception("Failed to find object_pool:" + object_pool_pathname);
+template <typename SubgroupType>
+node_id_t ServiceClient<CascadeTypes...>::send_cache_invalidation_subscription(
+        const typename SubgroupType::ObjectType& subscription,
+        const uint32_t subgroup_index,
+        const uint32_t shard_index,
+        const node_id_t node_id,
+        const node_id_t failed_node_id) {
+    std::vector<node_id_t> candidates;
+    if (node_id != INVALID_NODE_ID) {
+        candidates.emplace_back(node_id);
     }
-    uint32_t subgroup_index = opm.subgroup_index;
-    uint32_t shards = get_number_of_shards<SubgroupType>(subgroup_index);
-    std::vector<std::unique_ptr<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>> result;
-    for (uint32_t shard_index = 0; shard_index < shards; shard_index ++){
-        if (!is_external_client()) {
-            std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
-            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-            try {
-                // do p2p list_keys_by_time as a subgroup member.
-                auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
-                if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
-                    node_id = group_ptr->get_my_id();
-                }
-                auto shard_keys = subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,object_pool_pathname,ts_us,stable);
-                result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
-            } catch (derecho::invalid_subgroup_exception& ex) {
-                // do p2p list_keys_by_time as an external client.
-                auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
-                auto shard_keys = subgroup_handle.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,object_pool_pathname,ts_us,stable);
-                result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
-            }
-        } else {
-            std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
-            // call as an external client (ExternalClientCaller).
-            auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
-            node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
-            auto shard_keys = caller.template p2p_send<RPC_NAME(list_keys_by_time)>(node_id,object_pool_pathname,ts_us,stable);
-            result.emplace_back(std::make_unique<derecho::rpc::QueryResults<std::vector<typename SubgroupType::KeyType>>>(std::move(shard_keys)));
+    for (const auto& member : this->template get_shard_members<SubgroupType>(subgroup_index,shard_index)) {
+        if (member != node_id && member != failed_node_id) {
+            candidates.emplace_back(member);
         }
     }
-    return result;
+    // as the metadata subscriptions, it bypasses the member selection policy and the write combiner.
+    auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
+    for (const auto& candidate : candidates) {
+        try {
+            auto lck = submission_locks.lock(candidate);
+            caller.template p2p_send<RPC_NAME(trigger_put)>(candidate,subscription);
+            return candidate;
+        } catch (derecho::derecho_exception& ex) {
+            dbg_default_warn("Failed to subscribe to the changes of {} in shard:{} at node:{}: {}.",
+                             subscription.get_key_ref(), shard_index, candidate, ex.what());
+        }
+    }
+    return INVALID_NODE_ID;
 }
 
 template <typename... CascadeTypes>
-auto ServiceClient<CascadeTypes...>::list_keys_by_time(const uint64_t& ts_us, const bool stable, const std::string& object_pool_pathname) {
-    volatile uint32_t subgroup_type_index,subgroup_index,shard_index;
-    std::tie(subgroup_type_index,subgroup_index,shard_index) = this->template key_to_shard(object_pool_pathname+"/_");
-    return this->template type_recursive_list_keys_by_time<CascadeTypes...>(subgroup_type_index,ts_us,stable,object_pool_pathname);
+void ServiceClient<CascadeTypes...>::renew_cache_invalidation_subscriptions() {
+    std::vector<std::tuple<std::string,uint32_t,uint32_t>> object_pools;
+    {
+        std::lock_guard<std::mutex> lck(cache_subscriptions_mutex);
+        for (const auto& kv : cache_subscriptions) {
+            object_pools.emplace_back(kv.first,kv.second.subgroup_type_index,kv.second.subgroup_index);
+        }
+    }
+    for (const auto& object_pool : object_pools) {
+        try {
+            this->template type_recursive_subscribe_cache_invalidations<CascadeTypes...>(
+                    std::get<1>(object_pool),std::get<0>(object_pool),std::get<2>(object_pool));
+        } catch (derecho::derecho_exception& ex) {
+            dbg_default_warn("Failed to renew the cache subscriptions to {}: {}.", std::get<0>(object_pool), ex.what());
+        }
+    }
 }
 
 template <typename... CascadeTypes>
-void ServiceClient<CascadeTypes...>::refresh_object_pool_metadata_cache() {
-    std::unordered_map<std::string,ObjectPoolMetadata<CascadeTypes...>> refreshed_metadata;
-    uint32_t num_shards = this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
-    for(uint32_t shard=0;shard<num_shards;shard++) {
-        auto results = this->template list_keys<CascadeMetadataService<CascadeTypes...>>(CURRENT_VERSION,true,METADATA_SERVICE_SUBGROUP_INDEX,shard);
-        for (auto& reply : results.get()) { // only once
-            for(auto& key: reply.second.get()) { // iterate over keys
-                // we only read the stable version.
-                auto opm_result = this->template get<CascadeMetadataService<CascadeTypes...>>(key,CURRENT_VERSION,true,METADATA_SERVICE_SUBGROUP_INDEX,shard);
-                for (auto& opm_reply:opm_result.get()) { // only once
-                    refreshed_metadata[key] = opm_reply.second.get();
-                    break;
-                }
-            }
-            break;
+void ServiceClient<CascadeTypes...>::apply_cache_invalidation(const Blob& event) {
+    std::size_t offset = 0;
+    auto pathname = mutils::from_bytes<std::string>(nullptr,event.bytes);
+    offset += mutils::bytes_size(*pathname);
+    auto key = mutils::from_bytes<std::string>(nullptr,event.bytes + offset);
+    offset += mutils::bytes_size(*key);
+    auto version = mutils::from_bytes<persistent::version_t>(nullptr,event.bytes + offset);
+    offset += mutils::bytes_size(*version);
+    auto shard = mutils::from_bytes<uint32_t>(nullptr,event.bytes + offset);
+    std::lock_guard<std::mutex> lck(cache_subscriptions_mutex);
+    auto it = cache_subscriptions.find(*pathname);
+    if (it == cache_subscriptions.end() || *shard >= it->second.shard_versions.size()) {
+        return;
+    }
+    persistent::version_t& last_version = it->second.shard_versions[*shard];
+    if (key->empty()) {
+        // a heartbeat.
+        it->second.missed_heartbeats[*shard] = 0;
+        if (*version != persistent::INVALID_VERSION &&
+            (last_version == persistent::INVALID_VERSION || *version > last_version)) {
+            dbg_default_debug("Missed the changes of {} in shard:{} up to version:{}.", *pathname, *shard, *version);
+            read_cache.invalidate_all(*pathname);
+            last_version = *version;
         }
+        return;
     }
+    if (last_version == persistent::INVALID_VERSION || *version > last_version) {
+        last_version = *version;
+    }
+    read_cache.invalidate(*pathname,*key,*version);
+}
 
-    std::unique_lock<std::shared_mutex> wlck(object_pool_metadata_cache_mutex);
-    this->object_pool_metadata_cache = refreshed_metadata;
+template <typename... CascadeTypes>
+void ServiceClient<CascadeTypes...>::invalidate_cached_key(const std::string& object_pool_pathname, const std::string& key) {
+    if (!object_pool_pathname.empty()) {
+        read_cache.invalidate(object_pool_pathname,key,CURRENT_VERSION);
+    }
 }
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
 derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::create_object_pool(
         const std::string& pathname, const uint32_t subgroup_index,
-        const sharding_policy_t sharding_policy, const std::unordered_map<std::string,uint32_t>& object_locations) {
+        const sharding_policy_t sharding_policy, const std::unordered_map<std::string,uint32_t>& object_locations,
+        const std::vector<std::string>& split_points, const std::vector<uint32_t>& bucket_to_shard) {
     uint32_t subgroup_type_index = ObjectPoolMetadata<CascadeTypes...>::template get_subgroup_type_index<SubgroupType>();
     if (subgroup_type_index == ObjectPoolMetadata<CascadeTypes...>::invalid_subgroup_type_index) {
         dbg_default_crit("Create object pool failed because of invalid SubgroupType:{}", typeid(SubgroupType).name());
         throw derecho::derecho_exception(std::string("Create object pool failed because SubgroupType is invalid:")+typeid(SubgroupType).name());
     }
-    ObjectPoolMetadata<CascadeTypes...> opm(pathname,subgroup_type_index,subgroup_index,sharding_policy,object_locations,false);
-    // clear local cache entry.
-    std::shared_lock<std::shared_mutex> rlck(object_pool_metadata_cache_mutex);
-    if (object_pool_metadata_cache.find(pathname)==object_pool_metadata_cache.end()) {
-        rlck.unlock();
-    } else {
-        rlck.unlock();
-        std::unique_lock<std::shared_mutex> wlck(object_pool_metadata_cache_mutex);
-        object_pool_metadata_cache.erase(pathname);
+    const uint32_t num_shards = this->template get_number_of_shards<SubgroupType>(subgroup_index);
+    std::vector<uint32_t> buckets = bucket_to_shard;
+    if (sharding_policy == VIRTUAL && buckets.empty()) {
+        for (uint32_t bucket = 0; bucket < OBJECT_POOL_DEFAULT_NUM_BUCKETS; bucket ++) {
+            buckets.emplace_back(bucket % num_shards);
+        }
     }
+    // the placement tables are checked against the number of shards here, and by the metadata service.
+    ObjectPoolMetadata<CascadeTypes...> opm(pathname,subgroup_type_index,subgroup_index,sharding_policy,object_locations,false,split_points,buckets,
+                                            KEY_HASH_WYHASH,KEY_HASH_DEFAULT_SEED,num_shards);
+    // clear local cache entry.
+    object_pool_resolver.erase(pathname);
     // determine the shard index by hashing
-    uint32_t metadata_service_shard_index = std::hash<std::string>{}(pathname) % this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+    uint32_t metadata_service_shard_index = key_hash(KEY_HASH_STD,KEY_HASH_DEFAULT_SEED,pathname) % this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
 
     return this->template put<CascadeMetadataService<CascadeTypes...>>(opm,METADATA_SERVICE_SUBGROUP_INDEX,metadata_service_shard_index);
 }
@@ -1569,23 +3439,13 @@ derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceCl
 template <typename... CascadeTypes>
 derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::remove_object_pool(const std::string& pathname) {
     // determine the shard index by hashing
-    uint32_t metadata_service_shard_index = std::hash<std::string>{}(pathname) % this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+    uint32_t metadata_service_shard_index = key_hash(KEY_HASH_STD,KEY_HASH_DEFAULT_SEED,pathname) % this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
 
 
     // check if this object pool exist in metadata service.
     auto opm = find_object_pool(pathname);
     // remove it from local cache.
-    std::shared_lock<std::shared_mutex> rlck(object_pool_metadata_cache_mutex);
-    if (object_pool_metadata_cache.find(pathname) == object_pool_metadata_cache.end()) {
-        // no entry in cache
-        rlck.unlock();
-    } else {
-        // remove from cache
-        rlck.unlock();
-        std::unique_lock<std::shared_mutex> wlck(object_pool_metadata_cache_mutex);
-        object_pool_metadata_cache.erase(pathname);
-        wlck.unlock();
-    }
+    object_pool_resolver.erase(pathname);
     if (opm.is_valid() && !opm.is_null() && !opm.deleted) {
         opm.deleted = true;
         opm.set_previous_version(CURRENT_VERSION,opm.version); // only check previous_version_by_key
@@ -1599,29 +3459,290 @@ derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceCl
 
 template <typename... CascadeTypes>
 ObjectPoolMetadata<CascadeTypes...> ServiceClient<CascadeTypes...>::find_object_pool(const std::string& pathname) {
-    std::shared_lock<std::shared_mutex> rlck(object_pool_metadata_cache_mutex);
-    
-    auto components = str_tokenizer(pathname);
-    std::string prefix;
-    for (const auto& comp: components) {
-        prefix = prefix + PATH_SEPARATOR + comp;
-        if (object_pool_metadata_cache.find(prefix) != object_pool_metadata_cache.end()) {
-            return object_pool_metadata_cache.at(prefix);
+    auto opm = resolve_object_pool(pathname);
+    if (opm) {
+        return *opm;
+    }
+    return ObjectPoolMetadata<CascadeTypes...>::IV;
+}
+
+template <typename... CascadeTypes>
+std::shared_ptr<const ObjectPoolMetadata<CascadeTypes...>> ServiceClient<CascadeTypes...>::resolve_object_pool(
+        const std::string_view& pathname) {
+    // The resolver expects the canonical form. Other forms, with empty components, are rare, so we only pay for the
+    // tokenization in that case.
+    std::string canonical_pathname;
+    std::string_view lookup_pathname = pathname;
+    if (pathname.empty() || pathname.front() != PATH_SEPARATOR || pathname.back() == PATH_SEPARATOR ||
+        pathname.find(std::string(2,PATH_SEPARATOR)) != std::string_view::npos) {
+        for (const auto& comp: str_tokenizer(std::string(pathname))) {
+            canonical_pathname = canonical_pathname + PATH_SEPARATOR + comp;
         }
+        lookup_pathname = canonical_pathname;
+    }
+    if (metadata_cache_stale) {
+        refresh_object_pool_metadata_cache();
+    }
+    bool known_absent;
+    auto opm = object_pool_resolver.resolve(lookup_pathname,known_absent);
+    if (opm || known_absent) {
+        return opm;
     }
-    rlck.unlock();
 
     // refresh and try again.
     refresh_object_pool_metadata_cache();
-    prefix = "";
-    rlck.lock();
-    for (const auto& comp: components) {
-        prefix = prefix + PATH_SEPARATOR + comp;
-        if (object_pool_metadata_cache.find(prefix) != object_pool_metadata_cache.end()) {
-            return object_pool_metadata_cache.at(prefix);
+    opm = object_pool_resolver.resolve(lookup_pathname,known_absent);
+    if (!opm) {
+        object_pool_resolver.add_negative_entry(lookup_pathname);
+    }
+    return opm;
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+std::size_t ServiceClient<CascadeTypes...>::copy_moved_buckets(
+        const ObjectPoolMetadata<CascadeTypes...>& opm,
+        const std::vector<uint32_t>& bucket_to_shard,
+        const uint64_t cutover_ts_us,
+        std::unordered_map<std::string,MovedObject>& moved_objects) {
+    using ObjectType = typename SubgroupType::ObjectType;
+    const uint32_t num_shards = this->template get_number_of_shards<SubgroupType>(opm.subgroup_index);
+    const std::string key_prefix = opm.pathname + PATH_SEPARATOR;
+    std::size_t num_raced = 0;
+    // write a value on the new shard if it still has the version we read there.
+    auto conditional_put = [this,&opm](const std::string& key,const ObjectType& object,
+                                       const persistent::version_t expected_version,const uint32_t shard_index) -> persistent::version_t {
+        auto result = this->template transact<SubgroupType>({{key,expected_version}},{object},opm.subgroup_index,shard_index);
+        for (auto& reply : result.get()) {
+            return std::get<0>(reply.second.get());
+        }
+        return persistent::INVALID_VERSION;
+    };
+    for (uint32_t shard_index = 0; shard_index < num_shards; shard_index ++) {
+        std::vector<std::string> moved_keys;
+        auto keys_result = this->template list_keys<SubgroupType>(CURRENT_VERSION,false,opm.subgroup_index,shard_index);
+        for (auto& reply : keys_result.get()) {
+            for (const auto& key : reply.second.get()) {
+                if (key.compare(0,key_prefix.size(),key_prefix) != 0 ||
+                    opm.object_locations.contains(key)) {
+                    continue;
+                }
+                const uint32_t bucket = opm.key_to_bucket(key);
+                if (opm.bucket_to_shard.at(bucket) == shard_index && bucket_to_shard.at(bucket) != shard_index) {
+                    moved_keys.emplace_back(key);
+                }
+            }
+            break;
+        }
+        for (const auto& key : moved_keys) {
+            const uint32_t target_shard_index = bucket_to_shard.at(opm.key_to_bucket(key));
+            ObjectType object;
+            auto get_result = this->template get<SubgroupType>(key,CURRENT_VERSION,false,opm.subgroup_index,shard_index);
+            for (auto& reply : get_result.get()) {
+                object = reply.second.get();
+                break;
+            }
+            if (!object.is_valid()) {
+                continue;
+            }
+            auto moved = moved_objects.find(key);
+            if (moved != moved_objects.end() && moved->second.source_version == object.get_version()) {
+                continue;
+            }
+            if (object.is_null() && moved == moved_objects.end()) {
+                // removed before it was copied.
+                continue;
+            }
+            // the version of the key on the new shard.
+            ObjectType target_object;
+            auto target_result = this->template get<SubgroupType>(key,CURRENT_VERSION,false,opm.subgroup_index,target_shard_index);
+            for (auto& reply : target_result.get()) {
+                target_object = reply.second.get();
+                break;
+            }
+            const persistent::version_t target_version = target_object.get_version();
+            bool older = (cutover_ts_us == 0) || (target_version == persistent::INVALID_VERSION) ||
+                         (moved != moved_objects.end() && moved->second.target_version == target_version);
+            if constexpr (std::is_base_of_v<IKeepTimestamp,ObjectType>) {
+                // a removal left on the new shard by an earlier rebalance.
+                older = older || (target_object.is_null() && target_object.get_timestamp() < cutover_ts_us);
+            }
+            if (!older) {
+                // a client has written the key on the new shard since the cutover: the value on the old shard is stale.
+                moved_objects[key] = MovedObject{object.get_version(),target_version,object.is_null()};
+                continue;
+            }
+            const persistent::version_t source_version = object.get_version();
+            // the object is new to the destination shard, so the version checks of the source shard do not apply.
+            if constexpr (std::is_base_of_v<IKeepPreviousVersion,ObjectType>) {
+                object.set_previous_version(CURRENT_VERSION,CURRENT_VERSION);
+            }
+            // a removal on the old shard after the copy is copied as the null object.
+            const persistent::version_t copied_version = conditional_put(key,object,target_version,target_shard_index);
+            if (copied_version == persistent::INVALID_VERSION) {
+                // the key has changed on the new shard meanwhile: it is checked again in the next round.
+                dbg_default_debug("Copying key:{} raced with an update on shard:{}.", key, target_shard_index);
+                num_raced ++;
+                continue;
+            }
+            moved_objects[key] = MovedObject{source_version,copied_version,object.is_null()};
         }
     }
-    return ObjectPoolMetadata<CascadeTypes...>::IV;
+    return num_raced;
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+std::size_t ServiceClient<CascadeTypes...>::hand_off_moved_objects(
+        const ObjectPoolMetadata<CascadeTypes...>& opm,
+        std::unordered_map<std::string,MovedObject>& moved_objects) {
+    using ObjectType = typename SubgroupType::ObjectType;
+    std::size_t num_changed = 0;
+    for (auto& kv : moved_objects) {
+        if (kv.second.handed_off) {
+            continue;
+        }
+        const uint32_t source_shard_index = opm.bucket_to_shard.at(opm.key_to_bucket(kv.first));
+        const auto null_object = create_null_object_cb<typename SubgroupType::KeyType,ObjectType,&ObjectType::IK,&ObjectType::IV>(kv.first);
+        auto result = this->template transact<SubgroupType>({{kv.first,kv.second.source_version}},{null_object},
+                                                             opm.subgroup_index,source_shard_index);
+        persistent::version_t removed_version = persistent::INVALID_VERSION;
+        for (auto& reply : result.get()) {
+            removed_version = std::get<0>(reply.second.get());
+            break;
+        }
+        if (removed_version == persistent::INVALID_VERSION) {
+            num_changed ++;
+            continue;
+        }
+        kv.second.source_version = removed_version;
+        kv.second.handed_off = true;
+    }
+    return num_changed;
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+bool ServiceClient<CascadeTypes...>::__rebalance_object_pool(
+        const ObjectPoolMetadata<CascadeTypes...>& opm,
+        const std::vector<uint32_t>& bucket_to_shard) {
+    // 1) copy the objects in the moved buckets.
+    std::unordered_map<std::string,MovedObject> moved_objects;
+    copy_moved_buckets<SubgroupType>(opm,bucket_to_shard,0,moved_objects);
+
+    // 2) cutover: the new table is accepted only if the metadata is still at the version we started with.
+    ObjectPoolMetadata<CascadeTypes...> new_opm(opm);
+    new_opm.bucket_to_shard = bucket_to_shard;
+    new_opm.num_shards = this->template get_number_of_shards<SubgroupType>(opm.subgroup_index);
+    new_opm.set_previous_version(CURRENT_VERSION,opm.get_version()); // only check previous_version_by_key
+    uint32_t metadata_service_shard_index = key_hash(KEY_HASH_STD,KEY_HASH_DEFAULT_SEED,opm.pathname) % this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+    auto cutover_result = this->template put<CascadeMetadataService<CascadeTypes...>>(new_opm,METADATA_SERVICE_SUBGROUP_INDEX,metadata_service_shard_index);
+    std::tuple<persistent::version_t,uint64_t> cutover{persistent::INVALID_VERSION,0};
+    for (auto& reply : cutover_result.get()) {
+        cutover = reply.second.get();
+        break;
+    }
+    object_pool_resolver.erase(opm.pathname);
+    if (std::get<0>(cutover) == persistent::INVALID_VERSION) {
+        dbg_default_warn("Rebalancing object pool:{} failed because its metadata has changed.", opm.pathname);
+        return false;
+    }
+
+    // 3) fence the old shards.
+    std::this_thread::sleep_for(std::chrono::milliseconds(OBJECT_POOL_REBALANCE_FENCE_MS));
+
+    // 4) catch up with the updates on the old shards, and remove the moved objects from them.
+    for (uint32_t round = 0; round < OBJECT_POOL_REBALANCE_MAX_HANDOFF_ROUNDS; round ++) {
+        std::size_t num_changed = copy_moved_buckets<SubgroupType>(opm,bucket_to_shard,std::get<1>(cutover),moved_objects);
+        num_changed += hand_off_moved_objects<SubgroupType>(opm,moved_objects);
+        if (num_changed == 0) {
+            dbg_default_info("Rebalanced object pool:{}, {} object(s) moved.", opm.pathname, moved_objects.size());
+            return true;
+        }
+        dbg_default_debug("{} object(s) of object pool:{} changed during the hand-off.", num_changed, opm.pathname);
+    }
+    // the new table is in effect, but the objects left behind are not found through it.
+    dbg_default_warn("Rebalancing object pool:{} did not converge: some moved objects kept changing and are left on their old shards.", opm.pathname);
+    return false;
+}
+
+template <typename... CascadeTypes>
+template <typename FirstType,typename SecondType, typename...RestTypes>
+bool ServiceClient<CascadeTypes...>::type_recursive_rebalance_object_pool(
+        uint32_t type_index,
+        const ObjectPoolMetadata<CascadeTypes...>& opm,
+        const std::vector<uint32_t>& bucket_to_shard) {
+    if (type_index == 0) {
+        return this->template __rebalance_object_pool<FirstType>(opm,bucket_to_shard);
+    } else {
+        return this->template type_recursive_rebalance_object_pool<SecondType,RestTypes...>(type_index-1,opm,bucket_to_shard);
+    }
+}
+
+template <typename... CascadeTypes>
+template <typename LastType>
+bool ServiceClient<CascadeTypes...>::type_recursive_rebalance_object_pool(
+        uint32_t type_index,
+        const ObjectPoolMetadata<CascadeTypes...>& opm,
+        const std::vector<uint32_t>& bucket_to_shard) {
+    if (type_index == 0) {
+        return this->template __rebalance_object_pool<LastType>(opm,bucket_to_shard);
+    } else {
+        throw derecho::derecho_exception(std::string(__PRETTY_FUNCTION__) + ": type index is out of boundary.");
+    }
+}
+
+template <typename... CascadeTypes>
+std::future<bool> ServiceClient<CascadeTypes...>::rebalance_object_pool(
+        const std::string& pathname,
+        const std::vector<uint32_t>& bucket_to_shard) {
+    // always start from the latest metadata.
+    object_pool_resolver.erase(pathname);
+    auto opm = find_object_pool(pathname);
+    if (!opm.is_valid() || opm.is_null() || opm.deleted || opm.pathname != pathname) {
+        throw derecho::derecho_exception("Failed to find object_pool:" + pathname);
+    }
+    if (opm.sharding_policy != VIRTUAL) {
+        throw derecho::derecho_exception("Object pool:" + pathname + " does not use the VIRTUAL sharding policy.");
+    }
+    if (bucket_to_shard.size() != opm.bucket_to_shard.size()) {
+        throw derecho::derecho_exception("Object pool:" + pathname + " has " + std::to_string(opm.bucket_to_shard.size()) +
+                                         " buckets, but the new table has " + std::to_string(bucket_to_shard.size()) + ".");
+    }
+    const uint32_t num_shards = get_number_of_shards(opm.subgroup_type_index,opm.subgroup_index);
+    for (const auto shard_index : bucket_to_shard) {
+        if (shard_index >= num_shards) {
+            throw derecho::derecho_exception("Invalid shard index:" + std::to_string(shard_index) + " in the new table of object pool:" + pathname);
+        }
+    }
+    return std::async(std::launch::async,[this,opm,bucket_to_shard]() {
+        return this->template type_recursive_rebalance_object_pool<CascadeTypes...>(opm.subgroup_type_index,opm,bucket_to_shard);
+    });
+}
+
+template <typename... CascadeTypes>
+derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> ServiceClient<CascadeTypes...>::update_object_locations(
+        const std::string& pathname,
+        const std::unordered_map<std::string,uint32_t>& updates,
+        const std::vector<std::string>& removals) {
+    // always start from the latest metadata.
+    object_pool_resolver.erase(pathname);
+    auto opm = find_object_pool(pathname);
+    if (!opm.is_valid() || opm.is_null() || opm.deleted || opm.pathname != pathname) {
+        throw derecho::derecho_exception("Failed to find object_pool:" + pathname);
+    }
+    const uint32_t num_shards = get_number_of_shards(opm.subgroup_type_index,opm.subgroup_index);
+    for (const auto& update : updates) {
+        if (update.second >= num_shards) {
+            throw derecho::derecho_exception("Invalid shard index:" + std::to_string(update.second) + " for key:" + update.first);
+        }
+    }
+    opm.object_locations = opm.object_locations.apply(updates,removals);
+    opm.num_shards = num_shards;
+    opm.set_previous_version(CURRENT_VERSION,opm.version); // only check previous_version_by_key
+    object_pool_resolver.erase(pathname);
+    uint32_t metadata_service_shard_index = key_hash(KEY_HASH_STD,KEY_HASH_DEFAULT_SEED,pathname) % this->template get_number_of_shards<CascadeMetadataService<CascadeTypes...>>(METADATA_SERVICE_SUBGROUP_INDEX);
+    return this->template put<CascadeMetadataService<CascadeTypes...>>(opm,METADATA_SERVICE_SUBGROUP_INDEX,metadata_service_shard_index);
 }
 
 template <typename... CascadeTypes>
@@ -1630,13 +3751,7 @@ std::vector<std::string> ServiceClient<CascadeTypes...>::list_object_pools(bool
         this->refresh_object_pool_metadata_cache();
     }
 
-    std::vector<std::string> ret;
-    std::shared_lock rlck(this->object_pool_metadata_cache_mutex);
-    for (auto& op:this->object_pool_metadata_cache) {
-        ret.emplace_back(op.first);
-    }
-
-    return ret;
+    return object_pool_resolver.list_pathnames();
 }
 
 template <typename... CascadeTypes>
@@ -1649,16 +3764,8 @@ bool ServiceClient<CascadeTypes...>::register_notification_handler(
 
 template <typename... CascadeTypes>
 template <typename SubgroupType>
-bool ServiceClient<CascadeTypes...>::register_notification_handler(
-        const cascade_notification_handler_t& handler,
-        const std::string& object_pool_pathname,
+SubgroupNotificationHandler<SubgroupType>& ServiceClient<CascadeTypes...>::get_subgroup_notification_handler(
         const uint32_t subgroup_index) {
-    if (!is_external_client()) {
-        throw derecho_exception(std::string(__PRETTY_FUNCTION__) + 
-            "Cannot register notification handler because external_group_ptr is null.");
-    }
-
-    std::unique_lock<std::mutex> type_registry_lock(this->notification_handler_registry_mutex);
     auto& per_type_registry = notification_handler_registry.template get<SubgroupType>();
     // Register Cascade's root handler:
     // if subgroup_index exists in the per_type_registry, Cascade's root handler is registered already.
@@ -1666,10 +3773,24 @@ bool ServiceClient<CascadeTypes...>::register_notification_handler(
         per_type_registry.emplace(subgroup_index,SubgroupNotificationHandler<SubgroupType>{});
         // register to subgroup_caller
         auto& subgroup_caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
-        // to do ... register it.
         per_type_registry.at(subgroup_index).initialize(subgroup_caller);
     }
-    auto& subgroup_handlers = per_type_registry.at(subgroup_index);
+    return per_type_registry.at(subgroup_index);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+bool ServiceClient<CascadeTypes...>::register_notification_handler(
+        const cascade_notification_handler_t& handler,
+        const std::string& object_pool_pathname,
+        const uint32_t subgroup_index) {
+    if (!is_external_client()) {
+        throw derecho_exception(std::string(__PRETTY_FUNCTION__) + 
+            "Cannot register notification handler because external_group_ptr is null.");
+    }
+
+    std::unique_lock<std::mutex> type_registry_lock(this->notification_handler_registry_mutex);
+    auto& subgroup_handlers = this->template get_subgroup_notification_handler<SubgroupType>(subgroup_index);
 
     // Register the handler
     std::lock_guard<std::mutex> subgroup_handlers_lock(*subgroup_handlers.object_pool_notification_handlers_mutex);
@@ -1743,6 +3864,27 @@ void ServiceClient<CascadeTypes...>::notify(
         const std::string& object_pool_pathname,
         const uint32_t subgroup_index,
         const node_id_t client_id) const {
+    send_notification<SubgroupType>(CASCADE_NOTIFICATION_MESSAGE_TYPE,msg,object_pool_pathname,subgroup_index,client_id);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::notify_cache_invalidation(
+        const Blob& msg,
+        const std::string& object_pool_pathname,
+        const uint32_t subgroup_index,
+        const node_id_t client_id) const {
+    send_notification<SubgroupType>(CASCADE_CACHE_INVALIDATION_MESSAGE_TYPE,msg,object_pool_pathname,subgroup_index,client_id);
+}
+
+template <typename... CascadeTypes>
+template <typename SubgroupType>
+void ServiceClient<CascadeTypes...>::send_notification(
+        const uint64_t message_type,
+        const Blob& msg,
+        const std::string& object_pool_pathname,
+        const uint32_t subgroup_index,
+        const node_id_t client_id) const {
     if (is_external_client()) {
         throw derecho_exception(std::string(__PRETTY_FUNCTION__) +
                 "Cannot notify an external client from an external client.");
@@ -1752,7 +3894,7 @@ void ServiceClient<CascadeTypes...>::notify(
     
     //TODO: redesign to avoid memory copies.
     CascadeNotificationMessage cascade_notification_message(object_pool_pathname,msg);
-    derecho::NotificationMessage derecho_notification_message(CASCADE_NOTIFICATION_MESSAGE_TYPE, mutils::bytes_size(cascade_notification_message));
+    derecho::NotificationMessage derecho_notification_message(message_type, mutils::bytes_size(cascade_notification_message));
     mutils::to_bytes(cascade_notification_message,derecho_notification_message.body);
 
     client_handle.template p2p_send<RPC_NAME(notify)>(client_id,derecho_notification_message);
@@ -1807,19 +3949,20 @@ template <typename SubgroupType>
 derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::dump_timestamp(const std::string& filename, const uint32_t subgroup_index, const uint32_t shard_index) {
 
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+            auto lck = submission_locks.lock(get_my_id());
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             return subgroup_handle.template ordered_send<RPC_NAME(ordered_dump_timestamp_log)>(filename);
         } else {
             auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
             return subgroup_handle.template p2p_send<RPC_NAME(dump_timestamp_log)>(node_id,filename);
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
         return caller.template p2p_send<RPC_NAME(dump_timestamp_log)>(node_id,filename);
     }
 }
@@ -1836,21 +3979,22 @@ std::vector<std::unique_ptr<derecho::rpc::QueryResults<void>>> ServiceClient<Cas
     std::vector<std::unique_ptr<derecho::rpc::QueryResults<void>>> result;
     for (uint32_t shard_index = 0; shard_index < shards; shard_index ++){
         if (!is_external_client()) {
-            std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
             if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
+                auto lck = submission_locks.lock(get_my_id());
                 auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
                 auto qr = subgroup_handle.template ordered_send<RPC_NAME(ordered_dump_timestamp_log)>(filename);
                 result.emplace_back(std::make_unique<derecho::rpc::QueryResults<void>>(std::move(qr)));
             } else {
                 auto& subgroup_handle = group_ptr->template get_nonmember_subgroup<SubgroupType>(subgroup_index);
                 node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+                auto lck = submission_locks.lock(node_id);
                 auto qr = subgroup_handle.template p2p_send<RPC_NAME(dump_timestamp_log)>(node_id,filename);
                 result.emplace_back(std::make_unique<derecho::rpc::QueryResults<void>>(std::move(qr)));
             }
         } else {
-            std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
             auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
             node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+            auto lck = submission_locks.lock(node_id);
             auto qr = caller.template p2p_send<RPC_NAME(dump_timestamp_log)>(node_id,filename);
             result.emplace_back(std::make_unique<derecho::rpc::QueryResults<void>>(std::move(qr)));
         }
@@ -1861,8 +4005,8 @@ std::vector<std::unique_ptr<derecho::rpc::QueryResults<void>>> ServiceClient<Cas
 template <typename... CascadeTypes>
 template <typename SubgroupType>
 derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::dump_timestamp_workaround(const std::string& filename, const uint32_t subgroup_index, const uint32_t shard_index, const node_id_t node_id) {
+    auto lck = submission_locks.lock(node_id);
     if (!is_external_client()) {
-        std::lock_guard<std::mutex> lck(this->group_ptr_mutex);
         if (static_cast<uint32_t>(group_ptr->template get_my_shard<SubgroupType>(subgroup_index)) == shard_index) {
             auto& subgroup_handle = group_ptr->template get_subgroup<SubgroupType>(subgroup_index);
             return subgroup_handle.template p2p_send<RPC_NAME(dump_timestamp_log_workaround)>(node_id, filename);
@@ -1871,7 +4015,6 @@ derecho::rpc::QueryResults<void> ServiceClient<CascadeTypes...>::dump_timestamp_
             return subgroup_handle.template p2p_send<RPC_NAME(dump_timestamp_log_workaround)>(node_id,filename);
         }
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         return caller.template p2p_send<RPC_NAME(dump_timestamp_log_workaround)>(node_id,filename);
     }
@@ -1884,9 +4027,9 @@ derecho::rpc::QueryResults<double> ServiceClient<CascadeTypes...>::perf_put(cons
         // 'perf_put' must be issued from an external client.
         throw derecho::derecho_exception{"perf_put must be issued from an external client."};
     } else {
-        std::lock_guard<std::mutex> lck(this->external_group_ptr_mutex);
         auto& caller = external_group_ptr->template get_subgroup_caller<SubgroupType>(subgroup_index);
         node_id_t node_id = pick_member_by_policy<SubgroupType>(subgroup_index,shard_index);
+        auto lck = submission_locks.lock(node_id);
         return caller.template p2p_send<RPC_NAME(perf_put)>(node_id,message_size,duration_sec);
     }
 }
@@ -2326,7 +4469,7 @@ bool CascadeContext<CascadeTypes...>::post(Action&& action, bool is_trigger) {
             switch(stateful) {
             case DataFlowGraph::Statefulness::STATEFUL:
                 {
-                    uint32_t thread_index = std::hash<std::string>{}(action.key_string) % stateful_action_queues_for_p2p.size();
+                    uint32_t thread_index = action.key_hash_value % stateful_action_queues_for_p2p.size();
                     stateful_action_queues_for_p2p[thread_index]->action_buffer_enqueue(std::move(action));
                 }
                 break;
@@ -2345,7 +4488,7 @@ bool CascadeContext<CascadeTypes...>::post(Action&& action, bool is_trigger) {
             switch(stateful) {
             case DataFlowGraph::Statefulness::STATEFUL:
                 {
-                    uint32_t thread_index = std::hash<std::string>{}(action.key_string) % stateful_action_queues_for_multicast.size();
+                    uint32_t thread_index = action.key_hash_value % stateful_action_queues_for_multicast.size();
                     stateful_action_queues_for_multicast[thread_index]->action_buffer_enqueue(std::move(action));
                 }
                 break;
@@ -2383,5 +4526,180 @@ CascadeContext<CascadeTypes...>::~CascadeContext() {
     destroy();
 }
 
+template <typename... CascadeTypes>
+void MetadataChangePublisher<CascadeTypes...>::operator()(
+        const uint32_t subgroup_idx,
+        const uint32_t shard_idx,
+        const node_id_t sender_id,
+        const std::string& key,
+        const ObjectPoolMetadata<CascadeTypes...>& value,
+        ICascadeContext* cascade_ctxt,
+        bool is_trigger) {
+    auto* ctxt = dynamic_cast<CascadeContext<CascadeTypes...>*>(cascade_ctxt);
+    if (is_trigger) {
+        if (!key.empty() || ctxt == nullptr) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lck(subscribers_mutex);
+            if (subscribers.emplace(sender_id).second) {
+                dbg_default_debug("Client:{} subscribed to the metadata changes of shard:{}.", sender_id, shard_idx);
+            }
+        }
+        // answer with a heartbeat, which reads the version once the changes before it are pushed.
+        sender.post([this,ctxt,subgroup_idx,shard_idx,sender_id,key](){
+            persistent::version_t shard_version = persistent::INVALID_VERSION;
+            {
+                std::lock_guard<std::mutex> lck(subscribers_mutex);
+                if (shard_versions.find(shard_idx) != shard_versions.cend()) {
+                    shard_version = shard_versions.at(shard_idx);
+                }
+            }
+            std::vector<uint8_t> buffer(mutils::bytes_size(key) + mutils::bytes_size(shard_idx) + mutils::bytes_size(shard_version));
+            std::size_t offset = mutils::to_bytes(key,buffer.data());
+            offset += mutils::to_bytes(shard_idx,buffer.data() + offset);
+            mutils::to_bytes(shard_version,buffer.data() + offset);
+            try {
+                ctxt->get_service_client_ref().template notify<CascadeMetadataService<CascadeTypes...>>(
+                        Blob(buffer.data(),buffer.size()),key,subgroup_idx,sender_id);
+            } catch (derecho::derecho_exception& ex) {
+                dbg_default_warn("Failed to send a metadata heartbeat to client:{}: {}. It is unsubscribed.", sender_id, ex.what());
+                std::lock_guard<std::mutex> lck(subscribers_mutex);
+                subscribers.erase(sender_id);
+            }
+        });
+        return;
+    }
+    const persistent::version_t version = value.get_version();
+    bool has_receivers = false;
+    {
+        std::lock_guard<std::mutex> lck(subscribers_mutex);
+        has_receivers = !subscribers.empty();
+    }
+    // the change is serialized here, and only if it is pushed.
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+    if (has_receivers && ctxt != nullptr) {
+        const std::size_t key_size = mutils::bytes_size(key);
+        buffer = std::make_shared<std::vector<uint8_t>>(key_size + mutils::bytes_size(value));
+        mutils::to_bytes(key,buffer->data());
+        mutils::to_bytes(value,buffer->data() + key_size);
+    }
+    sender.post([this,ctxt,subgroup_idx,shard_idx,key,version,buffer](){
+        std::vector<node_id_t> receivers;
+        if (buffer) {
+            std::lock_guard<std::mutex> lck(subscribers_mutex);
+            receivers.assign(subscribers.cbegin(),subscribers.cend());
+        }
+        for (const auto& receiver : receivers) {
+            try {
+                ctxt->get_service_client_ref().template notify<CascadeMetadataService<CascadeTypes...>>(
+                        Blob(buffer->data(),buffer->size()),key,subgroup_idx,receiver);
+            } catch (derecho::derecho_exception& ex) {
+                dbg_default_warn("Failed to notify client:{} of the metadata change of {}: {}. It is unsubscribed.",
+                                 receiver, key, ex.what());
+                std::lock_guard<std::mutex> lck(subscribers_mutex);
+                subscribers.erase(receiver);
+            }
+        }
+        // a heartbeat reports the change only after it is pushed.
+        std::lock_guard<std::mutex> lck(subscribers_mutex);
+        shard_versions[shard_idx] = version;
+    });
+}
+
+template <typename SubgroupType, typename... CascadeTypes>
+CacheInvalidationPublisher<SubgroupType,CascadeTypes...>::CacheInvalidationPublisher(
+        CriticalDataPathObserver<SubgroupType>* _next_observer):
+    next_observer(_next_observer),
+    has_subscribers(false) {}
+
+template <typename SubgroupType, typename... CascadeTypes>
+void CacheInvalidationPublisher<SubgroupType,CascadeTypes...>::operator()(
+        const uint32_t subgroup_idx,
+        const uint32_t shard_idx,
+        const node_id_t sender_id,
+        const typename SubgroupType::KeyType& key,
+        const typename SubgroupType::ObjectType& value,
+        ICascadeContext* cascade_ctxt,
+        bool is_trigger) {
+    if constexpr (std::is_convertible_v<typename SubgroupType::KeyType,std::string>) {
+        const std::string& key_string = key;
+        auto* ctxt = dynamic_cast<CascadeContext<CascadeTypes...>*>(cascade_ctxt);
+        // the message body: the object pool pathname, the key, the version, and the shard index.
+        auto send = [this,ctxt,subgroup_idx,shard_idx](const std::string& pathname, const std::string& changed_key,
+                                                       const persistent::version_t& version, const node_id_t receiver) {
+            const std::size_t pathname_size = mutils::bytes_size(pathname);
+            const std::size_t key_size = mutils::bytes_size(changed_key);
+            const std::size_t version_size = mutils::bytes_size(version);
+            std::vector<uint8_t> buffer(pathname_size + key_size + version_size + mutils::bytes_size(shard_idx));
+            mutils::to_bytes(pathname,buffer.data());
+            mutils::to_bytes(changed_key,buffer.data() + pathname_size);
+            mutils::to_bytes(version,buffer.data() + pathname_size + key_size);
+            mutils::to_bytes(shard_idx,buffer.data() + pathname_size + key_size + version_size);
+            try {
+                ctxt->get_service_client_ref().template notify_cache_invalidation<SubgroupType>(
+                        Blob(buffer.data(),buffer.size()),pathname,subgroup_idx,receiver);
+            } catch (derecho::derecho_exception& ex) {
+                dbg_default_warn("Failed to notify client:{} of the changes of {}: {}. It is unsubscribed.",
+                                 receiver, pathname, ex.what());
+                std::lock_guard<std::mutex> lck(subscribers_mutex);
+                subscribers[pathname].erase(receiver);
+            }
+        };
+        if (is_trigger && !key_string.empty() && key_string.back() == PATH_SEPARATOR) {
+            // a subscription, which is not passed on.
+            const std::string pathname = key_string.substr(0,key_string.size()-1);
+            {
+                std::lock_guard<std::mutex> lck(subscribers_mutex);
+                subscribers[pathname].emplace(sender_id);
+                has_subscribers.store(true);
+            }
+            dbg_default_debug("Client:{} subscribed to the changes of {} in shard:{}.", sender_id, key_string, shard_idx);
+            if (ctxt != nullptr) {
+                // answer with a heartbeat, which reads the version once the changes before it are pushed.
+                sender.post([this,send,pathname,sender_id](){
+                    persistent::version_t version = persistent::INVALID_VERSION;
+                    {
+                        std::lock_guard<std::mutex> lck(subscribers_mutex);
+                        auto it = pool_versions.find(pathname);
+                        if (it != pool_versions.end()) {
+                            version = it->second;
+                        }
+                    }
+                    send(pathname,"",version,sender_id);
+                });
+            }
+            return;
+        }
+        if (!is_trigger && has_subscribers.load() && ctxt != nullptr) {
+            sender.post([this,send,key_string,version=value.get_version()](){
+                // the subscribed object pools of the key, which is in the object pool of the longest one.
+                std::vector<std::pair<std::string,std::vector<node_id_t>>> receivers;
+                {
+                    std::lock_guard<std::mutex> lck(subscribers_mutex);
+                    for (auto pos = key_string.rfind(PATH_SEPARATOR); pos != std::string::npos && pos > 0;
+                         pos = key_string.rfind(PATH_SEPARATOR,pos-1)) {
+                        auto it = subscribers.find(key_string.substr(0,pos));
+                        if (it != subscribers.end()) {
+                            receivers.emplace_back(it->first,std::vector<node_id_t>(it->second.cbegin(),it->second.cend()));
+                        }
+                    }
+                }
+                for (const auto& per_pool : receivers) {
+                    for (const auto& receiver : per_pool.second) {
+                        send(per_pool.first,key_string,version,receiver);
+                    }
+                    // recorded even without receivers, so that a client dropped meanwhile learns it from a heartbeat.
+                    std::lock_guard<std::mutex> lck(subscribers_mutex);
+                    pool_versions[per_pool.first] = version;
+                }
+            });
+        }
+    }
+    if (next_observer) {
+        (*next_observer)(subgroup_idx,shard_idx,sender_id,key,value,cascade_ctxt,is_trigger);
+    }
+}
+
 }
 }
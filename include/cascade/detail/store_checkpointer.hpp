@@ -0,0 +1,197 @@
+#pragma once
+
+#include <derecho/persistent/PersistentInterface.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * StoreCheckpointer writes periodic checkpoints of a persistent store, tagged with the log version they reflect.
+ * Historical reconstruction can then start from the nearest checkpoint and apply only the deltas after it, instead of
+ * replaying the log from its origin.
+ *
+ * The predicate thread only records the version and size of each update with record(). When the configured interval
+ * (in versions or in bytes) is reached, a background thread reads the deltas recorded since the latest checkpoint back
+ * from the log, and writes an incremental checkpoint with the objects they update. Every
+ * CHECKPOINT_INCREMENTALS_PER_FULL checkpoints, the chain is compacted into a full checkpoint of the whole state, and
+ * the checkpoints older than the 'retention' latest full ones are removed. So the critical path never serializes the
+ * state, and the checkpoint thread rarely does.
+ *
+ * A checkpoint file is named "<name>-<version in hex>.ckpt" and contains a header, the versions applied on top of the
+ * previous checkpoint (its base), and the serialized kv_map of the whole state or of the updated objects. A checkpoint
+ * whose base is unknown, for example the one written from the recovered state on restart, is full and not chained:
+ * reconstruction may start from it, but not from the checkpoint before it.
+ *
+ * @tparam KT   - the key type
+ * @tparam VT   - the value type
+ */
+template <typename KT, typename VT>
+class StoreCheckpointer {
+public:
+    using map_type = std::map<KT, VT>;
+    /**
+     * Read the delta at a log version and pass the object in it to a function.
+     */
+    using delta_reader_t = std::function<void(const persistent::version_t&, const std::function<void(const VT&)>&)>;
+    /**
+     * Reconstruct the state at a log version from the log and pass its kv_map to a function.
+     */
+    using state_reader_t = std::function<void(const persistent::version_t&, const std::function<void(const map_type&)>&)>;
+
+private:
+#define CHECKPOINT_FILE_MAGIC (0x32504b4344435343ull)
+#define CHECKPOINT_FILE_SUFFIX ".ckpt"
+#define CHECKPOINT_INCREMENTALS_PER_FULL (8)
+    struct CheckpointInfo {
+        /* the previous checkpoint this one is built on, or INVALID_VERSION if not chained. */
+        persistent::version_t base_version;
+        /* true if it holds the whole state, false if it only holds the objects updated since its base. */
+        bool full;
+        /* the versions applied on top of the base checkpoint, in log order. */
+        std::vector<persistent::version_t> applied_versions;
+        std::string filename;
+    };
+
+    const std::string directory;
+    const std::string name;
+    const uint64_t interval_versions;
+    const uint64_t interval_bytes;
+    const uint32_t retention;
+    const delta_reader_t delta_reader;
+    const state_reader_t state_reader;
+
+    /* the checkpoints on disk by version, and the versions recorded after pending_base_version. */
+    std::map<persistent::version_t, CheckpointInfo> checkpoints;
+    std::vector<persistent::version_t> pending_versions;
+    /* the version the pending versions are applied on; they extend the chain only if it is the latest checkpoint. */
+    persistent::version_t pending_base_version;
+    /* true until the checkpoint of the recovered state at pending_base_version is written. */
+    bool initial_checkpoint_pending;
+    /* the number of pending versions to go into the next checkpoint. */
+    size_t num_ready_versions;
+    uint64_t versions_since_checkpoint;
+    uint64_t bytes_since_checkpoint;
+    mutable std::mutex checkpoint_mutex;
+    std::condition_variable checkpoint_cv;
+
+    std::atomic<bool> stopped;
+    std::thread checkpoint_thread;
+
+    /**
+     * The checkpoint thread.
+     */
+    void checkpoint_worker();
+    /**
+     * Write a checkpoint file atomically.
+     */
+    void write_checkpoint(const persistent::version_t& version, const CheckpointInfo& info, const map_type& kv_map) const;
+    /**
+     * Read the header of a checkpoint file.
+     *
+     * @return false if it is not a valid checkpoint file.
+     */
+    static bool read_header(std::istream& is, persistent::version_t& version, CheckpointInfo& info);
+    /**
+     * Load the kv_map from an open checkpoint file.
+     */
+    static std::unique_ptr<map_type> load_checkpoint(std::istream& is, const std::string& filename);
+    /**
+     * Open the files of the chain of checkpoints from the latest full one to a checkpoint, in order. It must be called
+     * with checkpoint_mutex held, so that the files are not removed before they are opened.
+     *
+     * @return false if the chain is broken.
+     */
+    bool open_chain(typename std::map<persistent::version_t, CheckpointInfo>::const_iterator checkpoint,
+                    std::vector<std::pair<std::ifstream, std::string>>& files) const;
+    /**
+     * Load the state at a checkpoint from the files of its chain.
+     */
+    static std::unique_ptr<map_type> load_chain(std::vector<std::pair<std::ifstream, std::string>>& files);
+    /**
+     * The number of incremental checkpoints since the latest full one. It must be called with checkpoint_mutex held.
+     */
+    size_t num_incrementals_since_full() const;
+    /**
+     * Remove the checkpoints older than the 'retention' latest full ones. It must be called with checkpoint_mutex
+     * held.
+     */
+    void prune();
+    /**
+     * Load the headers of the checkpoint files of this store in the directory.
+     */
+    void load_catalogue();
+    /**
+     * Apply the deltas at the given versions to a kv_map.
+     */
+    void apply_versions(map_type& kv_map, const std::vector<persistent::version_t>& versions) const;
+    /**
+     * The checkpoint file name of a version.
+     */
+    std::string checkpoint_filename(const persistent::version_t& version) const;
+
+public:
+    /**
+     * Start the checkpointer of a store. The checkpoint of the recovered state, if there is none, is written by the
+     * checkpoint thread.
+     *
+     * @param directory             - the directory for the checkpoint files. It is created if it does not exist.
+     * @param name                  - the name of the store, unique in the directory.
+     * @param interval_versions     - write a checkpoint every so many versions, 0 for no limit.
+     * @param interval_bytes        - write a checkpoint every so many bytes of updates, 0 for no limit.
+     * @param retention             - the number of full checkpoints to keep, with the incremental ones after them.
+     * @param delta_reader          - reads the deltas back from the log.
+     * @param state_reader          - reconstructs a state from the log.
+     * @param version               - the version of the state recovered from the log.
+     */
+    StoreCheckpointer(const std::string& directory,
+                      const std::string& name,
+                      uint64_t interval_versions,
+                      uint64_t interval_bytes,
+                      uint32_t retention,
+                      const delta_reader_t& delta_reader,
+                      const state_reader_t& state_reader,
+                      const persistent::version_t& version);
+    /**
+     * Record an update applied by the predicate thread. The update at 'version' is not in the log yet, so it goes to
+     * the checkpoint after the next one.
+     *
+     * @param version   - the version of the update
+     * @param bytes     - the size of the update
+     */
+    void record(const persistent::version_t& version, uint64_t bytes);
+    /**
+     * Reconstruct the state at a version from the nearest checkpoint, and pass it to a function.
+     *
+     * @param version   - the version
+     * @param func      - the function consuming the state
+     *
+     * @return true if the state is reconstructed, false if no checkpoint chain covers the version.
+     */
+    bool reconstruct(const persistent::version_t& version, const std::function<void(const map_type&)>& func) const;
+    /**
+     * @return the version of the latest checkpoint, or INVALID_VERSION if there is none.
+     */
+    persistent::version_t get_latest_version() const;
+
+    StoreCheckpointer(const StoreCheckpointer&) = delete;
+    StoreCheckpointer& operator=(const StoreCheckpointer&) = delete;
+    virtual ~StoreCheckpointer();
+};
+
+}  // namespace cascade
+}  // namespace derecho
+
+#include "store_checkpointer_impl.hpp"
@@ -0,0 +1,384 @@
+#pragma once
+#include "store_checkpointer.hpp"
+
+#include "debug_util.hpp"
+
+#include <derecho/core/derecho_exception.hpp>
+#include <derecho/mutils-serialization/SerializationSupport.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace derecho {
+namespace cascade {
+
+template <typename KT, typename VT>
+std::string StoreCheckpointer<KT, VT>::checkpoint_filename(const persistent::version_t& version) const {
+    char hex_version[32];
+    snprintf(hex_version, sizeof(hex_version), "%016lx", static_cast<uint64_t>(version));
+    return directory + "/" + name + "-" + hex_version + CHECKPOINT_FILE_SUFFIX;
+}
+
+template <typename KT, typename VT>
+void StoreCheckpointer<KT, VT>::write_checkpoint(const persistent::version_t& version,
+                                                 const CheckpointInfo& info,
+                                                 const map_type& kv_map) const {
+    // The log is the source of truth, so the checkpoint is not synced: a checkpoint lost in a crash is written again.
+    const std::string tmp_filename = info.filename + ".tmp";
+    std::ofstream ofs(tmp_filename, std::ios::binary | std::ios::trunc);
+    if(!ofs) {
+        throw derecho::derecho_exception("Failed to create checkpoint file:" + tmp_filename);
+    }
+    const uint64_t magic = CHECKPOINT_FILE_MAGIC;
+    const uint64_t full = info.full ? 1 : 0;
+    const uint64_t num_applied_versions = info.applied_versions.size();
+    std::vector<uint8_t> map_bytes(mutils::bytes_size(kv_map));
+    mutils::to_bytes(kv_map, map_bytes.data());
+    const uint64_t map_size = map_bytes.size();
+    ofs.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    ofs.write(reinterpret_cast<const char*>(&info.base_version), sizeof(info.base_version));
+    ofs.write(reinterpret_cast<const char*>(&full), sizeof(full));
+    ofs.write(reinterpret_cast<const char*>(&num_applied_versions), sizeof(num_applied_versions));
+    ofs.write(reinterpret_cast<const char*>(info.applied_versions.data()), num_applied_versions * sizeof(persistent::version_t));
+    ofs.write(reinterpret_cast<const char*>(&map_size), sizeof(map_size));
+    ofs.write(reinterpret_cast<const char*>(map_bytes.data()), map_size);
+    ofs.close();
+    if(!ofs) {
+        throw derecho::derecho_exception("Failed to write checkpoint file:" + tmp_filename);
+    }
+    std::filesystem::rename(tmp_filename, info.filename);
+}
+
+template <typename KT, typename VT>
+bool StoreCheckpointer<KT, VT>::read_header(std::istream& is, persistent::version_t& version, CheckpointInfo& info) {
+    uint64_t magic = 0;
+    uint64_t full = 0;
+    uint64_t num_applied_versions = 0;
+    is.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    is.read(reinterpret_cast<char*>(&version), sizeof(version));
+    is.read(reinterpret_cast<char*>(&info.base_version), sizeof(info.base_version));
+    is.read(reinterpret_cast<char*>(&full), sizeof(full));
+    is.read(reinterpret_cast<char*>(&num_applied_versions), sizeof(num_applied_versions));
+    if(!is || magic != CHECKPOINT_FILE_MAGIC) {
+        return false;
+    }
+    info.full = (full != 0);
+    info.applied_versions.resize(num_applied_versions);
+    is.read(reinterpret_cast<char*>(info.applied_versions.data()), num_applied_versions * sizeof(persistent::version_t));
+    return static_cast<bool>(is);
+}
+
+template <typename KT, typename VT>
+std::unique_ptr<typename StoreCheckpointer<KT, VT>::map_type> StoreCheckpointer<KT, VT>::load_checkpoint(std::istream& is, const std::string& filename) {
+    persistent::version_t version;
+    CheckpointInfo info;
+    if(!read_header(is, version, info)) {
+        throw derecho::derecho_exception("Invalid checkpoint file:" + filename);
+    }
+    uint64_t map_size = 0;
+    is.read(reinterpret_cast<char*>(&map_size), sizeof(map_size));
+    std::vector<uint8_t> map_bytes(map_size);
+    is.read(reinterpret_cast<char*>(map_bytes.data()), map_size);
+    if(!is) {
+        throw derecho::derecho_exception("Truncated checkpoint file:" + filename);
+    }
+    return mutils::from_bytes<map_type>(nullptr, map_bytes.data());
+}
+
+template <typename KT, typename VT>
+bool StoreCheckpointer<KT, VT>::open_chain(typename std::map<persistent::version_t, CheckpointInfo>::const_iterator checkpoint,
+                                           std::vector<std::pair<std::ifstream, std::string>>& files) const {
+    std::vector<std::string> filenames;
+    while(!checkpoint->second.full) {
+        filenames.push_back(checkpoint->second.filename);
+        auto base = checkpoints.find(checkpoint->second.base_version);
+        if(base == checkpoints.cend()) {
+            return false;
+        }
+        checkpoint = base;
+    }
+    filenames.push_back(checkpoint->second.filename);
+    // the files stay readable after they are pruned, once they are open.
+    for(auto filename = filenames.crbegin(); filename != filenames.crend(); filename++) {
+        files.emplace_back(std::ifstream(*filename, std::ios::binary), *filename);
+    }
+    return true;
+}
+
+template <typename KT, typename VT>
+std::unique_ptr<typename StoreCheckpointer<KT, VT>::map_type> StoreCheckpointer<KT, VT>::load_chain(
+        std::vector<std::pair<std::ifstream, std::string>>& files) {
+    std::unique_ptr<map_type> kv_map = load_checkpoint(files.front().first, files.front().second);
+    for(auto file = std::next(files.begin()); file != files.end(); file++) {
+        std::unique_ptr<map_type> updates = load_checkpoint(file->first, file->second);
+        // the updated objects take precedence over the ones in the base.
+        updates->merge(*kv_map);
+        kv_map = std::move(updates);
+    }
+    return kv_map;
+}
+
+template <typename KT, typename VT>
+size_t StoreCheckpointer<KT, VT>::num_incrementals_since_full() const {
+    size_t num_incrementals = 0;
+    for(auto checkpoint = checkpoints.crbegin(); checkpoint != checkpoints.crend() && !checkpoint->second.full; checkpoint++) {
+        num_incrementals++;
+    }
+    return num_incrementals;
+}
+
+template <typename KT, typename VT>
+void StoreCheckpointer<KT, VT>::prune() {
+    uint32_t num_full = 0;
+    auto oldest_kept = checkpoints.end();
+    for(auto checkpoint = checkpoints.begin(); checkpoint != checkpoints.end(); checkpoint++) {
+        if(checkpoint->second.full) {
+            num_full++;
+        }
+    }
+    if(num_full <= retention) {
+        return;
+    }
+    // find the oldest of the 'retention' latest full checkpoints.
+    num_full = 0;
+    for(auto checkpoint = checkpoints.end(); checkpoint != checkpoints.begin();) {
+        checkpoint--;
+        if(checkpoint->second.full && ++num_full == retention) {
+            oldest_kept = checkpoint;
+            break;
+        }
+    }
+    for(auto checkpoint = checkpoints.begin(); checkpoint != oldest_kept;) {
+        std::error_code ec;
+        std::filesystem::remove(checkpoint->second.filename, ec);
+        if(ec) {
+            dbg_default_warn("Failed to remove checkpoint file:{}: {}", checkpoint->second.filename, ec.message());
+        }
+        checkpoint = checkpoints.erase(checkpoint);
+    }
+}
+
+template <typename KT, typename VT>
+void StoreCheckpointer<KT, VT>::load_catalogue() {
+    const std::string file_prefix = name + "-";
+    for(const auto& entry : std::filesystem::directory_iterator(directory)) {
+        const std::string filename = entry.path().filename().string();
+        if(!entry.is_regular_file() || filename.rfind(file_prefix, 0) != 0
+           || entry.path().extension().string() != CHECKPOINT_FILE_SUFFIX) {
+            continue;
+        }
+        std::ifstream ifs(entry.path(), std::ios::binary);
+        persistent::version_t version;
+        CheckpointInfo info;
+        if(!read_header(ifs, version, info)) {
+            dbg_default_warn("Skipping invalid checkpoint file:{}", entry.path().string());
+            continue;
+        }
+        info.filename = entry.path().string();
+        checkpoints.emplace(version, std::move(info));
+    }
+}
+
+template <typename KT, typename VT>
+void StoreCheckpointer<KT, VT>::apply_versions(map_type& kv_map, const std::vector<persistent::version_t>& versions) const {
+    for(const auto& ver : versions) {
+        delta_reader(ver, [&kv_map](const VT& value) {
+            kv_map.erase(value.get_key_ref());
+            kv_map.emplace(value.get_key_ref(), value);
+        });
+    }
+}
+
+template <typename KT, typename VT>
+void StoreCheckpointer<KT, VT>::checkpoint_worker() {
+    pthread_setname_np(pthread_self(), "cs_ckpt");
+    while(!stopped.load()) {
+        std::vector<persistent::version_t> batch;
+        persistent::version_t version;
+        CheckpointInfo info;
+        std::vector<std::pair<std::ifstream, std::string>> base_files;
+        bool chained;
+        {
+            std::unique_lock<std::mutex> lck(checkpoint_mutex);
+            checkpoint_cv.wait(lck, [this]() { return stopped.load() || initial_checkpoint_pending || num_ready_versions > 0; });
+            if(stopped.load()) {
+                break;
+            }
+            if(initial_checkpoint_pending) {
+                version = pending_base_version;
+            } else {
+                batch.assign(pending_versions.cbegin(), pending_versions.cbegin() + num_ready_versions);
+                version = batch.back();
+            }
+            chained = !checkpoints.empty() && checkpoints.crbegin()->first == pending_base_version;
+            info.base_version = persistent::INVALID_VERSION;
+            info.full = true;
+            if(chained) {
+                info.base_version = pending_base_version;
+                info.full = (num_incrementals_since_full() + 1 >= CHECKPOINT_INCREMENTALS_PER_FULL);
+                if(info.full) {
+                    chained = open_chain(std::prev(checkpoints.cend()), base_files);
+                    if(!chained) {
+                        info.base_version = persistent::INVALID_VERSION;
+                    }
+                }
+            }
+        }
+        try {
+            auto start = std::chrono::steady_clock::now();
+            size_t num_objects = 0;
+            info.filename = checkpoint_filename(version);
+            if(!chained) {
+                // the chain is broken, so the state is reconstructed from the log.
+                state_reader(version, [this, &version, &info, &num_objects](const map_type& kv_map) {
+                    write_checkpoint(version, info, kv_map);
+                    num_objects = kv_map.size();
+                });
+            } else {
+                info.applied_versions = batch;
+                std::unique_ptr<map_type> kv_map = info.full ? load_chain(base_files) : std::make_unique<map_type>();
+                apply_versions(*kv_map, batch);
+                write_checkpoint(version, info, *kv_map);
+                num_objects = kv_map->size();
+            }
+            {
+                std::lock_guard<std::mutex> lck(checkpoint_mutex);
+                pending_versions.erase(pending_versions.begin(), pending_versions.begin() + batch.size());
+                num_ready_versions -= batch.size();
+                pending_base_version = version;
+                initial_checkpoint_pending = false;
+                const bool full = info.full;
+                checkpoints.emplace(version, std::move(info));
+                if(full) {
+                    prune();
+                }
+            }
+            dbg_default_info("Checkpoint of {} at version 0x{:x} with {} objects is written in {} ms.",
+                             name, version, num_objects,
+                             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+        } catch(const std::exception& ex) {
+            // keep the pending versions; they go into the next checkpoint, which is reconstructed from the log if the
+            // initial one is missing.
+            dbg_default_error("Failed to write checkpoint of {}: {}", name, ex.what());
+            std::lock_guard<std::mutex> lck(checkpoint_mutex);
+            num_ready_versions = 0;
+            initial_checkpoint_pending = false;
+        }
+    }
+}
+
+template <typename KT, typename VT>
+StoreCheckpointer<KT, VT>::StoreCheckpointer(const std::string& _directory,
+                                             const std::string& _name,
+                                             uint64_t _interval_versions,
+                                             uint64_t _interval_bytes,
+                                             uint32_t _retention,
+                                             const delta_reader_t& _delta_reader,
+                                             const state_reader_t& _state_reader,
+                                             const persistent::version_t& version)
+        : directory(_directory),
+          name(_name),
+          interval_versions(_interval_versions),
+          interval_bytes(_interval_bytes),
+          retention(std::max(_retention, 1u)),
+          delta_reader(_delta_reader),
+          state_reader(_state_reader),
+          pending_base_version(version),
+          initial_checkpoint_pending(false),
+          num_ready_versions(0),
+          versions_since_checkpoint(0),
+          bytes_since_checkpoint(0),
+          stopped(false) {
+    std::filesystem::create_directories(directory);
+    load_catalogue();
+    // the checkpoints beyond the recovered version are not in the log any more.
+    while(!checkpoints.empty() && checkpoints.crbegin()->first > version) {
+        std::filesystem::remove(checkpoints.crbegin()->second.filename);
+        checkpoints.erase(std::prev(checkpoints.end()));
+    }
+    prune();
+    // The versions between the latest checkpoint and the recovered version are unknown, so the checkpoint thread
+    // starts a new chain from the recovered state.
+    initial_checkpoint_pending = (version != persistent::INVALID_VERSION
+                                  && (checkpoints.empty() || checkpoints.crbegin()->first != version));
+    checkpoint_thread = std::thread(&StoreCheckpointer<KT, VT>::checkpoint_worker, this);
+}
+
+template <typename KT, typename VT>
+persistent::version_t StoreCheckpointer<KT, VT>::get_latest_version() const {
+    std::lock_guard<std::mutex> lck(checkpoint_mutex);
+    if(checkpoints.empty()) {
+        return persistent::INVALID_VERSION;
+    }
+    return checkpoints.crbegin()->first;
+}
+
+template <typename KT, typename VT>
+void StoreCheckpointer<KT, VT>::record(const persistent::version_t& version, uint64_t bytes) {
+    std::lock_guard<std::mutex> lck(checkpoint_mutex);
+    if((interval_versions > 0 && versions_since_checkpoint >= interval_versions)
+       || (interval_bytes > 0 && bytes_since_checkpoint >= interval_bytes)) {
+        // all pending versions are in the log now.
+        num_ready_versions = pending_versions.size();
+        versions_since_checkpoint = 0;
+        bytes_since_checkpoint = 0;
+        checkpoint_cv.notify_one();
+    }
+    pending_versions.push_back(version);
+    versions_since_checkpoint++;
+    bytes_since_checkpoint += bytes;
+}
+
+template <typename KT, typename VT>
+bool StoreCheckpointer<KT, VT>::reconstruct(const persistent::version_t& version,
+                                            const std::function<void(const map_type&)>& func) const {
+    std::vector<std::pair<std::ifstream, std::string>> files;
+    std::vector<persistent::version_t> versions;
+    {
+        std::lock_guard<std::mutex> lck(checkpoint_mutex);
+        auto checkpoint = checkpoints.upper_bound(version);
+        if(checkpoint == checkpoints.cbegin()) {
+            return false;
+        }
+        checkpoint--;
+        auto next_checkpoint = std::next(checkpoint);
+        const std::vector<persistent::version_t>* following_versions = &pending_versions;
+        if(next_checkpoint != checkpoints.cend()) {
+            if(next_checkpoint->second.base_version != checkpoint->first) {
+                return false;
+            }
+            following_versions = &next_checkpoint->second.applied_versions;
+        } else if(checkpoint->first != pending_base_version) {
+            // the versions between the latest checkpoint and the pending ones are unknown.
+            return false;
+        }
+        if(!open_chain(checkpoint, files)) {
+            return false;
+        }
+        auto end = std::upper_bound(following_versions->cbegin(), following_versions->cend(), version);
+        versions.assign(following_versions->cbegin(), end);
+    }
+    std::unique_ptr<map_type> kv_map = load_chain(files);
+    apply_versions(*kv_map, versions);
+    func(*kv_map);
+    return true;
+}
+
+template <typename KT, typename VT>
+StoreCheckpointer<KT, VT>::~StoreCheckpointer() {
+    {
+        std::lock_guard<std::mutex> lck(checkpoint_mutex);
+        stopped.store(true);
+    }
+    checkpoint_cv.notify_all();
+    if(checkpoint_thread.joinable()) {
+        checkpoint_thread.join();
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <derecho/mutils-serialization/SerializationSupport.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * StreamManifest describes a streamed object, see ServiceClient::put_stream(). The data of a streamed object is split
+ * into chunks of a fixed size, which are stored as objects of their own, and the manifest is stored under the manifest
+ * key of the object (see manifest_key()), so a manifest is told from the data of a normal object by its key, never by
+ * its content. The chunk keys carry the id of the upload, so an upload never overwrites the chunks of the manifest that
+ * the readers see, and the manifest is committed after all of its chunks.
+ *
+ * A manifest also names the upload it replaced, whose chunks are kept until the next upload is committed, so that the
+ * readers of the previous manifest are not cut off by the upload that replaces it.
+ */
+struct StreamManifest : public mutils::ByteRepresentable {
+#define STREAM_CHUNK_KEY_SEPARATOR '~'
+#define STREAM_MANIFEST_KEY_SUFFIX "manifest"
+#define STREAM_DEFAULT_CHUNK_SIZE (1ul << 20)
+#define STREAM_MAX_CHUNKS_IN_FLIGHT (16)
+    /* the size of the data in bytes. */
+    uint64_t total_size;
+    /* the size of each chunk in bytes, but the last one. */
+    uint64_t chunk_size;
+    /* the id of the upload, which is part of the chunk keys: the uploading node and the upload time. */
+    uint64_t uploader_id;
+    uint64_t upload_time;
+    /* the id and the number of chunks of the replaced upload, whose number of chunks is zero if there is none. */
+    uint64_t previous_uploader_id;
+    uint64_t previous_upload_time;
+    uint64_t previous_num_chunks;
+
+    DEFAULT_SERIALIZATION_SUPPORT(StreamManifest, total_size, chunk_size, uploader_id, upload_time,
+                                  previous_uploader_id, previous_upload_time, previous_num_chunks);
+
+    StreamManifest() : total_size(0), chunk_size(0), uploader_id(0), upload_time(0),
+                       previous_uploader_id(0), previous_upload_time(0), previous_num_chunks(0) {}
+    StreamManifest(uint64_t _total_size, uint64_t _chunk_size, uint64_t _uploader_id, uint64_t _upload_time,
+                   uint64_t _previous_uploader_id, uint64_t _previous_upload_time, uint64_t _previous_num_chunks)
+            : total_size(_total_size), chunk_size(_chunk_size), uploader_id(_uploader_id), upload_time(_upload_time),
+              previous_uploader_id(_previous_uploader_id), previous_upload_time(_previous_upload_time),
+              previous_num_chunks(_previous_num_chunks) {}
+
+    /**
+     * @return the number of chunks.
+     */
+    uint64_t num_chunks() const {
+        return chunk_size == 0 ? 0 : (total_size + chunk_size - 1) / chunk_size;
+    }
+
+    /**
+     * @param key       the key of the streamed object
+     * @param index     the chunk index
+     *
+     * @return the key of a chunk, which is in the same object pool as the key.
+     */
+    std::string chunk_key(const std::string& key, uint64_t index) const {
+        return chunk_key(key, uploader_id, upload_time, index);
+    }
+
+    /**
+     * @param key       the key of the streamed object
+     * @param index     the chunk index
+     *
+     * @return the key of a chunk of the replaced upload.
+     */
+    std::string previous_chunk_key(const std::string& key, uint64_t index) const {
+        return chunk_key(key, previous_uploader_id, previous_upload_time, index);
+    }
+
+    static std::string chunk_key(const std::string& key, uint64_t uploader_id, uint64_t upload_time, uint64_t index) {
+        return key + STREAM_CHUNK_KEY_SEPARATOR + std::to_string(uploader_id) + "-" + std::to_string(upload_time)
+               + STREAM_CHUNK_KEY_SEPARATOR + std::to_string(index);
+    }
+
+    /**
+     * @param key       the key of the streamed object
+     *
+     * @return the key of the manifest, which is in the same object pool as the key, and is not a chunk key.
+     */
+    static std::string manifest_key(const std::string& key) {
+        return key + STREAM_CHUNK_KEY_SEPARATOR + STREAM_MANIFEST_KEY_SUFFIX;
+    }
+
+    /**
+     * Deserialize a manifest, checking its size first.
+     *
+     * @param bytes     the data of the manifest object
+     * @param size      the size of the data
+     *
+     * @return the manifest, or nullptr if the data is not a valid manifest.
+     */
+    static std::unique_ptr<StreamManifest> from_blob(const uint8_t* bytes, std::size_t size) {
+        // a manifest has a fixed size.
+        if(bytes == nullptr || size != mutils::bytes_size(StreamManifest{})) {
+            return nullptr;
+        }
+        auto manifest = mutils::from_bytes<StreamManifest>(nullptr, bytes);
+        if(manifest->chunk_size == 0 && manifest->total_size != 0) {
+            return nullptr;
+        }
+        return manifest;
+    }
+};
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <derecho/core/derecho_type_definitions.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * SubmissionLocks serialize the requests a client sends to the same node, while the requests to different nodes are
+ * sent concurrently. Each node has its own lock, created on the first request to it.
+ *
+ * The first request to a node is sent alone: it waits until the requests in flight to the other nodes are sent, and
+ * holds the new ones back until it is sent. Derecho opens the p2p connection to a node lazily, on the first request
+ * from an external client, and it does not promise that opening a connection is safe while requests are sent to the
+ * other nodes, so a connection is opened as it was under a single client lock. A request waiting to be sent alone
+ * goes before the requests which come after it, so that it is not starved by a busy client.
+ *
+ * It is thread-safe. A thread must not lock a node while it holds a lock.
+ */
+class SubmissionLocks {
+private:
+    struct NodeLock {
+        std::mutex mutex;
+        /* true once a request to the node has been sent, protected by gate_mutex. */
+        bool contacted = false;
+    };
+
+    /* the lock of each node, and the requests being sent, protected by gate_mutex. */
+    std::unordered_map<node_id_t, std::unique_ptr<NodeLock>> node_locks;
+    std::size_t shared_senders;
+    bool exclusive_sender;
+    std::mutex gate_mutex;
+    std::condition_variable gate_cv;
+
+    /**
+     * Let the other requests go once a request is sent.
+     *
+     * @param exclusive     - true if the request was sent alone.
+     */
+    void release(bool exclusive);
+
+public:
+    /**
+     * Guard holds the lock of a node while a request is sent to it, and releases it when destroyed.
+     */
+    class Guard {
+    private:
+        friend class SubmissionLocks;
+        SubmissionLocks& locks;
+        const bool exclusive;
+        std::unique_lock<std::mutex> node_lock;
+
+        Guard(SubmissionLocks& _locks, bool _exclusive, std::mutex& node_mutex);
+
+    public:
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard();
+    };
+
+    SubmissionLocks();
+    SubmissionLocks(const SubmissionLocks&) = delete;
+    SubmissionLocks& operator=(const SubmissionLocks&) = delete;
+
+    /**
+     * Lock a node, waiting for the requests which must be sent before.
+     *
+     * @param node_id       - the destination node
+     *
+     * @return the guard, which the caller holds while sending the request.
+     */
+    Guard lock(node_id_t node_id);
+};
+
+}  // namespace cascade
+}  // namespace derecho
@@ -28,6 +28,24 @@ void TriggerCascadeNoStore<KT, VT, IK, IV>::put_and_forget(const VT& value) cons
     dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+void TriggerCascadeNoStore<KT, VT, IK, IV>::put_and_forget_batch(const std::vector<VT>& values) const {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<std::tuple<persistent::version_t, uint64_t>> TriggerCascadeNoStore<KT, VT, IK, IV>::put_batch(const std::vector<VT>& values) const {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return {};
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::tuple<persistent::version_t, uint64_t> TriggerCascadeNoStore<KT, VT, IK, IV>::transact(
+        const std::vector<std::tuple<KT, persistent::version_t>>& read_set, const std::vector<VT>& write_set) const {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return {};
+}
+
 #ifdef ENABLE_EVALUATION
 template <typename KT, typename VT, KT* IK, VT* IV>
 double TriggerCascadeNoStore<KT, VT, IK, IV>::perf_put(const uint32_t max_payload_size, const uint64_t duration_sec) const {
@@ -60,6 +78,18 @@ const VT TriggerCascadeNoStore<KT, VT, IK, IV>::get_by_time(const KT& key, const
     return *IV;
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<VT> TriggerCascadeNoStore<KT, VT, IK, IV>::get_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return std::vector<VT>(keys.size(), *IV);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<VT> TriggerCascadeNoStore<KT, VT, IK, IV>::get_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return std::vector<VT>(keys.size(), *IV);
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV>
 std::vector<KT> TriggerCascadeNoStore<KT, VT, IK, IV>::multi_list_keys(const std::string& prefix) const {
     dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
@@ -96,6 +126,18 @@ uint64_t TriggerCascadeNoStore<KT, VT, IK, IV>::get_size_by_time(const KT& key,
     return 0;
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<uint64_t> TriggerCascadeNoStore<KT, VT, IK, IV>::get_size_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return std::vector<uint64_t>(keys.size(), 0);
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<uint64_t> TriggerCascadeNoStore<KT, VT, IK, IV>::get_size_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return std::vector<uint64_t>(keys.size(), 0);
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV>
 std::vector<KT> TriggerCascadeNoStore<KT, VT, IK, IV>::ordered_list_keys(const std::string& prefix) {
     dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
@@ -113,6 +155,19 @@ void TriggerCascadeNoStore<KT, VT, IK, IV>::ordered_put_and_forget(const VT& val
     dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<std::tuple<persistent::version_t, uint64_t>> TriggerCascadeNoStore<KT, VT, IK, IV>::ordered_put_batch(const std::vector<VT>& values) {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return {};
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::tuple<persistent::version_t, uint64_t> TriggerCascadeNoStore<KT, VT, IK, IV>::ordered_transact(
+        const std::vector<std::tuple<KT, persistent::version_t>>& read_set, const std::vector<VT>& write_set) {
+    dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
+    return {};
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV>
 std::tuple<persistent::version_t, uint64_t> TriggerCascadeNoStore<KT, VT, IK, IV>::ordered_remove(const KT& key) {
     dbg_default_warn("Calling unsupported func:{}", __PRETTY_FUNCTION__);
@@ -148,6 +203,15 @@ void TriggerCascadeNoStore<KT, VT, IK, IV>::trigger_put(const VT& value) const {
     debug_leave_func();
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+void TriggerCascadeNoStore<KT, VT, IK, IV>::trigger_put_batch(const std::vector<VT>& values) const {
+    debug_enter_func_with_args("values.size()={}", values.size());
+    for(const auto& value : values) {
+        trigger_put(value);
+    }
+    debug_leave_func();
+}
+
 #ifdef ENABLE_EVALUATION
 
 template <typename KT, typename VT, KT* IK, VT* IV>
@@ -11,7 +11,9 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
 
 namespace derecho {
 namespace cascade {
@@ -47,6 +49,50 @@ void VolatileCascadeStore<KT, VT, IK, IV>::put_and_forget(const VT& value) const
     debug_leave_func();
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+void VolatileCascadeStore<KT, VT, IK, IV>::put_and_forget_batch(const std::vector<VT>& values) const {
+    debug_enter_func_with_args("values.size()={}", values.size());
+    for(const auto& value : values) {
+        put_and_forget(value);
+    }
+    debug_leave_func();
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<std::tuple<persistent::version_t, uint64_t>> VolatileCascadeStore<KT, VT, IK, IV>::put_batch(const std::vector<VT>& values) const {
+    debug_enter_func_with_args("values.size()={}", values.size());
+
+    derecho::Replicated<VolatileCascadeStore>& subgroup_handle = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index);
+    auto results = subgroup_handle.template ordered_send<RPC_NAME(ordered_put_batch)>(values);
+    auto& replies = results.get();
+    std::vector<std::tuple<persistent::version_t, uint64_t>> ret;
+    // TODO: verfiy consistency ?
+    for(auto& reply_pair : replies) {
+        ret = reply_pair.second.get();
+    }
+
+    debug_leave_func();
+    return ret;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::tuple<persistent::version_t, uint64_t> VolatileCascadeStore<KT, VT, IK, IV>::transact(
+        const std::vector<std::tuple<KT, persistent::version_t>>& read_set, const std::vector<VT>& write_set) const {
+    debug_enter_func_with_args("read_set.size()={},write_set.size()={}", read_set.size(), write_set.size());
+
+    derecho::Replicated<VolatileCascadeStore>& subgroup_handle = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index);
+    auto results = subgroup_handle.template ordered_send<RPC_NAME(ordered_transact)>(read_set, write_set);
+    auto& replies = results.get();
+    std::tuple<persistent::version_t, uint64_t> ret(CURRENT_VERSION, 0);
+    // TODO: verfiy consistency ?
+    for(auto& reply_pair : replies) {
+        ret = reply_pair.second.get();
+    }
+
+    debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(ret), std::get<1>(ret));
+    return ret;
+}
+
 #ifdef ENABLE_EVALUATION
 
 template <typename CascadeType>
@@ -119,9 +165,46 @@ const VT VolatileCascadeStore<KT, VT, IK, IV>::get(const KT& key, const persiste
         return *IV;
     }
 
-    // copy data out
+    // The epoch guard keeps the object alive while we copy it into the return value, so there is no need to
+    // validate against lockless_v1/lockless_v2 and retry. The copy shares the blob of the stored object, which is
+    // immutable and reference-counted, so the data is not copied.
+    EpochManager::Guard epoch_guard;
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        debug_leave_func();
+        return it->second;
+    }
+    debug_leave_func();
+    return *IV;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+const VT VolatileCascadeStore<KT, VT, IK, IV>::multi_get(const KT& key) const {
+    debug_enter_func_with_args("key={}", key);
+
+    derecho::Replicated<VolatileCascadeStore>& subgroup_handle = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index);
+    auto results = subgroup_handle.template ordered_send<RPC_NAME(ordered_get)>(key);
+    auto& replies = results.get();
+    // TODO: verify consistency ?
+    for(auto& reply_pair : replies) {
+        reply_pair.second.wait();
+    }
+    debug_leave_func();
+    return replies.begin()->second.get();
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+const VT VolatileCascadeStore<KT, VT, IK, IV>::get_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const {
+    // VolatileCascadeStore does not support this.
+    debug_enter_func();
+    debug_leave_func();
+
+    return *IV;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void VolatileCascadeStore<KT, VT, IK, IV>::lockless_find_many(const std::vector<KT>& keys, std::vector<const VT*>& objects) const {
     persistent::version_t v1, v2;
-    static thread_local VT copied_out;
     do {
         // This only for TSO memory reordering.
         v2 = this->lockless_v2.load(std::memory_order_relaxed);
@@ -132,10 +215,11 @@ const VT VolatileCascadeStore<KT, VT, IK, IV>::get(const KT& key, const persiste
 #else
 #error Lockless support is currently for GCC only
 #endif
-        if(this->kv_map.find(key) != this->kv_map.end()) {
-            copied_out.copy_from(this->kv_map.at(key));
-        } else {
-            copied_out.copy_from(*IV);
+        // only the map nodes are collected here; the objects are copied once the state is known to be consistent.
+        objects.clear();
+        typename std::map<KT, VT>::iterator it;
+        for(const auto& key : keys) {
+            objects.emplace_back(this->kv_index.lookup(key, it) ? &it->second : nullptr);
         }
         // compiler reordering barrier
 #ifdef __GNUC__
@@ -145,34 +229,42 @@ const VT VolatileCascadeStore<KT, VT, IK, IV>::get(const KT& key, const persiste
 #error Lockless support is currently for GCC only
 #endif
         v1 = this->lockless_v1.load(std::memory_order_relaxed);
-        // busy sleep
-        std::this_thread::yield();
+        if(v1 != v2) {
+            // busy sleep only when we have to retry
+            std::this_thread::yield();
+        }
     } while(v1 != v2);
-    return copied_out;
 }
 
+// stable is ignored for VolatileCascadeStore
 template <typename KT, typename VT, KT* IK, VT* IV>
-const VT VolatileCascadeStore<KT, VT, IK, IV>::multi_get(const KT& key) const {
-    debug_enter_func_with_args("key={}", key);
+std::vector<VT> VolatileCascadeStore<KT, VT, IK, IV>::get_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool) const {
+    debug_enter_func_with_args("keys.size()={},ver=0x{:x}", keys.size(), ver);
+    if(ver != CURRENT_VERSION) {
+        debug_leave_func_with_value("Cannot support versioned get, ver=0x{:x}", ver);
+        return std::vector<VT>(keys.size(), *IV);
+    }
 
-    derecho::Replicated<VolatileCascadeStore>& subgroup_handle = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index);
-    auto results = subgroup_handle.template ordered_send<RPC_NAME(ordered_get)>(key);
-    auto& replies = results.get();
-    // TODO: verify consistency ?
-    for(auto& reply_pair : replies) {
-        reply_pair.second.wait();
+    // The epoch guard keeps the found objects alive, even if they are replaced after the lookups.
+    EpochManager::Guard epoch_guard;
+    std::vector<const VT*> objects;
+    lockless_find_many(keys, objects);
+    std::vector<VT> values;
+    values.reserve(keys.size());
+    for(const auto* object : objects) {
+        values.emplace_back(object ? *object : *IV);
     }
     debug_leave_func();
-    return replies.begin()->second.get();
+    return values;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
-const VT VolatileCascadeStore<KT, VT, IK, IV>::get_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const {
+std::vector<VT> VolatileCascadeStore<KT, VT, IK, IV>::get_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const {
     // VolatileCascadeStore does not support this.
     debug_enter_func();
     debug_leave_func();
 
-    return *IV;
+    return std::vector<VT>(keys.size(), *IV);
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
@@ -229,36 +321,15 @@ uint64_t VolatileCascadeStore<KT, VT, IK, IV>::get_size(const KT& key, const per
         debug_leave_func_with_value("Cannot support versioned get, ver=0x{:x}", ver);
         return 0;
     }
-    debug_leave_func();
 
-    // copy data out
-    persistent::version_t v1, v2;
-    uint64_t size = 0ull;
-    do {
-        // This only for TSO memory reordering.
-        v2 = this->lockless_v2.load(std::memory_order_relaxed);
-        // compiler reordering barrier
-#ifdef __GNUC__
-        asm volatile("" ::
-                             : "memory");
-#else
-#error Lockless support is currently for GCC only
-#endif
-        if(this->kv_map.find(key) != this->kv_map.end()) {
-            size = mutils::bytes_size(this->kv_map.at(key));
-        }
-        // compiler reordering barrier
-#ifdef __GNUC__
-        asm volatile("" ::
-                             : "memory");
-#else
-#error Lockless support is currently for GCC only
-#endif
-        v1 = this->lockless_v1.load(std::memory_order_relaxed);
-        // busy sleep
-        std::this_thread::yield();
-    } while(v1 != v2);
-    return size;
+    EpochManager::Guard epoch_guard;
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        debug_leave_func();
+        return mutils::bytes_size(it->second);
+    }
+    debug_leave_func();
+    return 0;
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
@@ -270,15 +341,40 @@ uint64_t VolatileCascadeStore<KT, VT, IK, IV>::get_size_by_time(const KT&, const
     return 0;
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<uint64_t> VolatileCascadeStore<KT, VT, IK, IV>::get_size_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool) const {
+    debug_enter_func_with_args("keys.size()={},ver=0x{:x}", keys.size(), ver);
+    if(ver != CURRENT_VERSION) {
+        debug_leave_func_with_value("Cannot support versioned get, ver=0x{:x}", ver);
+        return std::vector<uint64_t>(keys.size(), 0);
+    }
+
+    EpochManager::Guard epoch_guard;
+    std::vector<const VT*> objects;
+    lockless_find_many(keys, objects);
+    std::vector<uint64_t> sizes;
+    sizes.reserve(keys.size());
+    for(const auto* object : objects) {
+        sizes.emplace_back(object ? mutils::bytes_size(*object) : 0);
+    }
+    debug_leave_func();
+    return sizes;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<uint64_t> VolatileCascadeStore<KT, VT, IK, IV>::get_size_many_by_time(const std::vector<KT>& keys, const uint64_t&, const bool) const {
+    // VolatileCascadeStore does not support this.
+    debug_enter_func();
+
+    debug_leave_func();
+    return std::vector<uint64_t>(keys.size(), 0);
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV>
 std::vector<KT> VolatileCascadeStore<KT, VT, IK, IV>::ordered_list_keys(const std::string& prefix) {
     std::vector<KT> key_list;
     debug_enter_func();
-    for(auto kv : this->kv_map) {
-        if(get_pathname<KT>(kv.first).find(prefix) == 0) {
-            key_list.push_back(kv.first);
-        }
-    }
+    this->key_trie.list_keys(prefix, key_list);
 
     debug_leave_func();
     return key_list;
@@ -290,7 +386,7 @@ std::tuple<persistent::version_t, uint64_t> VolatileCascadeStore<KT, VT, IK, IV>
 
     std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index).get_current_version();
 
-    if(this->internal_ordered_put(value) == false) {
+    if(this->internal_ordered_put(value, this->update_version) == false) {
         version_and_timestamp = {persistent::INVALID_VERSION, 0};
     }
 
@@ -299,17 +395,159 @@ std::tuple<persistent::version_t, uint64_t> VolatileCascadeStore<KT, VT, IK, IV>
     return version_and_timestamp;
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::vector<std::tuple<persistent::version_t, uint64_t>> VolatileCascadeStore<KT, VT, IK, IV>::ordered_put_batch(const std::vector<VT>& values) {
+    debug_enter_func_with_args("values.size()={}", values.size());
+
+    // the batch is one ordered message, so all values share its version and timestamp, and follow the same version.
+    const std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index).get_current_version();
+    const persistent::version_t prev_ver = this->update_version;
+    std::vector<std::tuple<persistent::version_t, uint64_t>> ret;
+    ret.reserve(values.size());
+    std::vector<const VT*> accepted_values;
+
+    // the whole batch is one update for the lockless check, so that get_many sees all of it or none of it.
+    this->lockless_v1.store(std::get<0>(version_and_timestamp), std::memory_order_relaxed);
+    // compiler reordering barrier
+#ifdef __GNUC__
+    asm volatile("" ::
+                         : "memory");
+#else
+#error Lockless support is currently for GCC only
+#endif
+
+    for(const auto& value : values) {
+        if constexpr(std::is_base_of<IKeepVersion, VT>::value) {
+            value.set_version(std::get<0>(version_and_timestamp));
+        }
+        if constexpr(std::is_base_of<IKeepTimestamp, VT>::value) {
+            value.set_timestamp(std::get<1>(version_and_timestamp));
+        }
+        // the next values are verified against this one.
+        if(verify_ordered_put(value, prev_ver)) {
+            this->apply_ordered_put(value.get_key_ref(), value);
+            this->update_version = std::get<0>(version_and_timestamp);
+            accepted_values.emplace_back(&value);
+            ret.emplace_back(version_and_timestamp);
+        } else {
+            ret.emplace_back(persistent::INVALID_VERSION, 0);
+        }
+    }
+
+    // for lockless check
+    // compiler reordering barrier
+#ifdef __GNUC__
+    asm volatile("" ::
+                         : "memory");
+#else
+#error Lockless support is currently for GCC only
+#endif
+    this->lockless_v2.store(std::get<0>(version_and_timestamp), std::memory_order_relaxed);
+
+    if(cascade_watcher_ptr) {
+        for(const auto* value : accepted_values) {
+            (*cascade_watcher_ptr)(
+                    this->subgroup_index,
+                    group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index).get_shard_num(),
+                    group->get_rpc_caller_id(),
+                    value->get_key_ref(), *value, cascade_context_ptr);
+        }
+    }
+
+    debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(version_and_timestamp), std::get<1>(version_and_timestamp));
+    return ret;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+std::tuple<persistent::version_t, uint64_t> VolatileCascadeStore<KT, VT, IK, IV>::ordered_transact(
+        const std::vector<std::tuple<KT, persistent::version_t>>& read_set, const std::vector<VT>& write_set) {
+    debug_enter_func_with_args("read_set.size()={},write_set.size()={}", read_set.size(), write_set.size());
+
+    const std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index).get_current_version();
+    typename std::map<KT, VT>::iterator it;
+    // 1) check the read set.
+    // the version of a key is that of its object, a removed key included, like in verify_ordered_put().
+    for(const auto& read : read_set) {
+        persistent::version_t current_version = persistent::INVALID_VERSION;
+        if(this->kv_index.lookup(std::get<0>(read), it)) {
+            current_version = it->second.get_version();
+        }
+        if(current_version != std::get<1>(read)) {
+            debug_leave_func_with_value("stale read set at version=0x{:x}", std::get<0>(version_and_timestamp));
+            return {persistent::INVALID_VERSION, 0};
+        }
+    }
+    // 2) verify the write set against the state before the transaction.
+    std::unordered_set<KT> write_keys;
+    for(const auto& value : write_set) {
+        if constexpr(std::is_base_of<IKeepVersion, VT>::value) {
+            value.set_version(std::get<0>(version_and_timestamp));
+        }
+        if constexpr(std::is_base_of<IKeepTimestamp, VT>::value) {
+            value.set_timestamp(std::get<1>(version_and_timestamp));
+        }
+        if(!write_keys.insert(value.get_key_ref()).second || !verify_ordered_put(value, this->update_version)) {
+            debug_leave_func_with_value("rejected write set at version=0x{:x}", std::get<0>(version_and_timestamp));
+            return {persistent::INVALID_VERSION, 0};
+        }
+    }
+    // a read-only transaction creates no version: return the one whose state was checked.
+    if(write_set.empty()) {
+        debug_leave_func_with_value("read-only transaction checked at version=0x{:x}", this->update_version);
+        return {this->update_version, 0};
+    }
+
+    // 3) apply the write set.
+    // for lockless check
+    this->lockless_v1.store(std::get<0>(version_and_timestamp), std::memory_order_relaxed);
+    // compiler reordering barrier
+#ifdef __GNUC__
+    asm volatile("" ::
+                         : "memory");
+#else
+#error Lockless support is currently for GCC only
+#endif
+
+    for(const auto& value : write_set) {
+        this->apply_ordered_put(value.get_key_ref(), value);
+    }
+    this->update_version = std::get<0>(version_and_timestamp);
+
+    // for lockless check
+    // compiler reordering barrier
+#ifdef __GNUC__
+    asm volatile("" ::
+                         : "memory");
+#else
+#error Lockless support is currently for GCC only
+#endif
+    this->lockless_v2.store(std::get<0>(version_and_timestamp), std::memory_order_relaxed);
+
+    if(cascade_watcher_ptr) {
+        for(const auto& value : write_set) {
+            (*cascade_watcher_ptr)(
+                    this->subgroup_index,
+                    group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index).get_shard_num(),
+                    group->get_rpc_caller_id(),
+                    value.get_key_ref(), value, cascade_context_ptr);
+        }
+    }
+
+    debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(version_and_timestamp), std::get<1>(version_and_timestamp));
+    return version_and_timestamp;
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV>
 void VolatileCascadeStore<KT, VT, IK, IV>::ordered_put_and_forget(const VT& value) {
     debug_enter_func_with_args("key={}", value.get_key_ref());
     LOG_TIMESTAMP_BY_TAG(TLT_VOLATILE_ORDERED_PUT_AND_FORGET_START, group, value);
-    internal_ordered_put(value);
+    internal_ordered_put(value, this->update_version);
     LOG_TIMESTAMP_BY_TAG(TLT_VOLATILE_ORDERED_PUT_AND_FORGET_END, group, value);
     debug_leave_func();
 }
 
 template <typename KT, typename VT, KT* IK, VT* IV>
-bool VolatileCascadeStore<KT, VT, IK, IV>::internal_ordered_put(const VT& value) {
+bool VolatileCascadeStore<KT, VT, IK, IV>::internal_ordered_put(const VT& value, const persistent::version_t& prev_ver) {
     std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index).get_current_version();
 
     if constexpr(std::is_base_of<IKeepVersion, VT>::value) {
@@ -319,32 +557,8 @@ bool VolatileCascadeStore<KT, VT, IK, IV>::internal_ordered_put(const VT& value)
         value.set_timestamp(std::get<1>(version_and_timestamp));
     }
 
-    // validator
-    if constexpr(std::is_base_of<IValidator<KT, VT>, VT>::value) {
-        if(!value.validate(this->kv_map)) {
-            return false;
-        }
-    }
-
-    // Verify previous version MUST happen before update previous versions.
-    if constexpr(std::is_base_of<IVerifyPreviousVersion, VT>::value) {
-        bool verify_result;
-        if(this->kv_map.find(value.get_key_ref()) != this->kv_map.end()) {
-            verify_result = value.verify_previous_version(this->update_version, this->kv_map.at(value.get_key_ref()).get_version());
-        } else {
-            verify_result = value.verify_previous_version(this->update_version, persistent::INVALID_VERSION);
-        }
-        if(!verify_result) {
-            // reject the update by returning an invalid version and timestamp
-            return false;
-        }
-    }
-    if constexpr(std::is_base_of<IKeepPreviousVersion, VT>::value) {
-        if(this->kv_map.find(value.get_key_ref()) != this->kv_map.end()) {
-            value.set_previous_version(this->update_version, this->kv_map.at(value.get_key_ref()).get_version());
-        } else {
-            value.set_previous_version(this->update_version, persistent::INVALID_VERSION);
-        }
+    if(!verify_ordered_put(value, prev_ver)) {
+        return false;
     }
 
     // for lockless check
@@ -357,8 +571,7 @@ bool VolatileCascadeStore<KT, VT, IK, IV>::internal_ordered_put(const VT& value)
 #error Lockless support is currently for GCC only
 #endif
 
-    this->kv_map.erase(value.get_key_ref());           // remove
-    this->kv_map.emplace(value.get_key_ref(), value);  // copy constructor
+    this->apply_ordered_put(value.get_key_ref(), value);
     this->update_version = std::get<0>(version_and_timestamp);
 
     // for lockless check
@@ -383,13 +596,73 @@ bool VolatileCascadeStore<KT, VT, IK, IV>::internal_ordered_put(const VT& value)
     return true;
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+bool VolatileCascadeStore<KT, VT, IK, IV>::verify_ordered_put(const VT& value, const persistent::version_t& prev_ver) {
+    // only the deltas in the log refer to blob segments.
+    if constexpr(std::is_base_of<IOffloadableBlob<VT>, VT>::value) {
+        if(value.has_blob_segment_ref()) {
+            dbg_default_warn("{}: rejected an object of key:{} referring to a blob segment.", __PRETTY_FUNCTION__, value.get_key_ref());
+            return false;
+        }
+    }
+    // validator
+    if constexpr(std::is_base_of<IValidator<KT, VT>, VT>::value) {
+        if(!value.validate(this->kv_map)) {
+            return false;
+        }
+    }
+
+    typename std::map<KT, VT>::iterator it;
+    const bool found = this->kv_index.lookup(value.get_key_ref(), it);
+    // Verify previous version MUST happen before update previous versions.
+    if constexpr(std::is_base_of<IVerifyPreviousVersion, VT>::value) {
+        bool verify_result;
+        if(found) {
+            verify_result = value.verify_previous_version(prev_ver, it->second.get_version());
+        } else {
+            verify_result = value.verify_previous_version(prev_ver, persistent::INVALID_VERSION);
+        }
+        if(!verify_result) {
+            // reject the update by returning an invalid version and timestamp
+            return false;
+        }
+    }
+    if constexpr(std::is_base_of<IKeepPreviousVersion, VT>::value) {
+        if(found) {
+            value.set_previous_version(prev_ver, it->second.get_version());
+        } else {
+            value.set_previous_version(prev_ver, persistent::INVALID_VERSION);
+        }
+    }
+    return true;
+}
+
+template <typename KT, typename VT, KT* IK, VT* IV>
+void VolatileCascadeStore<KT, VT, IK, IV>::apply_ordered_put(const KT& key, const VT& value) {
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        // Lockless readers may still be reading the old node, so it is retired instead of freed.
+        auto hint = std::next(it);
+        auto old_node = this->kv_map.extract(it);
+        it = this->kv_map.emplace_hint(hint, key, value);
+        this->kv_index.put(it);
+        const std::size_t old_bytes = mutils::bytes_size(old_node.mapped());
+        EpochManager::get().retire(std::move(old_node), old_bytes);
+    } else {
+        it = this->kv_map.emplace(key, value).first;
+        this->kv_index.put(it);
+        this->key_trie.insert(key);
+    }
+}
+
 template <typename KT, typename VT, KT* IK, VT* IV>
 std::tuple<persistent::version_t, uint64_t> VolatileCascadeStore<KT, VT, IK, IV>::ordered_remove(const KT& key) {
     debug_enter_func_with_args("key={}", key);
 
     std::tuple<persistent::version_t, uint64_t> version_and_timestamp = group->template get_subgroup<VolatileCascadeStore>(this->subgroup_index).get_current_version();
 
-    if(this->kv_map.find(key) == this->kv_map.end()) {
+    typename std::map<KT, VT>::iterator it;
+    if(!this->kv_index.lookup(key, it)) {
         debug_leave_func_with_value("version=0x{:x},timestamp={}", std::get<0>(version_and_timestamp), std::get<1>(version_and_timestamp));
         return version_and_timestamp;
     }
@@ -403,11 +676,7 @@ std::tuple<persistent::version_t, uint64_t> VolatileCascadeStore<KT, VT, IK, IV>
         value.set_timestamp(std::get<1>(version_and_timestamp));
     }
     if constexpr(std::is_base_of<IKeepPreviousVersion, VT>::value) {
-        if(this->kv_map.find(key) != this->kv_map.end()) {
-            value.set_previous_version(this->update_version, this->kv_map.at(key).get_version());
-        } else {
-            value.set_previous_version(this->update_version, persistent::INVALID_VERSION);
-        }
+        value.set_previous_version(this->update_version, it->second.get_version());
     }
 
     // for lockless check
@@ -420,8 +689,7 @@ std::tuple<persistent::version_t, uint64_t> VolatileCascadeStore<KT, VT, IK, IV>
 #error Lockless support is currently for GCC only
 #endif
 
-    this->kv_map.erase(key);  // remove
-    this->kv_map.emplace(key, value);
+    this->apply_ordered_put(key, value);
     this->update_version = std::get<0>(version_and_timestamp);
 
     // for lockless check
@@ -452,9 +720,10 @@ template <typename KT, typename VT, KT* IK, VT* IV>
 const VT VolatileCascadeStore<KT, VT, IK, IV>::ordered_get(const KT& key) {
     debug_enter_func_with_args("key={}", key);
 
-    if(this->kv_map.find(key) != this->kv_map.end()) {
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
         debug_leave_func_with_value("key={}", key);
-        return this->kv_map.at(key);
+        return it->second;
     } else {
         debug_leave_func();
         return *IV;
@@ -465,8 +734,9 @@ template <typename KT, typename VT, KT* IK, VT* IV>
 uint64_t VolatileCascadeStore<KT, VT, IK, IV>::ordered_get_size(const KT& key) {
     debug_enter_func_with_args("key={}", key);
 
-    if(this->kv_map.find(key) != this->kv_map.end()) {
-        return mutils::bytes_size(this->kv_map.at(key));
+    typename std::map<KT, VT>::iterator it;
+    if(this->kv_index.lookup(key, it)) {
+        return mutils::bytes_size(it->second);
     } else {
         debug_leave_func();
         return 0;
@@ -488,6 +758,15 @@ void VolatileCascadeStore<KT, VT, IK, IV>::trigger_put(const VT& value) const {
     debug_leave_func();
 }
 
+template <typename KT, typename VT, KT* IK, VT* IV>
+void VolatileCascadeStore<KT, VT, IK, IV>::trigger_put_batch(const std::vector<VT>& values) const {
+    debug_enter_func_with_args("values.size()={}", values.size());
+    for(const auto& value : values) {
+        trigger_put(value);
+    }
+    debug_leave_func();
+}
+
 #ifdef ENABLE_EVALUATION
 template <typename KT, typename VT, KT* IK, VT* IV>
 void VolatileCascadeStore<KT, VT, IK, IV>::dump_timestamp_log(const std::string& filename) const {
@@ -556,6 +835,10 @@ VolatileCascadeStore<KT, VT, IK, IV>::VolatileCascadeStore(
                                cascade_watcher_ptr(cw),
                                cascade_context_ptr(cc) {
     debug_enter_func_with_args("copy to kv_map, size={}", kv_map.size());
+    kv_index.rebuild(kv_map);
+    for(const auto& kv : kv_map) {
+        key_trie.insert(kv.first);
+    }
     debug_leave_func();
 }
 
@@ -571,6 +854,10 @@ VolatileCascadeStore<KT, VT, IK, IV>::VolatileCascadeStore(
                                cascade_watcher_ptr(cw),
                                cascade_context_ptr(cc) {
     debug_enter_func_with_args("move to kv_map, size={}", kv_map.size());
+    kv_index.rebuild(kv_map);
+    for(const auto& kv : kv_map) {
+        key_trie.insert(kv.first);
+    }
     debug_leave_func();
 }
 }  // namespace cascade
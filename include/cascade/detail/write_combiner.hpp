@@ -0,0 +1,227 @@
+#pragma once
+
+#include <derecho/core/derecho.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <typeindex>
+#include <vector>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * WriteCombiner implements the client-side coalescing of put_and_forget in the ServiceClient. The objects are buffered
+ * per destination shard, and a buffer is sent as one batch when it reaches a size threshold, or when its oldest object
+ * has waited for a deadline, whichever comes first. Only the writes without a reply are coalesced, since a buffered
+ * write has no future to return.
+ *
+ * A buffer is sent under its own lock, so the batches to a shard are sent in order.
+ * The ServiceClient flushes the buffers of a shard before any other request to it (see flush_shard()), so that a
+ * write is not overtaken by the requests issued after it. The deadlines are watched by a worker thread, which is
+ * started when coalescing is enabled.
+ */
+class WriteCombiner {
+public:
+#define WRITE_COMBINER_DEFAULT_MAX_BATCH_BYTES (65536)
+#define WRITE_COMBINER_DEFAULT_MAX_DELAY_US (500)
+    /* a buffer is identified by the subgroup type, the subgroup index, and the shard index. */
+    using buffer_key_t = std::tuple<std::type_index, uint32_t, uint32_t>;
+
+    /**
+     * The counters of the coalesced writes.
+     */
+    struct Stats {
+        /* the objects buffered. */
+        uint64_t objects;
+        /* the batches sent. */
+        uint64_t batches;
+    };
+
+private:
+    /**
+     * The buffer of a shard, whatever the object type is.
+     */
+    class Buffer {
+    public:
+        std::mutex mutex;
+        /* the time in microseconds when the buffer must be sent, or zero if it is empty. */
+        std::atomic<uint64_t> deadline_us{0};
+        virtual ~Buffer() = default;
+        /**
+         * @return the number of buffered objects. The caller must hold the mutex.
+         */
+        virtual std::size_t size() const = 0;
+        /**
+         * Send the buffered objects as one batch. The caller must hold the mutex.
+         *
+         * @return true if there was anything to send.
+         */
+        virtual bool flush() = 0;
+    };
+
+    template <typename ObjectType>
+    class TypedBuffer;
+
+    std::atomic<bool> enabled;
+    std::atomic<std::size_t> max_batch_bytes;
+    std::atomic<uint64_t> max_delay_us;
+    /* the buffers are never erased, so a buffer can be used without buffers_mutex. */
+    std::map<buffer_key_t, std::unique_ptr<Buffer>> buffers;
+    std::mutex buffers_mutex;
+    std::condition_variable buffers_cv;
+
+    std::atomic<uint64_t> objects;
+    std::atomic<uint64_t> batches;
+    /* the objects buffered and not sent yet, so that flush_shard() returns at once if there is none. */
+    std::atomic<uint64_t> pending_objects;
+
+    bool worker_running;
+    std::thread worker;
+
+    static uint64_t now_us();
+
+    /**
+     * Find the buffer of a key, or create it.
+     */
+    template <typename ObjectType, typename SendFunc>
+    TypedBuffer<ObjectType>& buffer_of(const buffer_key_t& key, const SendFunc& send);
+
+    /**
+     * Send a buffer if it is not empty, and count the batch.
+     */
+    void flush_buffer(Buffer& buffer);
+
+    /**
+     * Wake the worker thread up for a new deadline.
+     */
+    void notify_deadline();
+
+    void watch_deadlines();
+
+public:
+    WriteCombiner();
+    WriteCombiner(const WriteCombiner&) = delete;
+    WriteCombiner& operator=(const WriteCombiner&) = delete;
+    /**
+     * The destructor sends the buffered objects.
+     */
+    virtual ~WriteCombiner();
+
+    /**
+     * Enable or disable coalescing. The buffered objects are sent when coalescing is disabled.
+     *
+     * @param enable            - true to enable coalescing.
+     * @param max_batch_bytes   - a buffer is sent when its objects reach this size, in bytes.
+     * @param max_delay_us      - a buffer is sent when its oldest object has waited this long, in microseconds.
+     */
+    void set_policy(bool enable, std::size_t max_batch_bytes, uint64_t max_delay_us);
+
+    /**
+     * @return true if coalescing is enabled.
+     */
+    bool is_enabled() const;
+
+    /**
+     * @return the counters of the coalesced writes.
+     */
+    Stats get_stats() const;
+
+    /**
+     * Send all of the buffered objects now.
+     */
+    void flush_all();
+
+    /**
+     * Send the buffered objects to a shard now.
+     *
+     * @param subgroup_type     - the subgroup type
+     * @param subgroup_index    - the subgroup index
+     * @param shard_index       - the shard index
+     */
+    void flush_shard(const std::type_index& subgroup_type, uint32_t subgroup_index, uint32_t shard_index);
+
+    /**
+     * Buffer an object, and send its buffer if it reaches the size threshold.
+     *
+     * @tparam ObjectType   - the object type
+     * @param key           - the buffer of the object
+     * @param object        - the object
+     * @param object_bytes  - the serialized size of the object
+     * @param send          - sends a batch of objects of this buffer, called as send(const std::vector<ObjectType>&).
+     *                        It is only kept when the buffer is created.
+     */
+    template <typename ObjectType, typename SendFunc>
+    void add(const buffer_key_t& key, const ObjectType& object, std::size_t object_bytes, const SendFunc& send);
+};
+
+template <typename ObjectType>
+class WriteCombiner::TypedBuffer : public WriteCombiner::Buffer {
+public:
+    std::vector<ObjectType> objects;
+    std::size_t bytes;
+    std::function<void(const std::vector<ObjectType>&)> send;
+
+    explicit TypedBuffer(const std::function<void(const std::vector<ObjectType>&)>& _send) : bytes(0), send(_send) {}
+
+    virtual std::size_t size() const override {
+        return objects.size();
+    }
+
+    virtual bool flush() override {
+        if(objects.empty()) {
+            return false;
+        }
+        std::vector<ObjectType> batch;
+        batch.swap(objects);
+        bytes = 0;
+        deadline_us.store(0, std::memory_order_relaxed);
+        send(batch);
+        return true;
+    }
+};
+
+template <typename ObjectType, typename SendFunc>
+WriteCombiner::TypedBuffer<ObjectType>& WriteCombiner::buffer_of(const buffer_key_t& key, const SendFunc& send) {
+    std::lock_guard<std::mutex> lck(buffers_mutex);
+    auto& buffer = buffers[key];
+    if(!buffer) {
+        buffer = std::make_unique<TypedBuffer<ObjectType>>(std::function<void(const std::vector<ObjectType>&)>(send));
+    }
+    return *dynamic_cast<TypedBuffer<ObjectType>*>(buffer.get());
+}
+
+template <typename ObjectType, typename SendFunc>
+void WriteCombiner::add(const buffer_key_t& key, const ObjectType& object, std::size_t object_bytes, const SendFunc& send) {
+    auto& buffer = buffer_of<ObjectType>(key, send);
+    objects++;
+    pending_objects++;
+    bool new_deadline = false;
+    {
+        std::lock_guard<std::mutex> lck(buffer.mutex);
+        if(buffer.objects.empty()) {
+            buffer.deadline_us.store(now_us() + max_delay_us.load(), std::memory_order_relaxed);
+            new_deadline = true;
+        }
+        buffer.objects.emplace_back(object);
+        buffer.bytes += object_bytes;
+        if(buffer.bytes >= max_batch_bytes.load()) {
+            flush_buffer(buffer);
+            new_deadline = false;
+        }
+    }
+    if(new_deadline) {
+        notify_deadline();
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -16,6 +16,7 @@
 #include <derecho/persistent/Persistent.hpp>
 
 #include <cascade/cascade.hpp>
+#include <cascade/detail/blob_segment_store.hpp>
 
 using namespace persistent;
 using namespace std::chrono_literals;
@@ -27,8 +28,16 @@ enum object_memory_mode_t {
     DEFAULT,
     EMPLACED,
     BLOB_GENERATOR,
+    BLOB_SEGMENT,   // the data is in a memory-mapped blob segment, see BlobSegmentStore.
+    SHARED,         // the data is immutable and reference-counted, so the copies share it.
 };
 
+/**
+ * A serialized Blob whose size has this bit set is a reference to a blob segment:
+ * [size|BLOB_SEGMENT_REF_FLAG][segment_id][offset][checksum]
+ */
+#define BLOB_SEGMENT_REF_FLAG (1ull << 63)
+
 using blob_generator_func_t = std::function<std::size_t(uint8_t*,const std::size_t)>;
 
 class Blob : public mutils::ByteRepresentable {
@@ -42,6 +51,11 @@ public:
 
     object_memory_mode_t   memory_mode;
 
+    // for BLOB_SEGMENT mode only
+    BlobSegmentRef segment_ref;
+
+    // for SHARED mode only
+    std::shared_ptr<const uint8_t> shared_bytes;
 
     // constructor - copy to own the data
     Blob(const uint8_t* const b, const decltype(size) s);
@@ -51,7 +65,10 @@ public:
     // generator constructor - data to be generated on serialization
     Blob(const blob_generator_func_t& generator, const decltype(size) s);
 
-    // copy constructor - copy to own the data
+    // blob segment constructor - refer to the data in a mapped blob segment
+    Blob(const BlobSegmentRef& ref, const uint8_t* const mapped_bytes);
+
+    // copy constructor - copy the data once into a SHARED buffer, which the later copies share
     Blob(const Blob& other);
 
     // move constructor - accept the memory from another object
@@ -94,7 +111,8 @@ public:
 class ObjectWithUInt64Key : public mutils::ByteRepresentable,
                             public ICascadeObject<uint64_t,ObjectWithUInt64Key>,
                             public IKeepTimestamp,
-                            public IVerifyPreviousVersion
+                            public IVerifyPreviousVersion,
+                            public IOffloadableBlob<ObjectWithUInt64Key>
 #ifdef ENABLE_EVALUATION
                             , public IHasMessageID
 #endif
@@ -185,6 +203,11 @@ public:
     virtual uint64_t get_timestamp() const override;
     virtual void set_previous_version(persistent::version_t prev_ver, persistent::version_t prev_ver_by_key) const override;
     virtual bool verify_previous_version(persistent::version_t prev_ver, persistent::version_t prev_ver_by_key) const override;
+    virtual const uint8_t* get_blob_bytes() const override;
+    virtual std::size_t get_blob_size() const override;
+    virtual bool has_blob_segment_ref() const override;
+    virtual ObjectWithUInt64Key copy_with_blob_segment(const BlobSegmentRef& ref, const uint8_t* mapped_bytes) const override;
+    virtual ObjectWithUInt64Key copy_with_blob_generator(const blob_generator_func_t& generator) const override;
 #ifdef ENABLE_EVALUATION
     virtual void set_message_id(uint64_t id) const override;
     virtual uint64_t get_message_id() const override;
@@ -237,7 +260,8 @@ inline std::ostream& operator<<(std::ostream& out, const ObjectWithUInt64Key& o)
 class ObjectWithStringKey : public mutils::ByteRepresentable,
                             public ICascadeObject<std::string,ObjectWithStringKey>,
                             public IKeepTimestamp,
-                            public IVerifyPreviousVersion
+                            public IVerifyPreviousVersion,
+                            public IOffloadableBlob<ObjectWithStringKey>
 #ifdef ENABLE_EVALUATION
                             ,public IHasMessageID
 #endif
@@ -328,6 +352,11 @@ public:
     virtual uint64_t get_timestamp() const override;
     virtual void set_previous_version(persistent::version_t prev_ver, persistent::version_t perv_ver_by_key) const override;
     virtual bool verify_previous_version(persistent::version_t prev_ver, persistent::version_t perv_ver_by_key) const override;
+    virtual const uint8_t* get_blob_bytes() const override;
+    virtual std::size_t get_blob_size() const override;
+    virtual bool has_blob_segment_ref() const override;
+    virtual ObjectWithStringKey copy_with_blob_segment(const BlobSegmentRef& ref, const uint8_t* mapped_bytes) const override;
+    virtual ObjectWithStringKey copy_with_blob_generator(const blob_generator_func_t& generator) const override;
 #ifdef ENABLE_EVALUATION
     virtual void set_message_id(uint64_t id) const override;
     virtual uint64_t get_message_id() const override;
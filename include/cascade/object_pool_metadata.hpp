@@ -1,15 +1,42 @@
 #pragma once
 #include "object.hpp"
 #include "utils.hpp"
+#include <cascade/detail/key_hash.hpp>
+#include <cascade/detail/object_locations.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 namespace derecho {
 namespace cascade {
 
 using sharding_policy_t = enum sharding_policy_type {
     HASH,
-    RANGE
+    RANGE,
+    VIRTUAL
 };
 
+/**
+ * The default number of virtual buckets of an object pool with the VIRTUAL sharding policy.
+ */
+#define OBJECT_POOL_DEFAULT_NUM_BUCKETS (1024)
+
+/**
+ * The serialized format of ObjectPoolMetadata, as it is stored in the log of the metadata service, is:
+ * [OBJECT_POOL_METADATA_MAGIC][uint32_t format version][fields]
+ * A newer format only appends fields. The legacy format, written before the format version was introduced, has no
+ * header: it starts with the version of the metadata, which is never below INVALID_VERSION, while the magic is
+ * negative. It has the fields up to 'deleted', with the placement map as a hash map.
+ */
+#define OBJECT_POOL_METADATA_MAGIC (static_cast<int64_t>(0x8f0b7e4d2c1a6953ull))
+#define OBJECT_POOL_METADATA_FORMAT_VERSION (1)
+
 /**
  * Important: A valid pathname follows the following format:
  * [PATH_SEPARATOR<folder_name>]\{1+}
@@ -37,21 +64,135 @@ public:
     uint32_t                                    subgroup_type_index; // index of subgroup type into subgroup_type_order
     uint32_t                                    subgroup_index; // index of the subgroup of type subgroup_type_order[subgroup_type_index]
     sharding_policy_t                           sharding_policy; // the default sharding policy
-    std::unordered_map<std::string,uint32_t>    object_locations; // the list of shards where a corresponding key is stored.
+    ObjectLocations                             object_locations; // the shards of the keys pinned to a specific shard.
     bool                                        deleted; // is deleted
+    std::vector<std::string>                    split_points; // the sorted split keys of the RANGE sharding policy.
+    std::vector<uint32_t>                       bucket_to_shard; // the shard of each virtual bucket of the VIRTUAL sharding policy.
+    key_hash_algorithm_t                        key_hash_algorithm; // the key hash algorithm of the HASH and VIRTUAL sharding policies.
+    uint64_t                                    key_hash_seed; // the key hash seed.
+    uint32_t                                    num_shards; // the number of shards the placement tables are built for, 0 if unknown.
+
+    // serialization support, see OBJECT_POOL_METADATA_FORMAT_VERSION.
+    std::size_t to_bytes(uint8_t* v) const {
+        std::size_t pos = 0;
+        const int64_t magic = OBJECT_POOL_METADATA_MAGIC;
+        const uint32_t format_version = OBJECT_POOL_METADATA_FORMAT_VERSION;
+        pos += mutils::to_bytes(magic, v + pos);
+        pos += mutils::to_bytes(format_version, v + pos);
+        pos += mutils::to_bytes(version, v + pos);
+        pos += mutils::to_bytes(timestamp_us, v + pos);
+        pos += mutils::to_bytes(previous_version, v + pos);
+        pos += mutils::to_bytes(previous_version_by_key, v + pos);
+        pos += mutils::to_bytes(pathname, v + pos);
+        pos += mutils::to_bytes(subgroup_type_index, v + pos);
+        pos += mutils::to_bytes(subgroup_index, v + pos);
+        pos += mutils::to_bytes(sharding_policy, v + pos);
+        pos += mutils::to_bytes(object_locations, v + pos);
+        pos += mutils::to_bytes(deleted, v + pos);
+        pos += mutils::to_bytes(split_points, v + pos);
+        pos += mutils::to_bytes(bucket_to_shard, v + pos);
+        pos += mutils::to_bytes(key_hash_algorithm, v + pos);
+        pos += mutils::to_bytes(key_hash_seed, v + pos);
+        pos += mutils::to_bytes(num_shards, v + pos);
+        return pos;
+    }
+
+    std::size_t bytes_size() const {
+        return sizeof(int64_t) + sizeof(uint32_t) +
+               mutils::bytes_size(version) +
+               mutils::bytes_size(timestamp_us) +
+               mutils::bytes_size(previous_version) +
+               mutils::bytes_size(previous_version_by_key) +
+               mutils::bytes_size(pathname) +
+               mutils::bytes_size(subgroup_type_index) +
+               mutils::bytes_size(subgroup_index) +
+               mutils::bytes_size(sharding_policy) +
+               mutils::bytes_size(object_locations) +
+               mutils::bytes_size(deleted) +
+               mutils::bytes_size(split_points) +
+               mutils::bytes_size(bucket_to_shard) +
+               mutils::bytes_size(key_hash_algorithm) +
+               mutils::bytes_size(key_hash_seed) +
+               mutils::bytes_size(num_shards);
+    }
+
+    void post_object(const std::function<void(uint8_t const* const, std::size_t)>& f) const {
+        const int64_t magic = OBJECT_POOL_METADATA_MAGIC;
+        const uint32_t format_version = OBJECT_POOL_METADATA_FORMAT_VERSION;
+        mutils::post_object(f, magic);
+        mutils::post_object(f, format_version);
+        mutils::post_object(f, version);
+        mutils::post_object(f, timestamp_us);
+        mutils::post_object(f, previous_version);
+        mutils::post_object(f, previous_version_by_key);
+        mutils::post_object(f, pathname);
+        mutils::post_object(f, subgroup_type_index);
+        mutils::post_object(f, subgroup_index);
+        mutils::post_object(f, sharding_policy);
+        mutils::post_object(f, object_locations);
+        mutils::post_object(f, deleted);
+        mutils::post_object(f, split_points);
+        mutils::post_object(f, bucket_to_shard);
+        mutils::post_object(f, key_hash_algorithm);
+        mutils::post_object(f, key_hash_seed);
+        mutils::post_object(f, num_shards);
+    }
 
-    // serialization support
-    DEFAULT_SERIALIZATION_SUPPORT(ObjectPoolMetadata<CascadeTypes...>,
-                                  version,
-                                  timestamp_us,
-                                  previous_version,
-                                  previous_version_by_key,
-                                  pathname,
-                                  subgroup_type_index,
-                                  subgroup_index,
-                                  sharding_policy,
-                                  object_locations,
-                                  deleted);
+    void ensure_registered(mutils::DeserializationManager&) {}
+
+    static std::unique_ptr<ObjectPoolMetadata> from_bytes(mutils::DeserializationManager* dsm, const uint8_t* const v) {
+        std::size_t pos = 0;
+        auto read = [dsm, v, &pos](auto& field) {
+            auto p_field = mutils::from_bytes<std::decay_t<decltype(field)>>(dsm, v + pos);
+            pos += mutils::bytes_size(*p_field);
+            field = std::move(*p_field);
+        };
+        int64_t magic;
+        memcpy(&magic, v, sizeof(magic));
+        auto opm = std::make_unique<ObjectPoolMetadata>();
+        if (magic != OBJECT_POOL_METADATA_MAGIC) {
+            // the legacy format.
+            std::unordered_map<std::string,uint32_t> locations;
+            read(opm->version);
+            read(opm->timestamp_us);
+            read(opm->previous_version);
+            read(opm->previous_version_by_key);
+            read(opm->pathname);
+            read(opm->subgroup_type_index);
+            read(opm->subgroup_index);
+            read(opm->sharding_policy);
+            read(locations);
+            read(opm->deleted);
+            opm->object_locations = ObjectLocations(locations);
+            opm->key_hash_algorithm = legacy_key_hash_algorithm(opm->sharding_policy);
+            opm->key_hash_seed = KEY_HASH_DEFAULT_SEED;
+            return opm;
+        }
+        pos += sizeof(magic);
+        uint32_t format_version;
+        read(format_version);
+        if (format_version > OBJECT_POOL_METADATA_FORMAT_VERSION) {
+            throw derecho::derecho_exception("Unknown object pool metadata format version:" + std::to_string(format_version));
+        }
+        read(opm->version);
+        read(opm->timestamp_us);
+        read(opm->previous_version);
+        read(opm->previous_version_by_key);
+        read(opm->pathname);
+        read(opm->subgroup_type_index);
+        read(opm->subgroup_index);
+        read(opm->sharding_policy);
+        read(opm->object_locations);
+        read(opm->deleted);
+        read(opm->split_points);
+        read(opm->bucket_to_shard);
+        read(opm->key_hash_algorithm);
+        read(opm->key_hash_seed);
+        read(opm->num_shards);
+        return opm;
+    }
+
+    DEFAULT_DESERIALIZE_NOALLOC(ObjectPoolMetadata);
 
     // constructor 0: default
     ObjectPoolMetadata():
@@ -64,7 +205,12 @@ public:
         subgroup_index(0),
         sharding_policy(HASH),
         object_locations(),
-        deleted(false) {}
+        deleted(false),
+        split_points(),
+        bucket_to_shard(),
+        key_hash_algorithm(legacy_key_hash_algorithm(HASH)),
+        key_hash_seed(KEY_HASH_DEFAULT_SEED),
+        num_shards(0) {}
 
     // constructor 1:
     ObjectPoolMetadata(const persistent::version_t _version,
@@ -76,7 +222,12 @@ public:
                        uint32_t _subgroup_index,
                        sharding_policy_t _sharding_policy,
                        const std::unordered_map<std::string,uint32_t>& _object_locations,
-                       bool _deleted):
+                       bool _deleted,
+                       const std::vector<std::string>& _split_points = {},
+                       const std::vector<uint32_t>& _bucket_to_shard = {},
+                       key_hash_algorithm_t _key_hash_algorithm = KEY_HASH_LEGACY,
+                       uint64_t _key_hash_seed = KEY_HASH_DEFAULT_SEED,
+                       uint32_t _num_shards = 0):
         version(_version),
         timestamp_us(_timestamp_us),
         previous_version(_previous_version),
@@ -86,10 +237,19 @@ public:
         subgroup_index(_subgroup_index),
         sharding_policy(_sharding_policy),
         object_locations(_object_locations),
-        deleted(_deleted) {
+        deleted(_deleted),
+        split_points(_split_points),
+        bucket_to_shard(_bucket_to_shard),
+        key_hash_algorithm(_key_hash_algorithm == KEY_HASH_LEGACY ? legacy_key_hash_algorithm(_sharding_policy) : _key_hash_algorithm),
+        key_hash_seed(_key_hash_seed),
+        num_shards(_num_shards) {
             if (!check_pathname_format(_pathname)) {
                 throw derecho::derecho_exception("Invalid object pool pathname:" + _pathname);
             }
+            const std::string error = check_placement();
+            if (!error.empty()) {
+                throw derecho::derecho_exception(error);
+            }
         }
 
     ObjectPoolMetadata(const std::string& _pathname,
@@ -97,7 +257,12 @@ public:
                        uint32_t _subgroup_index,
                        sharding_policy_t _sharding_policy,
                        const std::unordered_map<std::string,uint32_t>& _object_locations,
-                       bool _deleted):
+                       bool _deleted,
+                       const std::vector<std::string>& _split_points = {},
+                       const std::vector<uint32_t>& _bucket_to_shard = {},
+                       key_hash_algorithm_t _key_hash_algorithm = KEY_HASH_LEGACY,
+                       uint64_t _key_hash_seed = KEY_HASH_DEFAULT_SEED,
+                       uint32_t _num_shards = 0):
         version(persistent::INVALID_VERSION),
         timestamp_us(0),
         previous_version(persistent::INVALID_VERSION),
@@ -107,10 +272,19 @@ public:
         subgroup_index(_subgroup_index),
         sharding_policy(_sharding_policy),
         object_locations(_object_locations),
-        deleted(_deleted) {
+        deleted(_deleted),
+        split_points(_split_points),
+        bucket_to_shard(_bucket_to_shard),
+        key_hash_algorithm(_key_hash_algorithm == KEY_HASH_LEGACY ? legacy_key_hash_algorithm(_sharding_policy) : _key_hash_algorithm),
+        key_hash_seed(_key_hash_seed),
+        num_shards(_num_shards) {
             if (!check_pathname_format(_pathname)) {
                 throw derecho::derecho_exception("Invalid object pool pathname:" + _pathname);
             }
+            const std::string error = check_placement();
+            if (!error.empty()) {
+                throw derecho::derecho_exception(error);
+            }
         }
 
     // constructor 2: copy constructor
@@ -124,7 +298,12 @@ public:
         subgroup_index(other.subgroup_index),
         sharding_policy(other.sharding_policy),
         object_locations(other.object_locations),
-        deleted(other.deleted) {}
+        deleted(other.deleted),
+        split_points(other.split_points),
+        bucket_to_shard(other.bucket_to_shard),
+        key_hash_algorithm(other.key_hash_algorithm),
+        key_hash_seed(other.key_hash_seed),
+        num_shards(other.num_shards) {}
 
     // constructor 3: move constructor
     ObjectPoolMetadata(ObjectPoolMetadata&& other):
@@ -137,7 +316,12 @@ public:
         subgroup_index(other.subgroup_index),
         sharding_policy(other.sharding_policy),
         object_locations(std::move(other.object_locations)),
-        deleted(other.deleted) {}
+        deleted(other.deleted),
+        split_points(std::move(other.split_points)),
+        bucket_to_shard(std::move(other.bucket_to_shard)),
+        key_hash_algorithm(other.key_hash_algorithm),
+        key_hash_seed(other.key_hash_seed),
+        num_shards(other.num_shards) {}
 
     void operator = (const ObjectPoolMetadata& other) {
         this->version = other.version;
@@ -150,6 +334,11 @@ public:
         this->sharding_policy = other.sharding_policy;
         this->object_locations = other.object_locations;
         this->deleted = other.deleted;
+        this->split_points = other.split_points;
+        this->bucket_to_shard = other.bucket_to_shard;
+        this->key_hash_algorithm = other.key_hash_algorithm;
+        this->key_hash_seed = other.key_hash_seed;
+        this->num_shards = other.num_shards;
     }
 
     virtual const std::string& get_key_ref() const override {
@@ -194,45 +383,111 @@ public:
                ((this->previous_version_by_key == persistent::INVALID_VERSION)?true:(this->previous_version_by_key >= prev_ver_by_key));
     }
 
+    /**
+     * Check the placement tables against each other and against the number of shards, if it is known.
+     *
+     * @return an error message, or an empty string if the tables are consistent.
+     */
+    std::string check_placement() const {
+        if (!std::is_sorted(split_points.begin(),split_points.end(),std::less_equal<std::string>())) {
+            return "Split points of object pool:" + pathname + " are not in strictly ascending order.";
+        }
+        if (sharding_policy == VIRTUAL && bucket_to_shard.empty()) {
+            return "Object pool:" + pathname + " with VIRTUAL sharding policy has no buckets.";
+        }
+        if (key_hash_algorithm != KEY_HASH_WYHASH && key_hash_algorithm != KEY_HASH_FNV1A && key_hash_algorithm != KEY_HASH_STD) {
+            return "Object pool:" + pathname + " has an unknown key hash algorithm:" + std::to_string(key_hash_algorithm);
+        }
+        if (num_shards == 0) {
+            return "";
+        }
+        if (sharding_policy == RANGE && split_points.size() >= num_shards) {
+            return "Object pool:" + pathname + " has " + std::to_string(split_points.size() + 1) + " ranges, but " +
+                   std::to_string(num_shards) + " shard(s).";
+        }
+        if (sharding_policy == VIRTUAL) {
+            for (const auto shard_index : bucket_to_shard) {
+                if (shard_index >= num_shards) {
+                    return "Object pool:" + pathname + " maps a bucket to shard:" + std::to_string(shard_index) + ", but has " +
+                           std::to_string(num_shards) + " shard(s).";
+                }
+            }
+        }
+        for (std::size_t pos = 0; pos < object_locations.size(); pos ++) {
+            if (object_locations.shard_at(pos) >= num_shards) {
+                return "Object pool:" + pathname + " pins a key to shard:" + std::to_string(object_locations.shard_at(pos)) +
+                       ", but has " + std::to_string(num_shards) + " shard(s).";
+            }
+        }
+        return "";
+    }
+
+    /**
+     * An object pool must not be nested in another one. It costs O(depth*log(n)) with n object pools, since kv_map is
+     * sorted: the pathnames starting with this one follow it immediately in kv_map. The placement tables of an object
+     * pool must be consistent, see check_placement().
+     */
     virtual bool validate(const std::map<std::string,ObjectPoolMetadata<CascadeTypes...>>& kv_map) const override {
-        auto components = str_tokenizer(pathname,true,PATH_SEPARATOR); // only check prefixes. It is valid to overwrite an existing one.
-        std::string prefix;
-        for (const auto& comp:components) {
-            prefix = prefix + PATH_SEPARATOR + comp;
-            if (kv_map.find(prefix) != kv_map.end()) {
+        if (!deleted) {
+            const std::string error = check_placement();
+            if (!error.empty()) {
+                dbg_default_warn("{}", error);
                 return false;
             }
         }
-        for (const auto& oppn:kv_map) {
-            if (oppn.first.size() > pathname.size() && (oppn.first.compare(0,pathname.size(),pathname) == 0)) {
+        // only check prefixes. It is valid to overwrite an existing one.
+        for (std::size_t pos = pathname.find(PATH_SEPARATOR,1); pos != std::string::npos; pos = pathname.find(PATH_SEPARATOR,pos + 1)) {
+            if (kv_map.find(pathname.substr(0,pos)) != kv_map.end()) {
                 return false;
             }
         }
+        auto next = kv_map.upper_bound(pathname);
+        if (next != kv_map.end() && next->first.compare(0,pathname.size(),pathname) == 0) {
+            return false;
+        }
         return true;
     }
 
     /**
      * Find the shard for an object: key_to_shard_index
      *
+     * With the RANGE sharding policy, shard i holds the keys in [split_points[i-1],split_points[i]): the keys before
+     * split_points[0] go to shard 0, and the keys from the last split point go to the last shard. The split points are
+     * full keys, including the object pool pathname.
+     *
+     * With the HASH sharding policy, the shard is the key hash (see hash_key()) modulo the number of shards.
+     *
+     * With the VIRTUAL sharding policy, a key is mapped to one of the virtual buckets with jump consistent hashing,
+     * and the bucket_to_shard table maps the bucket to a shard. The number of buckets is fixed for the object pool, so
+     * the shards can be rebalanced by moving buckets, without remapping the other keys.
+     *
      * @tparam KeyType type of the key.
      * @param  key
      * @param  num_shards
      * @param  check_object_locations - By default, we check the object location maps. In most cases, we can accelerate
      *                                  process by disabling it by setting it to false.
      * @return shard index.
+     * @throws derecho::derecho_exception if the placement tables map the key to a shard beyond num_shards.
      */
     template<typename KeyType>
     inline uint32_t key_to_shard_index(const KeyType& key, uint32_t num_shards, bool check_object_locations = true) const {
         if constexpr (std::is_convertible_v<KeyType,std::string>) {
             if (check_object_locations) {
-                if (this->object_locations.find(key) != object_locations.end()) {
-                    return object_locations.at(key);
+                uint32_t pinned_shard_index;
+                if (this->object_locations.find(key,pinned_shard_index)) {
+                    return check_shard_index(pinned_shard_index,num_shards);
                 }
             }
             uint32_t shard_index = 0;
             switch (sharding_policy) {
             case HASH:
-                shard_index = std::hash<std::string>{}(key) % num_shards;
+                shard_index = hash_key(key) % num_shards;
+                break;
+            case RANGE:
+                shard_index = check_shard_index(std::upper_bound(split_points.cbegin(),split_points.cend(),key) - split_points.cbegin(),num_shards);
+                break;
+            case VIRTUAL:
+                shard_index = check_shard_index(bucket_to_shard.at(key_to_bucket(key)),num_shards);
                 break;
             default:
                 throw derecho::derecho_exception(std::string("Unknown sharding_policy:") + std::to_string(sharding_policy));
@@ -243,6 +498,122 @@ public:
         }
     }
 
+    /**
+     * Find the shards that may hold keys starting with a prefix. With the RANGE sharding policy, these are the shards
+     * whose ranges overlap the prefix, plus the shards of the matching keys in object_locations. Otherwise, these are
+     * all shards.
+     *
+     * @param  prefix       the key prefix, which starts with the object pool pathname.
+     * @param  num_shards
+     *
+     * @return the shard indexes in ascending order.
+     */
+    inline std::vector<uint32_t> prefix_to_shard_indexes(const std::string& prefix, uint32_t num_shards) const {
+        std::vector<uint32_t> shard_indexes;
+        if (sharding_policy != RANGE) {
+            for (uint32_t shard_index = 0; shard_index < num_shards; shard_index ++) {
+                shard_indexes.emplace_back(shard_index);
+            }
+            return shard_indexes;
+        }
+        // The keys starting with the prefix are in [prefix,prefix_end), where prefix_end is the prefix with its last
+        // byte incremented, after removing any trailing 0xff bytes. If the prefix is all 0xff, there is no upper end.
+        std::string prefix_end = prefix;
+        while (!prefix_end.empty() && static_cast<uint8_t>(prefix_end.back()) == 0xff) {
+            prefix_end.pop_back();
+        }
+        uint32_t first = key_to_shard_index(prefix,num_shards,false);
+        uint32_t last = num_shards - 1;
+        if (!prefix_end.empty()) {
+            prefix_end.back() = static_cast<char>(static_cast<uint8_t>(prefix_end.back()) + 1);
+            // the last shard whose range starts before prefix_end.
+            last = check_shard_index(std::lower_bound(split_points.cbegin(),split_points.cend(),prefix_end) - split_points.cbegin(),num_shards);
+        }
+        std::vector<bool> targeted(num_shards,false);
+        for (uint32_t shard_index = first; shard_index <= last; shard_index ++) {
+            targeted[shard_index] = true;
+        }
+        auto pinned = object_locations.prefix_range(prefix);
+        for (std::size_t pos = pinned.first; pos < pinned.second; pos ++) {
+            targeted[check_shard_index(object_locations.shard_at(pos),num_shards)] = true;
+        }
+        for (uint32_t shard_index = 0; shard_index < num_shards; shard_index ++) {
+            if (targeted[shard_index]) {
+                shard_indexes.emplace_back(shard_index);
+            }
+        }
+        return shard_indexes;
+    }
+
+    /**
+     * Check a shard index found in the placement tables.
+     *
+     * @return the shard index.
+     * @throws derecho::derecho_exception if it is beyond num_shards, e.g. after the layout shrinks.
+     */
+    inline uint32_t check_shard_index(std::size_t shard_index, uint32_t num_shards) const {
+        if (shard_index >= num_shards) {
+            throw derecho::derecho_exception("Object pool:" + pathname + " maps a key to shard:" + std::to_string(shard_index) +
+                                             ", but the subgroup has " + std::to_string(num_shards) + " shard(s).");
+        }
+        return static_cast<uint32_t>(shard_index);
+    }
+
+    /**
+     * Find the virtual bucket of a key with the VIRTUAL sharding policy.
+     *
+     * @param  key
+     *
+     * @return the bucket index.
+     */
+    inline uint32_t key_to_bucket(const std::string& key) const {
+        return jump_consistent_hash(hash_key(key),static_cast<uint32_t>(bucket_to_shard.size()));
+    }
+
+    /**
+     * Hash a key with the key hash algorithm and seed of this object pool.
+     *
+     * @param  key
+     *
+     * @return the 64-bit key hash.
+     */
+    inline uint64_t hash_key(const std::string_view& key) const {
+        return key_hash(key_hash_algorithm,key_hash_seed,key);
+    }
+
+    /**
+     * The key hash of an object pool whose metadata does not set it, i.e., the hash used before the algorithm was
+     * recorded: std::hash with the HASH sharding policy, and FNV-1a with the VIRTUAL one. The new object pools use
+     * KEY_HASH_WYHASH, see ServiceClient::create_object_pool().
+     *
+     * @param  policy       the sharding policy
+     *
+     * @return the key hash algorithm.
+     */
+    static inline key_hash_algorithm_t legacy_key_hash_algorithm(sharding_policy_t policy) {
+        return (policy == VIRTUAL) ? KEY_HASH_FNV1A : KEY_HASH_STD;
+    }
+
+    /**
+     * Jump consistent hash (Lamping and Veach): when the number of buckets grows from n to n+1, only 1/(n+1) of the
+     * keys move, all to the new bucket.
+     *
+     * @param  key_hash     a 64-bit hash of the key
+     * @param  num_buckets  the number of buckets, which must be positive.
+     *
+     * @return the bucket index in [0,num_buckets).
+     */
+    static inline uint32_t jump_consistent_hash(uint64_t key_hash, uint32_t num_buckets) {
+        int64_t bucket = -1;
+        int64_t next = 0;
+        while (next < static_cast<int64_t>(num_buckets)) {
+            bucket = next;
+            key_hash = key_hash * 2862933555777941757ULL + 1;
+            next = static_cast<int64_t>((bucket + 1) * (static_cast<double>(1LL << 31) / static_cast<double>((key_hash >> 33) + 1)));
+        }
+        return static_cast<uint32_t>(bucket);
+    }
+
     static std::string IK;
     static ObjectPoolMetadata<CascadeTypes...> IV;
 
@@ -325,7 +696,11 @@ inline std::ostream& operator<<(std::ostream& out, const ObjectPoolMetadata<Casc
             "\tsubgroup_type:" << std::to_string(opm.subgroup_type_index) << "-->" << ObjectPoolMetadata<CascadeTypes...>::subgroup_type_order[opm.subgroup_type_index].name() << "\n" <<
             "\tsubgroup_index:" << std::to_string(opm.subgroup_index) << "\n" <<
             "\tsharding_policy:" << std::to_string(opm.sharding_policy) <<"\n" <<
-            "\tobject_locations:[hidden]" << "\n" <<
+            "\tobject_locations:" << std::to_string(opm.object_locations.size()) << " pinned key(s)\n" <<
+            "\tsplit_points:" << std::to_string(opm.split_points.size()) << " split point(s)\n" <<
+            "\tbucket_to_shard:" << std::to_string(opm.bucket_to_shard.size()) << " bucket(s)\n" <<
+            "\tkey_hash:" << std::to_string(opm.key_hash_algorithm) << " seed:" << std::to_string(opm.key_hash_seed) << "\n" <<
+            "\tnum_shards:" << std::to_string(opm.num_shards) << "\n" <<
             "\tis_deleted:" << std::to_string(opm.deleted) <<
             std::endl;
     }
@@ -1,27 +1,46 @@
 #pragma once
 
 #include "cascade_interface.hpp"
+#include "detail/blob_segment_store.hpp"
 #include "detail/delta_store_core.hpp"
+#include "detail/store_checkpointer.hpp"
 
 #include <derecho/core/derecho.hpp>
 #include <derecho/mutils-serialization/SerializationSupport.hpp>
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <vector>
 
 namespace derecho {
 namespace cascade {
 
+/**
+ * configuration keys
+ */
+#define CASCADE_CHECKPOINT_INTERVAL_VERSIONS    "CASCADE/checkpoint_interval_versions"
+#define CASCADE_CHECKPOINT_INTERVAL_BYTES       "CASCADE/checkpoint_interval_bytes"
+#define CASCADE_CHECKPOINT_PATH                 "CASCADE/checkpoint_path"
+#define CASCADE_CHECKPOINT_RETENTION            "CASCADE/checkpoint_retention"
+#define CASCADE_NUM_RECOVERY_THREADS            "CASCADE/num_recovery_threads"
+#define CASCADE_BLOB_SEGMENT_THRESHOLD          "CASCADE/blob_segment_threshold"
+#define CASCADE_BLOB_SEGMENT_SIZE               "CASCADE/blob_segment_size"
+#define CASCADE_BLOB_SEGMENT_PATH               "CASCADE/blob_segment_path"
+#define CASCADE_MEMORY_BUDGET                   "CASCADE/memory_budget"
+#define CASCADE_VERSION_INDEX_MAX_UPDATES       "CASCADE/version_index_max_updates"
+
 /**
  * template for persistent cascade stores.
  *
  * PersistentCascadeStore is full-fledged implementation with log mechansim. Data can be stored in different
  * persistent devices including file system(persistent::ST_FILE) or SPDK(persistent::ST_SPDK). Please note that the
- * data is cached in memory too.
+ * data is cached in memory too. With a memory budget (see CASCADE_MEMORY_BUDGET), only the hot values are cached, and
+ * the cold ones are loaded from the log on demand; the keys and the object metadata always stay in memory.
  */
 template <typename KT, typename VT, KT* IK, VT* IV, persistent::StorageType ST = persistent::ST_FILE>
 class PersistentCascadeStore : public ICascadeStore<KT, VT, IK, IV>,
@@ -31,6 +50,88 @@ class PersistentCascadeStore : public ICascadeStore<KT, VT, IK, IV>,
                                public derecho::NotificationSupport {
 private:
     bool internal_ordered_put(const VT& value);
+    /**
+     * Periodic checkpoints of the state, or nullptr if checkpointing is disabled. See CASCADE_CHECKPOINT_* keys.
+     */
+    std::unique_ptr<StoreCheckpointer<KT, VT>> checkpointer;
+    /**
+     * Start the checkpointer if it is configured.
+     */
+    void initialize_checkpointer();
+    /**
+     * True once persistent_core has replayed the log. The core objects created by the factory before that are put in
+     * recovery mode. It must be declared before persistent_core.
+     */
+    bool log_replayed;
+    /**
+     * The number of threads to replay the log with. See CASCADE_NUM_RECOVERY_THREADS.
+     */
+    static uint32_t get_num_recovery_threads();
+    /**
+     * The segment files of the large blobs, or nullptr if the blobs are kept in the log. See CASCADE_BLOB_SEGMENT_*
+     * keys. The existing segments must be mapped before the log replay, so it is declared before persistent_core.
+     */
+    std::unique_ptr<BlobSegmentStore> blob_segments;
+    /**
+     * Open the blob segments of the store if they are configured.
+     *
+     * @param pr    - the persistent registry of the store, which names the segments.
+     */
+    static std::unique_ptr<BlobSegmentStore> create_blob_segments(persistent::PersistentRegistry* pr);
+    /**
+     * The memory budget of the cached values, or 0 if all values are cached. See CASCADE_MEMORY_BUDGET.
+     */
+    static uint64_t get_memory_budget();
+#define VERSION_INDEX_TRIM_INTERVAL (1024)
+#define VERSION_INDEX_DEFAULT_MAX_UPDATES (1048576)
+    /**
+     * The number of updates the version chains keep, or 0 for no limit. See CASCADE_VERSION_INDEX_MAX_UPDATES.
+     */
+    static uint64_t get_version_index_max_updates();
+    /**
+     * The updates since the version chains were last trimmed. Only the predicate thread accesses it.
+     */
+    uint64_t updates_since_index_trim = 0;
+    /**
+     * Trim the version chains every VERSION_INDEX_TRIM_INTERVAL updates, to the latest checkpoint or to the maximum
+     * number of updates, whichever is later.
+     *
+     * @param num_updates   - the number of updates just applied.
+     */
+    void trim_version_index(uint64_t num_updates);
+    /**
+     * Read the object in the delta of a version from the log.
+     */
+    void read_delta(const persistent::version_t& ver, const std::function<void(const VT&)>& func);
+    /**
+     * Find the last object of a key in a delta.
+     */
+    static void find_in_delta(const DeltaObjects<VT>& delta, const KT& key, std::optional<VT>& found);
+    /**
+     * Reconstruct the state at a version, from the nearest checkpoint if possible, and pass its kv_map to a function.
+     */
+    void with_state_at(const persistent::version_t& ver, const std::function<void(const std::map<KT, VT>&)>& func) const;
+    /**
+     * Find the version to read. A stable read of the current version reads at the global persistence frontier, and a
+     * stable read of another version waits until that version is persisted.
+     *
+     * @param ver                   - the requested version, or CURRENT_VERSION
+     * @param stable                - whether the read is stable
+     * @param requested_version     - the version to read is returned here, which is CURRENT_VERSION for the latest
+     *                                unstable state.
+     *
+     * @return false if the requested version is in the future.
+     */
+    bool resolve_read_version(const persistent::version_t& ver, const bool stable, persistent::version_t& requested_version) const;
+    /**
+     * Find the version of the state at a timestamp.
+     *
+     * @param ts_us     - timestamp in microsecond
+     * @param ver       - the version is returned here.
+     *
+     * @return false if the timestamp is in the future, or there is no state at that time.
+     */
+    bool resolve_read_time(const uint64_t& ts_us, persistent::version_t& ver) const;
 
 public:
     using derecho::GroupReference::group;
@@ -43,6 +144,9 @@ public:
                                              P2P_TARGETS(
                                                      put,
                                                      put_and_forget,
+                                                     put_and_forget_batch,
+                                                     put_batch,
+                                                     transact,
 #ifdef ENABLE_EVALUATION
                                                      perf_put,
 #endif  // ENABLE_EVALUATION
@@ -50,13 +154,18 @@ public:
                                                      get,
                                                      multi_get,
                                                      get_by_time,
+                                                     get_many,
+                                                     get_many_by_time,
                                                      multi_list_keys,
                                                      list_keys,
                                                      list_keys_by_time,
                                                      multi_get_size,
                                                      get_size,
                                                      get_size_by_time,
-                                                     trigger_put
+                                                     get_size_many,
+                                                     get_size_many_by_time,
+                                                     trigger_put,
+                                                     trigger_put_batch
 #ifdef ENABLE_EVALUATION
                                                      ,
                                                      dump_timestamp_log
@@ -69,6 +178,8 @@ public:
                                              ORDERED_TARGETS(
                                                      ordered_put,
                                                      ordered_put_and_forget,
+                                                     ordered_put_batch,
+                                                     ordered_transact,
                                                      ordered_remove,
                                                      ordered_get,
                                                      ordered_list_keys,
@@ -85,8 +196,13 @@ public:
 #endif
 #endif  // ENABLE_EVALUATION
     virtual void trigger_put(const VT& value) const override;
+    virtual void trigger_put_batch(const std::vector<VT>& values) const override;
     virtual std::tuple<persistent::version_t, uint64_t> put(const VT& value) const override;
     virtual void put_and_forget(const VT& value) const override;
+    virtual void put_and_forget_batch(const std::vector<VT>& values) const override;
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> put_batch(const std::vector<VT>& values) const override;
+    virtual std::tuple<persistent::version_t, uint64_t> transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                 const std::vector<VT>& write_set) const override;
 #ifdef ENABLE_EVALUATION
     virtual double perf_put(const uint32_t max_payload_size, const uint64_t duration_sec) const override;
 #endif  // ENABLE_EVALUATION
@@ -94,14 +210,21 @@ public:
     virtual const VT get(const KT& key, const persistent::version_t& ver, const bool stable, bool exact = false) const override;
     virtual const VT multi_get(const KT& key) const override;
     virtual const VT get_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const override;
+    virtual std::vector<VT> get_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const override;
+    virtual std::vector<VT> get_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const override;
     virtual std::vector<KT> multi_list_keys(const std::string& prefix) const override;
     virtual std::vector<KT> list_keys(const std::string& prefix, const persistent::version_t& ver, const bool stable) const override;
     virtual std::vector<KT> list_keys_by_time(const std::string& prefix, const uint64_t& ts_us, const bool stable) const override;
     virtual uint64_t multi_get_size(const KT& key) const override;
     virtual uint64_t get_size(const KT& key, const persistent::version_t& ver, const bool stable, bool exact = false) const override;
     virtual uint64_t get_size_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const override;
+    virtual std::vector<uint64_t> get_size_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const override;
+    virtual std::vector<uint64_t> get_size_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const override;
     virtual std::tuple<persistent::version_t, uint64_t> ordered_put(const VT& value) override;
     virtual void ordered_put_and_forget(const VT& value) override;
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> ordered_put_batch(const std::vector<VT>& values) override;
+    virtual std::tuple<persistent::version_t, uint64_t> ordered_transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                         const std::vector<VT>& write_set) override;
     virtual std::tuple<persistent::version_t, uint64_t> ordered_remove(const KT& key) override;
     virtual const VT ordered_get(const KT& key) override;
     virtual std::vector<KT> ordered_list_keys(const std::string& prefix) override;
@@ -109,6 +232,14 @@ public:
 #ifdef ENABLE_EVALUATION
     virtual void ordered_dump_timestamp_log(const std::string& filename) override;
 #endif  // ENABLE_EVALUATION
+    /**
+     * Get the cache counters of the memory budget, for tuning it.
+     *
+     * @param stats     - the counters are returned here.
+     *
+     * @return false if there is no memory budget.
+     */
+    bool get_residency_stats(ResidencyStats& stats) const;
 
     // serialization support
     DEFAULT_SERIALIZE(persistent_core);
@@ -124,6 +255,7 @@ public:
                            CriticalDataPathObserver<PersistentCascadeStore<KT, VT, IK, IV>>* cw = nullptr,
                            ICascadeContext* cc = nullptr);
     PersistentCascadeStore(persistent::Persistent<DeltaCascadeStoreCore<KT, VT, IK, IV>, ST>&& _persistent_core,
+                           persistent::PersistentRegistry* pr,
                            CriticalDataPathObserver<PersistentCascadeStore<KT, VT, IK, IV>>* cw = nullptr,
                            ICascadeContext* cc = nullptr);  // move persistent_core
     PersistentCascadeStore();
@@ -1,19 +1,24 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <derecho/core/notification.hpp>
 #include <derecho/mutils-serialization/SerializationSupport.hpp>
 #include <derecho/persistent/PersistentInterface.hpp>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <typeinfo>
 #include <tuple>
 #include <derecho/utils/time.h>
 #include <list>
+#include <deque>
 #include <condition_variable>
 #include <thread>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -22,7 +27,18 @@
 #include "object_pool_metadata.hpp"
 #include "user_defined_logic_manager.hpp"
 #include "data_flow_graph.hpp"
+#include "detail/key_hash.hpp"
+#include "detail/hedged_reads.hpp"
+#include "detail/submission_locks.hpp"
+#include "detail/async_pipeline.hpp"
+#include "detail/write_combiner.hpp"
+#include "detail/notification_sender.hpp"
+#include "detail/read_cache.hpp"
+#include "detail/stream_manifest.hpp"
+#include "detail/member_load_tracker.hpp"
+#include "detail/reply_watcher.hpp"
 #include "detail/prefix_registry.hpp"
+#include "detail/object_pool_resolver.hpp"
 
 /**
  * The cascade service templates
@@ -120,6 +136,7 @@ namespace cascade {
         std::shared_ptr<OffCriticalDataPathObserver>   ocdpo_ptr;
         std::shared_ptr<mutils::ByteRepresentable>     value_ptr;
         std::unordered_map<std::string,bool>           outputs;
+        uint64_t                        key_hash_value; // key_hash(key_string), computed once on the critical data path.
         /**
          * Move constructor
          * @param other     The input Action object
@@ -131,13 +148,15 @@ namespace cascade {
             version(other.version),
             ocdpo_ptr(std::move(other.ocdpo_ptr)),
             value_ptr(std::move(other.value_ptr)),
-            outputs(std::move(other.outputs)) {}
+            outputs(std::move(other.outputs)),
+            key_hash_value(other.key_hash_value) {}
         /**
          * Constructor
          * @param   _key_string
          * @param   _version
          * @param   _ocdpo_ptr const reference rvalue
          * @param   _value_ptr
+         * @param   _key_hash_value the key hash of _key_string, see key_hash(). It is computed if it is not given.
          */
         Action(const node_id_t              _sender = INVALID_NODE_ID,
                const std::string&           _key_string = "",
@@ -145,14 +164,16 @@ namespace cascade {
                const persistent::version_t& _version = CURRENT_VERSION,
                const std::shared_ptr<OffCriticalDataPathObserver>&  _ocdpo_ptr = nullptr,
                const std::shared_ptr<mutils::ByteRepresentable>&    _value_ptr = nullptr,
-               const std::unordered_map<std::string,bool>           _outputs = {}):
+               const std::unordered_map<std::string,bool>           _outputs = {},
+               const std::optional<uint64_t>&                       _key_hash_value = std::nullopt):
             sender(_sender),
             key_string(_key_string),
             prefix_length(_prefix_length),
             version(_version),
             ocdpo_ptr(_ocdpo_ptr),
             value_ptr(_value_ptr),
-            outputs(_outputs) {}
+            outputs(_outputs),
+            key_hash_value(_key_hash_value.has_value() ? _key_hash_value.value() : key_hash(_key_string)) {}
         Action(const Action&) = delete; // disable copy constructor
         /**
          * Assignment operators
@@ -179,6 +200,7 @@ namespace cascade {
         out << "Action:\n"
             << "\tsender = " << action.sender << "\n"
             << "\tkey = " << action.key_string << "\n"
+            << "\tkey_hash = " << std::hex << action.key_hash_value << std::dec << "\n"
             << "\tprefix_length = " << action.prefix_length << "\n"
             << "\tversion = " << std::hex << action.version << "\n"
             << "\tocdpo_ptr = " << action.ocdpo_ptr.get() << "\n"
@@ -313,6 +335,8 @@ namespace cascade {
         FixedRandom,    // use a random member and stick to that for the following operations.
         RoundRobin,     // use a member in round-robin order.
         UserSpecified,  // user specify which member to contact.
+        LeastOutstanding,   // use the member with the fewest outstanding requests from this client.
+        LatencyEWMA,    // use the member with the lowest expected latency, see MemberLoadTracker.
         InvalidPolicy = -1
     };
     // #define DEFAULT_SHARD_MEMBER_SELECTION_POLICY (ShardMemberSelectionPolicy::FirstMember)
@@ -330,8 +354,19 @@ namespace cascade {
     /** The notification handler type */
     using cascade_notification_handler_t = std::function<void(const Blob&)>;
 
+    /**
+     * The source of ServiceClient::put_stream(), which fills a buffer with up to the given size and returns the number
+     * of bytes filled, or zero at the end of the stream.
+     */
+    using stream_reader_t = std::function<std::size_t(uint8_t*,std::size_t)>;
+
+    /** The sink of ServiceClient::get_stream(), which is called with the data in order */
+    using stream_writer_t = std::function<void(const uint8_t*,std::size_t)>;
+
     /** The CascadeNotificationMessage type */
 #define CASCADE_NOTIFICATION_MESSAGE_TYPE   (0x100000000ull)
+    /** The type of the cache invalidation messages, see CacheInvalidationPublisher */
+#define CASCADE_CACHE_INVALIDATION_MESSAGE_TYPE   (0x100000001ull)
     struct CascadeNotificationMessage: public mutils::ByteRepresentable {
         /** The object pool pathname, empty string for raw cascade notification message */
         std::string object_pool_pathname;
@@ -366,6 +401,8 @@ namespace cascade {
         // value: an option for the handler
         // The handler for "" key is the default handler, which will always be triggered.
         std::unordered_map<std::string, std::optional<cascade_notification_handler_t>> object_pool_notification_handlers;
+        // The handler of the cache invalidation messages, which are not passed to the handlers above.
+        std::optional<cascade_notification_handler_t> cache_invalidation_handler;
         mutable std::unique_ptr<std::mutex> object_pool_notification_handlers_mutex;
 
         SubgroupNotificationHandler():
@@ -386,6 +423,16 @@ namespace cascade {
         inline void operator ()(const derecho::NotificationMessage& msg) {
             dbg_default_trace("SubgroupNotificationHandler(this={:x}) is triggered with message_type={:x}, size={} bytes",
                     reinterpret_cast<uint64_t>(this),msg.message_type, msg.size);
+            if (msg.message_type == CASCADE_CACHE_INVALIDATION_MESSAGE_TYPE) {
+                mutils::deserialize_and_run(nullptr, msg.body,
+                        [this](const CascadeNotificationMessage& cascade_message)->void {
+                            std::lock_guard<std::mutex> lck(*object_pool_notification_handlers_mutex);
+                            if (cache_invalidation_handler.has_value()) {
+                                (*cache_invalidation_handler)(cascade_message.blob);
+                            }
+                        });
+                return;
+            }
             if (msg.message_type != CASCADE_NOTIFICATION_MESSAGE_TYPE) {
                 return;
             }
@@ -403,7 +450,8 @@ namespace cascade {
                             }
                         }
                         // call object pool handler
-                        if (object_pool_notification_handlers.find(cascade_message.object_pool_pathname) !=
+                        if (!cascade_message.object_pool_pathname.empty() &&
+                            object_pool_notification_handlers.find(cascade_message.object_pool_pathname) !=
                             object_pool_notification_handlers.cend()) {
                             if (object_pool_notification_handlers.at(cascade_message.object_pool_pathname).has_value()) {
                                 (*object_pool_notification_handlers.at(cascade_message.object_pool_pathname))(cascade_message.blob);
@@ -422,10 +470,15 @@ namespace cascade {
     private:
         // default caller as an external client.
         std::unique_ptr<derecho::ExternalGroupClient<CascadeMetadataService<CascadeTypes...>,CascadeTypes...>> external_group_ptr;
-        mutable std::mutex external_group_ptr_mutex;
         // caller as a group member.
         derecho::Group<CascadeMetadataService<CascadeTypes...>, CascadeTypes...>* group_ptr;
-        mutable std::mutex group_ptr_mutex;
+        /**
+         * 'submission_locks' serialize the requests issued to the same destination node, through either caller. The
+         * ordered sends to the shard of this node are keyed by this node. The requests to different nodes, including
+         * the members of the same shard, are built and sent concurrently from different threads, but the first request
+         * to a node, which may open the connection to it, is sent alone (see SubmissionLocks).
+         */
+        mutable SubmissionLocks submission_locks;
         // cascade server side notification handler registry.
         mutable mutils::KindMap<per_type_notification_handler_registry_t,CascadeTypes...> notification_handler_registry;
         mutable std::mutex notification_handler_registry_mutex;
@@ -442,6 +495,16 @@ namespace cascade {
             std::tuple<std::type_index,uint32_t,uint32_t>,
             std::tuple<ShardMemberSelectionPolicy,node_id_t>,
             do_hash<std::tuple<std::type_index,uint32_t,uint32_t>>> member_selection_policies;
+        /**
+         * 'round_robin_counters' is a map from derecho shard to the index of its next member, if the policy is
+         * ShardMemberSelectionPolicy::RoundRobin. The counter starts after the member index in the policy, and is
+         * advanced atomically, so that the concurrent requests to a shard only take the read lock.
+         */
+        std::unordered_map<
+            std::tuple<std::type_index,uint32_t,uint32_t>,
+            std::unique_ptr<std::atomic<uint32_t>>,
+            do_hash<std::tuple<std::type_index,uint32_t,uint32_t>>> round_robin_counters;
+        // 'member_selection_policies_mutex' guards both 'member_selection_policies' and 'round_robin_counters'.
         mutable std::shared_mutex member_selection_policies_mutex;
         /**
          * 'member_cache' is a map from derecho shard to its member list. This cache is used to accelerate the member
@@ -454,13 +517,85 @@ namespace cascade {
             do_hash<std::tuple<std::type_index,uint32_t,uint32_t>>> member_cache;
         mutable std::shared_mutex member_cache_mutex;
         /**
-         * 'object_pool_info_cache' is a local cache for object pool metadata. This cache is used to accelerate the
+         * 'member_load_tracker' tracks the outstanding requests and the latency of each member, for the
+         * LeastOutstanding and LatencyEWMA policies. A request is recorded by track_reply(), or by
+         * track_hedged_request() if it is a hedged read.
+         */
+        MemberLoadTracker member_load_tracker;
+        /**
+         * 'object_pool_resolver' is a local cache for object pool metadata. This cache is used to accelerate the
          * object access process. If an object pool does not exists, it will be loaded from metadata service.
          */
-        std::unordered_map<
-            std::string,
-            ObjectPoolMetadata<CascadeTypes...>> object_pool_metadata_cache;
-        mutable std::shared_mutex object_pool_metadata_cache_mutex;
+        ObjectPoolResolver<ObjectPoolMetadata<CascadeTypes...>> object_pool_resolver;
+        /**
+         * The push-based sync of 'object_pool_resolver'. An external client subscribes to the metadata changes of all
+         * metadata service shards when it is created (see subscribe_object_pool_metadata_changes()), and applies each
+         * change event to the cache. 'metadata_shard_versions' holds the version of the latest change seen from each
+         * shard: an event whose previous version does not match it reveals missed events, and the cache is marked
+         * stale, so that it is reloaded.
+         *
+         * 'metadata_subscription_members' holds the member of each shard that has the subscription. The
+         * 'metadata_sync_thread' renews the subscriptions every METADATA_SYNC_INTERVAL_MS, and each renewal is answered
+         * with a heartbeat carrying the latest version of the shard, which catches the events missed without a later
+         * event to reveal them. A subscription moves to another member if its member has left the shard, or has not
+         * answered METADATA_SYNC_MAX_MISSED_HEARTBEATS renewals, and the cache is marked stale then.
+         */
+        SubgroupNotificationHandler<CascadeMetadataService<CascadeTypes...>> metadata_notification_handler;
+        std::vector<persistent::version_t> metadata_shard_versions;
+        std::vector<node_id_t> metadata_subscription_members;
+        std::vector<uint32_t> metadata_missed_heartbeats;
+        uint64_t metadata_change_count;
+        std::atomic<bool> metadata_cache_stale;
+        mutable std::mutex metadata_sync_mutex;
+#define METADATA_SYNC_INTERVAL_MS               (1000)
+#define METADATA_SYNC_MAX_MISSED_HEARTBEATS     (3)
+        std::thread metadata_sync_thread;
+        std::condition_variable metadata_sync_cv;
+        bool metadata_sync_stopped;
+        /**
+         * 'read_cache' caches the objects read from the object pools, see set_read_cache_policy(). An external client
+         * keeps the objects read at the current version valid with the invalidations pushed by the shards (see
+         * CacheInvalidationPublisher).
+         *
+         * 'cache_subscriptions' holds the invalidation subscriptions of each object pool cached at the current
+         * version, which are renewed with the metadata subscriptions by the 'metadata_sync_thread'. As for those, a
+         * subscription moves to another shard member if its member has left the shard, or has not answered
+         * METADATA_SYNC_MAX_MISSED_HEARTBEATS renewals. The invalidations pushed meanwhile are lost, so the cached
+         * objects of the object pool are dropped then, and also when a heartbeat reports a version the client has not
+         * received.
+         */
+        ReadCache read_cache;
+        struct CacheSubscription {
+            uint32_t subgroup_type_index;
+            uint32_t subgroup_index;
+            std::vector<node_id_t> members;
+            std::vector<uint32_t> missed_heartbeats;
+            std::vector<persistent::version_t> shard_versions;
+        };
+        std::unordered_map<std::string,CacheSubscription> cache_subscriptions;
+        mutable std::mutex cache_subscriptions_mutex;
+        /**
+         * 'hedged_reads' duplicates the slow p2p get and get_size requests to another shard member, see
+         * set_hedged_read_policy(). It is declared after the other members, so that its worker thread stops before
+         * they are destroyed.
+         */
+        HedgedReads hedged_reads;
+        /**
+         * 'reply_watcher' records the replies of the requests tracked by track_reply(). It is declared after
+         * member_load_tracker and hedged_reads, so that its threads stop before they are destroyed.
+         */
+        ReplyWatcher reply_watcher;
+        /**
+         * 'async_pipeline' runs the asynchronous operations, see set_async_pipeline(). It is declared after
+         * hedged_reads and reply_watcher, because its destructor waits for the in-flight operations, which may be
+         * hedged or tracked.
+         */
+        AsyncPipeline async_pipeline;
+        /**
+         * 'write_combiner' buffers put_and_forget, see set_write_coalescing_policy(). It is declared
+         * last, because its destructor sends the buffered objects with the other members.
+         */
+        WriteCombiner write_combiner;
 
         /**
          * Pick a member by a given a policy.
@@ -481,6 +616,43 @@ namespace cascade {
         template <typename SubgroupType>
         void refresh_member_cache_entry(uint32_t subgroup_index, uint32_t shard_index);
 
+        /**
+         * Pick the member for a duplicate read, see set_hedged_read_policy().
+         * @param subgroup_index
+         * @param shard_index
+         * @param primary_node_id   - the member of the first read, which is excluded.
+         *
+         * @return the member, or INVALID_NODE_ID if there is no other member.
+         */
+        template <typename SubgroupType>
+        node_id_t pick_hedge_member(uint32_t subgroup_index, uint32_t shard_index, node_id_t primary_node_id);
+
+        /**
+         * Track the reply of a p2p request for the load-aware policies. If the shard has the LeastOutstanding or
+         * LatencyEWMA policy, or if the hedged reads are enabled, the request is recorded in member_load_tracker. If
+         * member_load_tracker tracks it, which is the case for one request per member at a time, its reply is recorded
+         * by reply_watcher when it comes, and forwarded to the results returned. Otherwise, the results are returned as
+         * they are, and the reply of a later tracked request to the member completes the request.
+         * @param subgroup_index
+         * @param shard_index
+         * @param node_id           - the member the request was sent to.
+         * @param results           - the results of the request.
+         *
+         * @return the results to hand to the caller.
+         */
+        template <typename SubgroupType, typename ReplyType>
+        derecho::rpc::QueryResults<ReplyType> track_reply(uint32_t subgroup_index, uint32_t shard_index,
+                node_id_t node_id, derecho::rpc::QueryResults<ReplyType>&& results);
+
+        /**
+         * Record a request of a hedged read in member_load_tracker. The hedged reads watch their replies already, so
+         * the request is always tracked, and its reply is recorded by the completion handed to hedged_reads.
+         * @param node_id           - the member the request was sent to.
+         *
+         * @return the completion of the request.
+         */
+        HedgedReads::completion_t track_hedged_request(node_id_t node_id);
+
         /**
          * Deprecated: Please use key_to_shard() instead
          *
@@ -498,6 +670,17 @@ namespace cascade {
         std::tuple<uint32_t,uint32_t,uint32_t> key_to_shard(
                 const KeyType& key, bool check_object_location = true);
 
+        /**
+         * Metadata API Helper: turn a string key to subgroup type index, subgroup index, and shard index, and find
+         * whether the read cache of its object pool is enabled, with one metadata lookup.
+         *
+         * @param cached_object_pool    set to the pathname of the object pool of the key if its read cache is
+         *                              enabled, or to an empty string.
+         */
+        template <typename KeyType>
+        std::tuple<uint32_t,uint32_t,uint32_t> key_to_shard(
+                const KeyType& key, std::string& cached_object_pool, bool check_object_location = true);
+
     public:
         /**
          * The Constructor
@@ -508,6 +691,11 @@ namespace cascade {
          */
         ServiceClient(derecho::Group<CascadeMetadataService<CascadeTypes...>, CascadeTypes...>* _group_ptr=nullptr);
 
+        /**
+         * The Destructor stops the 'metadata_sync_thread'.
+         */
+        virtual ~ServiceClient();
+
         /**
          * ServiceClient can be an external client or a cascade server. is_external_client() test this condition.
          * The external client implementation is based on ExternalGroupClient<> while the cascade node implementation is
@@ -570,6 +758,151 @@ namespace cascade {
         std::tuple<ShardMemberSelectionPolicy,node_id_t> get_member_selection_policy(
                 uint32_t subgroup_index, uint32_t shard_index) const;
 
+        /**
+         * Hedged read control API. In hedging mode, if the member of a p2p get or get_size has not replied within a
+         * percentile of the recent read latencies, the read is sent to another member of the shard too, and the first
+         * reply wins. The ReplyMap of a hedged read is keyed by the member whose reply won. It never applies to the
+         * reads served by the local shard.
+         * - set_hedged_read_policy enables or disables the hedging mode.
+         * - get_hedged_read_stats returns the number of hedged reads, of the duplicate reads, and of the reads won by
+         *   the duplicate.
+         * @param enable        true to enable the hedging mode.
+         * @param percentile    the latency percentile after which a duplicate read is sent.
+         * @param min_delay_us  the minimal delay before a duplicate read.
+         */
+        void set_hedged_read_policy(bool enable,
+                double percentile = HEDGED_READ_DEFAULT_PERCENTILE,
+                uint64_t min_delay_us = HEDGED_READ_DEFAULT_MIN_DELAY_US);
+
+        HedgedReads::Stats get_hedged_read_stats() const;
+
+        /**
+         * Asynchronous operation API. An asynchronous operation (put_async, remove_async, get_async) is sent at once,
+         * and its completion callback is called with its QueryResults by a completion thread, once all of its replies
+         * have come. Each shard has a window of in-flight operations: an operation to a shard whose window is full
+         * waits until an operation to that shard completes. An operation submitted by a completion callback does not
+         * wait for the window. The operations complete as their replies come, so that a slow shard does not hold the
+         * callbacks of the other shards back, and the callbacks may run out of order. With more than one completion
+         * thread, they may run concurrently too.
+         * - set_async_pipeline configures the window size and the number of completion threads. The number of
+         *   completion threads cannot change after the first asynchronous operation.
+         * - wait_for_async_operations waits until all asynchronous operations have completed. It must not be called
+         *   by a completion callback.
+         * @param window_size           the maximal number of in-flight operations per shard.
+         * @param completion_threads    the number of completion threads.
+         */
+        void set_async_pipeline(uint32_t window_size,
+                uint32_t completion_threads = ASYNC_PIPELINE_DEFAULT_COMPLETION_THREADS);
+
+        void wait_for_async_operations();
+
+        /**
+         * Write coalescing control API. When write coalescing is enabled, put_and_forget buffers the objects per
+         * shard, and a buffer is sent with put_and_forget_batch when it reaches max_batch_bytes, or when its oldest
+         * object has waited for max_delay_us, whichever comes first. The order is kept among the put_and_forget
+         * objects to a shard. The other requests to a shard send its buffered objects first, so they are not
+         * overtaken. trigger_put is not coalesced, because it returns a future to wait for.
+         * - set_write_coalescing_policy enables or disables write coalescing. The buffered objects are sent when it
+         *   is disabled.
+         * - flush_coalesced_writes sends the buffered objects now.
+         * - get_write_coalescing_stats returns the number of buffered objects, and of the batches sent.
+         * @param enable            true to enable write coalescing.
+         * @param max_batch_bytes   the size threshold of a buffer, in bytes.
+         * @param max_delay_us      the maximal delay of a buffered object, in microseconds.
+         */
+        void set_write_coalescing_policy(bool enable,
+                std::size_t max_batch_bytes = WRITE_COMBINER_DEFAULT_MAX_BATCH_BYTES,
+                uint64_t max_delay_us = WRITE_COMBINER_DEFAULT_MAX_DELAY_US);
+
+        void flush_coalesced_writes();
+
+        WriteCombiner::Stats get_write_coalescing_stats() const;
+
+    protected:
+        /**
+         * "flush_shard_coalesced_writes" sends the buffered objects to a shard, before another request to it.
+         * @param subgroup_index    the subgroup index of SubgroupType
+         * @param shard_index       the shard index
+         */
+        template <typename SubgroupType>
+        void flush_shard_coalesced_writes(uint32_t subgroup_index, uint32_t shard_index);
+    public:
+
+        /**
+         * "put_async" writes an object to a given subgroup/shard asynchronously, see set_async_pipeline().
+         *
+         * @param object            the object to write, see put().
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         * @param on_complete       called with the results of the put, which are ready. It may be empty.
+         */
+        template <typename SubgroupType>
+        void put_async(const typename SubgroupType::ObjectType& object,
+                uint32_t subgroup_index, uint32_t shard_index,
+                const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete = {});
+
+        /**
+         * object pool version
+         * @param object        the object to write, the object pool is extracted from the object key.
+         * @param on_complete   called with the results of the put, which are ready. It may be empty.
+         */
+        template <typename ObjectType>
+        void put_async(const ObjectType& object,
+                const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete = {});
+
+        /**
+         * "remove_async" deletes an object from a given subgroup/shard asynchronously, see set_async_pipeline().
+         *
+         * @param key               the object key
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         * @param on_complete       called with the results of the remove, which are ready. It may be empty.
+         */
+        template <typename SubgroupType>
+        void remove_async(const typename SubgroupType::KeyType& key,
+                uint32_t subgroup_index, uint32_t shard_index,
+                const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete = {});
+
+        /**
+         * object pool version
+         * @param key           the object key, the object pool is extracted from it.
+         * @param on_complete   called with the results of the remove, which are ready. It may be empty.
+         */
+        template <typename KeyType>
+        void remove_async(const KeyType& key,
+                const std::function<void(derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>>&)>& on_complete = {});
+
+        /**
+         * "get_async" retrieves the object of a given key asynchronously, see set_async_pipeline().
+         *
+         * @param key               the object key
+         * @param version           the version, see get().
+         * @param stable            stable get or not
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         * @param on_complete       called with the results of the get, which are ready. It may be empty.
+         */
+        template <typename SubgroupType>
+        void get_async(const typename SubgroupType::KeyType& key,
+                const persistent::version_t& version,
+                bool stable,
+                uint32_t subgroup_index, uint32_t shard_index,
+                const std::function<void(derecho::rpc::QueryResults<const typename SubgroupType::ObjectType>&)>& on_complete = {});
+
+        /**
+         * object pool version
+         * @param key           the object key, the object pool is extracted from it.
+         * @param version       the version, see get().
+         * @param stable        stable get or not
+         * @param on_complete   called with the results of the get, which are ready. The type of the results is
+         *                      the one of the object pool version of get().
+         */
+        template <typename KeyType, typename CompletionCallback>
+        void get_async(const KeyType& key,
+                const persistent::version_t& version,
+                bool stable,
+                const CompletionCallback& on_complete);
+
         /**
          * "put" writes an object to a given subgroup/shard.
          *
@@ -641,11 +974,25 @@ namespace cascade {
          *                            already. TODO: should we make it an optional feature?
          * @param subugroup_index   the subgroup index of CascadeType
          * @param shard_index       the shard index.
+         *
+         * If write coalescing is enabled, the object is buffered, see set_write_coalescing_policy().
          */
         template <typename SubgroupType>
         void put_and_forget(const typename SubgroupType::ObjectType& object,
                 uint32_t subgroup_index, uint32_t shard_index);
 
+        /**
+         * "put_and_forget_batch" writes a batch of objects to a given subgroup/shard with one p2p message. Unlike
+         * put_batch, each object is still an ordered put_and_forget of its own.
+         *
+         * @param objects           the objects to write. See put() for the requirements on the objects.
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         */
+        template <typename SubgroupType>
+        void put_and_forget_batch(const std::vector<typename SubgroupType::ObjectType>& objects,
+                uint32_t subgroup_index, uint32_t shard_index);
+
         /**
          * "type_recursive_put_and_forget" is a helper function for internal use only.
          * @type_index              the index of the subgroup type in the CascadeTypes... list. and the FirstType,
@@ -676,6 +1023,121 @@ namespace cascade {
         template <typename ObjectType>
         void put_and_forget(const ObjectType& object);
 
+        /**
+         * "put_batch" writes a batch of objects to a given subgroup/shard in one ordered message, which is logged as a
+         * single delta. All objects in the batch get the same version and timestamp.
+         *
+         * @param objects           the objects to write. See put() for the requirements on the objects.
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a future to the version and timestamp of each object, in order. The version of a rejected object is
+         *         INVALID_VERSION.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<std::vector<std::tuple<persistent::version_t,uint64_t>>> put_batch(
+                const std::vector<typename SubgroupType::ObjectType>& objects,
+                uint32_t subgroup_index, uint32_t shard_index);
+
+        /**
+         * "type_recursive_put_batch" is a helper function for internal use only.
+         * @type_index              the index of the subgroup type in the CascadeTypes... list. And the FirstType,
+         *                          SecondType, ..., RestTypes should be in the same order.
+         * @objects                 the objects to write
+         * @subgroup_index          the subgroup index in the subgroup type designated by type_index
+         * @shard_index             the shard index
+         *
+         * @return a future to the versions and timestamps of the put_batch operation.
+         */
+    protected:
+        template <typename ObjectType, typename FirstType, typename SecondType, typename... RestTypes>
+        derecho::rpc::QueryResults<std::vector<std::tuple<persistent::version_t,uint64_t>>> type_recursive_put_batch(
+                uint32_t type_index,
+                const std::vector<ObjectType>& objects,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename ObjectType, typename LastType>
+        derecho::rpc::QueryResults<std::vector<std::tuple<persistent::version_t,uint64_t>>> type_recursive_put_batch(
+                uint32_t type_index,
+                const std::vector<ObjectType>& objects,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+    public:
+        /**
+         * object pool version
+         * The objects are grouped by shard, and each shard receives its group as one batch. The batches are sent
+         * before waiting for any of them.
+         *
+         * @param objects   the objects to write, the object pool of each object is extracted from its key.
+         *
+         * @return the version and timestamp of each object, in the order of the objects.
+         */
+        template <typename ObjectType>
+        std::vector<std::tuple<persistent::version_t,uint64_t>> put_batch(const std::vector<ObjectType>& objects);
+
+        /**
+         * "transact" writes a set of objects to a given subgroup/shard atomically, if none of the keys in the read set
+         * has changed. Everything is committed or rejected in one ordered message.
+         *
+         * @param read_set          the keys and the versions the caller has read. A removed key is expected with the
+         *                          version of its removal, and a key that never existed with INVALID_VERSION.
+         * @param write_set         the objects to write, with distinct keys. See put() for the requirements on the
+         *                          objects.
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a future to the version and timestamp of the transaction, whose version is INVALID_VERSION if it
+         *         is rejected. A read-only transaction returns the latest version of the shard and a zero timestamp.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> transact(
+                const std::vector<std::tuple<typename SubgroupType::KeyType,persistent::version_t>>& read_set,
+                const std::vector<typename SubgroupType::ObjectType>& write_set,
+                uint32_t subgroup_index, uint32_t shard_index);
+
+        /**
+         * "type_recursive_transact" is a helper function for internal use only.
+         * @type_index              the index of the subgroup type in the CascadeTypes... list. And the FirstType,
+         *                          SecondType, ..., RestTypes should be in the same order.
+         * @read_set                the keys and their expected versions
+         * @write_set               the objects to write
+         * @subgroup_index          the subgroup index in the subgroup type designated by type_index
+         * @shard_index             the shard index
+         *
+         * @return a future to the version and timestamp of the transaction.
+         */
+    protected:
+        template <typename ObjectType, typename FirstType, typename SecondType, typename... RestTypes>
+        derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> type_recursive_transact(
+                uint32_t type_index,
+                const std::vector<std::tuple<std::string,persistent::version_t>>& read_set,
+                const std::vector<ObjectType>& write_set,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename ObjectType, typename LastType>
+        derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> type_recursive_transact(
+                uint32_t type_index,
+                const std::vector<std::tuple<std::string,persistent::version_t>>& read_set,
+                const std::vector<ObjectType>& write_set,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+    public:
+        /**
+         * object pool version
+         * All keys in the read set and the write set must map to the same shard, otherwise an exception is thrown.
+         *
+         * @param read_set  the keys and the versions the caller has read.
+         * @param write_set the objects to write, the object pool is extracted from the object keys.
+         *
+         * @return a future to the version and timestamp of the transaction.
+         */
+        template <typename ObjectType>
+        derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> transact(
+                const std::vector<std::tuple<std::string,persistent::version_t>>& read_set,
+                const std::vector<ObjectType>& write_set);
+
         /**
          * "trigger_put" writes an object to a given subgroup/shard.
          *
@@ -684,11 +1146,43 @@ namespace cascade {
          * @param shard_index       the shard index.
          *
          * @return a void future.
+         *
+         * It is not coalesced, but it sends the buffered put_and_forget objects to the shard first, see
+         * set_write_coalescing_policy().
          */
         template <typename SubgroupType>
         derecho::rpc::QueryResults<void> trigger_put(const typename SubgroupType::ObjectType& object,
                 uint32_t subgroup_index, uint32_t shard_index);
 
+    protected:
+        /**
+         * "send_trigger_put" sends an object to a given subgroup/shard as a trigger at once, bypassing the write
+         * combiner. The internal subscriptions use it, because they are not to be delayed or batched.
+         *
+         * @param object            the object to write.
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a void future.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<void> send_trigger_put(const typename SubgroupType::ObjectType& object,
+                uint32_t subgroup_index, uint32_t shard_index);
+    public:
+
+        /**
+         * "trigger_put_batch" writes a batch of objects to a given subgroup/shard as triggers, with one p2p message.
+         *
+         * @param objects           the objects to write.
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a void future.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<void> trigger_put_batch(const std::vector<typename SubgroupType::ObjectType>& objects,
+                uint32_t subgroup_index, uint32_t shard_index);
+
         /**
          * "type_recursive_trigger_put" is a helper function for internal use only.
          * @type_index              the index of the subgroup type in the CascadeTypes... list. and the FirstType,
@@ -833,9 +1327,94 @@ namespace cascade {
                 bool stable,
                 uint32_t subgroup_index,
                 uint32_t shard_index);
+
+        /**
+         * "get_from_member" is get(), which also tells the member the get is sent to.
+         * @param node_id           set to the member the get is sent to, or to this node for a local get.
+         * @param key               the key
+         * @param version           the version
+         * @param stable            stable or not?
+         * @param subgroup_index    the subgroup index
+         * @param shard_index       the shard index
+         *
+         * @return a future for the object.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> get_from_member(
+                node_id_t& node_id,
+                const typename SubgroupType::KeyType& key,
+                const persistent::version_t& version,
+                bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+        /**
+         * "hedged_get" hands a p2p get over to hedged_reads, see set_hedged_read_policy(). The results are those of
+         * p2p_send, not wrapped by track_reply(): the requests are recorded by track_hedged_request().
+         * @param node_id           the member the get was sent to
+         * @param primary           the results of the get
+         * @param key               the key
+         * @param version           the version
+         * @param stable            stable or not?
+         * @param subgroup_index    the subgroup index
+         * @param shard_index       the shard index
+         *
+         * @return a future for the object.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> hedged_get(
+                node_id_t node_id,
+                derecho::rpc::QueryResults<const typename SubgroupType::ObjectType>&& primary,
+                const typename SubgroupType::KeyType& key,
+                const persistent::version_t& version,
+                bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+        /**
+         * "cached_get" serves a get of a cached object pool from read_cache, or sends it and caches the reply, see
+         * set_read_cache_policy(). It does not wait for the reply: the reply is cached and handed on by reply_watcher
+         * when it comes, keyed by the member the get was sent to.
+         * @param object_pool_pathname  the object pool of the key
+         * @param key                   the key
+         * @param version               the version
+         * @param stable                stable or not?
+         * @param subgroup_index        the subgroup index
+         * @param shard_index           the shard index
+         *
+         * @return a future for the object.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<const typename SubgroupType::ObjectType> cached_get(
+                const std::string& object_pool_pathname,
+                const typename SubgroupType::KeyType& key,
+                const persistent::version_t& version,
+                bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+        auto type_recursive_cached_get(
+                uint32_t type_index,
+                const std::string& object_pool_pathname,
+                const KeyType& key,
+                const persistent::version_t& version,
+                bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename KeyType, typename LastType>
+        auto type_recursive_cached_get(
+                uint32_t type_index,
+                const std::string& object_pool_pathname,
+                const KeyType& key,
+                const persistent::version_t& version,
+                bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
     public:
         /**
          * object pool version
+         *
+         * If the read cache of the object pool is enabled, the get may be served from it, see set_read_cache_policy().
          */
         template <typename KeyType>
         auto get(
@@ -843,6 +1422,68 @@ namespace cascade {
                 const persistent::version_t& version = CURRENT_VERSION,
                 bool stable = true);
 
+        /**
+         * "put_stream" writes a large object from a stream, without holding it in memory (object pool version).
+         *
+         * The data is split into chunks of chunk_size bytes, which are put as objects of their own, up to
+         * STREAM_MAX_CHUNKS_IN_FLIGHT at a time, and spread over the shards by their keys. A StreamManifest of the
+         * chunks is then put under the manifest key of the object (see StreamManifest::manifest_key()), so a reader
+         * sees either the previous data or the whole new data. The chunks of the previous manifest are kept for its
+         * readers, and the chunks of the manifest before it are removed afterwards. If a chunk fails, the chunks
+         * written so far are removed and the exception is thrown. A streamed object is read by get_stream() only, and
+         * a put of the key itself does not replace it.
+         *
+         * @tparam ObjectType       the object type, which is constructed from a key and a buffer.
+         * @param key               the object key
+         * @param reader            the source of the data
+         * @param chunk_size        the chunk size in bytes, which must fit in the payload of the subgroup.
+         *
+         * @return the version and timestamp of the manifest object.
+         */
+        template <typename ObjectType>
+        std::tuple<persistent::version_t,uint64_t> put_stream(
+                const std::string& key,
+                const stream_reader_t& reader,
+                std::size_t chunk_size = STREAM_DEFAULT_CHUNK_SIZE);
+
+        /**
+         * "get_stream" reads a range of an object written by put_stream, passing its data to the writer in order,
+         * chunk by chunk. Only the chunks in the range are read, up to STREAM_MAX_CHUNKS_IN_FLIGHT at a time. An
+         * object which is not streamed is passed to the writer as a whole range.
+         *
+         * @param key               the object key
+         * @param writer            the sink of the data
+         * @param version           the version of the manifest object, as returned by put_stream. The chunks of a
+         *                          manifest are removed by the second put_stream of the key after it, after which
+         *                          reading that version throws an exception.
+         * @param stable            read the manifest from stable data or not.
+         * @param offset            the offset of the range
+         * @param length            the length of the range, which ends at the end of the object at most.
+         *
+         * @return the number of bytes passed to the writer.
+         */
+        std::size_t get_stream(
+                const std::string& key,
+                const stream_writer_t& writer,
+                const persistent::version_t& version = CURRENT_VERSION,
+                bool stable = true,
+                std::size_t offset = 0,
+                std::size_t length = std::numeric_limits<std::size_t>::max());
+
+    protected:
+        /**
+         * Remove the chunks of an upload of a streamed object. A chunk which cannot be removed is left behind with a
+         * warning.
+         *
+         * @param key               the object key
+         * @param uploader_id       the uploader id of the upload, see StreamManifest.
+         * @param upload_time       the upload time of the upload, see StreamManifest.
+         * @param num_chunks        the number of chunks to remove, from the first one.
+         */
+        void remove_stream_chunks(const std::string& key, uint64_t uploader_id, uint64_t upload_time, uint64_t num_chunks);
+
+    public:
+
         /**
          * "multi_get" retrieve the object of a given key, this operation involves atomic broadcast
          *
@@ -959,150 +1600,429 @@ namespace cascade {
          * @param subugroup_index   the subgroup index of CascadeType
          * @param shard_index       the shard index.
          *
-         * @return a future to the retrieved size.
-         * TODO: check if the user application is responsible for reclaim the future by reading it sometime.
+         * @return a future to the retrieved size.
+         * TODO: check if the user application is responsible for reclaim the future by reading it sometime.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<uint64_t> get_size(
+                const typename SubgroupType::KeyType& key,
+                const persistent::version_t& version,
+                const bool stable = true,
+                uint32_t subgroup_index = 0,
+                uint32_t shard_index = 0);
+
+        /**
+         * "type_recursive_get_size" is a helper function for internal use only.
+         * @param type_index        the index of the subgroup type in the CascadeTypes... list. and the FirstType,
+         *                          SecondType, .../ RestTypes should be in the same order.
+         * @param key               the key
+         * @param version           version
+         * @param stable            stable get size or not
+         * @param subgroup_index    the subgroup index in the subgroup type designated by type_index
+         * @param shard_index       the shard index
+         *
+         * @return a future for the object.
+         */
+    protected:
+        template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size(
+                uint32_t type_index,
+                const KeyType& key,
+                const persistent::version_t& version,
+                const bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename KeyType, typename LastType>
+        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size(
+                uint32_t type_index,
+                const KeyType& key,
+                const persistent::version_t& version,
+                const bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        /**
+         * "hedged_get_size" hands a p2p get_size over to hedged_reads, as hedged_get does.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<uint64_t> hedged_get_size(
+                node_id_t node_id,
+                derecho::rpc::QueryResults<uint64_t>&& primary,
+                const typename SubgroupType::KeyType& key,
+                const persistent::version_t& version,
+                const bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+    public:
+        /**
+         * object pool version
+         */
+        template <typename KeyType>
+        derecho::rpc::QueryResults<uint64_t> get_size(
+                const KeyType& key,
+                const persistent::version_t& version,
+                const bool stable = true);
+
+        /**
+         * "multi_get_size" retrieve size of the object of a given key
+         *
+         * @param key               the object key
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a future to the retrieved size.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<uint64_t> multi_get_size(
+                const typename SubgroupType::KeyType& key,
+                uint32_t subgroup_index, uint32_t shard_index);
+
+        /**
+         * "type_recursive_multi_get_size" is a helper function for internal use only.
+         * @param type_index        the index of the subgroup type in the CascadeTypes... list. and the FirstType,
+         *                          SecondType, .../ RestTypes should be in the same order.
+         * @param key               the key
+         * @param subgroup_index    the subgroup index in the subgroup type designated by type_index
+         * @param shard_index       the shard index
+         *
+         * @return a future for the object.
+         */
+    protected:
+        template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+        derecho::rpc::QueryResults<uint64_t> type_recursive_multi_get_size(
+                uint32_t type_index,
+                const KeyType& key,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename KeyType, typename LastType>
+        derecho::rpc::QueryResults<uint64_t> type_recursive_multi_get_size(
+                uint32_t type_index,
+                const KeyType& key,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+    public:
+        /**
+         * object pool version
+         */
+        template <typename KeyType>
+        derecho::rpc::QueryResults<uint64_t> multi_get_size(const KeyType& key);
+
+        /**
+         * "get_size_by_time" retrieve size of the object of a given key
+         *
+         * @param key               the object key
+         * @param ts_us             Wall clock time in microseconds.
+         * @param stable            stable get or not
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a future to the retrieved size.
+         * TODO: check if the user application is responsible for reclaim the future by reading it sometime.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<uint64_t> get_size_by_time(
+                const typename SubgroupType::KeyType& key,
+                const uint64_t& ts_us,
+                const bool stable = true,
+                uint32_t subgroup_index = 0,
+                uint32_t shard_index = 0);
+
+        /**
+         * "type_recursive_get_size" is a helper function for internal use only.
+         * @param type_index        the index of the subgroup type in the CascadeTypes... list. and the FirstType,
+         *                          SecondType, .../ RestTypes should be in the same order.
+         * @param key               the key
+         * @param ts_us             Wall clock time in microseconds.
+         * @param stable            stable get or not
+         * @param subgroup_index    the subgroup index in the subgroup type designated by type_index
+         * @param shard_index       the shard index
+         *
+         * @return a future for the object.
+         */
+    protected:
+        template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size_by_time(
+                uint32_t type_index,
+                const KeyType& key,
+                const uint64_t& ts_us,
+                const bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename KeyType, typename LastType>
+        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size_by_time(
+                uint32_t type_index,
+                const KeyType& key,
+                const uint64_t& ts_us,
+                const bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+    public:
+
+        /**
+         * object pool version
+         */
+        template <typename KeyType>
+        derecho::rpc::QueryResults<uint64_t> get_size_by_time(
+                const KeyType& key,
+                const uint64_t& ts_us,
+                const bool stable = true);
+
+        /**
+         * "get_many" retrieve the objects of a list of keys in a given subgroup/shard with one request.
+         * The shard reads all of the keys from one snapshot of its state.
+         *
+         * @param keys              the object keys
+         * @param version           if version is CURRENT_VERSION, the latest state of the keys is read. Otherwise, the
+         *                          keys' state at version is read.
+         * @param stable            stable get or not
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a future to the objects, in the order of the keys.
+         */
+        template <typename SubgroupType>
+        derecho::rpc::QueryResults<std::vector<typename SubgroupType::ObjectType>> get_many(
+                const std::vector<typename SubgroupType::KeyType>& keys,
+                const persistent::version_t& version,
+                const bool stable = true,
+                uint32_t subgroup_index = 0,
+                uint32_t shard_index = 0);
+
+        /**
+         * "type_recursive_get_many" is a helper function for internal use only.
+         * @param type_index        the index of the subgroup type in the CascadeTypes... list. and the FirstType,
+         *                          SecondType, .../ RestTypes should be in the same order.
+         * @param keys              the keys
+         * @param version           if version is CURRENT_VERSION, the latest state of the keys is read. Otherwise, the
+         *                          keys' state at version is read.
+         * @param stable            stable get or not
+         * @param subgroup_index    the subgroup index in the subgroup type designated by type_index
+         * @param shard_index       the shard index
+         *
+         * @return a future for the objects.
+         */
+    protected:
+        template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
+        auto type_recursive_get_many(
+                uint32_t type_index,
+                const std::vector<KeyType>& keys,
+                const persistent::version_t& version,
+                const bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+
+        template <typename KeyType, typename LastType>
+        auto type_recursive_get_many(
+                uint32_t type_index,
+                const std::vector<KeyType>& keys,
+                const persistent::version_t& version,
+                const bool stable,
+                uint32_t subgroup_index,
+                uint32_t shard_index);
+    public:
+
+        /**
+         * object pool version
+         * The keys are grouped by shard, and each shard receives its group in one request. The requests are sent
+         * before waiting for any of them.
+         *
+         * @param keys      the object keys, in any object pools.
+         *
+         * @return the objects, in the order of the keys.
+         */
+        template <typename KeyType>
+        auto get_many(
+                const std::vector<KeyType>& keys,
+                const persistent::version_t& version = CURRENT_VERSION,
+                const bool stable = true);
+
+        /**
+         * "get_many_by_time" retrieve the objects of a list of keys in a given subgroup/shard with one request.
+         * The shard reads all of the keys from one snapshot of its state.
+         *
+         * @param keys              the object keys
+         * @param ts_us             Wall clock time in microseconds.
+         * @param stable            stable get or not
+         * @param subugroup_index   the subgroup index of CascadeType
+         * @param shard_index       the shard index.
+         *
+         * @return a future to the objects, in the order of the keys.
          */
         template <typename SubgroupType>
-        derecho::rpc::QueryResults<uint64_t> get_size(
-                const typename SubgroupType::KeyType& key,
-                const persistent::version_t& version,
+        derecho::rpc::QueryResults<std::vector<typename SubgroupType::ObjectType>> get_many_by_time(
+                const std::vector<typename SubgroupType::KeyType>& keys,
+                const uint64_t& ts_us,
                 const bool stable = true,
                 uint32_t subgroup_index = 0,
                 uint32_t shard_index = 0);
 
         /**
-         * "type_recursive_get_size" is a helper function for internal use only.
+         * "type_recursive_get_many_by_time" is a helper function for internal use only.
          * @param type_index        the index of the subgroup type in the CascadeTypes... list. and the FirstType,
          *                          SecondType, .../ RestTypes should be in the same order.
-         * @param key               the key
-         * @param version           version
-         * @param stable            stable get size or not
+         * @param keys              the keys
+         * @param ts_us             Wall clock time in microseconds.
+         * @param stable            stable get or not
          * @param subgroup_index    the subgroup index in the subgroup type designated by type_index
          * @param shard_index       the shard index
          *
-         * @return a future for the object.
+         * @return a future for the objects.
          */
     protected:
         template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size(
+        auto type_recursive_get_many_by_time(
                 uint32_t type_index,
-                const KeyType& key,
-                const persistent::version_t& version,
+                const std::vector<KeyType>& keys,
+                const uint64_t& ts_us,
                 const bool stable,
                 uint32_t subgroup_index,
                 uint32_t shard_index);
 
         template <typename KeyType, typename LastType>
-        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size(
+        auto type_recursive_get_many_by_time(
                 uint32_t type_index,
-                const KeyType& key,
-                const persistent::version_t& version,
+                const std::vector<KeyType>& keys,
+                const uint64_t& ts_us,
                 const bool stable,
                 uint32_t subgroup_index,
                 uint32_t shard_index);
-
     public:
+
         /**
          * object pool version
+         * The keys are grouped by shard, and each shard receives its group in one request. The requests are sent
+         * before waiting for any of them.
+         *
+         * @param keys      the object keys, in any object pools.
+         *
+         * @return the objects, in the order of the keys.
          */
         template <typename KeyType>
-        derecho::rpc::QueryResults<uint64_t> get_size(
-                const KeyType& key,
-                const persistent::version_t& version,
+        auto get_many_by_time(
+                const std::vector<KeyType>& keys,
+                const uint64_t& ts_us,
                 const bool stable = true);
 
         /**
-         * "multi_get_size" retrieve size of the object of a given key
+         * "get_size_many" retrieve the sizes of the objects of a list of keys in a given subgroup/shard with one request.
+         * The shard reads all of the keys from one snapshot of its state.
          *
-         * @param key               the object key
+         * @param keys              the object keys
+         * @param version           if version is CURRENT_VERSION, the latest state of the keys is read. Otherwise, the
+         *                          keys' state at version is read.
+         * @param stable            stable get or not
          * @param subugroup_index   the subgroup index of CascadeType
          * @param shard_index       the shard index.
          *
-         * @return a future to the retrieved size.
+         * @return a future to the sizes, in the order of the keys.
          */
         template <typename SubgroupType>
-        derecho::rpc::QueryResults<uint64_t> multi_get_size(
-                const typename SubgroupType::KeyType& key,
-                uint32_t subgroup_index, uint32_t shard_index);
+        derecho::rpc::QueryResults<std::vector<uint64_t>> get_size_many(
+                const std::vector<typename SubgroupType::KeyType>& keys,
+                const persistent::version_t& version,
+                const bool stable = true,
+                uint32_t subgroup_index = 0,
+                uint32_t shard_index = 0);
 
         /**
-         * "type_recursive_multi_get_size" is a helper function for internal use only.
+         * "type_recursive_get_size_many" is a helper function for internal use only.
          * @param type_index        the index of the subgroup type in the CascadeTypes... list. and the FirstType,
          *                          SecondType, .../ RestTypes should be in the same order.
-         * @param key               the key
+         * @param keys              the keys
+         * @param version           if version is CURRENT_VERSION, the latest state of the keys is read. Otherwise, the
+         *                          keys' state at version is read.
+         * @param stable            stable get or not
          * @param subgroup_index    the subgroup index in the subgroup type designated by type_index
          * @param shard_index       the shard index
          *
-         * @return a future for the object.
+         * @return a future for the sizes.
          */
     protected:
         template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-        derecho::rpc::QueryResults<uint64_t> type_recursive_multi_get_size(
+        auto type_recursive_get_size_many(
                 uint32_t type_index,
-                const KeyType& key,
+                const std::vector<KeyType>& keys,
+                const persistent::version_t& version,
+                const bool stable,
                 uint32_t subgroup_index,
                 uint32_t shard_index);
 
         template <typename KeyType, typename LastType>
-        derecho::rpc::QueryResults<uint64_t> type_recursive_multi_get_size(
+        auto type_recursive_get_size_many(
                 uint32_t type_index,
-                const KeyType& key,
+                const std::vector<KeyType>& keys,
+                const persistent::version_t& version,
+                const bool stable,
                 uint32_t subgroup_index,
                 uint32_t shard_index);
-
     public:
+
         /**
          * object pool version
+         * The keys are grouped by shard, and each shard receives its group in one request. The requests are sent
+         * before waiting for any of them.
+         *
+         * @param keys      the object keys, in any object pools.
+         *
+         * @return the sizes, in the order of the keys.
          */
         template <typename KeyType>
-        derecho::rpc::QueryResults<uint64_t> multi_get_size(const KeyType& key);
+        std::vector<uint64_t> get_size_many(
+                const std::vector<KeyType>& keys,
+                const persistent::version_t& version = CURRENT_VERSION,
+                const bool stable = true);
 
         /**
-         * "get_size_by_time" retrieve size of the object of a given key
+         * "get_size_many_by_time" retrieve the sizes of the objects of a list of keys in a given subgroup/shard with one request.
+         * The shard reads all of the keys from one snapshot of its state.
          *
-         * @param key               the object key
+         * @param keys              the object keys
          * @param ts_us             Wall clock time in microseconds.
          * @param stable            stable get or not
          * @param subugroup_index   the subgroup index of CascadeType
          * @param shard_index       the shard index.
          *
-         * @return a future to the retrieved size.
-         * TODO: check if the user application is responsible for reclaim the future by reading it sometime.
+         * @return a future to the sizes, in the order of the keys.
          */
         template <typename SubgroupType>
-        derecho::rpc::QueryResults<uint64_t> get_size_by_time(
-                const typename SubgroupType::KeyType& key,
+        derecho::rpc::QueryResults<std::vector<uint64_t>> get_size_many_by_time(
+                const std::vector<typename SubgroupType::KeyType>& keys,
                 const uint64_t& ts_us,
                 const bool stable = true,
                 uint32_t subgroup_index = 0,
                 uint32_t shard_index = 0);
 
         /**
-         * "type_recursive_get_size" is a helper function for internal use only.
+         * "type_recursive_get_size_many_by_time" is a helper function for internal use only.
          * @param type_index        the index of the subgroup type in the CascadeTypes... list. and the FirstType,
          *                          SecondType, .../ RestTypes should be in the same order.
-         * @param key               the key
+         * @param keys              the keys
          * @param ts_us             Wall clock time in microseconds.
          * @param stable            stable get or not
          * @param subgroup_index    the subgroup index in the subgroup type designated by type_index
          * @param shard_index       the shard index
          *
-         * @return a future for the object.
+         * @return a future for the sizes.
          */
     protected:
         template <typename KeyType, typename FirstType, typename SecondType, typename... RestTypes>
-        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size_by_time(
+        auto type_recursive_get_size_many_by_time(
                 uint32_t type_index,
-                const KeyType& key,
+                const std::vector<KeyType>& keys,
                 const uint64_t& ts_us,
                 const bool stable,
                 uint32_t subgroup_index,
                 uint32_t shard_index);
 
         template <typename KeyType, typename LastType>
-        derecho::rpc::QueryResults<uint64_t> type_recursive_get_size_by_time(
+        auto type_recursive_get_size_many_by_time(
                 uint32_t type_index,
-                const KeyType& key,
+                const std::vector<KeyType>& keys,
                 const uint64_t& ts_us,
                 const bool stable,
                 uint32_t subgroup_index,
@@ -1111,13 +2031,45 @@ namespace cascade {
 
         /**
          * object pool version
+         * The keys are grouped by shard, and each shard receives its group in one request. The requests are sent
+         * before waiting for any of them.
+         *
+         * @param keys      the object keys, in any object pools.
+         *
+         * @return the sizes, in the order of the keys.
          */
         template <typename KeyType>
-        derecho::rpc::QueryResults<uint64_t> get_size_by_time(
-                const KeyType& key,
+        std::vector<uint64_t> get_size_many_by_time(
+                const std::vector<KeyType>& keys,
                 const uint64_t& ts_us,
                 const bool stable = true);
 
+    protected:
+        /**
+         * "group_keys_by_shard" is a helper function for internal use only.
+         * @param keys              the object keys
+         *
+         * @return the keys of each shard, keyed by (subgroup type index, subgroup index, shard index), with the
+         *         positions of the keys in the input.
+         */
+        template <typename KeyType>
+        std::map<std::tuple<uint32_t,uint32_t,uint32_t>,std::pair<std::vector<KeyType>,std::vector<std::size_t>>>
+        group_keys_by_shard(const std::vector<KeyType>& keys);
+
+        /**
+         * "scatter_replies" is a helper function for internal use only. It waits for the replies of the shards, and
+         * puts them back in the order of the keys.
+         * @param results           the future of each shard, with the positions of its keys.
+         * @param num_keys          the number of keys.
+         *
+         * @return the replies, in the order of the keys.
+         */
+        template <typename ReplyType>
+        static std::vector<ReplyType> scatter_replies(
+                std::vector<std::pair<derecho::rpc::QueryResults<std::vector<ReplyType>>,const std::vector<std::size_t>*>>& results,
+                std::size_t num_keys);
+    public:
+
         /**
          * "list_keys" retrieve the list of keys in a shard
          *
@@ -1243,6 +2195,137 @@ namespace cascade {
          */
         void refresh_object_pool_metadata_cache();
 
+    protected:
+        /**
+         * Subscribe to the object pool metadata changes, load the object pool metadata cache, and start the
+         * 'metadata_sync_thread'. It is called once, by the constructor of an external client.
+         *
+         * The metadata service shards push each metadata change to the subscribed external clients through the
+         * notification channel, and the client applies it to its object pool metadata cache, instead of reloading the
+         * whole cache when a lookup misses.
+         */
+        void subscribe_object_pool_metadata_changes();
+
+        /**
+         * Renew the subscription to the metadata changes of each metadata service shard, or move it to another member
+         * of the shard if its member has left the shard or stopped answering, see 'metadata_subscription_members'.
+         */
+        void renew_object_pool_metadata_subscriptions();
+
+        /**
+         * Send a subscription, or a renewal, to a metadata service shard member.
+         *
+         * @param  shard_index      The metadata service shard.
+         * @param  node_id          The member, or INVALID_NODE_ID to pick a member other than 'failed_node_id'.
+         * @param  failed_node_id   The member that lost the subscription, if any.
+         *
+         * @return the member that has the subscription, or INVALID_NODE_ID if no member could be reached.
+         */
+        node_id_t send_object_pool_metadata_subscription(const uint32_t shard_index,
+                                                         const node_id_t node_id,
+                                                         const node_id_t failed_node_id);
+
+        /**
+         * The loop of 'metadata_sync_thread'.
+         */
+        void metadata_sync_worker();
+
+        /**
+         * Apply a metadata change event, or a heartbeat, to the object pool metadata cache.
+         *
+         * @param  event            The event, see MetadataChangePublisher.
+         */
+        void apply_object_pool_metadata_change(const Blob& event);
+
+    public:
+        /**
+         * Object Pool Management API: set the read cache policy of an object pool
+         *
+         * The objects read by the object pool version of get() are kept on the client, up to max_bytes per object
+         * pool, and a read that hits is served without a request. A read at a given version is cached if it is stable,
+         * because that object never changes. A read at the current version is cached only by an external client,
+         * which subscribes to the changes of the keys in the object pool from its shards, and drops a key from the
+         * cache when it changes. If a subscription is lost, all cached objects of the object pool are dropped. A read
+         * that misses waits for its reply before get() returns, so that the reply can be cached.
+         *
+         * @param object_pool_pathname  The object pool
+         * @param enable                true to enable the cache, false to disable it and drop the cached objects.
+         * @param max_bytes             The bound of the cached objects of the object pool, in bytes.
+         */
+        void set_read_cache_policy(const std::string& object_pool_pathname,
+                                   bool enable,
+                                   std::size_t max_bytes = READ_CACHE_DEFAULT_MAX_BYTES);
+
+        /**
+         * Get the counters of the read cache.
+         *
+         * @return the counters of the read cache.
+         */
+        ReadCache::Stats get_read_cache_stats() const;
+
+    protected:
+        /**
+         * Subscribe to the changes of the keys in an object pool from all shards of its subgroup, or renew the
+         * subscriptions, see 'cache_subscriptions'. The object pool must be in 'cache_subscriptions'.
+         *
+         * @tparam SubgroupType         The Subgroup Type
+         * @param object_pool_pathname  The object pool
+         * @param subgroup_index        The subgroup index of the object pool
+         */
+        template <typename SubgroupType>
+        void subscribe_cache_invalidations(const std::string& object_pool_pathname, const uint32_t subgroup_index);
+
+        /**
+         * Send an invalidation subscription, or a renewal, to a shard member.
+         *
+         * @tparam SubgroupType         The Subgroup Type
+         * @param subscription          The subscription object
+         * @param subgroup_index        The subgroup index of the object pool
+         * @param shard_index           The shard
+         * @param node_id               The member, or INVALID_NODE_ID to pick a member other than 'failed_node_id'.
+         * @param failed_node_id        The member that lost the subscription, if any.
+         *
+         * @return the member that has the subscription, or INVALID_NODE_ID if no member could be reached.
+         */
+        template <typename SubgroupType>
+        node_id_t send_cache_invalidation_subscription(const typename SubgroupType::ObjectType& subscription,
+                                                       const uint32_t subgroup_index,
+                                                       const uint32_t shard_index,
+                                                       const node_id_t node_id,
+                                                       const node_id_t failed_node_id);
+
+        /**
+         * Renew the invalidation subscriptions of all object pools in 'cache_subscriptions'.
+         */
+        void renew_cache_invalidation_subscriptions();
+        template <typename FirstType, typename SecondType, typename... RestTypes>
+        void type_recursive_subscribe_cache_invalidations(
+                uint32_t type_index,
+                const std::string& object_pool_pathname,
+                const uint32_t subgroup_index);
+        template <typename LastType>
+        void type_recursive_subscribe_cache_invalidations(
+                uint32_t type_index,
+                const std::string& object_pool_pathname,
+                const uint32_t subgroup_index);
+
+        /**
+         * Apply a cache invalidation, or a heartbeat, to the read cache.
+         *
+         * @param  event            The invalidation, see CacheInvalidationPublisher.
+         */
+        void apply_cache_invalidation(const Blob& event);
+
+        /**
+         * Drop the cached objects of a key written by this client, so that the client reads its own writes.
+         *
+         * @param  object_pool_pathname The cached object pool of the key, see key_to_shard(), or an empty string.
+         * @param  key                  The key
+         */
+        void invalidate_cached_key(const std::string& object_pool_pathname, const std::string& key);
+
+    public:
+
         /**
          * Object Pool Management API: create object pool
          *
@@ -1251,13 +2334,18 @@ namespace cascade {
          * @param  subgroup_index   Index of the subgroup
          * @param  sharding_policy  The default sharding policy for this object pool
          * @param  object_locations The set of special object locations.
+         * @param  split_points     The split keys of the RANGE sharding policy, in strictly ascending order. Shard i
+         *                          holds the keys in [split_points[i-1],split_points[i]).
+         * @param  bucket_to_shard  The shard of each virtual bucket of the VIRTUAL sharding policy. If it is empty,
+         *                          OBJECT_POOL_DEFAULT_NUM_BUCKETS buckets are spread over the shards evenly.
          *
          * @return a future to the version and timestamp of the put operation.
          */
         template <typename SubgroupType>
         derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> create_object_pool(
                 const std::string& pathname, const uint32_t subgroup_index,
-                const sharding_policy_t sharding_policy = HASH, const std::unordered_map<std::string,uint32_t>& object_locations = {});
+                const sharding_policy_t sharding_policy = HASH, const std::unordered_map<std::string,uint32_t>& object_locations = {},
+                const std::vector<std::string>& split_points = {}, const std::vector<uint32_t>& bucket_to_shard = {});
 
         /**
          * ObjectPoolManagement API: remote object pool
@@ -1277,6 +2365,18 @@ namespace cascade {
          */
         ObjectPoolMetadata<CascadeTypes...> find_object_pool(const std::string& pathname);
 
+        /**
+         * ObjectPoolManagement API: find object pool without copying its metadata
+         *
+         * The object pool is the one whose pathname is the longest prefix of 'pathname'. Unknown pathnames are
+         * cached negatively for a short time, so looking them up again does not reload the metadata.
+         *
+         * @param  pathname         Object pool pathname, or the pathname of a folder in the object pool.
+         *
+         * @return a handle to the shared, immutable object pool metadata, or nullptr if there is no such object pool.
+         */
+        std::shared_ptr<const ObjectPoolMetadata<CascadeTypes...>> resolve_object_pool(const std::string_view& pathname);
+
         /**
          * ObjectPoolManagement API: list all the object pools by pathnames
          *
@@ -1286,6 +2386,106 @@ namespace cascade {
          */
         std::vector<std::string> list_object_pools(bool refresh = false);
 
+        /**
+         * ObjectPoolManagement API: pin keys of an object pool to specific shards, or unpin them
+         *
+         * Only the change set is given; it is merged into the current placement map of the object pool. The update is
+         * conditioned on the metadata version it is based on, so it is rejected with INVALID_VERSION if the metadata
+         * has changed concurrently, in which case the caller can retry.
+         *
+         * @param  pathname         Object pool pathname
+         * @param  updates          The keys to pin, or to move, with their new shard indexes.
+         * @param  removals         The keys to unpin.
+         *
+         * @return a future to the version and timestamp of the put operation.
+         */
+        derecho::rpc::QueryResults<std::tuple<persistent::version_t,uint64_t>> update_object_locations(
+                const std::string& pathname,
+                const std::unordered_map<std::string,uint32_t>& updates,
+                const std::vector<std::string>& removals = {});
+
+        /**
+         * ObjectPoolManagement API: rebalance an object pool with the VIRTUAL sharding policy
+         *
+         * The migration runs in the background while the object pool stays online:
+         * 1) the objects in the moved buckets are copied from their current shards to the new ones;
+         * 2) the new bucket_to_shard table is put to the metadata service, conditioned on the metadata version read
+         *    at the start, so the cutover is atomic and fails if the metadata has changed meanwhile;
+         * 3) the old shards are fenced: the stores do not know the buckets, so they cannot reject the writes of a
+         *    client which still uses the old table. The migration only waits for OBJECT_POOL_REBALANCE_FENCE_MS, in
+         *    which the clients learn the new table, before it touches the objects left on the old shards. A write to
+         *    an old shard during the hand-off is copied in the next round, but a client which learns the new table
+         *    after the hand-off may still leave a write on an old shard, where it is not found;
+         * 4) the objects updated on the old shards since they were copied are copied again, and each moved object is
+         *    removed from its old shard with a transaction conditioned on the copied version, so that an update that
+         *    races with the removal is copied in the next round instead of being lost.
+         * A copy is a transaction conditioned on the version of the key on the new shard: it is written only if the
+         * key is absent there, or still holds an older copy, so a copy never overwrites a value that a client has
+         * written to the new shard after the cutover.
+         *
+         * @param  pathname         Object pool pathname
+         * @param  bucket_to_shard  The new shard of each bucket. It must have as many buckets as the object pool.
+         *
+         * @return a future to the result of the migration: true if the new table is in effect and all moved objects
+         *         have been handed off. It is false if the cutover failed because the metadata has changed, or if the
+         *         hand-off did not converge: the new table is in effect then, but some objects kept changing on their
+         *         old shards for OBJECT_POOL_REBALANCE_MAX_HANDOFF_ROUNDS rounds and are left there. Invalid arguments
+         *         are reported with an exception.
+         */
+        std::future<bool> rebalance_object_pool(const std::string& pathname, const std::vector<uint32_t>& bucket_to_shard);
+
+    protected:
+        /**
+         * An object moved by a rebalance: its version on the old shard when it was copied, or removed, and the version
+         * of the copy on the new shard.
+         */
+        struct MovedObject {
+            persistent::version_t source_version;
+            persistent::version_t target_version;
+            bool handed_off; // removed from the old shard.
+        };
+        #define OBJECT_POOL_REBALANCE_FENCE_MS          (2000)
+        #define OBJECT_POOL_REBALANCE_MAX_HANDOFF_ROUNDS (16)
+        /**
+         * Copy the objects of an object pool in the given buckets from their current shards to the new ones. A copy is
+         * conditioned on the version of the key on the new shard, see rebalance_object_pool().
+         *
+         * @param  opm              The object pool metadata, with the current bucket_to_shard table.
+         * @param  bucket_to_shard  The new bucket_to_shard table.
+         * @param  cutover_ts_us    The timestamp of the cutover, or 0 before the cutover. Before it, the clients do not
+         *                          write the moved keys on the new shards, so any value there is older.
+         * @param  moved_objects    The moved objects, by key. Objects at the same version are not copied again.
+         *
+         * @return the number of copies that raced with an update on the new shard, to be tried again.
+         */
+        template <typename SubgroupType>
+        std::size_t copy_moved_buckets(const ObjectPoolMetadata<CascadeTypes...>& opm,
+                                const std::vector<uint32_t>& bucket_to_shard,
+                                const uint64_t cutover_ts_us,
+                                std::unordered_map<std::string,MovedObject>& moved_objects);
+        /**
+         * Remove the copied objects from their old shards, each with a transaction conditioned on the copied version.
+         *
+         * @return the number of objects that changed on their old shards since they were copied.
+         */
+        template <typename SubgroupType>
+        std::size_t hand_off_moved_objects(const ObjectPoolMetadata<CascadeTypes...>& opm,
+                                           std::unordered_map<std::string,MovedObject>& moved_objects);
+        template <typename SubgroupType>
+        bool __rebalance_object_pool(const ObjectPoolMetadata<CascadeTypes...>& opm, const std::vector<uint32_t>& bucket_to_shard);
+        template <typename FirstType,typename SecondType, typename...RestTypes>
+        bool type_recursive_rebalance_object_pool(
+                uint32_t type_index,
+                const ObjectPoolMetadata<CascadeTypes...>& opm,
+                const std::vector<uint32_t>& bucket_to_shard);
+        template <typename LastType>
+        bool type_recursive_rebalance_object_pool(
+                uint32_t type_index,
+                const ObjectPoolMetadata<CascadeTypes...>& opm,
+                const std::vector<uint32_t>& bucket_to_shard);
+
+    public:
+
         /**
          * Register an notification handler to a subgroup. If such a handler has been registered, it will be replaced
          * by the new one.
@@ -1302,6 +2502,18 @@ namespace cascade {
                 const uint32_t subgroup_index = 0);
 
     protected:
+        /**
+         * Get the notification handler of a subgroup, which is created and registered to the subgroup caller on
+         * first use. The caller must hold notification_handler_registry_mutex.
+         *
+         * @tparam SubgroupType     The Subgroup Type
+         * @param subgroup_index    Index of the subgroup
+         *
+         * @return the notification handler of the subgroup.
+         */
+        template <typename SubgroupType>
+        SubgroupNotificationHandler<SubgroupType>& get_subgroup_notification_handler(const uint32_t subgroup_index);
+
         template <typename SubgroupType>
         bool register_notification_handler(
                 const cascade_notification_handler_t& handler,
@@ -1347,12 +2559,47 @@ namespace cascade {
         void notify(const Blob& msg,
                 const uint32_t subgroup_index,
                 const node_id_t client_id) const;
-    protected:
+
+        /**
+         * Send a notification message of an object pool to an external client.
+         *
+         * @tparam SubgroupType         The Subgroup Type
+         * @param msg                   The message to send
+         * @param object_pool_pathname  In which object_pool the notification is in.
+         * @param subgroup_index        The subgroup index
+         * @param client_id             The node id of the external client to be notified
+         */
         template <typename SubgroupType>
         void notify(const Blob& msg,
                 const std::string& object_pool_pathname,
                 const uint32_t subgroup_index,
                 const node_id_t client_id) const;
+
+        /**
+         * Send a cache invalidation message to an external client. It is passed to the client's read cache, instead
+         * of the notification handlers, see CacheInvalidationPublisher.
+         *
+         * @tparam SubgroupType         The Subgroup Type
+         * @param msg                   The invalidation
+         * @param object_pool_pathname  The object pool of the invalidated key
+         * @param subgroup_index        The subgroup index
+         * @param client_id             The node id of the external client to be notified
+         */
+        template <typename SubgroupType>
+        void notify_cache_invalidation(const Blob& msg,
+                const std::string& object_pool_pathname,
+                const uint32_t subgroup_index,
+                const node_id_t client_id) const;
+    protected:
+        /**
+         * Send a notification message of a given type to an external client.
+         */
+        template <typename SubgroupType>
+        void send_notification(const uint64_t message_type,
+                const Blob& msg,
+                const std::string& object_pool_pathname,
+                const uint32_t subgroup_index,
+                const node_id_t client_id) const;
         template <typename FirstType, typename SecondType, typename... RestTypes>
         void type_recursive_notify(
                 uint32_t type_index,
@@ -1708,4 +2955,97 @@ namespace cascade {
 } // cascade
 } // derecho
 
+namespace derecho {
+namespace cascade {
+    /**
+     * MetadataChangePublisher is the critical data path observer of the metadata service. It pushes every change to
+     * the object pool metadata to the subscribed external clients, as a notification message on the metadata service
+     * subgroup.
+     *
+     * A client subscribes with a trigger_put of an object pool metadata with an empty pathname to a metadata service
+     * shard member, which records the client. Only that member pushes the changes of its shard to the client. The
+     * notification body is the serialized pathname followed by the serialized metadata of the change, which is null
+     * for a removal. The metadata carries its version and the previous version of the shard, so the client can tell
+     * if it has missed an event.
+     *
+     * The client renews its subscription periodically, and the member answers each subscription with a heartbeat: an
+     * empty pathname followed by the serialized shard index and the version of the latest change it has pushed. The
+     * version is recorded after the change is pushed, so a heartbeat never runs ahead of the changes.
+     *
+     * A client that cannot be notified is dropped; it subscribes again when its heartbeats stop.
+     *
+     * The changes and the heartbeats are sent by a NotificationSender, off the delivery thread, in the order of the
+     * events.
+     */
+    template <typename... CascadeTypes>
+    class MetadataChangePublisher : public CriticalDataPathObserver<CascadeMetadataService<CascadeTypes...>> {
+    private:
+        std::unordered_set<node_id_t> subscribers;
+        // the version of the latest change pushed, by shard.
+        std::unordered_map<uint32_t,persistent::version_t> shard_versions;
+        mutable std::mutex subscribers_mutex;
+        // declared last, so that its thread is stopped before the members it uses are destroyed.
+        NotificationSender sender;
+
+    public:
+        virtual void operator()(const uint32_t subgroup_idx,
+                                const uint32_t shard_idx,
+                                const node_id_t sender_id,
+                                const std::string& key,
+                                const ObjectPoolMetadata<CascadeTypes...>& value,
+                                ICascadeContext* cascade_ctxt,
+                                bool is_trigger = false) override;
+    };
+
+    /**
+     * CacheInvalidationPublisher is the critical data path observer of a store subgroup, which pushes the changes of
+     * the keys to the external clients caching them (see ServiceClient::set_read_cache_policy()), and passes all
+     * other events to the next observer.
+     *
+     * A client subscribes to an object pool with a trigger_put of a null object, whose key is the object pool pathname
+     * followed by PATH_SEPARATOR, to a shard member, which records the client. Only that member pushes the changes of
+     * its shard to the client, as cache invalidation messages. The message body is the serialized object pool
+     * pathname, key, version of the change, and shard index. A client that cannot be notified is dropped.
+     *
+     * As with the MetadataChangePublisher, the client renews its subscription periodically, and each subscription is
+     * answered with a heartbeat: an invalidation message with an empty key, and the version of the latest change to
+     * the object pool in the shard. A heartbeat ahead of the changes a client has received tells it that it was
+     * dropped and missed some of them. The invalidations and the heartbeats are sent by a NotificationSender, off the
+     * delivery thread, in the order of the events.
+     *
+     * @tparam SubgroupType     The store subgroup type, whose keys must be strings.
+     * @tparam CascadeTypes     The subgroup types of the service.
+     */
+    template <typename SubgroupType, typename... CascadeTypes>
+    class CacheInvalidationPublisher : public CriticalDataPathObserver<SubgroupType> {
+    private:
+        CriticalDataPathObserver<SubgroupType>* next_observer;
+        /* the subscribed clients of each object pool. */
+        std::unordered_map<std::string,std::unordered_set<node_id_t>> subscribers;
+        /* the version of the latest change to each subscribed object pool, which the heartbeats report. */
+        std::unordered_map<std::string,persistent::version_t> pool_versions;
+        std::atomic<bool> has_subscribers;
+        mutable std::mutex subscribers_mutex;
+        /* declared last, so that its thread is stopped before the members it uses are destroyed. */
+        NotificationSender sender;
+
+    public:
+        /**
+         * Constructor
+         *
+         * @param _next_observer    The observer of the other events, or nullptr.
+         */
+        CacheInvalidationPublisher(CriticalDataPathObserver<SubgroupType>* _next_observer = nullptr);
+
+        virtual void operator()(const uint32_t subgroup_idx,
+                                const uint32_t shard_idx,
+                                const node_id_t sender_id,
+                                const typename SubgroupType::KeyType& key,
+                                const typename SubgroupType::ObjectType& value,
+                                ICascadeContext* cascade_ctxt,
+                                bool is_trigger = false) override;
+    };
+} // cascade
+} // derecho
+
 #include "detail/service_impl.hpp"
@@ -38,6 +38,9 @@ public:
                                              P2P_TARGETS(
                                                      put,
                                                      put_and_forget,
+                                                     put_and_forget_batch,
+                                                     put_batch,
+                                                     transact,
 #ifdef ENABLE_EVALUATION
                                                      perf_put,
 #endif
@@ -45,13 +48,18 @@ public:
                                                      get,
                                                      multi_get,
                                                      get_by_time,
+                                                     get_many,
+                                                     get_many_by_time,
                                                      multi_list_keys,
                                                      list_keys,
                                                      list_keys_by_time,
                                                      multi_get_size,
                                                      get_size,
                                                      get_size_by_time,
-                                                     trigger_put
+                                                     get_size_many,
+                                                     get_size_many_by_time,
+                                                     trigger_put,
+                                                     trigger_put_batch
 #ifdef ENABLE_EVALUATION
                                                      ,
                                                      dump_timestamp_log
@@ -64,6 +72,8 @@ public:
                                              ORDERED_TARGETS(
                                                      ordered_put,
                                                      ordered_put_and_forget,
+                                                     ordered_put_batch,
+                                                     ordered_transact,
                                                      ordered_remove,
                                                      ordered_get,
                                                      ordered_list_keys,
@@ -80,8 +90,13 @@ public:
 #endif
 #endif  // ENABLE_EVALUATION
     virtual void trigger_put(const VT& value) const override;
+    virtual void trigger_put_batch(const std::vector<VT>& values) const override;
     virtual std::tuple<persistent::version_t, uint64_t> put(const VT& value) const override;
     virtual void put_and_forget(const VT& value) const override;
+    virtual void put_and_forget_batch(const std::vector<VT>& values) const override;
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> put_batch(const std::vector<VT>& values) const override;
+    virtual std::tuple<persistent::version_t, uint64_t> transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                 const std::vector<VT>& write_set) const override;
 #ifdef ENABLE_EVALUATION
     virtual double perf_put(const uint32_t max_payload_size, const uint64_t duration_sec) const override;
 #endif  // ENABLE_EVALUATION
@@ -89,14 +104,21 @@ public:
     virtual const VT get(const KT& key, const persistent::version_t& ver, const bool stable, bool exact = false) const override;
     virtual const VT multi_get(const KT& key) const override;
     virtual const VT get_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const override;
+    virtual std::vector<VT> get_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const override;
+    virtual std::vector<VT> get_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const override;
     virtual std::vector<KT> multi_list_keys(const std::string& prefix) const override;
     virtual std::vector<KT> list_keys(const std::string& prefix, const persistent::version_t& ver, const bool stable) const override;
     virtual std::vector<KT> list_keys_by_time(const std::string& prefix, const uint64_t& ts_us, const bool stable) const override;
     virtual uint64_t multi_get_size(const KT& key) const override;
     virtual uint64_t get_size(const KT& key, const persistent::version_t& ver, const bool stable, bool exact = false) const override;
     virtual uint64_t get_size_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const override;
+    virtual std::vector<uint64_t> get_size_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const override;
+    virtual std::vector<uint64_t> get_size_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const override;
     virtual std::tuple<persistent::version_t, uint64_t> ordered_put(const VT& value) override;
     virtual void ordered_put_and_forget(const VT& value) override;
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> ordered_put_batch(const std::vector<VT>& values) override;
+    virtual std::tuple<persistent::version_t, uint64_t> ordered_transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                         const std::vector<VT>& write_set) override;
     virtual std::tuple<persistent::version_t, uint64_t> ordered_remove(const KT& key) override;
     virtual const VT ordered_get(const KT& key) override;
     virtual std::vector<KT> ordered_list_keys(const std::string& prefix) override;
@@ -2,6 +2,8 @@
 
 #include "cascade/config.h"
 #include "cascade_interface.hpp"
+#include "detail/key_path_trie.hpp"
+#include "detail/kv_hash_index.hpp"
 
 #include <derecho/core/derecho.hpp>
 #include <derecho/mutils-serialization/SerializationSupport.hpp>
@@ -25,13 +27,42 @@ class VolatileCascadeStore : public ICascadeStore<KT, VT, IK, IV>,
                              public derecho::GroupReference,
                              public derecho::NotificationSupport {
 private:
-    bool internal_ordered_put(const VT& value);
+    /**
+     * Apply an ordered put.
+     *
+     * @param value     - the value
+     * @param prev_ver  - the version of the shard before the ordered message of the put
+     */
+    bool internal_ordered_put(const VT& value, const persistent::version_t& prev_ver);
+    /**
+     * Validate and verify a value to put against the current state, and set its previous versions.
+     *
+     * @return false if the value is rejected.
+     */
+    bool verify_ordered_put(const VT& value, const persistent::version_t& prev_ver);
 #if defined(__i386__) || defined(__x86_64__) || defined(_M_AMD64) || defined(_M_IX86)
     mutable std::atomic<persistent::version_t> lockless_v1;
     mutable std::atomic<persistent::version_t> lockless_v2;
 #else
 #error The lockless reader/writer works only with TSO memory reordering. Please check https://en.wikipedia.org/wiki/Memory_ordering
 #endif
+    /* hash index over kv_map for the point operations, rebuilt by the constructors */
+    KVHashIndex<KT, VT> kv_index;
+    /* path trie over the keys in kv_map for list_keys, rebuilt by the constructors */
+    KeyPathTrie<KT> key_trie;
+    /**
+     * Replace or insert the object of a key in kv_map, and update the indexes. The replaced object is retired through
+     * the EpochManager. The caller is responsible for the lockless_v1/lockless_v2 update.
+     */
+    void apply_ordered_put(const KT& key, const VT& value);
+    /**
+     * Find the objects of a set of keys in one consistent state of kv_map, retrying while an update overlaps with the
+     * lookups. The caller must hold an EpochManager::Guard while using the objects.
+     *
+     * @param keys      - the keys
+     * @param objects   - the object of each key is returned here, or nullptr if the key is not found.
+     */
+    void lockless_find_many(const std::vector<KT>& keys, std::vector<const VT*>& objects) const;
 public:
     /* group reference */
     using derecho::GroupReference::group;
@@ -48,6 +79,9 @@ public:
                                              P2P_TARGETS(
                                                      put,
                                                      put_and_forget,
+                                                     put_and_forget_batch,
+                                                     put_batch,
+                                                     transact,
 #ifdef ENABLE_EVALUATION
                                                      perf_put,
 #endif
@@ -55,13 +89,18 @@ public:
                                                      get,
                                                      multi_get,
                                                      get_by_time,
+                                                     get_many,
+                                                     get_many_by_time,
                                                      multi_list_keys,
                                                      list_keys,
                                                      list_keys_by_time,
                                                      multi_get_size,
                                                      get_size,
                                                      get_size_by_time,
-                                                     trigger_put
+                                                     get_size_many,
+                                                     get_size_many_by_time,
+                                                     trigger_put,
+                                                     trigger_put_batch
 #ifdef ENABLE_EVALUATION
                                                      ,
                                                      dump_timestamp_log
@@ -74,6 +113,8 @@ public:
                                              ORDERED_TARGETS(
                                                      ordered_put,
                                                      ordered_put_and_forget,
+                                                     ordered_put_batch,
+                                                     ordered_transact,
                                                      ordered_remove,
                                                      ordered_get,
                                                      ordered_list_keys,
@@ -90,23 +131,35 @@ public:
 #endif
 #endif  // ENABLE_EVALUATION
     virtual void trigger_put(const VT& value) const override;
+    virtual void trigger_put_batch(const std::vector<VT>& values) const override;
     virtual std::tuple<persistent::version_t, uint64_t> put(const VT& value) const override;
 #ifdef ENABLE_EVALUATION
     virtual double perf_put(const uint32_t max_payload_size, const uint64_t duration_sec) const override;
 #endif  // ENABLE_EVALUATION
     virtual void put_and_forget(const VT& value) const override;
+    virtual void put_and_forget_batch(const std::vector<VT>& values) const override;
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> put_batch(const std::vector<VT>& values) const override;
+    virtual std::tuple<persistent::version_t, uint64_t> transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                 const std::vector<VT>& write_set) const override;
     virtual std::tuple<persistent::version_t, uint64_t> remove(const KT& key) const override;
     virtual const VT get(const KT& key, const persistent::version_t& ver, const bool stable, bool exact = false) const override;
     virtual const VT multi_get(const KT& key) const override;
     virtual const VT get_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const override;
+    virtual std::vector<VT> get_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const override;
+    virtual std::vector<VT> get_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const override;
     virtual std::vector<KT> multi_list_keys(const std::string& prefix) const override;
     virtual std::vector<KT> list_keys(const std::string& prefix, const persistent::version_t& ver, const bool stable) const override;
     virtual std::vector<KT> list_keys_by_time(const std::string& prefix, const uint64_t& ts_us, const bool stable) const override;
     virtual uint64_t multi_get_size(const KT& key) const override;
     virtual uint64_t get_size(const KT& key, const persistent::version_t& ver, const bool stable, bool exact = false) const override;
     virtual uint64_t get_size_by_time(const KT& key, const uint64_t& ts_us, const bool stable) const override;
+    virtual std::vector<uint64_t> get_size_many(const std::vector<KT>& keys, const persistent::version_t& ver, const bool stable) const override;
+    virtual std::vector<uint64_t> get_size_many_by_time(const std::vector<KT>& keys, const uint64_t& ts_us, const bool stable) const override;
     virtual std::tuple<persistent::version_t, uint64_t> ordered_put(const VT& value) override;
     virtual void ordered_put_and_forget(const VT& value) override;
+    virtual std::vector<std::tuple<persistent::version_t, uint64_t>> ordered_put_batch(const std::vector<VT>& values) override;
+    virtual std::tuple<persistent::version_t, uint64_t> ordered_transact(const std::vector<std::tuple<KT, persistent::version_t>>& read_set,
+                                                                         const std::vector<VT>& write_set) override;
     virtual std::tuple<persistent::version_t, uint64_t> ordered_remove(const KT& key) override;
     virtual const VT ordered_get(const KT& key) override;
     virtual std::vector<KT> ordered_list_keys(const std::string& prefix) override;
@@ -0,0 +1,107 @@
+#include <cascade/detail/async_pipeline.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <typeindex>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+using derecho::rpc::PendingResults;
+using derecho::rpc::QueryResults;
+
+using ResultsType = QueryResults<int>;
+
+static const AsyncPipeline::shard_key_t fast_shard{std::type_index(typeid(int)),0,0};
+static const AsyncPipeline::shard_key_t slow_shard{std::type_index(typeid(int)),0,1};
+
+/* an operation to a shard member, whose reply the test sets. */
+static std::shared_ptr<PendingResults<int>> operation_to(node_id_t node_id) {
+    auto pending_results = std::make_shared<PendingResults<int>>();
+    pending_results->fulfill_map({node_id});
+    return pending_results;
+}
+
+static std::function<ResultsType()> send(const std::shared_ptr<PendingResults<int>>& pending_results) {
+    return [pending_results]() { return std::move(*pending_results->get_future()); };
+}
+
+/* an operation completes when its replies come, while an operation submitted before it still waits for its reply. */
+static void test_completion_order() {
+    AsyncPipeline pipeline;
+    pipeline.set_config(4,1);
+    std::atomic<int> slow_value{0};
+    std::promise<int> fast_value;
+    auto slow = operation_to(1);
+    auto fast = operation_to(2);
+    pipeline.submit<ResultsType>(slow_shard,send(slow),[&slow_value](ResultsType& results) {
+        slow_value = results.get().begin()->second.get();
+    });
+    pipeline.submit<ResultsType>(fast_shard,send(fast),[&fast_value](ResultsType& results) {
+        fast_value.set_value(results.get().begin()->second.get());
+    });
+    fast->set_value(2,7);
+    auto fast_future = fast_value.get_future();
+    CHECK(fast_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    CHECK(fast_future.get() == 7);
+    CHECK(slow_value == 0);
+    CHECK(pipeline.get_in_flight() >= 1);
+
+    slow->set_value(1,5);
+    pipeline.wait_all();
+    CHECK(slow_value == 5);
+    CHECK(pipeline.get_in_flight() == 0);
+}
+
+/* a full window holds the next operation to its shard back, but not the operations to the other shards. */
+static void test_window() {
+    AsyncPipeline pipeline;
+    pipeline.set_config(1,1);
+    auto first = operation_to(1);
+    auto other = operation_to(2);
+    pipeline.submit<ResultsType>(slow_shard,send(first),nullptr);
+    pipeline.submit<ResultsType>(fast_shard,send(other),nullptr);
+    CHECK(pipeline.get_in_flight() == 2);
+
+    std::atomic<bool> submitted{false};
+    std::thread submitter([&pipeline,&submitted]() {
+        auto second = operation_to(1);
+        second->set_value(1,0);
+        pipeline.submit<ResultsType>(slow_shard,send(second),nullptr);
+        submitted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(!submitted);
+    first->set_value(1,0);
+    submitter.join();
+    CHECK(submitted);
+    other->set_value(2,0);
+    pipeline.wait_all();
+    CHECK(pipeline.get_in_flight() == 0);
+}
+
+/* a failed send gives its slot back. */
+static void test_failed_send() {
+    AsyncPipeline pipeline;
+    pipeline.set_config(1,1);
+    CHECK_THROWS(pipeline.submit<ResultsType>(fast_shard,[]() -> ResultsType {
+        throw derecho::derecho_exception("failed send");
+    },nullptr));
+    CHECK(pipeline.get_in_flight() == 0);
+    auto operation = operation_to(1);
+    operation->set_value(1,0);
+    pipeline.submit<ResultsType>(fast_shard,send(operation),nullptr);
+    pipeline.wait_all();
+    CHECK_THROWS(pipeline.set_config(0,1));
+}
+
+int main(int argc, char** argv) {
+    test_completion_order();
+    test_window();
+    test_failed_send();
+    std::cout << "async_pipeline: all checks passed." << std::endl;
+    return 0;
+}
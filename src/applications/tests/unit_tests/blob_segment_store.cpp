@@ -0,0 +1,122 @@
+#include <cascade/detail/blob_segment_store.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+static std::vector<uint8_t> make_blob(std::size_t len, uint8_t seed) {
+    std::vector<uint8_t> blob(len);
+    for(std::size_t i = 0; i < len; i++) {
+        blob[i] = static_cast<uint8_t>(seed + i);
+    }
+    return blob;
+}
+
+static bool holds(const uint8_t* data, const std::vector<uint8_t>& blob) {
+    return data != nullptr && memcmp(data, blob.data(), blob.size()) == 0;
+}
+
+/* an appended blob resolves to its mapped data, and a blob larger than a segment gets a segment of its own. */
+static void test_append_and_resolve(const std::string& directory) {
+    BlobSegmentStore store(directory, "append", 16, 4096);
+    CHECK(store.get_threshold() == 16);
+    auto small = make_blob(100, 1);
+    auto large = make_blob(10000, 2);
+    BlobSegmentRef small_ref, large_ref;
+    const uint8_t* small_data = store.append(small.data(), small.size(), small_ref);
+    const uint8_t* large_data = store.append(large.data(), large.size(), large_ref);
+    store.sync();
+    CHECK(holds(small_data, small));
+    CHECK(holds(large_data, large));
+    CHECK(small_ref.offset == 0);
+    CHECK(small_ref.length == small.size());
+    CHECK(large_ref.segment_id != small_ref.segment_id);
+    CHECK(BlobSegmentRegistry::get().resolve(small_ref) == small_data);
+    CHECK(BlobSegmentRegistry::get().resolve(large_ref) == large_data);
+
+    // a reference with a wrong checksum, out of range, or to an unknown segment is not resolved.
+    BlobSegmentRef bad_ref = small_ref;
+    bad_ref.checksum++;
+    CHECK(BlobSegmentRegistry::get().resolve(bad_ref) == nullptr);
+    bad_ref = small_ref;
+    bad_ref.offset = 4000;
+    CHECK(BlobSegmentRegistry::get().resolve(bad_ref) == nullptr);
+    bad_ref = small_ref;
+    bad_ref.segment_id ^= 0xffff;
+    CHECK(BlobSegmentRegistry::get().resolve(bad_ref) == nullptr);
+}
+
+/* a reopened store keeps the segments the replayed log refers to, and appends after the last blob it refers to. */
+static void test_resume(const std::string& directory) {
+    auto first = make_blob(100, 3);
+    auto second = make_blob(100, 4);
+    auto third = make_blob(100, 5);
+    BlobSegmentRef first_ref, second_ref, third_ref;
+    {
+        BlobSegmentStore store(directory, "resume", 16, 256);
+        store.append(first.data(), first.size(), first_ref);
+        store.append(second.data(), second.size(), second_ref);
+        store.append(third.data(), third.size(), third_ref);
+        store.sync();
+        CHECK(first_ref.segment_id == second_ref.segment_id);
+        CHECK(third_ref.segment_id != first_ref.segment_id);
+    }
+    CHECK(BlobSegmentRegistry::get().resolve(first_ref) == nullptr);
+
+    BlobSegmentStore store(directory, "resume", 16, 256);
+    // the replayed log only refers to the first blob: the second one was never committed.
+    CHECK(holds(BlobSegmentRegistry::get().resolve(first_ref), first));
+    store.resume();
+    CHECK(BlobSegmentRegistry::get().resolve(third_ref) == nullptr);
+    CHECK(!std::filesystem::exists(directory + "/resume-00000001.blob"));
+    CHECK(std::filesystem::exists(directory + "/resume-00000000.blob"));
+
+    auto fourth = make_blob(100, 6);
+    BlobSegmentRef fourth_ref;
+    const uint8_t* fourth_data = store.append(fourth.data(), fourth.size(), fourth_ref);
+    store.sync();
+    CHECK(fourth_ref.segment_id == first_ref.segment_id);
+    CHECK(fourth_ref.offset == first.size());
+    CHECK(holds(fourth_data, fourth));
+    CHECK(holds(BlobSegmentRegistry::get().resolve(first_ref), first));
+    CHECK(BlobSegmentRegistry::get().resolve(second_ref) == nullptr);
+}
+
+/* the scopes switch how the calling thread serializes and deserializes the blobs, and restore the previous mode. */
+static void test_scopes() {
+    CHECK(!BlobSegmentRegistry::serialize_refs());
+    CHECK(!BlobSegmentRegistry::resolve_refs());
+    {
+        BlobSegmentRegistry::RefScope ref_scope;
+        CHECK(BlobSegmentRegistry::serialize_refs());
+        {
+            BlobSegmentRegistry::RefScope nested_scope;
+            CHECK(BlobSegmentRegistry::serialize_refs());
+        }
+        CHECK(BlobSegmentRegistry::serialize_refs());
+        CHECK(!BlobSegmentRegistry::resolve_refs());
+    }
+    CHECK(!BlobSegmentRegistry::serialize_refs());
+    {
+        BlobSegmentRegistry::ResolveScope resolve_scope;
+        CHECK(BlobSegmentRegistry::resolve_refs());
+    }
+    CHECK(!BlobSegmentRegistry::resolve_refs());
+}
+
+int main(int argc, char** argv) {
+    const std::string directory = (std::filesystem::temp_directory_path()
+                                   / ("blob_segment_store_test." + std::to_string(getpid()))).string();
+    test_append_and_resolve(directory);
+    test_resume(directory);
+    test_scopes();
+    std::filesystem::remove_all(directory);
+    std::cout << "blob_segment_store: all checks passed." << std::endl;
+    return 0;
+}
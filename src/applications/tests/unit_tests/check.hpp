@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * CHECK ends the test with a failure, naming the condition and its location, if the condition does not hold.
+ */
+#define CHECK(cond)                                                                                   \
+    do {                                                                                              \
+        if (!(cond)) {                                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << std::endl;    \
+            std::exit(1);                                                                             \
+        }                                                                                             \
+    } while (0)
+
+/**
+ * CHECK_THROWS ends the test with a failure if the statement does not throw a derecho::derecho_exception.
+ */
+#define CHECK_THROWS(statement)                                                                       \
+    do {                                                                                              \
+        bool thrown = false;                                                                          \
+        try {                                                                                         \
+            statement;                                                                                \
+        } catch (derecho::derecho_exception&) {                                                       \
+            thrown = true;                                                                            \
+        }                                                                                             \
+        CHECK(thrown);                                                                                \
+    } while (0)
@@ -0,0 +1,58 @@
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "store_fixture.hpp"
+
+using namespace derecho::cascade;
+
+/**
+ * A delta as the logs written before batches were introduced hold it: the serialized object alone.
+ */
+static std::vector<uint8_t> baseline_delta(const ObjectWithStringKey& object) {
+    std::vector<uint8_t> delta(mutils::bytes_size(object));
+    mutils::to_bytes(object,delta.data());
+    return delta;
+}
+
+int main(int argc, char** argv) {
+    // a baseline log replays.
+    std::vector<std::vector<uint8_t>> deltas;
+    deltas.push_back(baseline_delta(make_object("/pool/a","a1",1)));
+    deltas.push_back(baseline_delta(make_object("/pool/b","b2",2)));
+    deltas.push_back(baseline_delta(make_object("/pool/a","a3",3)));
+    StoreCore replica;
+    for (const auto& delta : deltas) {
+        CHECK(!DeltaObjects<ObjectWithStringKey>::is_batch(delta.data()));
+        CHECK(DeltaObjects<ObjectWithStringKey>::delta_size(delta.data()) == delta.size());
+        replica.applyDelta(delta.data());
+    }
+    CHECK(data_of(replica.lockless_get("/pool/a")) == "a3");
+    CHECK(replica.lockless_get("/pool/a").get_version() == 3);
+    CHECK(data_of(replica.lockless_get("/pool/b")) == "b2");
+
+    // a single put is still logged in the baseline format, and a batch behind the marker.
+    StoreCore core;
+    std::vector<std::vector<uint8_t>> new_deltas;
+    CHECK(core.ordered_put(make_object("/pool/c","c4",4),persistent::INVALID_VERSION));
+    finalize(core,new_deltas);
+    CHECK(new_deltas.size() == 1);
+    CHECK(!DeltaObjects<ObjectWithStringKey>::is_batch(new_deltas[0].data()));
+    auto logged = mutils::from_bytes<ObjectWithStringKey>(nullptr,new_deltas[0].data());
+    CHECK(mutils::bytes_size(*logged) == new_deltas[0].size());
+    CHECK(data_of(*logged) == "c4");
+    core.ordered_put_batch({make_object("/pool/c","c5",5),make_object("/pool/d","d5",5)},4);
+    finalize(core,new_deltas);
+    CHECK(new_deltas.size() == 2);
+    CHECK(DeltaObjects<ObjectWithStringKey>::is_batch(new_deltas[1].data()));
+    CHECK(DeltaObjects<ObjectWithStringKey>::delta_size(new_deltas[1].data()) == new_deltas[1].size());
+
+    // a log mixing both formats replays.
+    for (const auto& delta : new_deltas) {
+        replica.applyDelta(delta.data());
+    }
+    CHECK(data_of(replica.lockless_get("/pool/a")) == "a3");
+    CHECK(data_of(replica.lockless_get("/pool/c")) == "c5");
+    CHECK(data_of(replica.lockless_get("/pool/d")) == "d5");
+    return 0;
+}
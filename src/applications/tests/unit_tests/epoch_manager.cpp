@@ -0,0 +1,99 @@
+#include <cascade/detail/epoch_manager.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+/* the number of retired objects not destroyed yet. */
+static std::atomic<int> live_objects{0};
+
+struct Tracked {
+    Tracked() {
+        live_objects++;
+    }
+    ~Tracked() {
+        live_objects--;
+    }
+};
+
+static void retire_tracked(size_t bytes = 0) {
+    EpochManager::get().retire(std::make_unique<Tracked>(), bytes);
+}
+
+/* wait until the reclaimer thread has destroyed the objects, or for ten reclaim intervals. */
+static bool wait_for_reclaimer() {
+    for(int i = 0; i < 100 && live_objects > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(EPOCH_RECLAIM_INTERVAL_MS / 10));
+    }
+    return live_objects == 0;
+}
+
+/* a batch is reclaimed when it is full, or when it holds enough bytes. These checks run before the reclaimer thread
+ * first wakes up. */
+static void test_batches() {
+    for(int i = 0; i < EPOCH_RETIRE_BATCH_SIZE - 1; i++) {
+        retire_tracked();
+    }
+    CHECK(live_objects == EPOCH_RETIRE_BATCH_SIZE - 1);
+    retire_tracked();
+    CHECK(live_objects == 0);
+
+    retire_tracked(EPOCH_RETIRE_BATCH_BYTES / 2);
+    CHECK(live_objects == 1);
+    retire_tracked(EPOCH_RETIRE_BATCH_BYTES / 2);
+    CHECK(live_objects == 0);
+    CHECK(EpochManager::get().num_retired_objects() == 0);
+}
+
+/* an object is not destroyed while a reader that might see it is pinned. */
+static void test_pinned_reader() {
+    std::promise<void> pinned, unpin;
+    auto reader = std::async(std::launch::async, [&pinned, &unpin]() {
+        EpochManager::Guard guard;
+        pinned.set_value();
+        unpin.get_future().wait();
+    });
+    pinned.get_future().wait();
+    for(int i = 0; i < EPOCH_RETIRE_BATCH_SIZE; i++) {
+        retire_tracked();
+    }
+    CHECK(EpochManager::get().reclaim() == 0);
+    CHECK(live_objects == EPOCH_RETIRE_BATCH_SIZE);
+    unpin.set_value();
+    reader.get();
+    EpochManager::get().reclaim();
+    CHECK(live_objects == 0);
+}
+
+/* the reclaimer thread destroys the objects of a thread which stopped retiring, and of an exited thread. */
+static void test_quiet_threads() {
+    std::promise<void> retired, stop;
+    auto quiet = std::async(std::launch::async, [&retired, &stop]() {
+        retire_tracked();
+        retired.set_value();
+        stop.get_future().wait();
+    });
+    retired.get_future().wait();
+    CHECK(live_objects == 1);
+    CHECK(wait_for_reclaimer());
+    stop.set_value();
+    quiet.get();
+
+    std::thread([]() { retire_tracked(); }).join();
+    CHECK(wait_for_reclaimer());
+    CHECK(EpochManager::get().num_retired_objects() == 0);
+}
+
+int main(int argc, char** argv) {
+    test_batches();
+    test_pinned_reader();
+    test_quiet_threads();
+    std::cout << "epoch_manager: all checks passed." << std::endl;
+    return 0;
+}
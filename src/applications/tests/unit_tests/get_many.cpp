@@ -0,0 +1,50 @@
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "store_fixture.hpp"
+
+using namespace derecho::cascade;
+
+static void put(StoreCore& core, const std::string& key, const std::string& data, persistent::version_t version) {
+    CHECK(core.ordered_put(make_object(key,data,version),version - 1));
+    core.finalizeCurrentDelta([](uint8_t const* const, std::size_t) {});
+}
+
+int main(int argc, char** argv) {
+    StoreCore core;
+    for (int i = 0; i < 10; i ++) {
+        put(core,"/pool/k" + std::to_string(i),"v" + std::to_string(i),i + 1);
+    }
+
+    // the values come in the order of the keys, a missing key and a repeated one included.
+    const std::vector<std::string> keys{"/pool/k5","/pool/missing","/pool/k1","/pool/k5","/pool/k9"};
+    auto objects = core.lockless_get_many(keys);
+    CHECK(objects.size() == keys.size());
+    CHECK(data_of(objects[0]) == "v5");
+    CHECK(!objects[1].is_valid());
+    CHECK(data_of(objects[2]) == "v1");
+    CHECK(data_of(objects[3]) == "v5");
+    CHECK(data_of(objects[4]) == "v9");
+    for (std::size_t i = 0; i < keys.size(); i ++) {
+        if (objects[i].is_valid()) {
+            CHECK(objects[i].get_key_ref() == keys[i]);
+        }
+    }
+
+    // the sizes come in the same order.
+    auto sizes = core.lockless_get_size_many(keys);
+    CHECK(sizes.size() == keys.size());
+    CHECK(sizes[1] == 0);
+    for (std::size_t i : {0,2,3,4}) {
+        CHECK(sizes[i] == mutils::bytes_size(objects[i]));
+    }
+
+    // a later put is seen by the next get_many, and not by the values already returned.
+    put(core,"/pool/k1","v1-new",11);
+    auto updated = core.lockless_get_many({"/pool/k1"});
+    CHECK(data_of(updated[0]) == "v1-new");
+    CHECK(data_of(objects[2]) == "v1");
+    std::cout << "get_many: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <cascade/detail/hedged_reads.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+using derecho::rpc::PendingResults;
+using derecho::rpc::QueryResults;
+
+/* the results of a request to a member, whose reply the test sets. */
+static std::shared_ptr<PendingResults<int>> request_to(node_id_t node_id) {
+    auto pending_results = std::make_shared<PendingResults<int>>();
+    pending_results->fulfill_map({node_id});
+    return pending_results;
+}
+
+/* the replies reported to the completions, as (member, succeeded) pairs. */
+struct Completions {
+    std::mutex mutex;
+    std::vector<std::pair<node_id_t,bool>> replies;
+
+    HedgedReads::completion_t of(node_id_t node_id) {
+        return [this,node_id](bool succeeded) {
+            std::lock_guard<std::mutex> lck(mutex);
+            replies.emplace_back(node_id,succeeded);
+        };
+    }
+
+    std::vector<std::pair<node_id_t,bool>> get() {
+        std::lock_guard<std::mutex> lck(mutex);
+        return replies;
+    }
+};
+
+static std::unique_ptr<QueryResults<int>> no_hedge(node_id_t&, HedgedReads::completion_t&) {
+    return nullptr;
+}
+
+/* a fast reply wins without a duplicate read, and is reported before the read completes. */
+static void test_fast_primary() {
+    Completions completions;
+    HedgedReads hedged_reads;
+    hedged_reads.set_policy(true,95.0,200);
+    auto primary = request_to(1);
+    auto results = hedged_reads.read<int>(1,std::move(*primary->get_future()),completions.of(1),no_hedge);
+    primary->set_value(1,5);
+    auto& replies = results.get();
+    CHECK(replies.size() == 1);
+    CHECK(replies.begin()->first == 1);
+    CHECK(replies.begin()->second.get() == 5);
+    CHECK((completions.get() == std::vector<std::pair<node_id_t,bool>>{{1,true}}));
+    CHECK(hedged_reads.get_stats().hedges == 0);
+}
+
+/* a read without a reply is duplicated after the delay, the duplicate wins, and the first request is reported as
+ * failed when the hedged reads stop. */
+static void test_slow_primary() {
+    Completions completions;
+    auto primary = request_to(1);
+    auto hedge = request_to(2);
+    {
+        HedgedReads hedged_reads;
+        hedged_reads.set_policy(true,95.0,200);
+        auto results = hedged_reads.read<int>(1,std::move(*primary->get_future()),completions.of(1),
+            [&completions,hedge](node_id_t& hedge_node_id, HedgedReads::completion_t& hedge_completion) {
+                hedge_node_id = 2;
+                hedge_completion = completions.of(2);
+                hedge->set_value(2,7);
+                return hedge->get_future();
+            });
+        auto& replies = results.get();
+        CHECK(replies.begin()->first == 2);
+        CHECK(replies.begin()->second.get() == 7);
+        CHECK((completions.get() == std::vector<std::pair<node_id_t,bool>>{{2,true}}));
+        auto stats = hedged_reads.get_stats();
+        CHECK(stats.reads == 1);
+        CHECK(stats.hedges == 1);
+        CHECK(stats.hedge_wins == 1);
+    }
+    CHECK((completions.get() == std::vector<std::pair<node_id_t,bool>>{{2,true},{1,false}}));
+}
+
+/* a failed read is duplicated at once, and fails if there is no other member. */
+static void test_failed_primary() {
+    Completions completions;
+    HedgedReads hedged_reads;
+    hedged_reads.set_policy(true,95.0,200);
+
+    auto primary = request_to(4);
+    auto hedge = request_to(3);
+    auto results = hedged_reads.read<int>(4,std::move(*primary->get_future()),completions.of(4),
+        [&completions,hedge](node_id_t& hedge_node_id, HedgedReads::completion_t& hedge_completion) {
+            hedge_node_id = 3;
+            hedge_completion = completions.of(3);
+            hedge->set_value(3,9);
+            return hedge->get_future();
+        });
+    primary->set_exception(4,std::make_exception_ptr(std::runtime_error("failed read")));
+    CHECK(results.get().begin()->first == 3);
+    CHECK(results.get().begin()->second.get() == 9);
+    CHECK((completions.get() == std::vector<std::pair<node_id_t,bool>>{{4,false},{3,true}}));
+
+    auto lonely = request_to(4);
+    auto failed = hedged_reads.read<int>(4,std::move(*lonely->get_future()),HedgedReads::completion_t{},no_hedge);
+    lonely->set_exception(4,std::make_exception_ptr(std::runtime_error("failed read")));
+    bool thrown = false;
+    try {
+        failed.get().begin()->second.get();
+    } catch (std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+int main(int argc, char** argv) {
+    test_fast_primary();
+    test_slow_primary();
+    test_failed_primary();
+    std::cout << "hedged_reads: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <cascade/detail/key_path_trie.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+static std::vector<std::string> list_keys(const KeyPathTrie<std::string>& trie, const std::string& prefix) {
+    std::vector<std::string> key_list;
+    trie.list_keys(prefix, key_list);
+    std::sort(key_list.begin(), key_list.end());
+    return key_list;
+}
+
+/* the keys whose pathname starts with prefix, as the stores used to list them key by key. */
+static std::vector<std::string> scan_keys(const std::vector<std::string>& keys, const std::string& prefix) {
+    std::vector<std::string> key_list;
+    for(const auto& key : keys) {
+        if(get_pathname<std::string>(key).compare(0, prefix.size(), prefix) == 0) {
+            key_list.emplace_back(key);
+        }
+    }
+    std::sort(key_list.begin(), key_list.end());
+    return key_list;
+}
+
+/* the last component of a prefix is a partial match, and a trailing separator only matches the subfolders. */
+static void test_prefix_rule() {
+    KeyPathTrie<std::string> trie;
+    CHECK(trie.insert("/a/b/k1"));
+    CHECK(trie.insert("/a/bc/k2"));
+    CHECK(trie.insert("/a/b/c/k3"));
+    CHECK(trie.insert("/a/c/k4"));
+    CHECK(!trie.insert("/a/b/k1"));
+    CHECK(trie.size() == 4);
+
+    CHECK(list_keys(trie, "/a/b") == (std::vector<std::string>{"/a/b/c/k3", "/a/b/k1", "/a/bc/k2"}));
+    CHECK(list_keys(trie, "/a/b/") == (std::vector<std::string>{"/a/b/c/k3"}));
+    CHECK(list_keys(trie, "/a/c") == (std::vector<std::string>{"/a/c/k4"}));
+    CHECK(list_keys(trie, "/a/d").empty());
+    CHECK(list_keys(trie, "/x/b").empty());
+    CHECK(list_keys(trie, "").size() == 4);
+}
+
+/* the listings match a scan of the keys, for the prefixes of every key. */
+static void test_against_scan() {
+    std::vector<std::string> keys{"k0", "/k1", "//k2", "/p/k3", "/p/k4", "/p/q/k5", "/pq/k6", "/p//k7", "/p/q/r/k8"};
+    KeyPathTrie<std::string> trie;
+    for(const auto& key : keys) {
+        trie.insert(key);
+    }
+    for(const auto& key : keys) {
+        for(size_t len = 0; len <= key.size(); len++) {
+            const std::string prefix = key.substr(0, len);
+            CHECK(list_keys(trie, prefix) == scan_keys(keys, prefix));
+        }
+    }
+}
+
+/* the erased keys are not listed any more, and clear drops them all. */
+static void test_erase_and_clear() {
+    KeyPathTrie<std::string> trie;
+    trie.insert("/a/b/k1");
+    trie.insert("/a/b/k2");
+    CHECK(trie.erase("/a/b/k1"));
+    CHECK(!trie.erase("/a/b/k1"));
+    CHECK(!trie.erase("/a/x/k1"));
+    CHECK(trie.size() == 1);
+    CHECK(list_keys(trie, "/a") == (std::vector<std::string>{"/a/b/k2"}));
+    trie.clear();
+    CHECK(trie.size() == 0);
+    CHECK(list_keys(trie, "").empty());
+    CHECK(trie.insert("/a/b/k1"));
+    CHECK(list_keys(trie, "/a/b") == (std::vector<std::string>{"/a/b/k1"}));
+}
+
+int main(int argc, char** argv) {
+    test_prefix_rule();
+    test_against_scan();
+    test_erase_and_clear();
+    std::cout << "key_path_trie: all checks passed." << std::endl;
+    return 0;
+}
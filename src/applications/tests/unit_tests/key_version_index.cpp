@@ -0,0 +1,115 @@
+#include <cascade/detail/key_version_index.hpp>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+using persistent::INVALID_VERSION;
+using persistent::version_t;
+
+/* the version of the latest update to key no later than ver, or INVALID_VERSION; -2 if ver is not covered. */
+static version_t version_at(const KeyVersionIndex<std::string>& index, const std::string& key, version_t ver) {
+    version_t key_version;
+    if(!index.lookup(key, ver, key_version)) {
+        return -2;
+    }
+    return key_version;
+}
+
+/* a lookup finds the latest update no later than the version, and the versions out of order are ignored. */
+static void test_lookup() {
+    KeyVersionIndex<std::string> index;
+    index.append("k1", 3);
+    index.append("k1", 7);
+    index.append("k2", 8);
+    index.append("k1", 12);
+    index.append("k1", 12);
+    index.append("k1", 5);
+    CHECK(version_at(index, "k1", 2) == INVALID_VERSION);
+    CHECK(version_at(index, "k1", 3) == 3);
+    CHECK(version_at(index, "k1", 11) == 7);
+    CHECK(version_at(index, "k1", 20) == 12);
+    CHECK(version_at(index, "k2", 7) == INVALID_VERSION);
+    CHECK(version_at(index, "unknown", 20) == INVALID_VERSION);
+    CHECK(index.num_recent_updates() == 4);
+    CHECK(index.recent_update_version(0) == 12);
+    CHECK(index.recent_update_version(3) == 3);
+    CHECK(index.recent_update_version(4) == INVALID_VERSION);
+}
+
+/* a trim keeps the version of each key at the frontier and the later ones, and uncovers the earlier versions. */
+static void test_trim() {
+    KeyVersionIndex<std::string> index;
+    index.append("k1", 1);
+    index.append("k1", 4);
+    index.append("k2", 5);
+    index.append("k1", 9);
+    index.trim(6);
+    CHECK(index.num_recent_updates() == 1);
+    CHECK(version_at(index, "k1", 5) == -2);
+    CHECK(version_at(index, "k1", 6) == 4);
+    CHECK(version_at(index, "k1", 9) == 9);
+    CHECK(version_at(index, "k2", 6) == 5);
+    // a trim does not move the frontier back.
+    index.trim(2);
+    CHECK(version_at(index, "k1", 5) == -2);
+    index.trim(9);
+    CHECK(index.num_recent_updates() == 0);
+    CHECK(version_at(index, "k1", 8) == -2);
+    CHECK(version_at(index, "k1", 9) == 9);
+}
+
+/* the chains built separately are merged into the chains of the index, and they are trimmed. */
+static void test_append_chains() {
+    KeyVersionIndex<std::string> index;
+    index.append("k1", 2);
+    std::unordered_map<std::string, std::vector<version_t>> chains;
+    chains["k1"] = {1, 2, 6};
+    chains["k2"] = {3, 4};
+    chains["k3"] = {5};
+    index.append_chains(std::move(chains));
+    CHECK(version_at(index, "k1", 5) == 2);
+    CHECK(version_at(index, "k1", 6) == 6);
+    CHECK(version_at(index, "k2", 3) == 3);
+    CHECK(version_at(index, "k3", 4) == INVALID_VERSION);
+    index.trim(6);
+    CHECK(version_at(index, "k1", 6) == 6);
+    CHECK(version_at(index, "k2", 6) == 4);
+    CHECK(version_at(index, "k3", 6) == 5);
+}
+
+struct VersionedObject {
+    version_t version;
+    version_t get_version() const {
+        return version;
+    }
+};
+
+/* an index seeded from a snapshot knows the version of each key in it, and covers the versions since the snapshot. */
+static void test_seed() {
+    KeyVersionIndex<std::string> index;
+    index.append("stale", 1);
+    std::map<std::string, VersionedObject> kv_map{{"k1", {3}}, {"k2", {8}}};
+    index.seed(kv_map, 10);
+    CHECK(index.num_recent_updates() == 0);
+    CHECK(version_at(index, "k1", 9) == -2);
+    CHECK(version_at(index, "k1", 10) == 3);
+    CHECK(version_at(index, "k2", 10) == 8);
+    CHECK(version_at(index, "stale", 10) == INVALID_VERSION);
+    index.append("k1", 11);
+    CHECK(version_at(index, "k1", 10) == 3);
+    CHECK(version_at(index, "k1", 11) == 11);
+}
+
+int main(int argc, char** argv) {
+    test_lookup();
+    test_trim();
+    test_append_chains();
+    test_seed();
+    std::cout << "key_version_index: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <cascade/detail/kv_hash_index.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+using StringIndex = KVHashIndex<std::string, int>;
+using IntegerIndex = KVHashIndex<uint64_t, int>;
+
+/* every key of the map is found, with its own entry, and a key out of the map is not. */
+template <typename KT>
+static bool finds_all(const KVHashIndex<KT, int>& index, std::map<KT, int>& kv_map) {
+    for(auto it = kv_map.begin(); it != kv_map.end(); it++) {
+        typename std::map<KT, int>::iterator found;
+        if(!index.lookup(it->first, found) || found != it) {
+            return false;
+        }
+    }
+    return index.size() == kv_map.size();
+}
+
+/* the keys are found after the table grows past its initial capacity, and an update points to the new entry. */
+static void test_put_and_grow() {
+    std::map<std::string, int> kv_map;
+    StringIndex index;
+    StringIndex::iterator it;
+    CHECK(!index.lookup("missing", it));
+    for(int i = 0; i < 4 * KV_HASH_INDEX_INITIAL_CAPACITY; i++) {
+        index.put(kv_map.emplace("/pool/key" + std::to_string(i), i).first);
+    }
+    CHECK(finds_all(index, kv_map));
+    CHECK(!index.lookup("missing", it));
+
+    // the stores replace an entry by extracting its node and inserting a new one.
+    auto node = kv_map.extract("/pool/key7");
+    node.mapped() = 70;
+    index.put(kv_map.insert(std::move(node)).position);
+    CHECK(index.lookup("/pool/key7", it));
+    CHECK(it->second == 70);
+    CHECK(index.size() == kv_map.size());
+}
+
+/* the keys shifted back into the slot of an erased key are still found, and the erased keys are not. */
+static void test_erase() {
+    std::map<uint64_t, int> kv_map;
+    IntegerIndex index;
+    for(uint64_t i = 0; i < KV_HASH_INDEX_INITIAL_CAPACITY / 4; i++) {
+        index.put(kv_map.emplace(i, static_cast<int>(i)).first);
+    }
+    for(uint64_t i = 0; i < KV_HASH_INDEX_INITIAL_CAPACITY / 4; i += 3) {
+        CHECK(index.erase(i));
+        CHECK(!index.erase(i));
+        kv_map.erase(i);
+    }
+    CHECK(finds_all(index, kv_map));
+    IntegerIndex::iterator it;
+    CHECK(!index.lookup(0, it));
+    CHECK(!index.lookup(3, it));
+}
+
+/* rebuild indexes exactly the entries of the map, and clear drops them all. */
+static void test_rebuild_and_clear() {
+    std::map<std::string, int> kv_map;
+    StringIndex index;
+    index.put(kv_map.emplace("stale", 0).first);
+    std::map<std::string, int> new_map;
+    for(int i = 0; i < KV_HASH_INDEX_INITIAL_CAPACITY; i++) {
+        new_map.emplace("/pool/key" + std::to_string(i), i);
+    }
+    index.rebuild(new_map);
+    CHECK(finds_all(index, new_map));
+    StringIndex::iterator it;
+    CHECK(!index.lookup("stale", it));
+    index.clear();
+    CHECK(index.size() == 0);
+    CHECK(!index.lookup("/pool/key0", it));
+    index.put(new_map.begin());
+    CHECK(index.size() == 1);
+}
+
+/* a lockless reader finds the keys which were indexed before it started, while the writer grows the table. */
+static void test_concurrent_reader() {
+    std::map<uint64_t, int> kv_map;
+    IntegerIndex index;
+    const uint64_t num_old_keys = KV_HASH_INDEX_INITIAL_CAPACITY / 4;
+    for(uint64_t i = 0; i < num_old_keys; i++) {
+        index.put(kv_map.emplace(i, static_cast<int>(i)).first);
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<bool> missed{false};
+    std::thread reader([&index, &stop, &missed, num_old_keys]() {
+        while(!stop) {
+            EpochManager::Guard guard;
+            for(uint64_t i = 0; i < num_old_keys; i++) {
+                IntegerIndex::iterator it;
+                if(!index.lookup(i, it) || it->second != static_cast<int>(i)) {
+                    missed = true;
+                }
+            }
+        }
+    });
+    for(uint64_t i = num_old_keys; i < 64 * KV_HASH_INDEX_INITIAL_CAPACITY; i++) {
+        index.put(kv_map.emplace(i, static_cast<int>(i)).first);
+    }
+    stop = true;
+    reader.join();
+    CHECK(!missed);
+    CHECK(finds_all(index, kv_map));
+}
+
+int main(int argc, char** argv) {
+    test_put_and_grow();
+    test_erase();
+    test_rebuild_and_clear();
+    test_concurrent_reader();
+    std::cout << "kv_hash_index: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <cascade/detail/member_load_tracker.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+/* one request per node is tracked at a time, and its reply completes the requests sent before it. */
+static void test_tracking() {
+    MemberLoadTracker tracker;
+    bool tracked = false;
+    const uint64_t first = tracker.on_dispatch(1,&tracked);
+    CHECK(tracked);
+    tracker.on_dispatch(1,&tracked);
+    CHECK(!tracked);
+    tracker.on_dispatch(2,&tracked);
+    CHECK(tracked);
+    CHECK(tracker.get_outstanding(1) == 2);
+    CHECK(tracker.get_outstanding(2) == 1);
+
+    // the reply of the first request does not complete the second one, sent after it.
+    tracker.on_reply(1,first);
+    CHECK(tracker.get_outstanding(1) == 1);
+    CHECK(tracker.get_latency_ewma_us(1) >= 0.0);
+    // the next request is tracked, and its reply completes both.
+    const uint64_t third = tracker.on_dispatch(1,&tracked);
+    CHECK(tracked);
+    CHECK(tracker.get_outstanding(1) == 2);
+    tracker.on_reply(1,third);
+    CHECK(tracker.get_outstanding(1) == 0);
+    // a request completed already is ignored.
+    tracker.on_reply(1,first);
+    CHECK(tracker.get_outstanding(1) == 0);
+    CHECK(tracker.get_outstanding(3) == 0);
+}
+
+/* an untracked request without a later tracked request expires after a few latencies. */
+static void test_untracked_expiration() {
+    MemberLoadTracker tracker;
+    bool tracked = false;
+    const uint64_t probe = tracker.on_dispatch(1,&tracked);
+    tracker.on_dispatch(1,&tracked);
+    CHECK(!tracked);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    tracker.on_reply(1,probe);
+    const double latency_us = tracker.get_latency_ewma_us(1);
+    CHECK(latency_us >= 2000.0);
+    CHECK(tracker.get_outstanding(1) == 1);
+    const auto expiration = std::chrono::microseconds(
+            static_cast<uint64_t>(MEMBER_LOAD_UNTRACKED_EXPIRATION_FACTOR * latency_us) + 1000);
+    std::this_thread::sleep_for(expiration);
+    CHECK(tracker.get_outstanding(1) == 0);
+
+    // a tracked request does not expire so early, and neither do the requests sent after it.
+    tracker.on_dispatch(1,&tracked);
+    CHECK(tracked);
+    tracker.on_dispatch(1,&tracked);
+    CHECK(!tracked);
+    std::this_thread::sleep_for(expiration);
+    CHECK(tracker.get_outstanding(1) == 2);
+}
+
+/* the load-aware policies avoid the loaded and the slow members. */
+static void test_pick() {
+    MemberLoadTracker tracker;
+    const std::vector<node_id_t> members{1,2,3};
+    // the requests without tracking, e.g. those of the hedged reads, are all outstanding.
+    tracker.on_dispatch(1);
+    tracker.on_dispatch(1);
+    tracker.on_dispatch(2);
+    CHECK(tracker.get_outstanding(1) == 2);
+    CHECK(tracker.pick_least_outstanding(members) == 3);
+    // an idle member without a sample is picked first.
+    CHECK(tracker.pick_lowest_latency(members) == 3);
+
+    const uint64_t slow = tracker.on_dispatch(3);
+    const uint64_t fast = tracker.on_dispatch(2);
+    tracker.on_reply(2,fast);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    tracker.on_reply(3,slow);
+    CHECK(tracker.get_latency_ewma_us(3) > tracker.get_latency_ewma_us(2));
+    CHECK(tracker.pick_lowest_latency({2,3}) == 2);
+    // a failed request gives no latency sample.
+    MemberLoadTracker failures;
+    failures.on_reply(1,failures.on_dispatch(1),false);
+    CHECK(failures.get_latency_ewma_us(1) == 0.0);
+    CHECK(failures.get_outstanding(1) == 0);
+}
+
+int main(int argc, char** argv) {
+    test_tracking();
+    test_untracked_expiration();
+    test_pick();
+    std::cout << "member_load_tracker: all checks passed." << std::endl;
+    return 0;
+}
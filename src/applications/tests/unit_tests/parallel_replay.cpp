@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "store_fixture.hpp"
+
+using namespace derecho::cascade;
+
+/**
+ * A log of puts, batches of puts, and removes over overlapping keys, and the store which wrote it.
+ */
+static persistent::version_t write_log(StoreCore& core, std::vector<std::vector<uint8_t>>& deltas, int num_keys, int num_rounds) {
+    persistent::version_t version = 0;
+    for (int round = 0; round < num_rounds; round ++) {
+        for (int i = 0; i < num_keys; i ++) {
+            const std::string key = "/pool" + std::to_string(i % 3) + "/k" + std::to_string(i);
+            const std::string data = "r" + std::to_string(round) + "k" + std::to_string(i);
+            version ++;
+            if (i % 7 == 3 && round % 2 == 1) {
+                CHECK(core.ordered_remove(make_object(key,"",version),version - 1));
+            } else if (i % 5 == 0 && i + 1 < num_keys) {
+                const std::string next_key = "/pool" + std::to_string((i + 1) % 3) + "/k" + std::to_string(i + 1);
+                core.ordered_put_batch({make_object(key,data,version),make_object(next_key,data + "b",version)},version - 1);
+            } else {
+                CHECK(core.ordered_put(make_object(key,data,version),version - 1));
+            }
+            finalize(core,deltas);
+        }
+    }
+    return version;
+}
+
+static void replay(StoreCore& replica, const std::vector<std::vector<uint8_t>>& deltas, uint32_t num_threads) {
+    replica.begin_recovery(num_threads);
+    for (const auto& delta : deltas) {
+        replica.applyDelta(delta.data());
+    }
+    replica.finish_recovery();
+}
+
+static std::vector<std::string> sorted_keys(const StoreCore& core, const std::string& prefix) {
+    auto keys = core.lockless_list_keys(prefix);
+    std::sort(keys.begin(),keys.end());
+    return keys;
+}
+
+/* a replica holds the same objects and lists the same keys as the store which wrote the log. */
+static void check_same_state(const StoreCore& expected, const StoreCore& replica, int num_keys) {
+    for (int i = 0; i < num_keys; i ++) {
+        const std::string key = "/pool" + std::to_string(i % 3) + "/k" + std::to_string(i);
+        const auto expected_object = expected.lockless_get(key);
+        const auto object = replica.lockless_get(key);
+        CHECK(object.is_null() == expected_object.is_null());
+        CHECK(object.get_version() == expected_object.get_version());
+        CHECK(data_of(object) == data_of(expected_object));
+    }
+    CHECK(sorted_keys(replica,"") == sorted_keys(expected,""));
+    CHECK(sorted_keys(replica,"/pool1") == sorted_keys(expected,"/pool1"));
+}
+
+/* the parallel replay builds the same state and the same version chains as the replay in the log order. */
+static void test_same_as_serial_replay() {
+    const int num_keys = 40;
+    std::vector<std::vector<uint8_t>> deltas;
+    StoreCore core;
+    const persistent::version_t last_version = write_log(core,deltas,num_keys,4);
+    CHECK(deltas.size() == static_cast<size_t>(last_version));
+
+    StoreCore serial;
+    replay(serial,deltas,1);
+    for (uint32_t num_threads : {2u,3u,8u}) {
+        StoreCore parallel;
+        replay(parallel,deltas,num_threads);
+        check_same_state(core,parallel,num_keys);
+        check_same_state(serial,parallel,num_keys);
+        for (int i = 0; i < num_keys; i ++) {
+            const std::string key = "/pool" + std::to_string(i % 3) + "/k" + std::to_string(i);
+            for (persistent::version_t ver = 1; ver <= last_version; ver ++) {
+                persistent::version_t expected_version = persistent::INVALID_VERSION;
+                persistent::version_t key_version = persistent::INVALID_VERSION;
+                CHECK(serial.lockless_get_key_version(key,ver,expected_version));
+                CHECK(parallel.lockless_get_key_version(key,ver,key_version));
+                CHECK(key_version == expected_version);
+            }
+        }
+    }
+}
+
+/* a log longer than a replay batch is replayed batch by batch, in the log order. */
+static void test_several_batches() {
+    const int num_keys = 1000;
+    std::vector<std::vector<uint8_t>> deltas;
+    StoreCore core;
+    write_log(core,deltas,num_keys,RECOVERY_BATCH_SIZE / num_keys + 2);
+    CHECK(deltas.size() > static_cast<size_t>(RECOVERY_BATCH_SIZE));
+    StoreCore parallel;
+    replay(parallel,deltas,4);
+    check_same_state(core,parallel,num_keys);
+}
+
+int main(int argc, char** argv) {
+    test_same_as_serial_replay();
+    test_several_batches();
+    std::cout << "parallel_replay: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <cascade/service_types.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+static const std::unordered_map<std::string,uint32_t> no_locations;
+
+/* with the RANGE sharding policy, shard i holds the keys in [split_points[i-1],split_points[i]). */
+static void test_range() {
+    DefaultObjectPoolMetadataType opm("/range",0,0,RANGE,no_locations,false,{"/range/g","/range/p"},{},
+                                      KEY_HASH_LEGACY,KEY_HASH_DEFAULT_SEED,3);
+    CHECK(opm.key_to_shard_index(std::string("/range/a"),3) == 0);
+    CHECK(opm.key_to_shard_index(std::string("/range/g"),3) == 1);
+    CHECK(opm.key_to_shard_index(std::string("/range/o"),3) == 1);
+    CHECK(opm.key_to_shard_index(std::string("/range/p"),3) == 2);
+    CHECK(opm.key_to_shard_index(std::string("/range/z"),3) == 2);
+    // a prefix is sent to the shards whose ranges overlap it.
+    CHECK((opm.prefix_to_shard_indexes("/range/h",3) == std::vector<uint32_t>{1}));
+    CHECK((opm.prefix_to_shard_indexes("/range/",3) == std::vector<uint32_t>{0,1,2}));
+    // a layout with fewer shards than ranges is an error, not a wrong shard.
+    CHECK_THROWS(opm.key_to_shard_index(std::string("/range/z"),2));
+    // the split points must be strictly ascending.
+    CHECK_THROWS(DefaultObjectPoolMetadataType("/range",0,0,RANGE,no_locations,false,{"/range/p","/range/g"}));
+}
+
+/* a pinned key overrides the sharding policy. */
+static void test_object_locations() {
+    const std::unordered_map<std::string,uint32_t> locations{{"/pinned/a",2}};
+    DefaultObjectPoolMetadataType opm("/pinned",0,0,RANGE,locations,false,{"/pinned/m"},{},
+                                      KEY_HASH_LEGACY,KEY_HASH_DEFAULT_SEED,3);
+    CHECK(opm.key_to_shard_index(std::string("/pinned/a"),3) == 2);
+    CHECK(opm.key_to_shard_index(std::string("/pinned/a"),3,false) == 0);
+    CHECK((opm.prefix_to_shard_indexes("/pinned/a",3) == std::vector<uint32_t>{0,2}));
+    CHECK_THROWS(DefaultObjectPoolMetadataType("/pinned",0,0,RANGE,locations,false,{"/pinned/m"},{},
+                                               KEY_HASH_LEGACY,KEY_HASH_DEFAULT_SEED,2));
+}
+
+/* rebalancing a VIRTUAL object pool moves the keys of the moved buckets only. */
+static void test_virtual_rebalance() {
+    const uint32_t num_buckets = 64;
+    std::vector<uint32_t> bucket_to_shard(num_buckets);
+    for (uint32_t bucket = 0; bucket < num_buckets; bucket ++) {
+        bucket_to_shard[bucket] = bucket % 3;
+    }
+    DefaultObjectPoolMetadataType before("/virtual",0,0,VIRTUAL,no_locations,false,{},bucket_to_shard,
+                                         KEY_HASH_WYHASH,KEY_HASH_DEFAULT_SEED,4);
+    // move every fourth bucket to the new shard.
+    std::vector<bool> moved(num_buckets,false);
+    for (uint32_t bucket = 0; bucket < num_buckets; bucket += 4) {
+        bucket_to_shard[bucket] = 3;
+        moved[bucket] = true;
+    }
+    DefaultObjectPoolMetadataType after("/virtual",0,0,VIRTUAL,no_locations,false,{},bucket_to_shard,
+                                        KEY_HASH_WYHASH,KEY_HASH_DEFAULT_SEED,4);
+    uint32_t num_moved_keys = 0;
+    for (uint32_t i = 0; i < 10000; i ++) {
+        const std::string key = "/virtual/key" + std::to_string(i);
+        const uint32_t bucket = before.key_to_bucket(key);
+        CHECK(bucket < num_buckets);
+        CHECK(after.key_to_bucket(key) == bucket);
+        const uint32_t old_shard = before.key_to_shard_index(key,4);
+        const uint32_t new_shard = after.key_to_shard_index(key,4);
+        if (moved[bucket]) {
+            CHECK(new_shard == 3);
+            num_moved_keys += (old_shard != new_shard) ? 1 : 0;
+        } else {
+            CHECK(new_shard == old_shard);
+        }
+    }
+    CHECK(num_moved_keys > 0);
+    // a bucket mapped beyond the shards is rejected.
+    bucket_to_shard[0] = 4;
+    CHECK_THROWS(DefaultObjectPoolMetadataType("/virtual",0,0,VIRTUAL,no_locations,false,{},bucket_to_shard,
+                                               KEY_HASH_WYHASH,KEY_HASH_DEFAULT_SEED,4));
+}
+
+/* growing the buckets from n to n+1 moves keys to the new bucket only. */
+static void test_jump_consistent_hash() {
+    for (uint64_t hash = 1; hash < 100000; hash += 7) {
+        const uint64_t key_hash = hash * 0x9e3779b97f4a7c15ull;
+        const uint32_t old_bucket = DefaultObjectPoolMetadataType::jump_consistent_hash(key_hash,10);
+        const uint32_t new_bucket = DefaultObjectPoolMetadataType::jump_consistent_hash(key_hash,11);
+        CHECK(old_bucket < 10);
+        CHECK(new_bucket == old_bucket || new_bucket == 10);
+    }
+}
+
+/* the placement tables survive serialization. */
+static void test_serialization() {
+    const std::unordered_map<std::string,uint32_t> locations{{"/range/x",0}};
+    DefaultObjectPoolMetadataType opm("/range",0,0,RANGE,locations,false,{"/range/g","/range/p"},{},
+                                      KEY_HASH_LEGACY,KEY_HASH_DEFAULT_SEED,3);
+    std::vector<uint8_t> bytes(mutils::bytes_size(opm));
+    mutils::to_bytes(opm,bytes.data());
+    auto copy = mutils::from_bytes<DefaultObjectPoolMetadataType>(nullptr,bytes.data());
+    for (const std::string key : {"/range/a","/range/h","/range/x","/range/z"}) {
+        CHECK(copy->key_to_shard_index(key,3) == opm.key_to_shard_index(key,3));
+    }
+    CHECK(copy->hash_key("/range/a") == opm.hash_key("/range/a"));
+}
+
+int main(int argc, char** argv) {
+    test_range();
+    test_object_locations();
+    test_virtual_rebalance();
+    test_jump_consistent_hash();
+    test_serialization();
+    std::cout << "placement: all checks passed." << std::endl;
+    return 0;
+}
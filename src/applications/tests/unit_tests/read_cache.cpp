@@ -0,0 +1,120 @@
+#include <cascade/detail/read_cache.hpp>
+
+#include <memory>
+#include <string>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+/**
+ * The cached object type, which has the interface ReadCache uses.
+ */
+struct TestObject {
+    persistent::version_t version;
+    std::string data;
+
+    bool is_valid() const {
+        return true;
+    }
+    bool is_null() const {
+        return false;
+    }
+    persistent::version_t get_version() const {
+        return version;
+    }
+};
+
+static std::shared_ptr<const TestObject> make_object(persistent::version_t version, const std::string& data) {
+    return std::make_shared<const TestObject>(TestObject{version,data});
+}
+
+static std::shared_ptr<const TestObject> lookup(ReadCache& cache, const std::string& key, persistent::version_t version, bool stable) {
+    bool cacheable = false;
+    return cache.lookup<TestObject>("/pool",key,version,stable,cacheable);
+}
+
+/* a miss is filled, and a hit returns the filled object. */
+static void test_fill_and_hit() {
+    ReadCache cache;
+    CHECK(!cache.is_active());
+    cache.enable("/pool",1024,true);
+    CHECK(cache.is_active());
+    CHECK(cache.is_enabled("/pool"));
+    CHECK(!cache.is_enabled("/other"));
+    bool cacheable = false;
+    CHECK(cache.lookup<TestObject>("/pool","/pool/a",CURRENT_VERSION,true,cacheable) == nullptr);
+    CHECK(cacheable);
+    cache.fill("/pool","/pool/a",CURRENT_VERSION,true,make_object(5,"a5"),2);
+    auto object = lookup(cache,"/pool/a",CURRENT_VERSION,true);
+    CHECK(object != nullptr && object->data == "a5");
+    CHECK(cache.get_stats().hits == 1);
+    CHECK(cache.get_stats().misses == 1);
+    // a versioned read is cached only if it is stable, and only the object of that exact version.
+    CHECK(cache.lookup<TestObject>("/pool","/pool/a",5,false,cacheable) == nullptr);
+    CHECK(!cacheable);
+    cache.fill("/pool","/pool/a",6,true,make_object(5,"a5"),2);
+    CHECK(lookup(cache,"/pool/a",6,true) == nullptr);
+    cache.disable("/pool");
+    CHECK(!cache.is_active());
+}
+
+/* a change drops the current entry of its key, and a late reply older than the change is not cached. */
+static void test_invalidate() {
+    ReadCache cache;
+    cache.enable("/pool",1024,true);
+    cache.fill("/pool","/pool/a",CURRENT_VERSION,true,make_object(5,"a5"),2);
+    cache.fill("/pool","/pool/b",CURRENT_VERSION,true,make_object(5,"b5"),2);
+    cache.invalidate("/pool","/pool/a",7);
+    CHECK(lookup(cache,"/pool/a",CURRENT_VERSION,true) == nullptr);
+    CHECK(lookup(cache,"/pool/b",CURRENT_VERSION,true) != nullptr);
+    cache.fill("/pool","/pool/a",CURRENT_VERSION,true,make_object(5,"a5"),2);
+    CHECK(lookup(cache,"/pool/a",CURRENT_VERSION,true) == nullptr);
+    cache.fill("/pool","/pool/a",CURRENT_VERSION,true,make_object(7,"a7"),2);
+    auto object = lookup(cache,"/pool/a",CURRENT_VERSION,true);
+    CHECK(object != nullptr && object->data == "a7");
+    // a lost subscription drops all of the current entries, but not the versioned ones.
+    cache.fill("/pool","/pool/a",5,true,make_object(5,"a5"),2);
+    cache.invalidate_all("/pool");
+    CHECK(lookup(cache,"/pool/a",CURRENT_VERSION,true) == nullptr);
+    CHECK(lookup(cache,"/pool/b",CURRENT_VERSION,true) == nullptr);
+    CHECK(lookup(cache,"/pool/a",5,true) != nullptr);
+}
+
+/* the least recently used entries are evicted over the bound. */
+static void test_eviction() {
+    ReadCache cache;
+    const std::size_t entry_bytes = 10 + std::string("/pool/a").size();
+    cache.enable("/pool",entry_bytes * 2,true);
+    cache.fill("/pool","/pool/a",CURRENT_VERSION,true,make_object(1,"a"),10);
+    cache.fill("/pool","/pool/b",CURRENT_VERSION,true,make_object(1,"b"),10);
+    CHECK(lookup(cache,"/pool/a",CURRENT_VERSION,true) != nullptr);
+    cache.fill("/pool","/pool/c",CURRENT_VERSION,true,make_object(1,"c"),10);
+    CHECK(lookup(cache,"/pool/b",CURRENT_VERSION,true) == nullptr);
+    CHECK(lookup(cache,"/pool/a",CURRENT_VERSION,true) != nullptr);
+    CHECK(lookup(cache,"/pool/c",CURRENT_VERSION,true) != nullptr);
+    CHECK(cache.get_stats().evictions == 1);
+    CHECK(cache.get_stats().bytes == entry_bytes * 2);
+}
+
+/* a client not told about the changes caches the versioned reads only. */
+static void test_without_invalidations() {
+    ReadCache cache;
+    cache.enable("/pool",1024,false);
+    bool cacheable = true;
+    CHECK(cache.lookup<TestObject>("/pool","/pool/a",CURRENT_VERSION,true,cacheable) == nullptr);
+    CHECK(!cacheable);
+    cache.fill("/pool","/pool/a",CURRENT_VERSION,true,make_object(5,"a5"),2);
+    CHECK(lookup(cache,"/pool/a",CURRENT_VERSION,true) == nullptr);
+    cache.fill("/pool","/pool/a",5,true,make_object(5,"a5"),2);
+    CHECK(lookup(cache,"/pool/a",5,true) != nullptr);
+}
+
+int main(int argc, char** argv) {
+    test_fill_and_hit();
+    test_invalidate();
+    test_eviction();
+    test_without_invalidations();
+    std::cout << "read_cache: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <cascade/detail/residency_clock.hpp>
+
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "store_fixture.hpp"
+
+using namespace derecho::cascade;
+
+/* the clock evicts the values that were not read since the hand last passed them, until the budget holds. */
+static void test_clock() {
+    ResidencyClock<std::string> clock(300);
+    clock.admit("a",100);
+    clock.admit("b",100);
+    clock.admit("c",100);
+    CHECK(!clock.over_budget());
+    clock.admit("d",100);
+    CHECK(clock.over_budget());
+    // every key is referenced when admitted: the first round clears the bits, and the second evicts "a".
+    std::string victim;
+    CHECK(clock.next_victim(victim));
+    CHECK(victim == "a");
+    CHECK(!clock.over_budget());
+    CHECK(!clock.is_resident("a"));
+    // "b" is passed by the first round, but read since: the hand skips it.
+    CHECK(clock.touch("b"));
+    CHECK(clock.next_victim(victim));
+    CHECK(victim == "c");
+
+    // a read of an evicted value is a miss, which queues a promotion.
+    CHECK(!clock.touch("a"));
+    CHECK((clock.take_promotions() == std::vector<std::string>{"a"}));
+    CHECK(clock.take_promotions().empty());
+    clock.admit("a",100);
+    clock.count_promotion();
+    CHECK(clock.is_resident("a"));
+
+    // an unknown key is neither a hit nor a miss.
+    CHECK(!clock.touch("z"));
+    ResidencyStats stats = clock.get_stats();
+    CHECK(stats.budget_bytes == 300);
+    CHECK(stats.resident_bytes == 300);
+    CHECK(stats.num_keys == 4);
+    CHECK(stats.num_resident_keys == 3);
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.evictions == 2);
+    CHECK(stats.promotions == 1);
+
+    // a value without heap memory is never evicted.
+    ResidencyClock<std::string> empty_values(0);
+    empty_values.admit("a",0);
+    CHECK(!empty_values.next_victim(victim));
+
+    // interrupt() stops the promotion thread.
+    clock.interrupt();
+    CHECK(!clock.wait_for_promotions());
+}
+
+/* the parallel replay keeps the store within the memory budget that is set before it. */
+static void test_parallel_replay_budget() {
+    const std::string data(1000,'x');
+    std::vector<std::vector<uint8_t>> deltas;
+    StoreCore core;
+    for (int i = 0; i < 100; i ++) {
+        CHECK(core.ordered_put(make_object("/pool/k" + std::to_string(i),data,i + 1),i));
+        finalize(core,deltas);
+    }
+    CHECK(deltas.size() == 100);
+
+    StoreCore replica;
+    replica.begin_recovery(4);
+    replica.set_blob_loader([&deltas](const persistent::version_t& ver, const std::function<void(const ObjectWithStringKey&)>& func) {
+        DeltaObjects<ObjectWithStringKey>::for_each(deltas.at(ver - 1).data(),func);
+    });
+    replica.set_memory_budget(10 * data.size());
+    for (const auto& delta : deltas) {
+        replica.applyDelta(delta.data());
+    }
+    replica.finish_recovery();
+    ResidencyStats stats;
+    CHECK(replica.get_residency_stats(stats));
+    CHECK(stats.num_keys == 100);
+    CHECK(stats.resident_bytes <= 10 * data.size());
+    CHECK(stats.evictions >= 90);
+    // an evicted value is loaded from the log when it is read.
+    CHECK(data_of(replica.lockless_get("/pool/k0")) == data);
+}
+
+int main(int argc, char** argv) {
+    test_clock();
+    test_parallel_replay_budget();
+    std::cout << "residency_clock: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cascade/detail/delta_store_core.hpp>
+#include <cascade/object.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * The store core and the objects the store core tests work on.
+ */
+using StoreCore = derecho::cascade::DeltaCascadeStoreCore<std::string,derecho::cascade::ObjectWithStringKey,
+                                                          &derecho::cascade::ObjectWithStringKey::IK,
+                                                          &derecho::cascade::ObjectWithStringKey::IV>;
+
+inline derecho::cascade::ObjectWithStringKey make_object(const std::string& key, const std::string& data,
+                                                         persistent::version_t version) {
+    derecho::cascade::ObjectWithStringKey object(key,reinterpret_cast<const uint8_t*>(data.data()),data.size());
+    object.set_version(version);
+    return object;
+}
+
+inline std::string data_of(const derecho::cascade::ObjectWithStringKey& object) {
+    return std::string(reinterpret_cast<const char*>(object.blob.bytes),object.blob.size);
+}
+
+/**
+ * Take the delta of the last operation, if it generated one, as Persistent does.
+ */
+inline void finalize(StoreCore& core, std::vector<std::vector<uint8_t>>& deltas) {
+    core.finalizeCurrentDelta([&deltas](uint8_t const* const buffer, std::size_t len) {
+        if (len > 0) {
+            deltas.emplace_back(buffer,buffer + len);
+        }
+    });
+}
@@ -0,0 +1,65 @@
+#include <cascade/detail/stream_manifest.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+/* a manifest survives serialization, and data of another size is not taken for a manifest. */
+static void test_round_trip() {
+    StreamManifest manifest(10,4,7,123,6,100,2);
+    std::vector<uint8_t> bytes(mutils::bytes_size(manifest));
+    mutils::to_bytes(manifest,bytes.data());
+    auto copy = StreamManifest::from_blob(bytes.data(),bytes.size());
+    CHECK(copy != nullptr);
+    CHECK(copy->total_size == 10);
+    CHECK(copy->chunk_size == 4);
+    CHECK(copy->chunk_key("/pool/k",0) == manifest.chunk_key("/pool/k",0));
+    CHECK(copy->previous_chunk_key("/pool/k",1) == manifest.previous_chunk_key("/pool/k",1));
+    CHECK(copy->previous_num_chunks == 2);
+
+    CHECK(StreamManifest::from_blob(bytes.data(),bytes.size() - 1) == nullptr);
+    bytes.emplace_back(0);
+    CHECK(StreamManifest::from_blob(bytes.data(),bytes.size()) == nullptr);
+    CHECK(StreamManifest::from_blob(nullptr,0) == nullptr);
+    const std::string data = "not a manifest";
+    CHECK(StreamManifest::from_blob(reinterpret_cast<const uint8_t*>(data.data()),data.size()) == nullptr);
+}
+
+/* the chunks cover the data, the last one holding the remainder. */
+static void test_num_chunks() {
+    CHECK(StreamManifest(0,4,0,0,0,0,0).num_chunks() == 0);
+    CHECK(StreamManifest(1,4,0,0,0,0,0).num_chunks() == 1);
+    CHECK(StreamManifest(8,4,0,0,0,0,0).num_chunks() == 2);
+    CHECK(StreamManifest(9,4,0,0,0,0,0).num_chunks() == 3);
+}
+
+/* the keys of two uploads and of the manifest never collide. */
+static void test_keys() {
+    const std::string key = "/pool/k";
+    StreamManifest first(8,4,1,100,0,0,0);
+    StreamManifest second(8,4,1,200,1,100,first.num_chunks());
+    std::set<std::string> keys{StreamManifest::manifest_key(key)};
+    for (uint64_t index = 0; index < first.num_chunks(); index ++) {
+        CHECK(keys.insert(first.chunk_key(key,index)).second);
+        CHECK(second.previous_chunk_key(key,index) == first.chunk_key(key,index));
+    }
+    for (uint64_t index = 0; index < second.num_chunks(); index ++) {
+        CHECK(keys.insert(second.chunk_key(key,index)).second);
+    }
+    // the keys stay in the object pool of the key.
+    for (const auto& chunk_key : keys) {
+        CHECK(chunk_key.compare(0,key.size(),key) == 0);
+    }
+}
+
+int main(int argc, char** argv) {
+    test_round_trip();
+    test_num_chunks();
+    test_keys();
+    std::cout << "stream_manifest: all checks passed." << std::endl;
+    return 0;
+}
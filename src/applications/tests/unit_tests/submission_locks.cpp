@@ -0,0 +1,105 @@
+#include <cascade/detail/submission_locks.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+/* how long a test waits to conclude that a thread is blocked. */
+static const auto blocked_wait = std::chrono::milliseconds(50);
+
+/* lock a node in another thread, which holds the lock until 'unlock' is set. */
+static std::future<void> lock_in_thread(SubmissionLocks& locks, node_id_t node_id, std::atomic<bool>& locked,
+                                        std::shared_future<void> unlock) {
+    return std::async(std::launch::async, [&locks, node_id, &locked, unlock]() {
+        auto lck = locks.lock(node_id);
+        locked = true;
+        unlock.wait();
+    });
+}
+
+static void contact(SubmissionLocks& locks, node_id_t node_id) {
+    auto lck = locks.lock(node_id);
+}
+
+/* the requests to different nodes are sent concurrently, and the requests to the same node one by one. */
+static void test_known_nodes() {
+    SubmissionLocks locks;
+    contact(locks, 1);
+    contact(locks, 2);
+    std::promise<void> unlock;
+    std::shared_future<void> unlocked = unlock.get_future().share();
+    std::atomic<bool> first{false}, other_node{false}, same_node{false};
+    auto first_done = lock_in_thread(locks, 1, first, unlocked);
+    while(!first) {
+        std::this_thread::yield();
+    }
+    auto other_done = lock_in_thread(locks, 2, other_node, unlocked);
+    auto same_done = lock_in_thread(locks, 1, same_node, unlocked);
+    std::this_thread::sleep_for(blocked_wait);
+    CHECK(other_node);
+    CHECK(!same_node);
+    unlock.set_value();
+    first_done.get();
+    other_done.get();
+    same_done.get();
+    CHECK(same_node);
+}
+
+/* the first request to a node waits for the requests in flight, and holds the later requests back. */
+static void test_first_contact() {
+    SubmissionLocks locks;
+    contact(locks, 1);
+    contact(locks, 2);
+    std::promise<void> unlock_first, unlock_new;
+    std::atomic<bool> first{false}, new_node{false}, later{false};
+    auto first_done = lock_in_thread(locks, 1, first, unlock_first.get_future().share());
+    while(!first) {
+        std::this_thread::yield();
+    }
+    auto new_done = lock_in_thread(locks, 3, new_node, unlock_new.get_future().share());
+    std::this_thread::sleep_for(blocked_wait);
+    CHECK(!new_node);
+    // a request to a known node which comes after the first request to the new node waits for it.
+    std::promise<void> no_wait;
+    no_wait.set_value();
+    auto later_done = lock_in_thread(locks, 2, later, no_wait.get_future().share());
+    std::this_thread::sleep_for(blocked_wait);
+    CHECK(!later);
+    unlock_first.set_value();
+    first_done.get();
+    while(!new_node) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(blocked_wait);
+    CHECK(!later);
+    unlock_new.set_value();
+    new_done.get();
+    later_done.get();
+    CHECK(later);
+    // the later requests to the new node are not sent alone.
+    std::promise<void> unlock_known;
+    std::shared_future<void> unlocked = unlock_known.get_future().share();
+    std::atomic<bool> known{false}, again{false};
+    auto known_done = lock_in_thread(locks, 1, known, unlocked);
+    while(!known) {
+        std::this_thread::yield();
+    }
+    auto again_done = lock_in_thread(locks, 3, again, unlocked);
+    std::this_thread::sleep_for(blocked_wait);
+    CHECK(again);
+    unlock_known.set_value();
+    known_done.get();
+    again_done.get();
+}
+
+int main(int argc, char** argv) {
+    test_known_nodes();
+    test_first_contact();
+    std::cout << "submission_locks: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "check.hpp"
+#include "store_fixture.hpp"
+
+using namespace derecho::cascade;
+
+using read_set_t = std::vector<std::tuple<std::string,persistent::version_t>>;
+
+int main(int argc, char** argv) {
+    StoreCore core;
+    std::vector<std::vector<uint8_t>> deltas;
+    CHECK(core.ordered_put(make_object("/pool/a","a1",1),persistent::INVALID_VERSION));
+    finalize(core,deltas);
+    CHECK(core.ordered_put(make_object("/pool/b","b2",2),1));
+    finalize(core,deltas);
+
+    // a transaction whose read set is current writes all of its write set, in one delta.
+    CHECK(core.ordered_transact(read_set_t{{"/pool/a",1},{"/pool/b",2}},
+                                {make_object("/pool/a","a3",3),make_object("/pool/c","c3",3)},2));
+    finalize(core,deltas);
+    CHECK(deltas.size() == 3);
+    CHECK(data_of(core.lockless_get("/pool/a")) == "a3");
+    CHECK(core.lockless_get("/pool/a").get_version() == 3);
+    CHECK(data_of(core.lockless_get("/pool/c")) == "c3");
+
+    // a stale read set writes nothing.
+    CHECK(!core.ordered_transact(read_set_t{{"/pool/a",1}},{make_object("/pool/b","b4",4)},3));
+    finalize(core,deltas);
+    CHECK(deltas.size() == 3);
+    CHECK(data_of(core.lockless_get("/pool/b")) == "b2");
+
+    // a key which does not exist has the invalid version.
+    CHECK(core.ordered_transact(read_set_t{{"/pool/d",persistent::INVALID_VERSION}},{make_object("/pool/d","d5",5)},3));
+    finalize(core,deltas);
+    CHECK(!core.ordered_transact(read_set_t{{"/pool/d",persistent::INVALID_VERSION}},{make_object("/pool/d","d6",6)},5));
+    finalize(core,deltas);
+    CHECK(data_of(core.lockless_get("/pool/d")) == "d5");
+
+    // a write set with a key twice is rejected as a whole.
+    CHECK(!core.ordered_transact(read_set_t{},{make_object("/pool/e","e7",7),make_object("/pool/e","e7",7)},5));
+    finalize(core,deltas);
+    CHECK(!core.lockless_get("/pool/e").is_valid());
+
+    // a read-only transaction commits without a delta.
+    CHECK(core.ordered_transact(read_set_t{{"/pool/a",3}},{},5));
+    finalize(core,deltas);
+    CHECK(deltas.size() == 4);
+
+    // replaying the deltas rebuilds the same state.
+    StoreCore replica;
+    for (const auto& delta : deltas) {
+        replica.applyDelta(delta.data());
+    }
+    for (const std::string key : {"/pool/a","/pool/b","/pool/c","/pool/d"}) {
+        const auto object = core.lockless_get(key);
+        const auto replayed = replica.lockless_get(key);
+        CHECK(replayed.is_valid());
+        CHECK(replayed.get_version() == object.get_version());
+        CHECK(data_of(replayed) == data_of(object));
+    }
+    std::cout << "transact: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <cascade/detail/write_combiner.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <typeindex>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace derecho::cascade;
+
+struct TestSubgroup {};
+
+/**
+ * The batches sent by a buffer, in order.
+ */
+struct Sent {
+    std::mutex mutex;
+    std::vector<std::vector<int>> batches;
+
+    std::size_t num_batches() {
+        std::lock_guard<std::mutex> lck(mutex);
+        return batches.size();
+    }
+};
+
+static WriteCombiner::buffer_key_t buffer_key(uint32_t shard_index) {
+    return std::make_tuple(std::type_index(typeid(TestSubgroup)),0u,shard_index);
+}
+
+/* a buffer is sent as one batch, in order, when it reaches the size threshold. */
+static void test_size_threshold() {
+    WriteCombiner combiner;
+    combiner.set_policy(true,4*sizeof(int),1000000000ul);
+    Sent sent;
+    auto send = [&sent](const std::vector<int>& batch) {
+        std::lock_guard<std::mutex> lck(sent.mutex);
+        sent.batches.emplace_back(batch);
+    };
+    for (int i = 0; i < 10; i ++) {
+        combiner.add(buffer_key(0),i,sizeof(int),send);
+    }
+    CHECK(sent.num_batches() == 2);
+    CHECK((sent.batches[0] == std::vector<int>{0,1,2,3}));
+    CHECK((sent.batches[1] == std::vector<int>{4,5,6,7}));
+    // the rest is sent when coalescing is disabled.
+    combiner.set_policy(false,4*sizeof(int),1000000000ul);
+    CHECK(sent.num_batches() == 3);
+    CHECK((sent.batches[2] == std::vector<int>{8,9}));
+    CHECK(combiner.get_stats().objects == 10);
+    CHECK(combiner.get_stats().batches == 3);
+}
+
+/* a buffer is sent when its oldest object has waited for the deadline. */
+static void test_deadline() {
+    WriteCombiner combiner;
+    combiner.set_policy(true,1ul << 20,1000);
+    Sent sent;
+    auto send = [&sent](const std::vector<int>& batch) {
+        std::lock_guard<std::mutex> lck(sent.mutex);
+        sent.batches.emplace_back(batch);
+    };
+    combiner.add(buffer_key(0),1,sizeof(int),send);
+    combiner.add(buffer_key(0),2,sizeof(int),send);
+    const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (sent.num_batches() == 0 && std::chrono::steady_clock::now() < give_up) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(sent.num_batches() == 1);
+    CHECK((sent.batches[0] == std::vector<int>{1,2}));
+}
+
+/* flushing a shard sends the buffer of that shard only. */
+static void test_flush_shard() {
+    WriteCombiner combiner;
+    combiner.set_policy(true,1ul << 20,1000000000ul);
+    Sent puts, other_shard;
+    auto send_to = [](Sent& sent) {
+        return [&sent](const std::vector<int>& batch) {
+            std::lock_guard<std::mutex> lck(sent.mutex);
+            sent.batches.emplace_back(batch);
+        };
+    };
+    combiner.add(buffer_key(1),1,sizeof(int),send_to(puts));
+    combiner.add(buffer_key(1),2,sizeof(int),send_to(puts));
+    combiner.add(buffer_key(2),3,sizeof(int),send_to(other_shard));
+    combiner.flush_shard(std::type_index(typeid(TestSubgroup)),0,1);
+    CHECK(puts.num_batches() == 1);
+    CHECK((puts.batches[0] == std::vector<int>{1,2}));
+    CHECK(other_shard.num_batches() == 0);
+    // an empty shard is not sent again.
+    combiner.flush_shard(std::type_index(typeid(TestSubgroup)),0,1);
+    CHECK(combiner.get_stats().batches == 1);
+    // flushing all sends the other shards.
+    combiner.flush_all();
+    CHECK(other_shard.num_batches() == 1);
+}
+
+int main(int argc, char** argv) {
+    test_size_threshold();
+    test_deadline();
+    test_flush_shard();
+    std::cout << "write_combiner: all checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include <cascade/detail/blob_segment_store.hpp>
+
+#include <derecho/conf/conf.hpp>
+#include <derecho/core/derecho_exception.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace derecho {
+namespace cascade {
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t blob_checksum(const uint8_t* data, std::size_t len) {
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ len;
+    std::size_t pos = 0;
+    for(; pos + sizeof(uint64_t) <= len; pos += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + pos, sizeof(word));
+        h ^= rotl64(word * 0x87c37b91114253d5ull, 31) * 0x4cf5ad432745937full;
+        h = rotl64(h, 27) * 5 + 0x52dce729;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + pos, len - pos);
+    h ^= rotl64(tail * 0x87c37b91114253d5ull, 31) * 0x4cf5ad432745937full;
+    // murmur3 fmix64
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * FNV-1a, which is stable across builds, unlike std::hash.
+ */
+static uint32_t name_hash(const std::string& name) {
+    uint32_t h = 2166136261u;
+    for(const char c : name) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static thread_local bool serialize_blob_segment_refs = false;
+static thread_local bool resolve_blob_segment_refs = false;
+
+BlobSegmentRegistry::RefScope::RefScope() : previous(serialize_blob_segment_refs) {
+    serialize_blob_segment_refs = true;
+}
+
+BlobSegmentRegistry::RefScope::~RefScope() {
+    serialize_blob_segment_refs = previous;
+}
+
+BlobSegmentRegistry::ResolveScope::ResolveScope() : previous(resolve_blob_segment_refs) {
+    resolve_blob_segment_refs = true;
+}
+
+BlobSegmentRegistry::ResolveScope::~ResolveScope() {
+    resolve_blob_segment_refs = previous;
+}
+
+bool BlobSegmentRegistry::serialize_refs() {
+    return serialize_blob_segment_refs;
+}
+
+bool BlobSegmentRegistry::resolve_refs() {
+    return resolve_blob_segment_refs;
+}
+
+BlobSegmentRegistry::BlobSegmentRegistry() {}
+
+BlobSegmentRegistry::~BlobSegmentRegistry() {}
+
+BlobSegmentRegistry& BlobSegmentRegistry::get() {
+    static BlobSegmentRegistry registry;
+    return registry;
+}
+
+void BlobSegmentRegistry::register_segment(uint64_t segment_id, const uint8_t* base, std::size_t size) {
+    std::unique_lock<std::shared_mutex> wlck(regions_mutex);
+    regions.erase(segment_id);
+    regions.try_emplace(segment_id, base, size);
+}
+
+void BlobSegmentRegistry::unregister_segment(uint64_t segment_id) {
+    std::unique_lock<std::shared_mutex> wlck(regions_mutex);
+    regions.erase(segment_id);
+}
+
+const uint8_t* BlobSegmentRegistry::resolve(const BlobSegmentRef& ref) const {
+    const uint8_t* data = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> rlck(regions_mutex);
+        auto region = regions.find(ref.segment_id);
+        if(region == regions.cend() || ref.offset > region->second.size
+           || ref.length > region->second.size - ref.offset) {
+            return nullptr;
+        }
+        data = region->second.base + ref.offset;
+        if(blob_checksum(data, ref.length) != ref.checksum) {
+            dbg_default_error("Checksum mismatch of blob in segment:0x{:x}, offset:{}, length:{}.",
+                              ref.segment_id, ref.offset, ref.length);
+            return nullptr;
+        }
+        std::size_t referenced_end = region->second.referenced_end.load(std::memory_order_relaxed);
+        while(referenced_end < ref.offset + ref.length
+              && !region->second.referenced_end.compare_exchange_weak(referenced_end, ref.offset + ref.length,
+                                                                      std::memory_order_relaxed)) {
+        }
+    }
+    return data;
+}
+
+std::size_t BlobSegmentRegistry::get_referenced_end(uint64_t segment_id) const {
+    std::shared_lock<std::shared_mutex> rlck(regions_mutex);
+    auto region = regions.find(segment_id);
+    if(region == regions.cend()) {
+        return 0;
+    }
+    return region->second.referenced_end.load(std::memory_order_relaxed);
+}
+
+BlobSegmentStore::BlobSegmentStore(const std::string& _directory,
+                                   const std::string& _name,
+                                   std::size_t _threshold,
+                                   std::size_t _segment_capacity)
+        : directory(_directory),
+          name(_name),
+          store_hash(name_hash(_name)),
+          threshold(_threshold),
+          segment_capacity(_segment_capacity),
+          next_segment_number(0),
+          write_offset(0) {
+    std::filesystem::create_directories(directory);
+    // map the existing segments for the log replay.
+    const std::string file_prefix = name + "-";
+    for(const auto& entry : std::filesystem::directory_iterator(directory)) {
+        const std::string filename = entry.path().filename().string();
+        if(!entry.is_regular_file() || filename.rfind(file_prefix, 0) != 0 || entry.path().extension().string() != ".blob"
+           || entry.file_size() == 0) {
+            continue;
+        }
+        const uint32_t segment_number = std::stoul(filename.substr(file_prefix.size()), nullptr, 16);
+        map_segment(segment_number, entry.file_size(), false);
+        next_segment_number = std::max(next_segment_number, segment_number + 1);
+    }
+    std::sort(segments.begin(), segments.end(),
+              [](const Segment& lhs, const Segment& rhs) { return lhs.segment_id < rhs.segment_id; });
+    // the append position in the last segment is not known until the log is replayed, see resume().
+    write_offset = segment_capacity;
+}
+
+void BlobSegmentStore::resume() {
+    std::vector<Segment> referenced_segments;
+    for(auto& segment : segments) {
+        if(BlobSegmentRegistry::get().get_referenced_end(segment.segment_id) > 0) {
+            referenced_segments.push_back(segment);
+            continue;
+        }
+        // the log does not refer to any blob in it.
+        const std::string filename = segment_filename(static_cast<uint32_t>(segment.segment_id));
+        BlobSegmentRegistry::get().unregister_segment(segment.segment_id);
+        munmap(segment.base, segment.capacity);
+        close(segment.fd);
+        std::error_code ec;
+        std::filesystem::remove(filename, ec);
+        dbg_default_info("Removed blob segment:{}, which the log does not refer to.", filename);
+    }
+    segments.swap(referenced_segments);
+    unsynced_segments.clear();
+    write_offset = segment_capacity;
+    if(!segments.empty()) {
+        // the blobs after the last one the log refers to were never committed, so they are overwritten.
+        write_offset = BlobSegmentRegistry::get().get_referenced_end(segments.back().segment_id);
+    }
+}
+
+std::string BlobSegmentStore::segment_filename(uint32_t segment_number) const {
+    char hex_number[16];
+    snprintf(hex_number, sizeof(hex_number), "%08x", segment_number);
+    return directory + "/" + name + "-" + hex_number + ".blob";
+}
+
+void BlobSegmentStore::map_segment(uint32_t segment_number, std::size_t capacity, bool create) {
+    const std::string filename = segment_filename(segment_number);
+    int fd = open(filename.c_str(), create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, S_IRUSR | S_IWUSR);
+    if(fd < 0) {
+        throw derecho::derecho_exception("Failed to open blob segment:" + filename + ", errno=" + std::to_string(errno));
+    }
+    if(create && ftruncate(fd, capacity) != 0) {
+        close(fd);
+        throw derecho::derecho_exception("Failed to allocate blob segment:" + filename + ", errno=" + std::to_string(errno));
+    }
+    void* base = mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+    if(base == MAP_FAILED) {
+        close(fd);
+        throw derecho::derecho_exception("Failed to map blob segment:" + filename + ", errno=" + std::to_string(errno));
+    }
+    const uint64_t segment_id = (static_cast<uint64_t>(store_hash) << 32) | segment_number;
+    segments.push_back({segment_id, fd, static_cast<uint8_t*>(base), capacity});
+    BlobSegmentRegistry::get().register_segment(segment_id, static_cast<const uint8_t*>(base), capacity);
+}
+
+std::size_t BlobSegmentStore::get_threshold() const {
+    return threshold;
+}
+
+const uint8_t* BlobSegmentStore::append(const uint8_t* data, std::size_t len, BlobSegmentRef& ref) {
+    if(segments.empty() || write_offset + len > segments.back().capacity) {
+        map_segment(next_segment_number++, std::max(segment_capacity, len), true);
+        write_offset = 0;
+    }
+    if(unsynced_segments.empty() || unsynced_segments.back() != segments.size() - 1) {
+        unsynced_segments.push_back(segments.size() - 1);
+    }
+    Segment& segment = segments.back();
+    std::size_t written = 0;
+    while(written < len) {
+        ssize_t ret = pwrite(segment.fd, data + written, len - written, write_offset + written);
+        if(ret < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            throw derecho::derecho_exception("Failed to write blob segment:" + std::to_string(segment.segment_id) + ", errno=" + std::to_string(errno));
+        }
+        written += ret;
+    }
+    ref.segment_id = segment.segment_id;
+    ref.offset = write_offset;
+    ref.length = len;
+    ref.checksum = blob_checksum(data, len);
+    write_offset += len;
+    return segment.base + ref.offset;
+}
+
+void BlobSegmentStore::sync() {
+    for(const auto& index : unsynced_segments) {
+        if(fdatasync(segments[index].fd) != 0) {
+            throw derecho::derecho_exception("Failed to sync blob segment:" + std::to_string(segments[index].segment_id) + ", errno=" + std::to_string(errno));
+        }
+    }
+    unsynced_segments.clear();
+}
+
+BlobSegmentStore::~BlobSegmentStore() {
+    for(auto& segment : segments) {
+        BlobSegmentRegistry::get().unregister_segment(segment.segment_id);
+        munmap(segment.base, segment.capacity);
+        close(segment.fd);
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
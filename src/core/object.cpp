@@ -75,11 +75,23 @@ Blob::Blob(const blob_generator_func_t& generator, const decltype(size) s):
     // no data is generated here.
 }
 
+Blob::Blob(const BlobSegmentRef& ref, const uint8_t* const mapped_bytes) :
+    bytes(mapped_bytes), size(ref.length), capacity(ref.length), memory_mode(object_memory_mode_t::BLOB_SEGMENT),
+    segment_ref(ref) {}
+
 Blob::Blob(const Blob& other) :
     bytes(nullptr), size(0), capacity(0), memory_mode(object_memory_mode_t::DEFAULT) {
-    if(other.size > 0) {
+    if(other.memory_mode == object_memory_mode_t::BLOB_SEGMENT || other.memory_mode == object_memory_mode_t::SHARED) {
+        // the mapped segment outlives the objects, and the shared data is immutable, so we share the data.
+        bytes = other.bytes;
+        size = other.size;
+        capacity = other.size;
+        memory_mode = other.memory_mode;
+        segment_ref = other.segment_ref;
+        shared_bytes = other.shared_bytes;
+    } else if(other.size > 0) {
         uint8_t* t_bytes = static_cast<uint8_t*>(malloc(other.size));
-        if (memory_mode == object_memory_mode_t::BLOB_GENERATOR) {
+        if (other.memory_mode == object_memory_mode_t::BLOB_GENERATOR) {
             // instantiate data.
             auto number_bytes_generated = other.blob_generator(t_bytes,other.size);
             if (number_bytes_generated != other.size) {
@@ -93,15 +105,20 @@ Blob::Blob(const Blob& other) :
             // uint8_t* t_bytes = PAGE_ALIGNED_NEW(other.size);
             memcpy(t_bytes, other.bytes, other.size);
         }
+        // Nothing writes to the data of a copy, so the copies of the copy share it. This is what makes the copies of
+        // the stored objects, e.g. the replies of the lockless reads, free of memcpy.
+        shared_bytes = std::shared_ptr<const uint8_t>(t_bytes, [](const uint8_t* p) { free(const_cast<uint8_t*>(p)); });
         bytes = t_bytes;
         size = other.size;
         capacity = other.size;
+        memory_mode = object_memory_mode_t::SHARED;
     }
 }
 
 Blob::Blob(Blob&& other) : 
     bytes(other.bytes), size(other.size), capacity(other.size),
-    blob_generator(other.blob_generator), memory_mode(other.memory_mode) {
+    blob_generator(other.blob_generator), memory_mode(other.memory_mode), segment_ref(other.segment_ref),
+    shared_bytes(std::move(other.shared_bytes)) {
     other.bytes = nullptr;
     other.size = 0;
     other.capacity = 0;
@@ -121,25 +138,40 @@ Blob& Blob::operator=(Blob&& other) {
     auto swp_cap  = other.capacity;
     auto swp_blob_generator = other.blob_generator;
     auto swp_memory_mode = other.memory_mode;
+    auto swp_segment_ref = other.segment_ref;
+    std::swap(shared_bytes, other.shared_bytes);
     other.bytes = bytes;
     other.size = size;
     other.capacity = capacity;
     other.blob_generator = blob_generator;
     other.memory_mode = memory_mode;
+    other.segment_ref = segment_ref;
     bytes = swp_bytes;
     size = swp_size;
     capacity = swp_cap;
     blob_generator = swp_blob_generator;
     memory_mode = swp_memory_mode;
+    segment_ref = swp_segment_ref;
     return *this;
 }
 
 Blob& Blob::operator=(const Blob& other) {
+    if (this == &other) {
+        return *this;
+    }
     // 1) this->is_emplaced has to be false;
-    if (memory_mode != object_memory_mode_t::DEFAULT) {
+    if (memory_mode == object_memory_mode_t::EMPLACED || memory_mode == object_memory_mode_t::BLOB_GENERATOR) {
         throw std::runtime_error("Copy to a Blob that does not own the data (object_memory_mode_T::DEFAULT) is prohibited.");
     }
 
+    // 1.5) the data of this blob, or of the other one, is shared or in a blob segment: we copy and swap, so that the
+    //      data is shared or released instead of overwritten.
+    if (memory_mode == object_memory_mode_t::SHARED || other.memory_mode == object_memory_mode_t::SHARED ||
+        memory_mode == object_memory_mode_t::BLOB_SEGMENT || other.memory_mode == object_memory_mode_t::BLOB_SEGMENT) {
+        Blob copy(other);
+        return *this = std::move(copy);
+    }
+
     // 2) verify that this->capacity has enough memory;
     if (this->capacity < other.size) {
         bytes = static_cast<uint8_t*>(realloc(const_cast<void*>(static_cast<const void*>(bytes)),other.size));
@@ -167,6 +199,14 @@ Blob& Blob::operator=(const Blob& other) {
 }
 
 std::size_t Blob::to_bytes(uint8_t* v) const {
+    // an unresolved reference, which has no data, stays a reference.
+    if(memory_mode == object_memory_mode_t::BLOB_SEGMENT && (BlobSegmentRegistry::serialize_refs() || bytes == nullptr)) {
+        ((std::size_t*)(v))[0] = segment_ref.length | BLOB_SEGMENT_REF_FLAG;
+        ((uint64_t*)(v + sizeof(size)))[0] = segment_ref.segment_id;
+        ((uint64_t*)(v + sizeof(size)))[1] = segment_ref.offset;
+        ((uint64_t*)(v + sizeof(size)))[2] = segment_ref.checksum;
+        return bytes_size();
+    }
     ((std::size_t*)(v))[0] = size;
     if(size > 0) {
         if (memory_mode == object_memory_mode_t::BLOB_GENERATOR) {
@@ -186,11 +226,19 @@ std::size_t Blob::to_bytes(uint8_t* v) const {
 }
 
 std::size_t Blob::bytes_size() const {
+    if(memory_mode == object_memory_mode_t::BLOB_SEGMENT && (BlobSegmentRegistry::serialize_refs() || bytes == nullptr)) {
+        return sizeof(size) + 3 * sizeof(uint64_t);
+    }
     return size + sizeof(size);
 }
 
 void Blob::post_object(const std::function<void(uint8_t const* const, std::size_t)>& f) const {
-    if (size > 0 && (memory_mode == object_memory_mode_t::BLOB_GENERATOR)) {
+    if(memory_mode == object_memory_mode_t::BLOB_SEGMENT && (BlobSegmentRegistry::serialize_refs() || bytes == nullptr)) {
+        std::size_t flagged_size = segment_ref.length | BLOB_SEGMENT_REF_FLAG;
+        uint64_t ref_fields[3] = {segment_ref.segment_id, segment_ref.offset, segment_ref.checksum};
+        f((uint8_t*)&flagged_size, sizeof(flagged_size));
+        f((uint8_t*)ref_fields, sizeof(ref_fields));
+    } else if (size > 0 && (memory_mode == object_memory_mode_t::BLOB_GENERATOR)) {
         // we have to instatiate the data. CAUTIOUS: this is inefficient. Please use BLOB_GENERATOR mode carefully.
         uint8_t* local_bytes = static_cast<uint8_t*>(malloc(size));
         auto number_bytes_generated = blob_generator(local_bytes,size);
@@ -211,15 +259,49 @@ void Blob::post_object(const std::function<void(uint8_t const* const, std::size_
     }
 }
 
+/**
+ * Resolve a serialized blob segment reference to a Blob in the mapped segment. Out of a
+ * BlobSegmentRegistry::ResolveScope, e.g. in a request of a client, the reference is not resolved: the Blob is empty,
+ * and the stores reject it.
+ */
+static Blob* resolve_blob_segment_ref(const uint8_t* const v) {
+    BlobSegmentRef ref;
+    ref.length = ((std::size_t*)(v))[0] & ~BLOB_SEGMENT_REF_FLAG;
+    ref.segment_id = ((uint64_t*)(v + sizeof(std::size_t)))[0];
+    ref.offset = ((uint64_t*)(v + sizeof(std::size_t)))[1];
+    ref.checksum = ((uint64_t*)(v + sizeof(std::size_t)))[2];
+    if (!BlobSegmentRegistry::resolve_refs()) {
+        Blob* unresolved = new Blob(ref, nullptr);
+        unresolved->size = 0;
+        unresolved->capacity = 0;
+        return unresolved;
+    }
+    const uint8_t* mapped_bytes = BlobSegmentRegistry::get().resolve(ref);
+    if (mapped_bytes == nullptr) {
+        throw derecho::derecho_exception("Failed to resolve the blob in segment:" + std::to_string(ref.segment_id)
+                + ", offset:" + std::to_string(ref.offset) + ", length:" + std::to_string(ref.length));
+    }
+    return new Blob(ref, mapped_bytes);
+}
+
 mutils::context_ptr<Blob> Blob::from_bytes_noalloc(mutils::DeserializationManager* ctx, const uint8_t* const v) {
+    if (((std::size_t*)(v))[0] & BLOB_SEGMENT_REF_FLAG) {
+        return mutils::context_ptr<Blob>{resolve_blob_segment_ref(v)};
+    }
     return mutils::context_ptr<Blob>{new Blob(const_cast<uint8_t*>(v) + sizeof(std::size_t), ((std::size_t*)(v))[0], true)};
 }
 
 mutils::context_ptr<const Blob> Blob::from_bytes_noalloc_const(mutils::DeserializationManager* ctx, const uint8_t* const v) {
+    if (((std::size_t*)(v))[0] & BLOB_SEGMENT_REF_FLAG) {
+        return mutils::context_ptr<const Blob>{resolve_blob_segment_ref(v)};
+    }
     return mutils::context_ptr<const Blob>{new Blob(const_cast<uint8_t*>(v) + sizeof(std::size_t), ((std::size_t*)(v))[0], true)};
 }
 
 std::unique_ptr<Blob> Blob::from_bytes(mutils::DeserializationManager*, const uint8_t* const v) {
+    if (((std::size_t*)(v))[0] & BLOB_SEGMENT_REF_FLAG) {
+        return std::unique_ptr<Blob>{resolve_blob_segment_ref(v)};
+    }
     return std::make_unique<Blob>(v + sizeof(std::size_t), ((std::size_t*)(v))[0]);
 }
 
@@ -265,7 +347,8 @@ ObjectWithUInt64Key::ObjectWithUInt64Key(
     previous_version(_previous_version),
     previous_version_by_key(_previous_version_by_key),
     key(_key), 
-    blob(_blob.bytes,_blob.size,emplaced) {}
+    blob((_blob.memory_mode == object_memory_mode_t::BLOB_SEGMENT || _blob.memory_mode == object_memory_mode_t::SHARED) ?
+         Blob(_blob) : Blob(_blob.bytes,_blob.size,emplaced)) {}
 
 // constructor 1 : copy consotructor
 ObjectWithUInt64Key::ObjectWithUInt64Key(const uint64_t _key,
@@ -426,6 +509,50 @@ bool ObjectWithUInt64Key::verify_previous_version(persistent::version_t prev_ver
            ((this->previous_version_by_key == persistent::INVALID_VERSION)?true:(this->previous_version_by_key >= prev_ver_by_key));
 }
 
+const uint8_t* ObjectWithUInt64Key::get_blob_bytes() const {
+    if (blob.memory_mode == object_memory_mode_t::BLOB_GENERATOR ||
+        blob.memory_mode == object_memory_mode_t::BLOB_SEGMENT) {
+        return nullptr;
+    }
+    return blob.bytes;
+}
+
+std::size_t ObjectWithUInt64Key::get_blob_size() const {
+    return blob.size;
+}
+
+bool ObjectWithUInt64Key::has_blob_segment_ref() const {
+    return blob.memory_mode == object_memory_mode_t::BLOB_SEGMENT;
+}
+
+ObjectWithUInt64Key ObjectWithUInt64Key::copy_with_blob_segment(const BlobSegmentRef& ref, const uint8_t* mapped_bytes) const {
+    return ObjectWithUInt64Key(
+#ifdef ENABLE_EVALUATION
+        message_id,
+#endif
+        version,
+        timestamp_us,
+        previous_version,
+        previous_version_by_key,
+        key,
+        Blob(ref, mapped_bytes),
+        false);
+}
+
+ObjectWithUInt64Key ObjectWithUInt64Key::copy_with_blob_generator(const blob_generator_func_t& generator) const {
+    return ObjectWithUInt64Key(
+#ifdef ENABLE_EVALUATION
+        message_id,
+#endif
+        version,
+        timestamp_us,
+        previous_version,
+        previous_version_by_key,
+        key,
+        generator,
+        blob.size);
+}
+
 #ifdef ENABLE_EVALUATION
 void ObjectWithUInt64Key::set_message_id(uint64_t id) const {
     this->message_id = id;
@@ -619,7 +746,8 @@ ObjectWithStringKey::ObjectWithStringKey(
     previous_version(_previous_version),
     previous_version_by_key(_previous_version_by_key),
     key(_key), 
-    blob(_blob.bytes,_blob.size,emplaced) {}
+    blob((_blob.memory_mode == object_memory_mode_t::BLOB_SEGMENT || _blob.memory_mode == object_memory_mode_t::SHARED) ?
+         Blob(_blob) : Blob(_blob.bytes,_blob.size,emplaced)) {}
 
 // constructor 1 : copy consotructor
 ObjectWithStringKey::ObjectWithStringKey(const std::string& _key,
@@ -779,6 +907,50 @@ bool ObjectWithStringKey::verify_previous_version(persistent::version_t prev_ver
            ((this->previous_version_by_key == persistent::INVALID_VERSION)?true:(this->previous_version_by_key >= prev_ver_by_key));
 }
 
+const uint8_t* ObjectWithStringKey::get_blob_bytes() const {
+    if (blob.memory_mode == object_memory_mode_t::BLOB_GENERATOR ||
+        blob.memory_mode == object_memory_mode_t::BLOB_SEGMENT) {
+        return nullptr;
+    }
+    return blob.bytes;
+}
+
+std::size_t ObjectWithStringKey::get_blob_size() const {
+    return blob.size;
+}
+
+bool ObjectWithStringKey::has_blob_segment_ref() const {
+    return blob.memory_mode == object_memory_mode_t::BLOB_SEGMENT;
+}
+
+ObjectWithStringKey ObjectWithStringKey::copy_with_blob_segment(const BlobSegmentRef& ref, const uint8_t* mapped_bytes) const {
+    return ObjectWithStringKey(
+#ifdef ENABLE_EVALUATION
+        message_id,
+#endif
+        version,
+        timestamp_us,
+        previous_version,
+        previous_version_by_key,
+        key,
+        Blob(ref, mapped_bytes),
+        false);
+}
+
+ObjectWithStringKey ObjectWithStringKey::copy_with_blob_generator(const blob_generator_func_t& generator) const {
+    return ObjectWithStringKey(
+#ifdef ENABLE_EVALUATION
+        message_id,
+#endif
+        version,
+        timestamp_us,
+        previous_version,
+        previous_version_by_key,
+        key,
+        generator,
+        blob.size);
+}
+
 #ifdef ENABLE_EVALUATION
 void ObjectWithStringKey::set_message_id(uint64_t id) const {
     this->message_id = id;
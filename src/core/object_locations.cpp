@@ -0,0 +1,238 @@
+#include <cascade/detail/object_locations.hpp>
+#include <derecho/core/derecho_exception.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <optional>
+
+namespace derecho {
+namespace cascade {
+
+ObjectLocations::ObjectLocations(std::shared_ptr<const Table>&& _table) : table(std::move(_table)) {}
+
+ObjectLocations::ObjectLocations() : table(std::make_shared<const Table>()) {}
+
+ObjectLocations::ObjectLocations(const std::unordered_map<std::string, uint32_t>& locations) {
+    std::vector<std::pair<std::string_view, uint32_t>> sorted;
+    sorted.reserve(locations.size());
+    for(const auto& location : locations) {
+        sorted.emplace_back(location.first, location.second);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    auto new_table = std::make_shared<Table>();
+    new_table->key_ends.reserve(sorted.size());
+    new_table->shards.reserve(sorted.size());
+    for(const auto& location : sorted) {
+        new_table->keys.append(location.first);
+        new_table->key_ends.push_back(new_table->keys.size());
+        new_table->shards.push_back(location.second);
+    }
+    table = std::move(new_table);
+}
+
+std::size_t ObjectLocations::size() const {
+    return table->shards.size();
+}
+
+bool ObjectLocations::empty() const {
+    return table->shards.empty();
+}
+
+std::string_view ObjectLocations::key_at(std::size_t pos) const {
+    const uint64_t begin = (pos == 0) ? 0 : table->key_ends[pos - 1];
+    return std::string_view(table->keys.data() + begin, table->key_ends[pos] - begin);
+}
+
+uint32_t ObjectLocations::shard_at(std::size_t pos) const {
+    return table->shards[pos];
+}
+
+std::size_t ObjectLocations::lower_bound(const std::string_view& key) const {
+    std::size_t first = 0;
+    std::size_t count = size();
+    while(count > 0) {
+        const std::size_t step = count / 2;
+        if(key_at(first + step) < key) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+bool ObjectLocations::find(const std::string_view& key, uint32_t& shard_index) const {
+    const std::size_t pos = lower_bound(key);
+    if(pos == size() || key_at(pos) != key) {
+        return false;
+    }
+    shard_index = shard_at(pos);
+    return true;
+}
+
+bool ObjectLocations::contains(const std::string_view& key) const {
+    uint32_t shard_index;
+    return find(key, shard_index);
+}
+
+std::pair<std::size_t, std::size_t> ObjectLocations::prefix_range(const std::string_view& prefix) const {
+    const std::size_t first = lower_bound(prefix);
+    std::size_t last = first;
+    while(last < size() && key_at(last).compare(0, prefix.size(), prefix) == 0) {
+        last++;
+    }
+    return {first, last};
+}
+
+ObjectLocations ObjectLocations::apply(const std::unordered_map<std::string, uint32_t>& updates,
+                                       const std::vector<std::string>& removals) const {
+    // the change set, in ascending key order. A removal is marked by an empty shard.
+    std::vector<std::pair<std::string_view, std::optional<uint32_t>>> changes;
+    changes.reserve(updates.size() + removals.size());
+    for(const auto& update : updates) {
+        changes.emplace_back(update.first, update.second);
+    }
+    for(const auto& removal : removals) {
+        changes.emplace_back(removal, std::nullopt);
+    }
+    // a removal sorts before an update of the same key, and wins.
+    std::stable_sort(changes.begin(), changes.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first || (lhs.first == rhs.first && !lhs.second.has_value() && rhs.second.has_value());
+    });
+
+    auto new_table = std::make_shared<Table>();
+    new_table->keys.reserve(table->keys.size());
+    new_table->key_ends.reserve(size() + updates.size());
+    new_table->shards.reserve(size() + updates.size());
+    auto append = [&new_table](const std::string_view& key, uint32_t shard_index) {
+        new_table->keys.append(key);
+        new_table->key_ends.push_back(new_table->keys.size());
+        new_table->shards.push_back(shard_index);
+    };
+    std::size_t pos = 0;
+    auto change = changes.cbegin();
+    while(change != changes.cend()) {
+        const std::string_view key = change->first;
+        while(pos < size() && key_at(pos) < key) {
+            append(key_at(pos), shard_at(pos));
+            pos++;
+        }
+        if(pos < size() && key_at(pos) == key) {
+            pos++;
+        }
+        if(change->second.has_value()) {
+            append(key, change->second.value());
+        }
+        // skip the other changes of the same key.
+        while(change != changes.cend() && change->first == key) {
+            change++;
+        }
+    }
+    while(pos < size()) {
+        append(key_at(pos), shard_at(pos));
+        pos++;
+    }
+    return ObjectLocations(std::move(new_table));
+}
+
+std::unordered_map<std::string, uint32_t> ObjectLocations::to_map() const {
+    std::unordered_map<std::string, uint32_t> locations;
+    locations.reserve(size());
+    for(std::size_t pos = 0; pos < size(); pos++) {
+        locations.emplace(key_at(pos), shard_at(pos));
+    }
+    return locations;
+}
+
+/*
+ * The serialized format is:
+ * [uint64_t count][uint64_t keys size][uint64_t key_ends[count]][uint32_t shards[count]][keys]
+ */
+std::size_t ObjectLocations::to_bytes(uint8_t* v) const {
+    const uint64_t header[2] = {size(), table->keys.size()};
+    std::size_t offset = 0;
+    memcpy(v + offset, header, sizeof(header));
+    offset += sizeof(header);
+    if(!empty()) {
+        memcpy(v + offset, table->key_ends.data(), size() * sizeof(uint64_t));
+        offset += size() * sizeof(uint64_t);
+        memcpy(v + offset, table->shards.data(), size() * sizeof(uint32_t));
+        offset += size() * sizeof(uint32_t);
+    }
+    memcpy(v + offset, table->keys.data(), table->keys.size());
+    offset += table->keys.size();
+    return offset;
+}
+
+std::size_t ObjectLocations::bytes_size() const {
+    return 2 * sizeof(uint64_t) + size() * (sizeof(uint64_t) + sizeof(uint32_t)) + table->keys.size();
+}
+
+void ObjectLocations::post_object(const std::function<void(uint8_t const* const, std::size_t)>& f) const {
+    const uint64_t header[2] = {size(), table->keys.size()};
+    f(reinterpret_cast<const uint8_t*>(header), sizeof(header));
+    f(reinterpret_cast<const uint8_t*>(table->key_ends.data()), size() * sizeof(uint64_t));
+    f(reinterpret_cast<const uint8_t*>(table->shards.data()), size() * sizeof(uint32_t));
+    f(reinterpret_cast<const uint8_t*>(table->keys.data()), table->keys.size());
+}
+
+ObjectLocations* ObjectLocations::deserialize(const uint8_t* const v) {
+    uint64_t header[2];
+    memcpy(header, v, sizeof(header));
+    const uint64_t count = header[0];
+    const uint64_t keys_size = header[1];
+    // a corrupted header must not overflow the offsets below.
+    const uint64_t max_count = (std::numeric_limits<std::size_t>::max() - sizeof(header)) / (sizeof(uint64_t) + sizeof(uint32_t));
+    if(count > max_count || keys_size > std::numeric_limits<std::size_t>::max() - sizeof(header) - count * (sizeof(uint64_t) + sizeof(uint32_t))) {
+        throw derecho::derecho_exception("Corrupted object locations: " + std::to_string(count) + " keys of "
+                                         + std::to_string(keys_size) + " bytes.");
+    }
+    auto new_table = std::make_shared<Table>();
+    new_table->key_ends.resize(count);
+    new_table->shards.resize(count);
+    std::size_t offset = sizeof(header);
+    if(count > 0) {
+        memcpy(new_table->key_ends.data(), v + offset, count * sizeof(uint64_t));
+        offset += count * sizeof(uint64_t);
+        memcpy(new_table->shards.data(), v + offset, count * sizeof(uint32_t));
+        offset += count * sizeof(uint32_t);
+    }
+    new_table->keys.assign(reinterpret_cast<const char*>(v + offset), keys_size);
+    // the key offsets must stay in the key buffer, and the keys must be in ascending order for the binary search.
+    uint64_t begin = 0;
+    for(uint64_t pos = 0; pos < count; pos++) {
+        if(new_table->key_ends[pos] < begin || new_table->key_ends[pos] > keys_size) {
+            throw derecho::derecho_exception("Corrupted object locations: key " + std::to_string(pos)
+                                             + " ends at " + std::to_string(new_table->key_ends[pos]) + ".");
+        }
+        begin = new_table->key_ends[pos];
+    }
+    if(begin != keys_size) {
+        throw derecho::derecho_exception("Corrupted object locations: the keys end at " + std::to_string(begin)
+                                         + " of " + std::to_string(keys_size) + " bytes.");
+    }
+    ObjectLocations locations(std::move(new_table));
+    for(std::size_t pos = 1; pos < locations.size(); pos++) {
+        if(!(locations.key_at(pos - 1) < locations.key_at(pos))) {
+            throw derecho::derecho_exception("Corrupted object locations: the keys are not in ascending order.");
+        }
+    }
+    return new ObjectLocations(locations);
+}
+
+std::unique_ptr<ObjectLocations> ObjectLocations::from_bytes(mutils::DeserializationManager*, const uint8_t* const v) {
+    return std::unique_ptr<ObjectLocations>{deserialize(v)};
+}
+
+mutils::context_ptr<ObjectLocations> ObjectLocations::from_bytes_noalloc(mutils::DeserializationManager*, const uint8_t* const v) {
+    return mutils::context_ptr<ObjectLocations>{deserialize(v)};
+}
+
+mutils::context_ptr<const ObjectLocations> ObjectLocations::from_bytes_noalloc_const(mutils::DeserializationManager*, const uint8_t* const v) {
+    return mutils::context_ptr<const ObjectLocations>{deserialize(v)};
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -3,6 +3,8 @@
 #include <string>
 #include <fstream>
 #include <typeindex>
+#include <thread>
+#include <atomic>
 #include <stdio.h>
 #include <readline/readline.h>
 #include <readline/history.h>
@@ -47,6 +49,8 @@ static const char* policy_names[] = {
     "FixedRandom",
     "RoundRobin",
     "UserSpecified",
+    "LeastOutstanding",
+    "LatencyEWMA",
     nullptr
 };
 
@@ -238,6 +242,33 @@ void op_put_file_and_forget(ServiceClientAPI& capi, const std::string& key, cons
     std::cout << "put done." << std::endl;
 }
 
+void op_put_stream(ServiceClientAPI& capi, const std::string& key, const std::string& filename, std::size_t chunk_size) {
+    std::ifstream value_file(filename,std::ios::binary);
+    if(!value_file.good()) {
+        dbg_default_error("Cannot open file:{} for read.", filename);
+        throw std::runtime_error("Cannot open file:" + filename + "for read");
+    }
+    stream_reader_t reader = [&value_file] (uint8_t* buffer, std::size_t size) {
+        value_file.read(reinterpret_cast<char*>(buffer),size);
+        return static_cast<std::size_t>(value_file.gcount());
+    };
+    auto ret = capi.template put_stream<ObjectWithStringKey>(key,reader,chunk_size);
+    std::cout << "put_stream done with version:" << std::get<0>(ret) << ",ts_us:" << std::get<1>(ret) << std::endl;
+}
+
+void op_get_stream(ServiceClientAPI& capi, const std::string& key, const std::string& filename, std::size_t offset, std::size_t length) {
+    std::ofstream value_file(filename,std::ios::binary|std::ios::trunc);
+    if(!value_file.good()) {
+        dbg_default_error("Cannot open file:{} for write.", filename);
+        throw std::runtime_error("Cannot open file:" + filename + "for write");
+    }
+    stream_writer_t writer = [&value_file] (const uint8_t* buffer, std::size_t size) {
+        value_file.write(reinterpret_cast<const char*>(buffer),size);
+    };
+    std::size_t size = capi.get_stream(key,writer,CURRENT_VERSION,true,offset,length);
+    std::cout << "get_stream done with " << size << " bytes." << std::endl;
+}
+
 template <typename SubgroupType>
 void create_object_pool(ServiceClientAPI& capi, const std::string& id, uint32_t subgroup_index) {
     auto result = capi.template create_object_pool<SubgroupType>(id,subgroup_index);
@@ -648,6 +679,112 @@ bool perftest_ordered_put<TriggerCascadeNoStoreWithStringKey>(ServiceClientAPI &
     return false;
 }
 
+/**
+ * Measure how the throughput of this client scales with the number of application threads. For 1, 2, 4, ... and
+ * max_threads threads, each thread sends a put or get request to the object pool and waits for its reply before sending
+ * the next one, for duration_sec seconds. It prints the throughput with each number of threads; the requests of the
+ * threads are serialized when they go to the same node.
+ */
+bool perftest_threads(ServiceClientAPI& capi,
+                      const std::string& op,
+                      const std::string& object_pool_pathname,
+                      uint32_t message_size,
+                      uint32_t max_threads,
+                      uint64_t duration_sec) {
+    debug_enter_func_with_args("op={},object_pool_pathname={},message_size={},max_threads={},duration_sec={}",
+                               op,object_pool_pathname,message_size,max_threads,duration_sec);
+    if (op != "put" && op != "get") {
+        print_red("Unknown operation:" + op);
+        return false;
+    }
+    if (max_threads == 0) {
+        max_threads = std::thread::hardware_concurrency();
+    }
+    const std::string value(message_size,'x');
+    auto key_of = [&object_pool_pathname](uint32_t thread_index, uint64_t i) {
+        return object_pool_pathname + "/perftest_threads_" + std::to_string(thread_index) + "_"
+               + std::to_string(i % PERFTEST_THREADS_KEYS_PER_THREAD);
+    };
+    // the get test reads the objects written here.
+    if (op == "get") {
+        for (uint32_t thread_index = 0; thread_index < max_threads; thread_index ++) {
+            for (uint64_t i = 0; i < PERFTEST_THREADS_KEYS_PER_THREAD; i ++) {
+                ObjectWithStringKey obj;
+                obj.key = key_of(thread_index,i);
+                obj.blob = Blob(reinterpret_cast<const uint8_t*>(value.c_str()),value.length());
+                auto result = capi.put(obj);
+                for (auto& reply_future:result.get()) {
+                    reply_future.second.get();
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+        thread_counts.push_back(num_threads);
+    }
+    thread_counts.push_back(max_threads);
+    double single_thread_ops = 0.0;
+    bool ret = true;
+    for (uint32_t num_threads : thread_counts) {
+        std::vector<uint64_t> ops(num_threads,0);
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> threads;
+        const uint64_t end_ns = get_walltime() + duration_sec*1000000000ull;
+        for (uint32_t thread_index = 0; thread_index < num_threads; thread_index ++) {
+            threads.emplace_back([&,thread_index](){
+                ObjectWithStringKey obj;
+                obj.blob = Blob(reinterpret_cast<const uint8_t*>(value.c_str()),value.length());
+                uint64_t thread_ops = 0;
+                try {
+                    while (get_walltime() < end_ns) {
+                        if (op == "put") {
+                            obj.key = key_of(thread_index,thread_ops);
+                            auto result = capi.put(obj);
+                            for (auto& reply_future:result.get()) {
+                                reply_future.second.get();
+                            }
+                        } else {
+                            auto result = capi.get(key_of(thread_index,thread_ops));
+                            for (auto& reply_future:result.get()) {
+                                reply_future.second.get();
+                            }
+                        }
+                        thread_ops ++;
+                    }
+                } catch (std::exception& ex) {
+                    print_red(std::string("perftest_threads failed:") + ex.what());
+                    failed.store(true);
+                }
+                // written once, to keep the counters of the threads off each other's cache lines while running.
+                ops[thread_index] = thread_ops;
+            });
+        }
+        for (auto& thread:threads) {
+            thread.join();
+        }
+        if (failed) {
+            ret = false;
+            break;
+        }
+        uint64_t total_ops = 0;
+        for (auto thread_ops:ops) {
+            total_ops += thread_ops;
+        }
+        const double ops_per_sec = static_cast<double>(total_ops)/duration_sec;
+        if (num_threads == 1) {
+            single_thread_ops = ops_per_sec;
+        }
+        std::cout << "threads:" << num_threads
+                  << "\tops/s:" << ops_per_sec
+                  << "\tspeedup:" << ((single_thread_ops > 0.0) ? ops_per_sec/single_thread_ops : 0.0)
+                  << std::endl;
+    }
+    debug_leave_func();
+    return ret;
+}
+
 template <typename SubgroupType>
 bool dump_timestamp(ServiceClientAPI &capi,
                     uint32_t subgroup_index,
@@ -699,7 +836,7 @@ ssize_t find_command(const std::vector<command_entry_t>& command_list, const std
 
 bool shell_is_active = true;
 #define SUBGROUP_TYPE_LIST "VCSS|PCSS|TCSS"
-#define SHARD_MEMBER_SELECTION_POLICY_LIST "FirstMember|LastMember|Random|FixedRandom|RoundRobin|UserSpecified"
+#define SHARD_MEMBER_SELECTION_POLICY_LIST "FirstMember|LastMember|Random|FixedRandom|RoundRobin|UserSpecified|LeastOutstanding|LatencyEWMA"
 #define CHECK_FORMAT(tks,argc) \
             if (tks.size() < argc) { \
                 print_red("Invalid command format. Please try help " + tks[0] + "."); \
@@ -970,6 +1107,37 @@ std::vector<command_entry_t> commands =
             return true;
         }
     },
+    {
+        "op_put_stream",
+        "Put a large object into an object pool as chunks, where object's value is from a file.",
+        "op_put_stream <key> <filename> [chunk_size(default:1MB)]\n"
+            "Please note that cascade automatically decides the object pool path using the key's prefix.",
+        [](ServiceClientAPI& capi, const std::vector<std::string>& cmd_tokens) {
+            std::size_t chunk_size = STREAM_DEFAULT_CHUNK_SIZE;
+            CHECK_FORMAT(cmd_tokens,3);
+            if (cmd_tokens.size() >= 4)
+                chunk_size = static_cast<std::size_t>(std::stoul(cmd_tokens[3],nullptr,0));
+            op_put_stream(capi,cmd_tokens[1]/*key*/,cmd_tokens[2]/*filename*/,chunk_size);
+            return true;
+        }
+    },
+    {
+        "op_get_stream",
+        "Get a range of an object put by op_put_stream into a file.",
+        "op_get_stream <key> <filename> [offset(default:0)] [length(default:all)]\n"
+            "Please note that cascade automatically decides the object pool path using the key's prefix.",
+        [](ServiceClientAPI& capi, const std::vector<std::string>& cmd_tokens) {
+            std::size_t offset = 0;
+            std::size_t length = std::numeric_limits<std::size_t>::max();
+            CHECK_FORMAT(cmd_tokens,3);
+            if (cmd_tokens.size() >= 4)
+                offset = static_cast<std::size_t>(std::stoul(cmd_tokens[3],nullptr,0));
+            if (cmd_tokens.size() >= 5)
+                length = static_cast<std::size_t>(std::stoul(cmd_tokens[4],nullptr,0));
+            op_get_stream(capi,cmd_tokens[1]/*key*/,cmd_tokens[2]/*filename*/,offset,length);
+            return true;
+        }
+    },
     {
         "trigger_put",
         "Trigger put an object to a shard.",
@@ -1072,6 +1240,23 @@ std::vector<command_entry_t> commands =
             return true;
         }
     },
+    {
+        "op_get_many",
+        "Get the latest objects of a list of keys, with one request per shard.",
+        "op_get_many <stable> <key1> [key2 key3 ...]\n"
+            "stable := 0|1  using stable data or not.\n"
+            "Please note that cascade automatically decides the object pool path using the key's prefix.",
+        [](ServiceClientAPI& capi, const std::vector<std::string>& cmd_tokens) {
+            CHECK_FORMAT(cmd_tokens,3);
+            bool stable = static_cast<bool>(std::stoi(cmd_tokens[1],nullptr,0));
+            std::vector<std::string> keys(cmd_tokens.cbegin()+2,cmd_tokens.cend());
+            auto values = capi.get_many(keys,CURRENT_VERSION,stable);
+            for (std::size_t i = 0; i < keys.size(); i++) {
+                std::cout << "key(" << keys[i] << ") value:" << values[i] << std::endl;
+            }
+            return true;
+        }
+    },
     {
         "get_by_time",
         "Get an object (by timestamp in microseconds).",
@@ -1580,6 +1765,21 @@ std::vector<command_entry_t> commands =
             return true;
         }
     },
+    {
+        "perftest_threads",
+        "Performance Test for concurrent requests from the threads of this client.",
+        "perftest_threads <op> <object pool pathname> <message_size> <max threads> <duration_sec>\n"
+            "op := put|get\n"
+            "'max threads' is the largest number of threads, 0 for the number of cores; the test runs with 1, 2, 4, ... and 'max threads' threads;\n"
+            "'duration_sec' is the span of the test with each number of threads",
+        [](ServiceClientAPI& capi, const std::vector<std::string>& cmd_tokens) {
+            CHECK_FORMAT(cmd_tokens,6);
+            uint32_t message_size = std::stoul(cmd_tokens[3],nullptr,0);
+            uint32_t max_threads = std::stoul(cmd_tokens[4],nullptr,0);
+            uint64_t duration_sec = std::stoul(cmd_tokens[5],nullptr,0);
+            return perftest_threads(capi,cmd_tokens[1],cmd_tokens[2],message_size,max_threads,duration_sec);
+        }
+    },
     {
         "dump_timestamp",
         "Dump timestamp for a given shard. Each node will write its timestamps to the given file.",
@@ -365,6 +365,12 @@ private:
             contents += std::to_string(std::get<1>(policy));
             contents += ")\n";
             break;
+        case LeastOutstanding:
+            contents += "LeastOutstanding\n";
+            break;
+        case LatencyEWMA:
+            contents += "LatencyEWMA\n";
+            break;
         default:
             contents += "Unknown\n";
             break;
@@ -565,6 +571,9 @@ private:
         case RANGE:
             objp_contents += "Range\n";
             break;
+        case VIRTUAL:
+            objp_contents += "Virtual shards\n";
+            break;
         default:
             objp_contents += "Unknown\n";
             break;
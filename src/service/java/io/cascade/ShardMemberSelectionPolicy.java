@@ -13,6 +13,8 @@ public enum ShardMemberSelectionPolicy {
     FixedRandom(3), // use a random member and stick to that for the following operations.
     RoundRobin(4), // use a member in round-robin order.
     UserSpecified(5), // user specify which member to contact.
+    LeastOutstanding(6), // use the member with the fewest outstanding requests.
+    LatencyEWMA(7), // use the member with the lowest expected latency.
     InvalidPolicy(-1);
 
     private int value;
@@ -238,6 +238,12 @@ JNIEXPORT jobject JNICALL Java_io_cascade_Client_getMemberSelectionPolicy(JNIEnv
     case derecho::cascade::ShardMemberSelectionPolicy::UserSpecified:
         java_policy_str = "UserSpecified";
         break;
+    case derecho::cascade::ShardMemberSelectionPolicy::LeastOutstanding:
+        java_policy_str = "LeastOutstanding";
+        break;
+    case derecho::cascade::ShardMemberSelectionPolicy::LatencyEWMA:
+        java_policy_str = "LatencyEWMA";
+        break;
     case derecho::cascade::ShardMemberSelectionPolicy::InvalidPolicy:
         java_policy_str = "InvalidPolicy";
         break;
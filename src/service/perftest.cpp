@@ -5,7 +5,6 @@
 #include <derecho/core/detail/rpc_utils.hpp>
 #include <type_traits>
 #include <optional>
-#include <queue>
 #include <derecho/utils/time.h>
 #include <unistd.h>
 #include <fstream>
@@ -28,68 +27,14 @@ namespace cascade {
         throw derecho::derecho_exception(std::string("Unknown type_index:") + tindex.name()); \
     }
 
-#define on_subgroup_type_index_with_return(tindex, result_handler, func, ...) \
-    if (std::type_index(typeid(VolatileCascadeStoreWithStringKey)) == tindex) { \
-        result_handler(func <VolatileCascadeStoreWithStringKey>(__VA_ARGS__)); \
-    } else if (std::type_index(typeid(PersistentCascadeStoreWithStringKey)) == tindex) { \
-        result_handler(func <PersistentCascadeStoreWithStringKey>(__VA_ARGS__)); \
-    } else if (std::type_index(typeid(TriggerCascadeNoStoreWithStringKey)) == tindex) { \
-        result_handler(func <TriggerCascadeNoStoreWithStringKey>(__VA_ARGS__)); \
-    } else { \
-        throw derecho::derecho_exception(std::string("Unknown type_index:") + tindex.name()); \
-    }
-
 bool PerfTestServer::eval_put(uint64_t max_operation_per_second,
                               uint64_t duration_secs,
                               uint32_t subgroup_type_index,
                               uint32_t subgroup_index,
                               uint32_t shard_index) {
-        // synchronization data structures
-        // 1 - sending window and future queue
-        uint32_t                window_size = derecho::getConfUInt32(CONF_DERECHO_P2P_WINDOW_SIZE);
-        uint32_t                window_slots = window_size*2;
-        std::mutex              window_slots_mutex;
-        std::condition_variable window_slots_cv;
-        std::queue<std::pair<uint64_t,derecho::QueryResults<std::tuple<persistent::version_t,uint64_t>>>> futures;
-        std::mutex                                                                                        futures_mutex;
-        std::condition_variable                                                                           futures_cv;
-        std::condition_variable                                                                           window_cv;
-        // 3 - all sent flag
-        std::atomic<bool>                                   all_sent(false);
-        // 4 - query thread
-        std::thread                                         query_thread(
-            [&window_slots,&window_slots_mutex,&window_slots_cv,&futures,&futures_mutex,&futures_cv,&all_sent](){
-                std::unique_lock<std::mutex> futures_lck{futures_mutex};
-                while(!all_sent || (futures.size()>0)) {
-                    // pick pending futures
-                    using namespace std::chrono_literals;
-                    while(!futures_cv.wait_for(futures_lck,500ms,[&futures,&all_sent]{return (futures.size() > 0) || all_sent;}));
-                    std::decay_t<decltype(futures)> pending_futures;
-                    futures.swap(pending_futures);
-                    futures_lck.unlock();
-                    //+---------------------------------------+
-                    //|             QUEUE UNLOCKED            |
-                    // waiting for futures with lock released.
-                    while (pending_futures.size() > 0) {
-                        auto& replies = pending_futures.front().second.get();
-                        for (auto& reply: replies) {
-                            std::get<0>(reply.second.get());
-                            break;
-                        }
-                        pending_futures.pop();
-                        {
-                            std::lock_guard<std::mutex> window_slots_lock{window_slots_mutex};
-                            window_slots ++;
-                        }
-                        window_slots_cv.notify_one();
-                    }
-                    //|            QUEUE UNLOCKED             |
-                    //+---------------------------------------+
-                    // Acquire LOCK
-                    futures_lck.lock();
-                }
-            }
-        );
+        // the asynchronous pipeline keeps the sending window, and waits for the replies.
+        uint32_t window_size = derecho::getConfUInt32(CONF_DERECHO_P2P_WINDOW_SIZE);
+        this->capi.set_async_pipeline(window_size*2);
 
         //TODO: control read_write_ratio
         uint64_t interval_ns = (max_operation_per_second==0)?0:static_cast<uint64_t>(1e9/max_operation_per_second);
@@ -99,27 +44,13 @@ bool PerfTestServer::eval_put(uint64_t max_operation_per_second,
         while(true) {
             uint64_t now_ns = get_walltime();
             if (now_ns > end_ns) {
-                all_sent.store(true);
                 break;
             }
             // we leave 500 ns for loop overhead.
             if (now_ns + 500 < next_ns) {
                 usleep((next_ns - now_ns - 500)/1000); // sleep in microseconds.
             }
-            {
-                std::unique_lock<std::mutex> window_slots_lock{window_slots_mutex};
-                window_slots_cv.wait(window_slots_lock,[&window_slots]{return (window_slots > 0);});
-                window_slots --;
-            }
             next_ns += interval_ns;
-            std::function<void(QueryResults<std::tuple<persistent::version_t,uint64_t>>&&)> future_appender = 
-                [&futures,&futures_mutex,&futures_cv](QueryResults<std::tuple<persistent::version_t,uint64_t>>&& query_results){
-                    std::unique_lock<std::mutex> lock{futures_mutex};
-                    uint64_t timestamp_ns = get_walltime();
-                    futures.emplace(timestamp_ns,std::move(query_results));
-                    lock.unlock();
-                    futures_cv.notify_one();
-                };
             // set message id.
             // constexpr does not work in non-template functions.
             if (std::is_base_of<IHasMessageID,std::decay_t<decltype(objects[0])>>::value) {
@@ -128,20 +59,20 @@ bool PerfTestServer::eval_put(uint64_t max_operation_per_second,
                 throw derecho_exception{"Evaluation requests an object to support IHasMessageID interface."};
             }
             global_timestamp_logger.log(TLT_READY_TO_SEND,this->capi.get_my_id(),message_id,get_walltime());
+            // put_async waits for a slot in the window of the shard.
             if (subgroup_index == INVALID_SUBGROUP_INDEX ||
                 shard_index == INVALID_SHARD_INDEX) {
-                future_appender(this->capi.put(objects.at(now_ns%NUMBER_OF_DISTINCT_OBJECTS)));
+                this->capi.put_async(objects.at(now_ns%NUMBER_OF_DISTINCT_OBJECTS));
             } else {
-                on_subgroup_type_index_with_return(
+                on_subgroup_type_index(
                     std::decay_t<decltype(capi)>::subgroup_type_order.at(subgroup_type_index),
-                    future_appender,
-                    this->capi.template put, objects.at(now_ns%NUMBER_OF_DISTINCT_OBJECTS), subgroup_index, shard_index);
+                    this->capi.template put_async, objects.at(now_ns%NUMBER_OF_DISTINCT_OBJECTS), subgroup_index, shard_index);
             }
             global_timestamp_logger.log(TLT_EC_SENT,this->capi.get_my_id(),message_id,get_walltime());
             message_id ++;
         }
-        // wait for all pending futures.
-        query_thread.join();
+        // wait for all pending operations.
+        this->capi.wait_for_async_operations();
         return true;
 }
 
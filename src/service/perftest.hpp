@@ -12,6 +12,7 @@ namespace cascade {
 
 #define PERFTEST_PORT               (18720)
 #define NUMBER_OF_DISTINCT_OBJECTS  (4096)
+#define PERFTEST_THREADS_KEYS_PER_THREAD    (64)
 #define INVALID_SUBGROUP_INDEX      (std::numeric_limits<uint32_t>::max())
 #define INVALID_SHARD_INDEX         (std::numeric_limits<uint32_t>::max())
 
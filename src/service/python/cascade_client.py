@@ -78,6 +78,8 @@ class CascadeClientShell(cmd.Cmd):
                         FixedRandom
                         RoundRobin
                         UserSpecified
+                        LeastOutstanding
+                        LatencyEWMA
         node_id:        if policy is 'UserSpecified', you need to specify the corresponding node id.
         '''
         self.check_capi()
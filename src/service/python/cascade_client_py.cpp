@@ -46,6 +46,8 @@ static const char* policy_names[] = {
         "FixedRandom",
         "RoundRobin",
         "UserSpecified",
+        "LeastOutstanding",
+        "LatencyEWMA",
         nullptr};
 
 /**
@@ -399,11 +401,14 @@ auto get_object_pool(ServiceClientAPI& capi, const std::string& object_pool_path
     opm["subgroup_index"] = py::int_(copm.subgroup_index);
     opm["sharding_policy"] = py::int_(static_cast<int>(copm.sharding_policy));
     py::dict object_locations;
-    for(const auto& kv : copm.object_locations) {
-        object_locations[py::str(kv.first)] = kv.second;
+    for(std::size_t pos = 0; pos < copm.object_locations.size(); pos++) {
+        object_locations[py::str(std::string(copm.object_locations.key_at(pos)))] = copm.object_locations.shard_at(pos);
     }
     opm["object_locations"] = object_locations;
     opm["deleted"] = py::bool_(copm.deleted);
+    opm["key_hash_algorithm"] = py::int_(static_cast<int>(copm.key_hash_algorithm));
+    opm["key_hash_seed"] = py::int_(copm.key_hash_seed);
+    opm["num_shards"] = py::int_(copm.num_shards);
     return opm;
 }
 
@@ -987,6 +992,27 @@ PYBIND11_MODULE(member_client, m) {
                     "\t@arg2    subgroup_index \n"
                     "\t@return  a future of the (version,timestamp)"
             )
+            .def(
+                    "set_hedged_read_policy",
+                    [](ServiceClientAPI_PythonWrapper& capi, bool enable, double percentile, uint64_t min_delay_us) {
+                        capi.ref.set_hedged_read_policy(enable, percentile, min_delay_us);
+                    },
+                    "Enable or disable hedged get/get_size. \n"
+                    "\t@arg0    enable \n"
+                    "\t@arg1    the latency percentile after which the read is sent to another shard member \n"
+                    "\t@arg2    the minimal delay in microseconds before sending it")
+            .def(
+                    "get_hedged_read_stats",
+                    [](ServiceClientAPI_PythonWrapper& capi) {
+                        auto stats = capi.ref.get_hedged_read_stats();
+                        py::dict ret;
+                        ret["reads"] = py::int_(stats.reads);
+                        ret["hedges"] = py::int_(stats.hedges);
+                        ret["hedge_wins"] = py::int_(stats.hedge_wins);
+                        return ret;
+                    },
+                    "Get the hedged read counters. \n"
+                    "\t@return  a dict with the number of hedged reads, duplicate reads, and reads won by the duplicate.")
             .def(
                     "list_object_pools",
                     [](ServiceClientAPI_PythonWrapper& capi) {
@@ -1001,7 +1027,17 @@ PYBIND11_MODULE(member_client, m) {
                     },
                     "Get an object pool by pathname. \n"
                     "\t@arg0    object pool pathname \n"
-                    "\t@return  object pool details.");
+                    "\t@return  object pool details.")
+            .def_static(
+                    "key_hash",
+                    [](const std::string& key, uint32_t algorithm, uint64_t seed) {
+                        return key_hash(static_cast<key_hash_algorithm_t>(algorithm), seed, key);
+                    },
+                    "Hash a key as the HASH and VIRTUAL sharding policies do. \n"
+                    "\t@arg0    key \n"
+                    "\t@arg1    key hash algorithm, the 'key_hash_algorithm' of the object pool \n"
+                    "\t@arg2    key hash seed, the 'key_hash_seed' of the object pool \n"
+                    "\t@return  the 64-bit key hash.");
 
     py::class_<QueryResultsStore<std::tuple<persistent::version_t, uint64_t>, std::vector<long>>>(m, "QueryResultsStoreVerTmeStmp")
             .def(
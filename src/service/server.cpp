@@ -25,17 +25,24 @@ int main(int argc, char** argv) {
     CascadeServiceCDPO<PersistentCascadeStoreWithStringKey> cdpo_pcss;
     CascadeServiceCDPO<TriggerCascadeNoStoreWithStringKey> cdpo_tcss;
 
-    auto meta_factory = [](persistent::PersistentRegistry* pr, derecho::subgroup_id_t, ICascadeContext* context_ptr) {
-        // critical data path for metadata service is currently disabled. But we can leverage it later for object pool
-        // metadata handling.
+    MetadataChangePublisher<VolatileCascadeStoreWithStringKey, PersistentCascadeStoreWithStringKey, TriggerCascadeNoStoreWithStringKey> metadata_publisher;
+
+    // the critical data paths of the stores push the changes of the keys to the clients caching them, before the
+    // CDPOs above.
+    CacheInvalidationPublisher<VolatileCascadeStoreWithStringKey, VolatileCascadeStoreWithStringKey, PersistentCascadeStoreWithStringKey, TriggerCascadeNoStoreWithStringKey> cache_publisher_vcss(&cdpo_vcss);
+    CacheInvalidationPublisher<PersistentCascadeStoreWithStringKey, VolatileCascadeStoreWithStringKey, PersistentCascadeStoreWithStringKey, TriggerCascadeNoStoreWithStringKey> cache_publisher_pcss(&cdpo_pcss);
+
+    auto meta_factory = [&metadata_publisher](persistent::PersistentRegistry* pr, derecho::subgroup_id_t, ICascadeContext* context_ptr) {
+        // the critical data path of the metadata service pushes the object pool metadata changes to the subscribed
+        // clients.
         return std::make_unique<CascadeMetadataService<VolatileCascadeStoreWithStringKey, PersistentCascadeStoreWithStringKey, TriggerCascadeNoStoreWithStringKey>>(
-                pr, nullptr, context_ptr);
+                pr, &metadata_publisher, context_ptr);
     };
-    auto vcss_factory = [&cdpo_vcss](persistent::PersistentRegistry*, derecho::subgroup_id_t, ICascadeContext* context_ptr) {
-        return std::make_unique<VolatileCascadeStoreWithStringKey>(&cdpo_vcss, context_ptr);
+    auto vcss_factory = [&cache_publisher_vcss](persistent::PersistentRegistry*, derecho::subgroup_id_t, ICascadeContext* context_ptr) {
+        return std::make_unique<VolatileCascadeStoreWithStringKey>(&cache_publisher_vcss, context_ptr);
     };
-    auto pcss_factory = [&cdpo_pcss](persistent::PersistentRegistry* pr, derecho::subgroup_id_t, ICascadeContext* context_ptr) {
-        return std::make_unique<PersistentCascadeStoreWithStringKey>(pr, &cdpo_pcss, context_ptr);
+    auto pcss_factory = [&cache_publisher_pcss](persistent::PersistentRegistry* pr, derecho::subgroup_id_t, ICascadeContext* context_ptr) {
+        return std::make_unique<PersistentCascadeStoreWithStringKey>(pr, &cache_publisher_pcss, context_ptr);
     };
     auto tcss_factory = [&cdpo_tcss](persistent::PersistentRegistry*, derecho::subgroup_id_t, ICascadeContext* context_ptr) {
         return std::make_unique<TriggerCascadeNoStoreWithStringKey>(&cdpo_tcss, context_ptr);
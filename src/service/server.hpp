@@ -60,9 +60,11 @@ class CascadeServiceCDPO : public CriticalDataPathObserver<CascadeType> {
             }
             // filter for normal put (put/put_and_forget)
             bool new_actions = false;
+            // the key hash is computed once here, and carried along with the actions.
+            const uint64_t key_hash_value = key_hash(key);
             {
                 auto shard_members = ctxt->get_service_client_ref().template get_shard_members<CascadeType>(sgidx, shidx);
-                bool icare = (shard_members[std::hash<std::string>{}(key) % shard_members.size()] == ctxt->get_service_client_ref().get_my_id());
+                bool icare = (shard_members[key_hash_value % shard_members.size()] == ctxt->get_service_client_ref().get_my_id());
                 for(auto& per_prefix : handlers) {
                     // per_prefix.first is the matching prefix
                     // per_prefix.second is a set of handlers
@@ -133,10 +135,11 @@ class CascadeServiceCDPO : public CriticalDataPathObserver<CascadeType> {
 #endif
                             value_ptr,
 #ifdef HAS_STATEFUL_UDL_SUPPORT
-                            std::get<4>(handler.second)  // outputs
+                            std::get<4>(handler.second),  // outputs
 #else
-                            std::get<3>(handler.second)  // outputs
+                            std::get<3>(handler.second),  // outputs
 #endif
+                            key_hash_value
                     );
 #ifdef HAS_STATEFUL_UDL_SUPPORT
                     ctxt->post(std::move(action), std::get<1>(handler.second), is_trigger);
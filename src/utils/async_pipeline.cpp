@@ -0,0 +1,137 @@
+#include <cascade/detail/async_pipeline.hpp>
+
+#include <algorithm>
+
+namespace derecho {
+namespace cascade {
+
+thread_local bool AsyncPipeline::in_completion_thread = false;
+
+AsyncPipeline::AsyncPipeline() : window_size(ASYNC_PIPELINE_DEFAULT_WINDOW_SIZE),
+                                 num_completion_threads(ASYNC_PIPELINE_DEFAULT_COMPLETION_THREADS),
+                                 total_in_flight(0),
+                                 completion_threads_running(false) {}
+
+AsyncPipeline::~AsyncPipeline() {
+    {
+        std::lock_guard<std::mutex> lck(pending_mutex);
+        completion_threads_running = false;
+    }
+    pending_cv.notify_all();
+    // the completion threads complete the pending operations before they stop.
+    for(auto& thread : completion_threads) {
+        thread.join();
+    }
+}
+
+void AsyncPipeline::set_config(std::size_t _window_size, uint32_t completion_threads) {
+    if(_window_size == 0 || completion_threads == 0) {
+        throw derecho::derecho_exception("Invalid asynchronous pipeline configuration, window size:"
+                                         + std::to_string(_window_size)
+                                         + ", completion threads:" + std::to_string(completion_threads));
+    }
+    {
+        std::lock_guard<std::mutex> lck(pending_mutex);
+        if(completion_threads_running && completion_threads != num_completion_threads) {
+            throw derecho::derecho_exception("Cannot change the number of completion threads once they are started.");
+        }
+        num_completion_threads = completion_threads;
+    }
+    std::lock_guard<std::mutex> lck(windows_mutex);
+    window_size = _window_size;
+    for(auto& shard_window : windows) {
+        shard_window.second->cv.notify_all();
+    }
+}
+
+std::size_t AsyncPipeline::get_window_size() const {
+    std::lock_guard<std::mutex> lck(windows_mutex);
+    return window_size;
+}
+
+std::size_t AsyncPipeline::get_in_flight() const {
+    std::lock_guard<std::mutex> lck(windows_mutex);
+    return total_in_flight;
+}
+
+void AsyncPipeline::wait_all() {
+    std::unique_lock<std::mutex> lck(windows_mutex);
+    drained_cv.wait(lck, [this] { return total_in_flight == 0; });
+}
+
+AsyncPipeline::Window* AsyncPipeline::acquire(const shard_key_t& shard) {
+    std::unique_lock<std::mutex> lck(windows_mutex);
+    auto& window = windows[shard];
+    if(!window) {
+        window = std::make_unique<Window>();
+    }
+    if(!in_completion_thread) {
+        window->cv.wait(lck, [this, &window] { return window->in_flight < window_size; });
+    }
+    window->in_flight++;
+    total_in_flight++;
+    return window.get();
+}
+
+void AsyncPipeline::release(Window* window) {
+    std::lock_guard<std::mutex> lck(windows_mutex);
+    window->in_flight--;
+    total_in_flight--;
+    window->cv.notify_one();
+    if(total_in_flight == 0) {
+        drained_cv.notify_all();
+    }
+}
+
+void AsyncPipeline::enqueue(std::unique_ptr<Operation>&& operation) {
+    {
+        std::lock_guard<std::mutex> lck(pending_mutex);
+        pending.emplace_back(std::move(operation));
+        if(!completion_threads_running) {
+            completion_threads_running = true;
+            for(uint32_t i = 0; i < num_completion_threads; i++) {
+                completion_threads.emplace_back(&AsyncPipeline::run_completions, this);
+            }
+        }
+    }
+    pending_cv.notify_one();
+}
+
+std::unique_ptr<AsyncPipeline::Operation> AsyncPipeline::take_ready() {
+    for(auto it = pending.begin(); it != pending.end(); it++) {
+        if((*it)->is_ready()) {
+            auto operation = std::move(*it);
+            pending.erase(it);
+            return operation;
+        }
+    }
+    return nullptr;
+}
+
+void AsyncPipeline::run_completions() {
+    in_completion_thread = true;
+    uint64_t poll_us = ASYNC_PIPELINE_MIN_POLL_US;
+    std::unique_lock<std::mutex> lck(pending_mutex);
+    while(true) {
+        pending_cv.wait(lck, [this] { return !pending.empty() || !completion_threads_running; });
+        if(pending.empty()) {
+            break;
+        }
+        auto operation = take_ready();
+        if(!operation) {
+            // a new operation wakes the thread up, because it may be ready already.
+            pending_cv.wait_for(lck, std::chrono::microseconds(poll_us));
+            poll_us = std::min<uint64_t>(poll_us * 2, ASYNC_PIPELINE_MAX_POLL_US);
+            continue;
+        }
+        poll_us = ASYNC_PIPELINE_MIN_POLL_US;
+        // call the completion callback without holding the lock.
+        lck.unlock();
+        operation->complete();
+        release(operation->window);
+        lck.lock();
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,199 @@
+#include <cascade/detail/epoch_manager.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <pthread.h>
+
+namespace derecho {
+namespace cascade {
+
+/**
+ * Owns the record of a thread and gives it back when the thread exits.
+ */
+struct ThreadRecordOwner {
+    EpochManager::ThreadRecord* record = nullptr;
+    ~ThreadRecordOwner() {
+        if(record != nullptr) {
+            EpochManager::get().release_thread_record(record);
+        }
+    }
+};
+
+static thread_local ThreadRecordOwner thread_record_owner;
+
+EpochManager::EpochManager() : global_epoch(1),
+                               thread_records(nullptr),
+                               orphaned_bytes(0),
+                               num_retired(0),
+                               reclaimer_stopped(false) {}
+
+EpochManager::~EpochManager() {
+    {
+        std::lock_guard<std::mutex> lck(reclaimer_mutex);
+        reclaimer_stopped = true;
+    }
+    reclaimer_cv.notify_all();
+    if(reclaimer.joinable()) {
+        reclaimer.join();
+    }
+    ThreadRecord* record = thread_records.load(std::memory_order_acquire);
+    while(record != nullptr) {
+        ThreadRecord* next = record->next;
+        delete record;
+        record = next;
+    }
+}
+
+EpochManager& EpochManager::get() {
+    static EpochManager epoch_manager;
+    return epoch_manager;
+}
+
+EpochManager::ThreadRecord* EpochManager::get_thread_record() {
+    if(thread_record_owner.record != nullptr) {
+        return thread_record_owner.record;
+    }
+    // reuse the record of an exited thread.
+    for(ThreadRecord* record = thread_records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        bool expected = false;
+        if(record->in_use.compare_exchange_strong(expected, true)) {
+            thread_record_owner.record = record;
+            return record;
+        }
+    }
+    ThreadRecord* record = new ThreadRecord();
+    record->in_use.store(true, std::memory_order_relaxed);
+    record->next = thread_records.load(std::memory_order_relaxed);
+    while(!thread_records.compare_exchange_weak(record->next, record, std::memory_order_acq_rel)) {
+    }
+    thread_record_owner.record = record;
+    return record;
+}
+
+void EpochManager::release_thread_record(ThreadRecord* record) {
+    record->epoch.store(0, std::memory_order_release);
+    record->pin_depth = 0;
+    std::unique_lock<std::mutex> retired_lck(record->retired_mutex);
+    if(!record->retired_objects.empty()) {
+        std::lock_guard<std::mutex> lck(orphaned_objects_mutex);
+        std::move(record->retired_objects.begin(), record->retired_objects.end(), std::back_inserter(orphaned_objects));
+        orphaned_bytes += record->retired_bytes;
+        record->retired_objects.clear();
+        record->retired_bytes = 0;
+    }
+    retired_lck.unlock();
+    record->in_use.store(false, std::memory_order_release);
+}
+
+uint64_t EpochManager::oldest_pinned_epoch() const {
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for(ThreadRecord* record = thread_records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        uint64_t epoch = record->epoch.load(std::memory_order_acquire);
+        if(epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
+
+size_t EpochManager::reclaim_list(retired_list_t& retired_objects, size_t& retired_bytes) {
+    // A reader pinning the new epoch starts after the objects in the list were unlinked.
+    global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const uint64_t oldest = oldest_pinned_epoch();
+    const size_t before = retired_objects.size();
+    auto it = std::remove_if(retired_objects.begin(), retired_objects.end(),
+                             [oldest, &retired_bytes](const auto& retired) {
+                                 if(retired.first >= oldest) {
+                                     return false;
+                                 }
+                                 retired_bytes -= retired.second->bytes;
+                                 return true;
+                             });
+    retired_objects.erase(it, retired_objects.end());
+    const size_t reclaimed = before - retired_objects.size();
+    num_retired.fetch_sub(reclaimed, std::memory_order_relaxed);
+    return reclaimed;
+}
+
+void EpochManager::retire_object(std::unique_ptr<RetiredObject>&& obj) {
+    std::call_once(reclaimer_started, [this]() { reclaimer = std::thread(&EpochManager::run_reclaimer, this); });
+    ThreadRecord* record = get_thread_record();
+    std::lock_guard<std::mutex> retired_lck(record->retired_mutex);
+    // The caller has unlinked the object. Readers pinning an epoch later than this one cannot see it.
+    record->retired_bytes += obj->bytes;
+    record->retired_objects.emplace_back(global_epoch.load(std::memory_order_seq_cst), std::move(obj));
+    num_retired.fetch_add(1, std::memory_order_relaxed);
+    if(record->retired_objects.size() < EPOCH_RETIRE_BATCH_SIZE && record->retired_bytes < EPOCH_RETIRE_BATCH_BYTES) {
+        return;
+    }
+    reclaim_list(record->retired_objects, record->retired_bytes);
+    // the orphaned objects are picked up on the way, unless another thread is at it.
+    std::unique_lock<std::mutex> lck(orphaned_objects_mutex, std::try_to_lock);
+    if(lck.owns_lock() && !orphaned_objects.empty()) {
+        reclaim_list(orphaned_objects, orphaned_bytes);
+    }
+}
+
+size_t EpochManager::reclaim() {
+    ThreadRecord* record = get_thread_record();
+    size_t reclaimed = 0;
+    {
+        std::lock_guard<std::mutex> retired_lck(record->retired_mutex);
+        reclaimed = reclaim_list(record->retired_objects, record->retired_bytes);
+    }
+    std::lock_guard<std::mutex> lck(orphaned_objects_mutex);
+    return reclaimed + reclaim_list(orphaned_objects, orphaned_bytes);
+}
+
+size_t EpochManager::reclaim_all() {
+    size_t reclaimed = 0;
+    for(ThreadRecord* record = thread_records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        // a thread retiring an object reclaims its own objects if it needs to.
+        std::unique_lock<std::mutex> retired_lck(record->retired_mutex, std::try_to_lock);
+        if(retired_lck.owns_lock() && !record->retired_objects.empty()) {
+            reclaimed += reclaim_list(record->retired_objects, record->retired_bytes);
+        }
+    }
+    std::lock_guard<std::mutex> lck(orphaned_objects_mutex);
+    if(!orphaned_objects.empty()) {
+        reclaimed += reclaim_list(orphaned_objects, orphaned_bytes);
+    }
+    return reclaimed;
+}
+
+void EpochManager::run_reclaimer() {
+    pthread_setname_np(pthread_self(), "cs_reclaim");
+    std::unique_lock<std::mutex> lck(reclaimer_mutex);
+    while(!reclaimer_stopped) {
+        reclaimer_cv.wait_for(lck, std::chrono::milliseconds(EPOCH_RECLAIM_INTERVAL_MS));
+        if(reclaimer_stopped || num_retired.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        lck.unlock();
+        reclaim_all();
+        lck.lock();
+    }
+}
+
+size_t EpochManager::num_retired_objects() const {
+    return num_retired.load(std::memory_order_relaxed);
+}
+
+EpochManager::Guard::Guard() : record(EpochManager::get().get_thread_record()) {
+    if(record->pin_depth++ == 0) {
+        record->epoch.store(EpochManager::get().global_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        // The pin must be visible before we read any shared pointer.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+EpochManager::Guard::~Guard() {
+    if(--record->pin_depth == 0) {
+        record->epoch.store(0, std::memory_order_release);
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
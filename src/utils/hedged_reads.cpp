@@ -0,0 +1,146 @@
+#include <cascade/detail/hedged_reads.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <pthread.h>
+
+namespace derecho {
+namespace cascade {
+
+HedgedReads::HedgedReads() : enabled(false),
+                             percentile(HEDGED_READ_DEFAULT_PERCENTILE),
+                             min_delay_us(HEDGED_READ_DEFAULT_MIN_DELAY_US),
+                             next_sample(0),
+                             samples_since_update(0),
+                             delay_us(HEDGED_READ_INITIAL_DELAY_US),
+                             reads(0),
+                             hedges(0),
+                             hedge_wins(0),
+                             worker_running(false),
+                             worker_stopped(false) {}
+
+HedgedReads::~HedgedReads() {
+    std::priority_queue<Deadline, std::vector<Deadline>, LaterDeadline> unsent;
+    {
+        std::lock_guard<std::mutex> lck(deadlines_mutex);
+        worker_running = false;
+        worker_stopped = true;
+        unsent.swap(deadlines);
+    }
+    deadlines_cv.notify_all();
+    if(worker.joinable()) {
+        worker.join();
+    }
+    // the reads still in flight are failed by reply_watcher, when it is destroyed.
+    while(!unsent.empty()) {
+        unsent.top().second->abandon();
+        unsent.pop();
+    }
+}
+
+uint64_t HedgedReads::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+void HedgedReads::set_policy(bool enable, double _percentile, uint64_t _min_delay_us) {
+    if(enable && (_percentile <= 0.0 || _percentile > 100.0)) {
+        throw derecho::derecho_exception("Invalid hedged read percentile:" + std::to_string(_percentile));
+    }
+    {
+        std::lock_guard<std::mutex> lck(latency_mutex);
+        percentile = _percentile;
+        min_delay_us = _min_delay_us;
+        // recompute the delay on the next sample.
+        samples_since_update = HEDGED_READ_MIN_SAMPLES;
+    }
+    if(enable) {
+        std::lock_guard<std::mutex> lck(deadlines_mutex);
+        if(!worker_running && !worker_stopped) {
+            worker_running = true;
+            worker = std::thread(&HedgedReads::send_hedges, this);
+        }
+    }
+    // the worker keeps running when hedging is disabled, so that the in-flight reads are still hedged.
+    enabled.store(enable, std::memory_order_release);
+}
+
+bool HedgedReads::is_enabled() const {
+    return enabled.load(std::memory_order_acquire);
+}
+
+HedgedReads::Stats HedgedReads::get_stats() const {
+    return Stats{reads.load(), hedges.load(), hedge_wins.load()};
+}
+
+void HedgedReads::record_latency(uint64_t latency_us) {
+    std::lock_guard<std::mutex> lck(latency_mutex);
+    if(latency_window.size() < HEDGED_READ_LATENCY_WINDOW) {
+        latency_window.push_back(latency_us);
+    } else {
+        latency_window[next_sample] = latency_us;
+        next_sample = (next_sample + 1) % HEDGED_READ_LATENCY_WINDOW;
+    }
+    if(latency_window.size() < HEDGED_READ_MIN_SAMPLES || ++samples_since_update < HEDGED_READ_MIN_SAMPLES) {
+        return;
+    }
+    samples_since_update = 0;
+    std::vector<uint64_t> samples(latency_window);
+    const std::size_t rank = std::min(samples.size() - 1,
+                                      static_cast<std::size_t>(std::ceil(percentile / 100.0 * samples.size())) - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    delay_us = std::max(samples[rank], min_delay_us);
+}
+
+uint64_t HedgedReads::get_delay_us() const {
+    std::lock_guard<std::mutex> lck(latency_mutex);
+    return delay_us;
+}
+
+bool HedgedReads::acquire_hedge() {
+    return hedges.load() * 100 < reads.load() * HEDGED_READ_MAX_HEDGE_PERCENT;
+}
+
+void HedgedReads::schedule(uint64_t deadline_us, const std::shared_ptr<Read>& read) {
+    {
+        std::lock_guard<std::mutex> lck(deadlines_mutex);
+        if(worker_running) {
+            const bool earliest = deadlines.empty() || deadline_us < deadlines.top().first;
+            deadlines.emplace(deadline_us, read);
+            if(earliest) {
+                deadlines_cv.notify_one();
+            }
+            return;
+        }
+    }
+    read->abandon();
+}
+
+void HedgedReads::send_hedges() {
+    pthread_setname_np(pthread_self(), "cs_hedge");
+    std::unique_lock<std::mutex> lck(deadlines_mutex);
+    while(worker_running) {
+        if(deadlines.empty()) {
+            deadlines_cv.wait(lck);
+            continue;
+        }
+        const uint64_t deadline_us = deadlines.top().first;
+        if(now_us() < deadline_us) {
+            // a read with an earlier deadline, or the destructor, wakes the worker up.
+            deadlines_cv.wait_until(lck, std::chrono::steady_clock::time_point(std::chrono::microseconds(deadline_us)));
+            continue;
+        }
+        auto read = deadlines.top().second;
+        deadlines.pop();
+        // send without holding the lock: sending a duplicate read takes the client locks, which the readers may hold
+        // while scheduling.
+        lck.unlock();
+        read->hedge(*this);
+        read.reset();
+        lck.lock();
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,158 @@
+#include <cascade/detail/member_load_tracker.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace derecho {
+namespace cascade {
+
+MemberLoadTracker::MemberLoadTracker() : next_request_id(0), next_start(0) {}
+
+uint64_t MemberLoadTracker::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+void MemberLoadTracker::complete_until(NodeLoad& load, std::map<uint64_t, Request>::iterator last) {
+    auto end = std::next(last);
+    for(auto it = load.outstanding_requests.begin(); it != end; it++) {
+        if(it->second.tracked) {
+            load.num_tracked--;
+        }
+    }
+    load.outstanding_requests.erase(load.outstanding_requests.begin(), end);
+}
+
+void MemberLoadTracker::expire(NodeLoad& load, uint64_t now) {
+    while(!load.outstanding_requests.empty()) {
+        auto oldest = load.outstanding_requests.begin();
+        const uint64_t age = now - oldest->second.dispatch_us;
+        bool expired = (age > MEMBER_LOAD_REQUEST_EXPIRATION_US);
+        if(!expired && !oldest->second.tracked && load.last_sample_us != 0) {
+            // no tracked request sent after it has replied yet, e.g. because the client is idle.
+            expired = (age > MEMBER_LOAD_UNTRACKED_EXPIRATION_FACTOR * load.latency_ewma_us);
+        }
+        if(!expired) {
+            break;
+        }
+        complete_until(load, oldest);
+    }
+}
+
+double MemberLoadTracker::latency_of(const NodeLoad& load, uint64_t now) {
+    if(load.last_sample_us == 0) {
+        return 0.0;
+    }
+    return load.latency_ewma_us
+           * std::exp(-static_cast<double>(now - load.last_sample_us) / MEMBER_LOAD_LATENCY_DECAY_US);
+}
+
+uint64_t MemberLoadTracker::on_dispatch(node_id_t node_id, bool* tracked) {
+    std::lock_guard<std::mutex> lck(node_loads_mutex);
+    // take the time under the lock, so that the requests are in the order of their dispatch time.
+    const uint64_t now = now_us();
+    auto& load = node_loads[node_id];
+    expire(load, now);
+    const uint64_t request_id = next_request_id++;
+    const bool is_tracked = (tracked == nullptr) || (load.num_tracked == 0);
+    if(tracked != nullptr) {
+        *tracked = is_tracked;
+    }
+    if(is_tracked) {
+        load.num_tracked++;
+    }
+    load.outstanding_requests.emplace_hint(load.outstanding_requests.cend(), request_id, Request{now, is_tracked});
+    return request_id;
+}
+
+void MemberLoadTracker::on_reply(node_id_t node_id, uint64_t request_id, bool succeeded) {
+    const uint64_t now = now_us();
+    std::lock_guard<std::mutex> lck(node_loads_mutex);
+    auto& load = node_loads[node_id];
+    auto request = load.outstanding_requests.find(request_id);
+    if(request == load.outstanding_requests.end()) {
+        // the request has expired.
+        return;
+    }
+    const double sample = static_cast<double>(now - request->second.dispatch_us);
+    // the replies of a node come in the order of the requests, so the requests sent before are complete too.
+    complete_until(load, request);
+    expire(load, now);
+    if(!succeeded) {
+        return;
+    }
+    const double latency = latency_of(load, now);
+    if(load.last_sample_us == 0 || sample > latency) {
+        // a slower sample is taken at once, so a member that slows down is avoided without delay.
+        load.latency_ewma_us = sample;
+    } else {
+        // the weight of the previous average decays with the time since the previous sample.
+        const double weight = std::exp(-static_cast<double>(now - load.last_sample_us) / MEMBER_LOAD_LATENCY_DECAY_US);
+        load.latency_ewma_us = weight * latency + (1.0 - weight) * sample;
+    }
+    load.last_sample_us = now;
+}
+
+std::size_t MemberLoadTracker::get_outstanding(node_id_t node_id) const {
+    std::lock_guard<std::mutex> lck(node_loads_mutex);
+    auto load = node_loads.find(node_id);
+    if(load == node_loads.cend()) {
+        return 0;
+    }
+    // the expired requests are only dropped by the writers.
+    NodeLoad current = load->second;
+    expire(current, now_us());
+    return current.outstanding_requests.size();
+}
+
+double MemberLoadTracker::get_latency_ewma_us(node_id_t node_id) const {
+    std::lock_guard<std::mutex> lck(node_loads_mutex);
+    auto load = node_loads.find(node_id);
+    return (load == node_loads.cend()) ? 0.0 : latency_of(load->second, now_us());
+}
+
+template <typename CostFunc>
+node_id_t MemberLoadTracker::pick(const std::vector<node_id_t>& members, const CostFunc& cost_of) {
+    const uint64_t now = now_us();
+    // start from a rotating position, so that the ties are not always broken in favor of the same member.
+    const std::size_t start = next_start.fetch_add(1, std::memory_order_relaxed) % members.size();
+    node_id_t picked = members[start];
+    double lowest_cost = std::numeric_limits<double>::infinity();
+    for(std::size_t i = 0; i < members.size(); i++) {
+        const node_id_t node_id = members[(start + i) % members.size()];
+        auto& load = node_loads[node_id];
+        expire(load, now);
+        const double cost = cost_of(load, now);
+        if(cost < lowest_cost) {
+            lowest_cost = cost;
+            picked = node_id;
+        }
+    }
+    return picked;
+}
+
+node_id_t MemberLoadTracker::pick_least_outstanding(const std::vector<node_id_t>& members) {
+    std::lock_guard<std::mutex> lck(node_loads_mutex);
+    return pick(members, [](const NodeLoad& load, uint64_t) {
+        return static_cast<double>(load.outstanding_requests.size());
+    });
+}
+
+node_id_t MemberLoadTracker::pick_lowest_latency(const std::vector<node_id_t>& members) {
+    std::lock_guard<std::mutex> lck(node_loads_mutex);
+    return pick(members, [](const NodeLoad& load, uint64_t now) {
+        // the age of the oldest outstanding request is a lower bound of the latency, which penalizes a member that
+        // stops replying before any sample shows it.
+        double latency = latency_of(load, now);
+        if(!load.outstanding_requests.empty()) {
+            latency = std::max(latency, static_cast<double>(now - load.outstanding_requests.cbegin()->second.dispatch_us));
+        }
+        return latency * static_cast<double>(load.outstanding_requests.size() + 1);
+    });
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,52 @@
+#include <cascade/detail/notification_sender.hpp>
+
+#include <pthread.h>
+
+namespace derecho {
+namespace cascade {
+
+NotificationSender::NotificationSender() : running(false), stopped(false) {}
+
+NotificationSender::~NotificationSender() {
+    {
+        std::lock_guard<std::mutex> lck(pending_mutex);
+        stopped = true;
+        pending.clear();
+    }
+    pending_cv.notify_all();
+    if(sender.joinable()) {
+        sender.join();
+    }
+}
+
+void NotificationSender::post(std::function<void()>&& send) {
+    std::lock_guard<std::mutex> lck(pending_mutex);
+    if(stopped) {
+        return;
+    }
+    if(!running) {
+        running = true;
+        sender = std::thread(&NotificationSender::send_notifications, this);
+    }
+    pending.emplace_back(std::move(send));
+    pending_cv.notify_one();
+}
+
+void NotificationSender::send_notifications() {
+    pthread_setname_np(pthread_self(), "cs_notify");
+    std::unique_lock<std::mutex> lck(pending_mutex);
+    while(true) {
+        pending_cv.wait(lck, [this] { return !pending.empty() || stopped; });
+        if(stopped) {
+            break;
+        }
+        auto send = std::move(pending.front());
+        pending.pop_front();
+        lck.unlock();
+        send();
+        lck.lock();
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
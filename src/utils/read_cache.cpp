@@ -0,0 +1,158 @@
+#include <cascade/detail/read_cache.hpp>
+
+namespace derecho {
+namespace cascade {
+
+ReadCache::ReadCache() : num_pools(0), stats{0, 0, 0, 0, 0} {}
+
+bool ReadCache::to_entry_key(const Pool& pool, const std::string& key, const persistent::version_t& version, bool stable,
+                             entry_key_t& entry_key) {
+    if(version == CURRENT_VERSION) {
+        if(!pool.cache_current) {
+            return false;
+        }
+        entry_key = entry_key_t{key, CURRENT_VERSION, stable};
+        return true;
+    }
+    // a version that is not stable yet may be lost.
+    if(!stable) {
+        return false;
+    }
+    entry_key = entry_key_t{key, version, true};
+    return true;
+}
+
+void ReadCache::erase_entry(Pool& pool, std::map<entry_key_t, Entry>::iterator it) {
+    pool.bytes -= it->second.bytes;
+    stats.bytes -= it->second.bytes;
+    pool.lru.erase(it->second.lru_position);
+    pool.entries.erase(it);
+}
+
+std::size_t ReadCache::erase_current_entries(Pool& pool) {
+    std::size_t num_erased = 0;
+    for(auto it = pool.entries.begin(); it != pool.entries.end();) {
+        auto current = it++;
+        if(std::get<1>(current->first) == CURRENT_VERSION) {
+            erase_entry(pool, current);
+            num_erased++;
+        }
+    }
+    return num_erased;
+}
+
+bool ReadCache::insert_entry(Pool& pool, const entry_key_t& entry_key, std::shared_ptr<const void>&& object,
+                             const std::type_index& type, const persistent::version_t& version, std::size_t bytes) {
+    if(bytes > pool.max_bytes) {
+        return false;
+    }
+    if(std::get<1>(entry_key) == CURRENT_VERSION) {
+        auto floor = pool.floors.find(std::get<0>(entry_key));
+        if(floor != pool.floors.end() && version < floor->second) {
+            return false;
+        }
+    }
+    auto it = pool.entries.find(entry_key);
+    if(it != pool.entries.end()) {
+        if(version < it->second.version) {
+            return false;
+        }
+        erase_entry(pool, it);
+    }
+    pool.lru.emplace_front(entry_key);
+    pool.entries.emplace(entry_key, Entry{std::move(object), type, version, bytes, pool.lru.begin()});
+    pool.bytes += bytes;
+    stats.bytes += bytes;
+    while(pool.bytes > pool.max_bytes) {
+        erase_entry(pool, pool.entries.find(pool.lru.back()));
+        stats.evictions++;
+    }
+    return true;
+}
+
+void ReadCache::enable(const std::string& object_pool_pathname, std::size_t max_bytes, bool cache_current) {
+    if(max_bytes == 0) {
+        throw derecho::derecho_exception("Invalid read cache size for object pool:" + object_pool_pathname);
+    }
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    auto& pool = pools[object_pool_pathname];
+    if(!pool) {
+        pool = std::make_unique<Pool>();
+        num_pools.store(pools.size());
+    }
+    pool->max_bytes = max_bytes;
+    if(pool->cache_current && !cache_current) {
+        // the entries of the current version are not kept valid any more.
+        erase_current_entries(*pool);
+    }
+    pool->cache_current = cache_current;
+    while(pool->bytes > pool->max_bytes) {
+        erase_entry(*pool, pool->entries.find(pool->lru.back()));
+        stats.evictions++;
+    }
+}
+
+void ReadCache::disable(const std::string& object_pool_pathname) {
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    auto pool_it = pools.find(object_pool_pathname);
+    if(pool_it == pools.end()) {
+        return;
+    }
+    stats.bytes -= pool_it->second->bytes;
+    pools.erase(pool_it);
+    num_pools.store(pools.size());
+}
+
+bool ReadCache::is_active() const {
+    return num_pools.load() > 0;
+}
+
+bool ReadCache::is_enabled(const std::string& object_pool_pathname) const {
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    return pools.find(object_pool_pathname) != pools.end();
+}
+
+void ReadCache::invalidate(const std::string& object_pool_pathname, const std::string& key, const persistent::version_t& version) {
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    auto pool_it = pools.find(object_pool_pathname);
+    if(pool_it == pools.end()) {
+        return;
+    }
+    Pool& pool = *pool_it->second;
+    if(version != CURRENT_VERSION) {
+        auto floor = pool.floors.find(key);
+        if(floor == pool.floors.end()) {
+            pool.floors.emplace(key, version);
+            pool.floor_order.emplace_back(key);
+            if(pool.floor_order.size() > READ_CACHE_MAX_FLOORS_PER_POOL) {
+                pool.floors.erase(pool.floor_order.front());
+                pool.floor_order.pop_front();
+            }
+        } else if(floor->second < version) {
+            floor->second = version;
+        }
+    }
+    for(bool stable : {false, true}) {
+        auto it = pool.entries.find(entry_key_t{key, CURRENT_VERSION, stable});
+        if(it != pool.entries.end() && (version == CURRENT_VERSION || it->second.version < version)) {
+            erase_entry(pool, it);
+            stats.invalidations++;
+        }
+    }
+}
+
+void ReadCache::invalidate_all(const std::string& object_pool_pathname) {
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    auto pool_it = pools.find(object_pool_pathname);
+    if(pool_it != pools.end()) {
+        stats.invalidations += erase_current_entries(*pool_it->second);
+    }
+}
+
+ReadCache::Stats ReadCache::get_stats() const {
+    std::lock_guard<std::mutex> lck(pools_mutex);
+    return stats;
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,76 @@
+#include <cascade/detail/reply_watcher.hpp>
+
+#include <pthread.h>
+
+namespace derecho {
+namespace cascade {
+
+ReplyWatcher::ReplyWatcher() : stopped(false) {}
+
+ReplyWatcher::~ReplyWatcher() {
+    {
+        std::lock_guard<std::mutex> lck(node_replies_mutex);
+        stopped = true;
+        for(auto& replies : node_replies) {
+            replies.second->replies_cv.notify_all();
+        }
+    }
+    // the threads are not started or removed once stopped is set.
+    for(auto& replies : node_replies) {
+        if(replies.second->watcher.joinable()) {
+            replies.second->watcher.join();
+        }
+    }
+}
+
+void ReplyWatcher::watch(node_id_t node_id, std::unique_ptr<Reply>&& reply) {
+    std::unique_lock<std::mutex> lck(node_replies_mutex);
+    if(stopped) {
+        lck.unlock();
+        reply->abandon();
+        return;
+    }
+    auto& replies = node_replies[node_id];
+    if(!replies) {
+        replies = std::make_unique<NodeReplies>();
+        replies->watcher = std::thread(&ReplyWatcher::watch_node_replies, this, node_id, std::ref(*replies));
+    }
+    replies->replies.emplace_back(std::move(reply));
+    replies->replies_cv.notify_one();
+}
+
+void ReplyWatcher::watch_node_replies(node_id_t node_id, NodeReplies& replies) {
+    pthread_setname_np(pthread_self(), ("cs_reply" + std::to_string(node_id)).substr(0, 15).c_str());
+    std::unique_lock<std::mutex> lck(node_replies_mutex);
+    while(true) {
+        replies.replies_cv.wait(lck, [this, &replies] { return !replies.replies.empty() || stopped; });
+        if(stopped) {
+            break;
+        }
+        auto reply = std::move(replies.replies.front());
+        replies.replies.pop_front();
+        lck.unlock();
+        // wait in slices, so that a reply which never comes does not keep the watcher from stopping.
+        while(!reply->wait_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(REPLY_WATCHER_STOP_CHECK_MS))) {
+            lck.lock();
+            const bool stopping = stopped;
+            lck.unlock();
+            if(stopping) {
+                reply->abandon();
+                break;
+            }
+        }
+        lck.lock();
+    }
+    // the destructor has stopped the watcher: give up the replies not watched yet.
+    while(!replies.replies.empty()) {
+        auto reply = std::move(replies.replies.front());
+        replies.replies.pop_front();
+        lck.unlock();
+        reply->abandon();
+        lck.lock();
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
@@ -0,0 +1,48 @@
+#include <cascade/detail/submission_locks.hpp>
+
+namespace derecho {
+namespace cascade {
+
+SubmissionLocks::Guard::Guard(SubmissionLocks& _locks, bool _exclusive, std::mutex& node_mutex)
+        : locks(_locks), exclusive(_exclusive), node_lock(node_mutex) {}
+
+SubmissionLocks::Guard::~Guard() {
+    node_lock.unlock();
+    locks.release(exclusive);
+}
+
+SubmissionLocks::SubmissionLocks() : shared_senders(0), exclusive_sender(false) {}
+
+SubmissionLocks::Guard SubmissionLocks::lock(node_id_t node_id) {
+    std::unique_lock<std::mutex> lck(gate_mutex);
+    gate_cv.wait(lck, [this] { return !exclusive_sender; });
+    auto& node_lock = node_locks[node_id];
+    if(!node_lock) {
+        node_lock = std::make_unique<NodeLock>();
+    }
+    const bool exclusive = !node_lock->contacted;
+    if(exclusive) {
+        // the new requests wait from now on, and the requests in flight are waited for.
+        exclusive_sender = true;
+        node_lock->contacted = true;
+        gate_cv.wait(lck, [this] { return shared_senders == 0; });
+    } else {
+        shared_senders++;
+    }
+    NodeLock* locked = node_lock.get();
+    lck.unlock();
+    return Guard(*this, exclusive, locked->mutex);
+}
+
+void SubmissionLocks::release(bool exclusive) {
+    std::lock_guard<std::mutex> lck(gate_mutex);
+    if(exclusive) {
+        exclusive_sender = false;
+        gate_cv.notify_all();
+    } else if(--shared_senders == 0 && exclusive_sender) {
+        gate_cv.notify_all();
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho
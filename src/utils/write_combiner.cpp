@@ -0,0 +1,154 @@
+#include <cascade/detail/write_combiner.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace derecho {
+namespace cascade {
+
+WriteCombiner::WriteCombiner() : enabled(false),
+                                 max_batch_bytes(WRITE_COMBINER_DEFAULT_MAX_BATCH_BYTES),
+                                 max_delay_us(WRITE_COMBINER_DEFAULT_MAX_DELAY_US),
+                                 objects(0),
+                                 batches(0),
+                                 pending_objects(0),
+                                 worker_running(false) {}
+
+WriteCombiner::~WriteCombiner() {
+    {
+        std::lock_guard<std::mutex> lck(buffers_mutex);
+        worker_running = false;
+    }
+    buffers_cv.notify_all();
+    if(worker.joinable()) {
+        worker.join();
+    }
+    flush_all();
+}
+
+uint64_t WriteCombiner::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+void WriteCombiner::set_policy(bool enable, std::size_t _max_batch_bytes, uint64_t _max_delay_us) {
+    if(enable && (_max_batch_bytes == 0 || _max_delay_us == 0)) {
+        throw derecho::derecho_exception("Invalid write coalescing policy, max batch bytes:" + std::to_string(_max_batch_bytes)
+                                         + ", max delay us:" + std::to_string(_max_delay_us));
+    }
+    max_batch_bytes.store(_max_batch_bytes);
+    max_delay_us.store(_max_delay_us);
+    if(enable) {
+        std::lock_guard<std::mutex> lck(buffers_mutex);
+        if(!worker_running) {
+            worker_running = true;
+            worker = std::thread(&WriteCombiner::watch_deadlines, this);
+        }
+    }
+    enabled.store(enable, std::memory_order_release);
+    if(!enable) {
+        // the worker keeps running, in case a racing put is buffered after the flush.
+        flush_all();
+    }
+}
+
+bool WriteCombiner::is_enabled() const {
+    return enabled.load(std::memory_order_acquire);
+}
+
+WriteCombiner::Stats WriteCombiner::get_stats() const {
+    return Stats{objects.load(), batches.load()};
+}
+
+void WriteCombiner::flush_buffer(Buffer& buffer) {
+    // the objects are taken out of the buffer even if they fail to be sent.
+    pending_objects -= buffer.size();
+    try {
+        if(buffer.flush()) {
+            batches++;
+        }
+    } catch(const std::exception& ex) {
+        dbg_default_warn("{}: failed to send a coalesced batch: {}", __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void WriteCombiner::flush_all() {
+    std::vector<Buffer*> all_buffers;
+    {
+        std::lock_guard<std::mutex> lck(buffers_mutex);
+        for(auto& kv : buffers) {
+            all_buffers.emplace_back(kv.second.get());
+        }
+    }
+    for(auto* buffer : all_buffers) {
+        std::lock_guard<std::mutex> lck(buffer->mutex);
+        flush_buffer(*buffer);
+    }
+}
+
+void WriteCombiner::flush_shard(const std::type_index& subgroup_type, uint32_t subgroup_index, uint32_t shard_index) {
+    if(pending_objects.load() == 0) {
+        return;
+    }
+    Buffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lck(buffers_mutex);
+        auto it = buffers.find(std::make_tuple(subgroup_type, subgroup_index, shard_index));
+        if(it == buffers.end()) {
+            return;
+        }
+        buffer = it->second.get();
+    }
+    std::lock_guard<std::mutex> lck(buffer->mutex);
+    flush_buffer(*buffer);
+}
+
+void WriteCombiner::notify_deadline() {
+    // lock and unlock, so that the notification is not lost between the worker's check and its wait.
+    { std::lock_guard<std::mutex> lck(buffers_mutex); }
+    buffers_cv.notify_one();
+}
+
+void WriteCombiner::watch_deadlines() {
+    std::unique_lock<std::mutex> lck(buffers_mutex);
+    while(worker_running) {
+        // find the due buffers and the next deadline.
+        const uint64_t now = now_us();
+        uint64_t next_deadline = std::numeric_limits<uint64_t>::max();
+        std::vector<Buffer*> due_buffers;
+        for(auto& kv : buffers) {
+            const uint64_t deadline = kv.second->deadline_us.load(std::memory_order_relaxed);
+            if(deadline == 0) {
+                continue;
+            }
+            if(deadline <= now) {
+                due_buffers.emplace_back(kv.second.get());
+            } else {
+                next_deadline = std::min(next_deadline, deadline);
+            }
+        }
+        if(!due_buffers.empty()) {
+            // send without holding buffers_mutex, which the writers need to find their buffers.
+            lck.unlock();
+            for(auto* buffer : due_buffers) {
+                std::lock_guard<std::mutex> buffer_lck(buffer->mutex);
+                // the buffer may have been sent by a writer in the meantime.
+                const uint64_t deadline = buffer->deadline_us.load(std::memory_order_relaxed);
+                if(deadline != 0 && deadline <= now_us()) {
+                    flush_buffer(*buffer);
+                }
+            }
+            lck.lock();
+            continue;
+        }
+        if(next_deadline == std::numeric_limits<uint64_t>::max()) {
+            buffers_cv.wait(lck);
+        } else {
+            buffers_cv.wait_for(lck, std::chrono::microseconds(next_deadline - now));
+        }
+    }
+}
+
+}  // namespace cascade
+}  // namespace derecho